@@ -0,0 +1,235 @@
+// "How many seats are left" and "4 seats together in section N" on a large
+// venue: availability bitmaps (and, for whole-event counts, the inventory
+// counters) against a scan of the seats through seat_get.
+// The venue is loaded from a manifest (sections of rows of seats) and about
+// 70% of it is held at random before timing.
+//
+//   make bench/bench_avail && ./bench/bench_avail [sections] [rows] [seats_per_row]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_util.h"
+#include "manifest.h"
+#include "reservation.h"
+#include "utils.h"
+
+static const char *g_csv = "/tmp/bench_avail.csv";
+static const char *g_bin = "/tmp/bench_avail.tbv";
+
+static size_t g_sections, g_rows, g_per_row;
+
+static void seat_name(char *out, size_t sec, size_t row, size_t i)
+{
+    snprintf(out, TB_ID_LEN, "S%u-R%u-%u", (unsigned)sec, (unsigned)row, (unsigned)i);
+}
+
+static void load_venue(void)
+{
+    FILE *f = fopen(g_csv, "w");
+    if (!f)
+    {
+        perror(g_csv);
+        exit(1);
+    }
+    char sid[TB_ID_LEN];
+    for (size_t s = 0; s < g_sections; ++s)
+        for (size_t r = 0; r < g_rows; ++r)
+            for (size_t i = 0; i < g_per_row; ++i)
+            {
+                seat_name(sid, s, r, i);
+                fprintf(f, "ARENA,%zu,R%zu,%s,P%zu,%zu\n", s, r, sid, s % 4, 2500 + 1000 * (s % 4));
+            }
+    fclose(f);
+    if (!tb_manifest_from_csv(g_csv, g_bin, NULL) ||
+        reservation_load_manifest(g_bin, 1) != g_sections * g_rows * g_per_row)
+    {
+        fprintf(stderr, "venue load failed\n");
+        exit(1);
+    }
+    remove(g_csv);
+    remove(g_bin);
+}
+
+// Today's answer: look at every seat.
+static size_t naive_count(size_t sec_lo, size_t sec_hi)
+{
+    char sid[TB_ID_LEN];
+    seat_view_t v;
+    size_t n = 0;
+    for (size_t s = sec_lo; s < sec_hi; ++s)
+        for (size_t r = 0; r < g_rows; ++r)
+            for (size_t i = 0; i < g_per_row; ++i)
+            {
+                seat_name(sid, s, r, i);
+                n += seat_get("ARENA", sid, &v) && v.status == SEAT_AVAILABLE;
+            }
+    return n;
+}
+
+// Same policy as find_best_available: first row with a block of n, the
+// block nearest the row centre; then hold it.
+static bool naive_best(const char *user, size_t sec, size_t n, char ids[][TB_ID_LEN])
+{
+    char sid[TB_ID_LEN];
+    seat_view_t v;
+    bool free_seat[1024];
+    size_t near = (g_per_row - n) / 2;
+    for (size_t r = 0; r < g_rows; ++r)
+    {
+        for (size_t i = 0; i < g_per_row; ++i)
+        {
+            seat_name(sid, sec, r, i);
+            free_seat[i] = seat_get("ARENA", sid, &v) && v.status == SEAT_AVAILABLE;
+        }
+        size_t best = SIZE_MAX, run = 0;
+        for (size_t i = 0; i < g_per_row; ++i)
+        {
+            run = free_seat[i] ? run + 1 : 0;
+            if (run < n)
+                continue;
+            size_t start = i + 1 - n;
+            size_t d = start < near ? near - start : start - near;
+            if (best == SIZE_MAX || d < (best < near ? near - best : best - near))
+                best = start;
+        }
+        if (best == SIZE_MAX)
+            continue;
+        for (size_t k = 0; k < n; ++k)
+        {
+            seat_name(ids[k], sec, r, best + k);
+            if (place_hold(user, "ARENA", ids[k]).code != RES_OK)
+                return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+static double per_call_us(uint64_t t0, uint64_t t1, size_t calls)
+{
+    return (t1 - t0) / 1e3 / calls;
+}
+
+int main(int argc, char **argv)
+{
+    g_sections = bench_arg_size(argc, argv, 1, 40);
+    g_rows = bench_arg_size(argc, argv, 2, 50);
+    g_per_row = bench_arg_size(argc, argv, 3, 50);
+    if (g_per_row < 8 || g_per_row > 1024)
+        g_per_row = 50;
+    if (g_sections == 0 || g_sections > 99999 || g_rows == 0 || g_rows > 99999)
+        return 1; // seat ids must fit in TB_ID_LEN
+    size_t seats = g_sections * g_rows * g_per_row;
+    if (!reservation_init())
+        return 1;
+    load_venue();
+
+    // Hold ~70% of the venue at random.
+    uint64_t seed = 42;
+    char sid[TB_ID_LEN];
+    for (size_t s = 0; s < g_sections; ++s)
+        for (size_t r = 0; r < g_rows; ++r)
+            for (size_t i = 0; i < g_per_row; ++i)
+                if (bench_rand(&seed) % 10 < 7)
+                {
+                    seat_name(sid, s, r, i);
+                    place_hold("CROWD", "ARENA", sid);
+                }
+    size_t left = event_available_count("ARENA", NULL);
+    printf("venue: %zu sections x %zu rows x %zu seats = %zu seats, %zu available\n",
+           g_sections, g_rows, g_per_row, seats, left);
+
+    // Whole-event count.
+    enum { REPS = 200, NAIVE_REPS = 5 };
+    uint64_t t0 = bench_now_ns();
+    for (int k = 0; k < NAIVE_REPS; ++k)
+        if (naive_count(0, g_sections) != left)
+            printf("  naive count mismatch!\n");
+    uint64_t t1 = bench_now_ns();
+    printf("event count     seat_get scan   %10.1f us\n", per_call_us(t0, t1, NAIVE_REPS));
+    const char *name;
+    for (size_t v = 0; (name = tb_utils_variant_name(v)) != NULL; ++v)
+    {
+        if (!tb_utils_select(name))
+            continue;
+        t0 = bench_now_ns();
+        size_t sum = 0;
+        for (int k = 0; k < REPS; ++k)
+            sum += event_available_count("ARENA", NULL);
+        t1 = bench_now_ns();
+        printf("event count     bitmap %-8s %10.2f us%s\n", name, per_call_us(t0, t1, REPS),
+               sum == left * REPS ? "" : "  (mismatch!)");
+    }
+
+    // The same total from the per-event counters.
+    t0 = bench_now_ns();
+    size_t held = 0;
+    event_inventory_t inv;
+    for (int k = 0; k < REPS; ++k)
+        if (event_inventory("ARENA", &inv))
+            held += inv.held;
+    t1 = bench_now_ns();
+    printf("event count     counters        %10.2f us%s\n", per_call_us(t0, t1, REPS),
+           held == (seats - left) * REPS ? "" : "  (mismatch!)");
+
+    // Section count.
+    size_t sec_left = event_available_count("ARENA", "7");
+    t0 = bench_now_ns();
+    for (int k = 0; k < NAIVE_REPS * 10; ++k)
+        if (naive_count(7, 8) != sec_left)
+            printf("  naive section count mismatch!\n");
+    t1 = bench_now_ns();
+    printf("section count   seat_get scan   %10.1f us\n", per_call_us(t0, t1, NAIVE_REPS * 10));
+    t0 = bench_now_ns();
+    size_t sum = 0;
+    for (int k = 0; k < REPS; ++k)
+        sum += event_available_count("ARENA", "7");
+    t1 = bench_now_ns();
+    printf("section count   bitmap          %10.2f us%s\n", per_call_us(t0, t1, REPS),
+           sum == sec_left * REPS ? "" : "  (mismatch!)");
+
+    // Best 4 together, per section, held and then released again.
+    char ids[RES_MAX_GROUP][TB_ID_LEN];
+    group_seat_t g[RES_MAX_GROUP];
+    size_t found_naive = 0, found_bits = 0;
+    t0 = bench_now_ns();
+    for (size_t s = 0; s < g_sections; ++s)
+        if (naive_best("BUYER", s, 4, ids))
+        {
+            found_naive++;
+            for (int k = 0; k < 4; ++k)
+                cancel_hold("BUYER", "ARENA", ids[k]);
+        }
+    t1 = bench_now_ns();
+    printf("best 4 together seat_get scan   %10.1f us/section\n", per_call_us(t0, t1, g_sections));
+    char sec[TB_ID_LEN];
+    t0 = bench_now_ns();
+    for (size_t s = 0; s < g_sections; ++s)
+    {
+        snprintf(sec, sizeof sec, "%zu", s);
+        if (find_best_available("BUYER", "ARENA", sec, 4, g) == RES_OK)
+        {
+            found_bits++;
+            for (int k = 0; k < 4; ++k)
+                cancel_hold("BUYER", "ARENA", g[k].seat_id);
+        }
+    }
+    t1 = bench_now_ns();
+    printf("best 4 together bitmap          %10.1f us/section%s\n", per_call_us(t0, t1, g_sections),
+           found_bits == found_naive ? "" : "  (found count differs!)");
+
+    // What the holds themselves cost, in both of the above.
+    t0 = bench_now_ns();
+    for (size_t s = 0; s < g_sections; ++s)
+        for (int k = 0; k < 4; ++k)
+        {
+            place_hold("BUYER", "ARENA", g[k].seat_id);
+            cancel_hold("BUYER", "ARENA", g[k].seat_id);
+        }
+    t1 = bench_now_ns();
+    printf("  of which 4 holds + cancels    %10.1f us/section\n", per_call_us(t0, t1, g_sections));
+
+    reservation_shutdown();
+    return 0;
+}
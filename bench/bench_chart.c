@@ -0,0 +1,197 @@
+// Full seating-chart reads of a 60k-seat venue while writers hold and
+// cancel seats: one consistent event snapshot against a seat_get per seat,
+// and the cached serialized chart against serializing seat_get results.
+//
+//   make bench/bench_chart && ./bench/bench_chart [seats] [millis] [writers]
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_util.h"
+#include "reservation.h"
+
+#define MAX_SEATS 200000
+
+typedef struct
+{
+    size_t seats;
+    volatile int stop;
+    uint64_t ops;
+    uint64_t seed;
+} worker_t;
+
+static char g_seat_ids[MAX_SEATS][TB_ID_LEN];
+
+static void *writer_fn(void *p)
+{
+    worker_t *w = (worker_t *)p;
+    char user[TB_ID_LEN];
+    snprintf(user, sizeof user, "U%llu", (unsigned long long)w->seed);
+    while (!__atomic_load_n(&w->stop, __ATOMIC_ACQUIRE))
+    {
+        const char *sid = g_seat_ids[bench_rand(&w->seed) % w->seats];
+        if (place_hold(user, "VENUE", sid).code == RES_OK)
+            cancel_hold(user, "VENUE", sid);
+        w->ops++;
+    }
+    return NULL;
+}
+
+// One full chart: every seat, counted by status.
+static size_t chart_snapshot(void)
+{
+    seat_snapshot_t *s = event_snapshot_begin("VENUE");
+    seat_view_t v;
+    size_t avail = 0;
+    while (event_snapshot_next(s, &v))
+        avail += v.status == SEAT_AVAILABLE;
+    event_snapshot_end(s);
+    return avail;
+}
+
+// What a chart request costs without the cache: seat_get per seat, then
+// JSON for the client.
+static size_t chart_seat_get_json(size_t seats)
+{
+    static char out[200 * MAX_SEATS];
+    static const char st[4] = {'A', 'H', 'S', 'R'};
+    size_t len = (size_t)sprintf(out, "{\"event\":\"VENUE\",\"seats\":[");
+    seat_view_t v;
+    for (size_t i = 0; i < seats; ++i)
+        if (seat_get("VENUE", g_seat_ids[i], &v))
+            len += (size_t)sprintf(out + len, "%s{\"id\":\"%s\",\"price\":%d,\"status\":\"%c\"}",
+                                   i ? "," : "", v.seat_id, (int)v.price_cents, st[v.status & 3]);
+    len += (size_t)sprintf(out + len, "]}");
+    return len;
+}
+
+// The cached chart: a reference to a ready buffer.
+static size_t chart_cached(chart_format_t format)
+{
+    const event_chart_t *c = event_chart_acquire("VENUE", format);
+    size_t len = c ? c->len : 0;
+    event_chart_release(c);
+    return len;
+}
+
+static uint64_t cpu_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static size_t chart_seat_get(size_t seats)
+{
+    seat_view_t v;
+    size_t avail = 0;
+    for (size_t i = 0; i < seats; ++i)
+        if (seat_get("VENUE", g_seat_ids[i], &v))
+            avail += v.status == SEAT_AVAILABLE;
+    return avail;
+}
+
+// reader: 0 none, 1 snapshots, 2 seat_get loops, 3 seat_get + JSON,
+// 4 cached JSON, 5 cached binary
+static void run(const char *label, size_t seats, int writers, int reader, unsigned millis)
+{
+    enum { MAX_THREADS = 16 };
+    worker_t wr[MAX_THREADS];
+    pthread_t wt[MAX_THREADS];
+    for (int i = 0; i < writers; ++i)
+    {
+        wr[i] = (worker_t){.seats = seats, .seed = 1 + (uint64_t)i};
+        pthread_create(&wt[i], NULL, writer_fn, &wr[i]);
+    }
+
+    uint64_t charts = 0, t0 = bench_now_ns(), t1, c0 = cpu_now_ns();
+    size_t avail = 0;
+    do
+    {
+        if (reader == 1)
+            avail += chart_snapshot();
+        else if (reader == 2)
+            avail += chart_seat_get(seats);
+        else if (reader == 3)
+            avail += chart_seat_get_json(seats);
+        else if (reader >= 4)
+            avail += chart_cached(reader == 4 ? CHART_JSON : CHART_BINARY);
+        else
+            usleep(10000);
+        charts += reader != 0;
+        t1 = bench_now_ns();
+    } while (t1 - t0 < millis * 1000000ull);
+    uint64_t cpu = cpu_now_ns() - c0;
+
+    uint64_t writes = 0;
+    for (int i = 0; i < writers; ++i)
+        __atomic_store_n(&wr[i].stop, 1, __ATOMIC_RELEASE);
+    for (int i = 0; i < writers; ++i)
+    {
+        pthread_join(wt[i], NULL);
+        writes += wr[i].ops;
+    }
+    double secs = (t1 - t0) / 1e9;
+    if (charts)
+        printf("%-16s %10.0f charts/s %9.1f us cpu/chart  place_hold: %8.0f ops/s\n", label,
+               charts / secs, cpu / 1e3 / charts, writes / secs);
+    else
+        printf("%-16s %10s charts/s %9s us cpu/chart  place_hold: %8.0f ops/s\n", label, "-", "-",
+               writes / secs);
+    (void)avail;
+}
+
+int main(int argc, char **argv)
+{
+    size_t seats = bench_arg_size(argc, argv, 1, 60000);
+    unsigned millis = (unsigned)bench_arg_size(argc, argv, 2, 2000);
+    int writers = (int)bench_arg_size(argc, argv, 3, 2);
+    if (writers < 0 || writers > 16)
+        writers = 2;
+    if (seats == 0 || seats > MAX_SEATS)
+        seats = 60000;
+
+    if (!reservation_init())
+        return 1;
+    for (size_t i = 0; i < seats; ++i)
+    {
+        seat_t s = {0};
+        strcpy(s.event_id, "VENUE");
+        snprintf(g_seat_ids[i], TB_ID_LEN, "S%zu-%zu", i / 100, i % 100);
+        strcpy(s.seat_id, g_seat_ids[i]);
+        s.price_cents = 5000;
+        reservation_put_seat(&s);
+    }
+
+    printf("seats=%zu writers=%d\n", seats, writers);
+    run("writers only", seats, writers, 0, millis);
+    run("snapshot", seats, writers, 1, millis);
+    run("seat_get loop", seats, writers, 2, millis);
+    run("seat_get + JSON", seats, writers, 3, millis);
+    run("cached JSON", seats, writers, 4, millis);
+    run("cached binary", seats, writers, 5, millis);
+    run("snapshot, idle", seats, 0, 1, millis);
+    run("seat_get, idle", seats, 0, 2, millis);
+    run("cached, idle", seats, 0, 4, millis);
+
+    // The cache must have converged on the seats as they are now.
+    const event_chart_t *c = event_chart_acquire("VENUE", CHART_JSON);
+    char *fresh = malloc(200 * MAX_SEATS);
+    size_t len = 0;
+    seat_view_t v;
+    static const char st[4] = {'A', 'H', 'S', 'R'};
+    len += (size_t)sprintf(fresh, "{\"event\":\"VENUE\",\"seats\":[");
+    for (size_t i = 0; i < seats; ++i)
+        if (seat_get("VENUE", g_seat_ids[i], &v))
+            len += (size_t)sprintf(fresh + len, "%s{\"id\":\"%s\",\"price\":%d,\"status\":\"%c\"}",
+                                   i ? "," : "", v.seat_id, (int)v.price_cents, st[v.status & 3]);
+    len += (size_t)sprintf(fresh + len, "]}");
+    printf("cached chart %s a fresh build\n",
+           c && c->len == len && memcmp(c->data, fresh, len) == 0 ? "matches" : "DIFFERS from");
+    event_chart_release(c);
+    free(fresh);
+
+    reservation_shutdown();
+    return 0;
+}
@@ -0,0 +1,143 @@
+// Aggregate throughput of a cluster of node processes behind one router, as
+// nodes are added live. Starts with one node, then doubles up to max_nodes,
+// moving events onto each new node while nothing runs and timing the moves.
+// Per round, clients_per_node threads per node each place and cancel holds
+// on random seats of random events for `millis`.
+//
+//   make bench/bench_cluster && ./bench/bench_cluster [max_nodes] [clients_per_node] [millis] [events]
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+
+#include "bench_util.h"
+#include "cluster.h"
+
+#define MAX_NODES   16
+#define MAX_CLIENTS 256
+#define SEATS       256
+
+static tb_router_t *g_router;
+static size_t g_events;
+static volatile int g_stop;
+
+typedef struct
+{
+    uint64_t seed;
+    uint64_t ops;
+    uint64_t errors;
+} client_t;
+
+static void *client_fn(void *p)
+{
+    client_t *c = (client_t *)p;
+    char user[TB_ID_LEN], ev[TB_ID_LEN], sid[TB_ID_LEN];
+    snprintf(user, sizeof user, "BU%llu", (unsigned long long)c->seed);
+    while (!g_stop)
+    {
+        uint64_t x = bench_rand(&c->seed);
+        snprintf(ev, sizeof ev, "BE%llu", (unsigned long long)(x % g_events));
+        snprintf(sid, sizeof sid, "S%llu", (unsigned long long)((x >> 32) % SEATS));
+        hold_result_t h = tb_router_place_hold(g_router, user, ev, sid);
+        if (h.code == RES_OK)
+            c->errors += tb_router_cancel_hold(g_router, user, ev, sid) != RES_OK;
+        else
+            c->errors += h.code == RES_INTERNAL_ERR;
+        c->ops += 1 + (h.code == RES_OK);
+    }
+    return NULL;
+}
+
+static double run(size_t clients, unsigned millis, uint64_t *errors)
+{
+    pthread_t th[MAX_CLIENTS];
+    client_t cs[MAX_CLIENTS];
+    g_stop = 0;
+    uint64_t t0 = bench_now_ns();
+    for (size_t i = 0; i < clients; ++i)
+    {
+        cs[i] = (client_t){.seed = 0x9E3779B97F4A7C15ULL * (i + 1)};
+        pthread_create(&th[i], NULL, client_fn, &cs[i]);
+    }
+    usleep(millis * 1000u);
+    g_stop = 1;
+    uint64_t ops = 0;
+    *errors = 0;
+    for (size_t i = 0; i < clients; ++i)
+    {
+        pthread_join(th[i], NULL);
+        ops += cs[i].ops;
+        *errors += cs[i].errors;
+    }
+    return ops / ((bench_now_ns() - t0) / 1e9);
+}
+
+int main(int argc, char **argv)
+{
+    size_t max_nodes = bench_arg_size(argc, argv, 1, 4);
+    size_t per_node = bench_arg_size(argc, argv, 2, 4);
+    unsigned millis = (unsigned)bench_arg_size(argc, argv, 3, 1000);
+    g_events = bench_arg_size(argc, argv, 4, 64);
+    if (max_nodes == 0 || max_nodes > MAX_NODES || per_node == 0 ||
+        per_node * max_nodes > MAX_CLIENTS || g_events == 0)
+        return 1;
+
+    char paths[MAX_NODES][64];
+    pid_t pids[MAX_NODES];
+    for (size_t n = 0; n < max_nodes; ++n)
+    {
+        snprintf(paths[n], sizeof paths[n], "/tmp/tb_bench_cluster_%d_%zu.sock", (int)getpid(), n);
+        if ((pids[n] = tb_node_spawn(paths[n], (uint32_t)n)) < 0)
+            return 1;
+    }
+    g_router = tb_router_create();
+    if (!g_router || !tb_router_add_node(g_router, 0, paths[0]))
+        return 1;
+    static seat_t seats[SEATS];
+    memset(seats, 0, sizeof seats);
+    for (size_t e = 0; e < g_events; ++e)
+    {
+        for (size_t s = 0; s < SEATS; ++s)
+        {
+            snprintf(seats[s].event_id, TB_ID_LEN, "BE%zu", e);
+            snprintf(seats[s].seat_id, TB_ID_LEN, "S%zu", s);
+            seats[s].price_cents = 5000;
+        }
+        if (!tb_router_load_event(g_router, seats[0].event_id, seats, SEATS))
+            return 1;
+    }
+
+    printf("events=%zu x %d seats  clients/node=%zu  online cpus=%ld\n", g_events, SEATS, per_node,
+           sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%6s %8s %14s %8s %10s %12s\n", "nodes", "clients", "calls/s", "speedup", "moved", "move ms");
+    double base = 0;
+    size_t nodes = 1, moved = 0;
+    double move_ms = 0;
+    for (;;)
+    {
+        uint64_t errors;
+        double rate = run(nodes * per_node, millis, &errors);
+        if (nodes == 1)
+            base = rate;
+        printf("%6zu %8zu %12.0f/s %7.2fx %10zu %12.1f%s\n", nodes, nodes * per_node, rate,
+               rate / base, moved, move_ms, errors ? "  (errors!)" : "");
+        if (nodes * 2 > max_nodes)
+            break;
+        size_t before = tb_router_moves(g_router);
+        uint64_t t0 = bench_now_ns();
+        for (size_t n = nodes; n < nodes * 2; ++n)
+            if (!tb_router_add_node(g_router, (uint32_t)n, paths[n]))
+                return 1;
+        move_ms = (bench_now_ns() - t0) / 1e6;
+        moved = tb_router_moves(g_router) - before;
+        nodes *= 2;
+    }
+
+    tb_router_destroy(g_router);
+    for (size_t n = 0; n < max_nodes; ++n)
+    {
+        tb_node_stop(paths[n]);
+        waitpid(pids[n], NULL, 0);
+    }
+    return 0;
+}
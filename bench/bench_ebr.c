@@ -0,0 +1,171 @@
+// Lock-free lookups while other threads insert and delete seats and load
+// and unload events. Readers run find_ix + read for `millis` on their own,
+// then again alongside a writer churning one event's seats and reloading
+// another, for 1..max readers. Also prices an empty EBR section.
+//
+//   make bench/bench_ebr && ./bench/bench_ebr [seats] [max_readers] [millis]
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench_util.h"
+#include "hashtable.h"
+#include "intern.h"
+
+#define MAX_READERS 16
+#define CHURN_SEATS 4096
+#define LOAD_SEATS  1024
+
+static seat_map_t *g_map;
+static uint32_t g_event;
+static uint32_t *g_seat_ix;
+static size_t g_seats;
+static volatile int g_stop;
+
+typedef struct
+{
+    uint64_t seed;
+    uint64_t ops;
+} worker_t;
+
+static void *reader_fn(void *p)
+{
+    worker_t *w = (worker_t *)p;
+    seat_t out;
+    uint64_t ops = 0;
+    while (!g_stop)
+    {
+        for (int k = 0; k < 256; ++k)
+        {
+            uint32_t ix = g_seat_ix[bench_rand(&w->seed) % g_seats];
+            tb_ebr_enter();
+            seat_ref_t r = seat_map_find_ix(g_map, g_event, ix);
+            if (r)
+                seat_map_read(g_map, r, &out);
+            tb_ebr_exit();
+        }
+        ops += 256;
+    }
+    w->ops = ops;
+    return NULL;
+}
+
+static void *writer_fn(void *p)
+{
+    worker_t *w = (worker_t *)p;
+    static char churn[CHURN_SEATS][TB_ID_LEN], loaded[LOAD_SEATS][TB_ID_LEN];
+    for (size_t i = 0; i < CHURN_SEATS; ++i)
+        snprintf(churn[i], TB_ID_LEN, "C%zu", i);
+    for (size_t i = 0; i < LOAD_SEATS; ++i)
+        snprintf(loaded[i], TB_ID_LEN, "L%zu", i);
+    bool live[CHURN_SEATS] = {false};
+    uint64_t ops = 0;
+    while (!g_stop)
+    {
+        for (int k = 0; k < 1000; ++k)
+        {
+            size_t i = bench_rand(&w->seed) % CHURN_SEATS;
+            if (live[i])
+                seat_map_delete(g_map, "EBRCHURN", churn[i]);
+            else
+            {
+                seat_t s = {.price_cents = 100};
+                memcpy(s.event_id, "EBRCHURN", 9);
+                memcpy(s.seat_id, churn[i], TB_ID_LEN);
+                seat_map_put(g_map, &s);
+            }
+            live[i] = !live[i];
+        }
+        for (size_t i = 0; i < LOAD_SEATS; ++i)
+        {
+            seat_t s = {.price_cents = 100};
+            memcpy(s.event_id, "EBRLOAD", 8);
+            memcpy(s.seat_id, loaded[i], TB_ID_LEN);
+            seat_map_put(g_map, &s);
+        }
+        seat_map_event_unload(g_map, "EBRLOAD");
+        ops += 1000 + LOAD_SEATS + 1;
+    }
+    w->ops = ops;
+    return NULL;
+}
+
+// Reads per second over all readers, with or without the writer.
+static double run(size_t readers, bool churn, unsigned millis, double *writes)
+{
+    pthread_t rt[MAX_READERS], wt;
+    worker_t rw[MAX_READERS], ww = {.seed = 77};
+    g_stop = 0;
+    uint64_t t0 = bench_now_ns();
+    for (size_t i = 0; i < readers; ++i)
+    {
+        rw[i] = (worker_t){.seed = 0x9E3779B97F4A7C15ULL * (i + 1)};
+        pthread_create(&rt[i], NULL, reader_fn, &rw[i]);
+    }
+    if (churn)
+        pthread_create(&wt, NULL, writer_fn, &ww);
+    usleep(millis * 1000u);
+    g_stop = 1;
+    uint64_t ops = 0;
+    for (size_t i = 0; i < readers; ++i)
+    {
+        pthread_join(rt[i], NULL);
+        ops += rw[i].ops;
+    }
+    if (churn)
+        pthread_join(wt, NULL);
+    double secs = (bench_now_ns() - t0) / 1e9;
+    *writes = churn ? ww.ops / secs : 0;
+    return ops / secs;
+}
+
+int main(int argc, char **argv)
+{
+    g_seats = bench_arg_size(argc, argv, 1, 1000000);
+    size_t max_readers = bench_arg_size(argc, argv, 2, 4);
+    unsigned millis = (unsigned)bench_arg_size(argc, argv, 3, 500);
+    if (g_seats == 0 || max_readers == 0 || max_readers > MAX_READERS)
+        return 1;
+
+    g_map = seat_map_create(g_seats);
+    g_seat_ix = malloc(g_seats * sizeof *g_seat_ix);
+    seat_bulk_t *rows = malloc(g_seats * sizeof *rows);
+    if (!g_map || !g_seat_ix || !rows)
+        return 1;
+    char sid[TB_ID_LEN];
+    for (size_t i = 0; i < g_seats; ++i)
+    {
+        snprintf(sid, sizeof sid, "S%zu", i);
+        g_seat_ix[i] = tb_intern(TB_NS_SEAT, sid);
+        rows[i] = (seat_bulk_t){.seat_ix = g_seat_ix[i], .price_cents = 5000};
+    }
+    g_event = tb_intern(TB_NS_EVENT, "EBRREAD");
+    if (!seat_map_bulk_begin(g_map, g_event, g_seats) ||
+        seat_map_bulk_fill(g_map, g_event, 0, rows, g_seats, 0) != g_seats)
+        return 1;
+    seat_map_bulk_end(g_map, g_event);
+    free(rows);
+
+    const size_t sections = 20000000;
+    uint64_t t0 = bench_now_ns();
+    for (size_t i = 0; i < sections; ++i)
+    {
+        tb_ebr_enter();
+        __asm__ volatile("" ::: "memory");
+        tb_ebr_exit();
+    }
+    printf("seats=%zu  empty EBR section: %.1f ns\n", g_seats,
+           (double)(bench_now_ns() - t0) / sections);
+
+    printf("%8s %16s %16s %14s\n", "readers", "reads/s alone", "reads/s + writer", "writer ops/s");
+    for (size_t n = 1; n <= max_readers; n *= 2)
+    {
+        double w;
+        double alone = run(n, false, millis, &w);
+        double mixed = run(n, true, millis, &w);
+        printf("%8zu %14.2f M %14.2f M %12.2f M\n", n, alone / 1e6, mixed / 1e6, w / 1e6);
+    }
+    seat_map_destroy(g_map);
+    free(g_seat_ix);
+    return 0;
+}
@@ -0,0 +1,166 @@
+// Seat change feed: what publishing costs a writer, and how fast changes
+// fan out to many subscribers while writers hold and cancel seats.
+//
+//   make bench/bench_feed && ./bench/bench_feed [subscribers] [millis] [readers]
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench_util.h"
+#include "feed.h"
+#include "reservation.h"
+
+#define SEATS       10000
+#define WRITERS     2
+#define POLL_MAX    256
+#define MAX_READERS 16
+
+static char g_seat_ids[SEATS][TB_ID_LEN];
+static volatile int g_stop;
+
+typedef struct
+{
+    uint64_t seed;
+    uint64_t ops;
+} writer_t;
+
+static void *writer_fn(void *p)
+{
+    writer_t *w = (writer_t *)p;
+    char user[TB_ID_LEN];
+    snprintf(user, sizeof user, "W%llu", (unsigned long long)w->seed);
+    while (!__atomic_load_n(&g_stop, __ATOMIC_ACQUIRE))
+    {
+        const char *sid = g_seat_ids[bench_rand(&w->seed) % SEATS];
+        if (place_hold(user, "FEED", sid).code == RES_OK)
+            cancel_hold(user, "FEED", sid);
+        w->ops++;
+    }
+    return NULL;
+}
+
+// Each reader owns a stripe of the subscribers and polls them in turn.
+typedef struct
+{
+    tb_feed_sub_t **subs;
+    size_t n;
+    uint64_t delivered, polls, lapped;
+} reader_t;
+
+static void *reader_fn(void *p)
+{
+    reader_t *r = (reader_t *)p;
+    tb_change_t out[POLL_MAX];
+    while (!__atomic_load_n(&g_stop, __ATOMIC_ACQUIRE))
+    {
+        uint64_t got = 0;
+        for (size_t i = 0; i < r->n; ++i)
+        {
+            bool lost;
+            size_t n = tb_feed_poll(r->subs[i], out, POLL_MAX, &lost);
+            got += n;
+            r->lapped += lost;
+            r->polls++;
+        }
+        r->delivered += got;
+        if (got == 0)
+            usleep(1000); // nothing new anywhere: be a polite client
+    }
+    return NULL;
+}
+
+static void bench_publish_cost(void)
+{
+    enum { N = 2000000 };
+    tb_feed_t *f = tb_feed_create(65536);
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t i = 0; i < N; ++i)
+        tb_feed_publish(f, 1, i & 4095, TB_CHANGE_HELD);
+    uint64_t t1 = bench_now_ns();
+    tb_feed_destroy(f);
+
+    // One place_hold + cancel_hold pair publishes two changes.
+    enum { PAIRS = 20000 };
+    t0 = t1 - t0;
+    uint64_t t2 = bench_now_ns();
+    for (size_t i = 0; i < PAIRS; ++i)
+        if (place_hold("U", "FEED", g_seat_ids[i % SEATS]).code == RES_OK)
+            cancel_hold("U", "FEED", g_seat_ids[i % SEATS]);
+    uint64_t t3 = bench_now_ns();
+    double pub_ns = (double)t0 / N, pair_ns = (double)(t3 - t2) / PAIRS;
+    printf("publish: %.1f ns/change; hold+cancel pair %.0f ns, of which feed %.1f%%\n", pub_ns,
+           pair_ns, 200.0 * pub_ns / pair_ns);
+}
+
+int main(int argc, char **argv)
+{
+    size_t n_subs = bench_arg_size(argc, argv, 1, 1000);
+    unsigned millis = (unsigned)bench_arg_size(argc, argv, 2, 2000);
+    size_t readers = bench_arg_size(argc, argv, 3, 4);
+    if (readers == 0 || readers > MAX_READERS)
+        readers = 4;
+    if (n_subs < readers)
+        n_subs = readers;
+
+    if (!reservation_init())
+        return 1;
+    for (size_t i = 0; i < SEATS; ++i)
+    {
+        seat_t s = {0};
+        strcpy(s.event_id, "FEED");
+        snprintf(g_seat_ids[i], TB_ID_LEN, "F%zu", i);
+        strcpy(s.seat_id, g_seat_ids[i]);
+        s.price_cents = 5000;
+        reservation_put_seat(&s);
+    }
+    bench_publish_cost();
+
+    tb_feed_t *feed = reservation_feed();
+    tb_feed_sub_t **subs = malloc(n_subs * sizeof *subs);
+    for (size_t i = 0; i < n_subs; ++i)
+        subs[i] = tb_feed_subscribe(feed);
+    reader_t rd[MAX_READERS];
+    pthread_t rt[MAX_READERS], wt[WRITERS];
+    writer_t wr[WRITERS];
+    size_t per = n_subs / readers;
+    uint64_t head0 = tb_feed_head(feed), t0 = bench_now_ns();
+    for (size_t i = 0; i < readers; ++i)
+    {
+        rd[i] = (reader_t){.subs = subs + i * per, .n = i + 1 < readers ? per : n_subs - i * per};
+        pthread_create(&rt[i], NULL, reader_fn, &rd[i]);
+    }
+    for (int i = 0; i < WRITERS; ++i)
+    {
+        wr[i] = (writer_t){.seed = 1 + (uint64_t)i};
+        pthread_create(&wt[i], NULL, writer_fn, &wr[i]);
+    }
+    usleep(millis * 1000u);
+    __atomic_store_n(&g_stop, 1, __ATOMIC_RELEASE);
+    uint64_t ops = 0, delivered = 0, polls = 0, lapped = 0;
+    for (int i = 0; i < WRITERS; ++i)
+    {
+        pthread_join(wt[i], NULL);
+        ops += wr[i].ops;
+    }
+    for (size_t i = 0; i < readers; ++i)
+    {
+        pthread_join(rt[i], NULL);
+        delivered += rd[i].delivered;
+        polls += rd[i].polls;
+        lapped += rd[i].lapped;
+    }
+    double secs = (bench_now_ns() - t0) / 1e9;
+    uint64_t published = tb_feed_head(feed) - head0;
+    printf("subscribers=%zu readers=%zu writers=%d\n", n_subs, readers, WRITERS);
+    printf("  writers:     %9.0f hold attempts/s, %9.0f changes/s published\n", ops / secs,
+           published / secs);
+    printf("  subscribers: %9.0f changes/s delivered (%.2f M/s), %.0f polls/s, %llu lapped polls\n",
+           delivered / secs, delivered / secs / 1e6, polls / secs, (unsigned long long)lapped);
+    printf("  coalescing:  %.2f published changes per delivered change per subscriber\n",
+           delivered ? (double)published * n_subs / delivered : 0.0);
+    for (size_t i = 0; i < n_subs; ++i)
+        tb_feed_unsubscribe(subs[i]);
+    free(subs);
+    reservation_shutdown();
+    return 0;
+}
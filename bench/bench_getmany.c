@@ -0,0 +1,128 @@
+// Batched seat lookups against a loop of single ones, at random positions of
+// a map too large for the caches. The seats are bulk-loaded into events of
+// EVENT_SEATS seats whose seat names repeat from event to event, as venue
+// layouts do.
+//
+//   make bench/bench_getmany && ./bench/bench_getmany [seats] [batch]
+#include <stdio.h>
+#include <string.h>
+
+#include "bench_util.h"
+#include "hashtable.h"
+#include "intern.h"
+
+#define EVENT_SEATS 50000
+#define MAX_BATCH   1024
+#define LOOKUPS     2000000
+
+static char g_event_ids[4096][TB_ID_LEN];
+static char g_seat_ids[EVENT_SEATS][TB_ID_LEN];
+static uint32_t g_event_ix[4096], g_seat_ix[EVENT_SEATS];
+
+static void report(const char *what, uint64_t ns, size_t found)
+{
+    printf("  %-26s %8.1f ns/seat %7.2f M seats/s%s\n", what, (double)ns / LOOKUPS,
+           LOOKUPS / (ns / 1e3), found == LOOKUPS ? "" : "  (misses!)");
+}
+
+int main(int argc, char **argv)
+{
+    size_t seats = bench_arg_size(argc, argv, 1, 1000000);
+    size_t batch = bench_arg_size(argc, argv, 2, 32);
+    if (batch == 0 || batch > MAX_BATCH)
+        batch = 32;
+    size_t events = (seats + EVENT_SEATS - 1) / EVENT_SEATS;
+    if (events == 0 || events > 4096)
+        return 1;
+
+    seat_map_t *m = seat_map_create(seats);
+    static seat_bulk_t rows[EVENT_SEATS];
+    for (size_t i = 0; i < EVENT_SEATS; ++i)
+    {
+        snprintf(g_seat_ids[i], TB_ID_LEN, "S%zu", i);
+        g_seat_ix[i] = tb_intern(TB_NS_SEAT, g_seat_ids[i]);
+        rows[i] = (seat_bulk_t){.seat_ix = g_seat_ix[i], .price_cents = 5000};
+    }
+    for (size_t e = 0; e < events; ++e)
+    {
+        snprintf(g_event_ids[e], TB_ID_LEN, "EV%zu", e);
+        g_event_ix[e] = tb_intern(TB_NS_EVENT, g_event_ids[e]);
+        size_t n = e + 1 < events ? EVENT_SEATS : seats - e * EVENT_SEATS;
+        if (!seat_map_bulk_begin(m, g_event_ix[e], n) ||
+            seat_map_bulk_fill(m, g_event_ix[e], 0, rows, n, 0) != n)
+            return 1;
+        seat_map_bulk_end(m, g_event_ix[e]);
+    }
+    printf("seats=%zu events=%zu batch=%zu rss=%.0f MB\n", seats, events, batch,
+           bench_rss_bytes() / 1048576.0);
+
+    // Each request is `batch` random seats of one random event, as a cart or
+    // a group would be; both sides answer the same requests.
+    size_t per_event = seats < EVENT_SEATS ? seats : EVENT_SEATS;
+    static const char *names[MAX_BATCH];
+    static uint32_t ix[MAX_BATCH];
+    static seat_ref_t refs[MAX_BATCH];
+    static seat_t out[MAX_BATCH];
+    static bool found[MAX_BATCH];
+    size_t requests = LOOKUPS / batch;
+    uint64_t seed, t0, t1;
+    size_t hits;
+
+    // By name: what a client asking for seat ids pays.
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        seed = 7;
+        hits = 0;
+        t0 = bench_now_ns();
+        for (size_t q = 0; q < requests; ++q)
+        {
+            size_t e = bench_rand(&seed) % events;
+            size_t span = e + 1 < events ? per_event : seats - e * EVENT_SEATS;
+            for (size_t i = 0; i < batch; ++i)
+                names[i] = g_seat_ids[bench_rand(&seed) % span];
+            if (pass == 0)
+                for (size_t i = 0; i < batch; ++i)
+                    hits += seat_map_get(m, g_event_ids[e], names[i], &out[i]);
+            else
+                hits += seat_map_get_many(m, g_event_ids[e], names, batch, out, found);
+        }
+        t1 = bench_now_ns();
+        hits += LOOKUPS - requests * batch;
+        report(pass == 0 ? "seat_map_get loop" : "seat_map_get_many", t1 - t0, hits);
+    }
+
+    // By interned id: the map alone, without hashing the names.
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        seed = 7;
+        hits = 0;
+        t0 = bench_now_ns();
+        for (size_t q = 0; q < requests; ++q)
+        {
+            size_t e = bench_rand(&seed) % events;
+            size_t span = e + 1 < events ? per_event : seats - e * EVENT_SEATS;
+            for (size_t i = 0; i < batch; ++i)
+                ix[i] = g_seat_ix[bench_rand(&seed) % span];
+            if (pass == 0)
+                for (size_t i = 0; i < batch; ++i)
+                {
+                    seat_ref_t r = seat_map_find_ix(m, g_event_ix[e], ix[i]);
+                    if (r)
+                    {
+                        seat_map_read(m, r, &out[i]);
+                        hits++;
+                    }
+                }
+            else
+            {
+                hits += seat_map_find_many_ix(m, g_event_ix[e], ix, batch, refs);
+                seat_map_read_many(m, refs, batch, out);
+            }
+        }
+        t1 = bench_now_ns();
+        hits += LOOKUPS - requests * batch;
+        report(pass == 0 ? "find_ix + read loop" : "find_many_ix + read_many", t1 - t0, hits);
+    }
+    seat_map_destroy(m);
+    return 0;
+}
@@ -0,0 +1,95 @@
+// utils kernel micro-benchmark, per dispatch variant: ns per seat-shaped key,
+// bulk hash bandwidth and token compares, against the previous
+// byte-at-a-time splitmix64 hash.
+//
+//   make bench/bench_hash && ./bench/bench_hash [iterations]
+#include <stdio.h>
+#include <string.h>
+
+#include "bench_util.h"
+#include "utils.h"
+
+static inline uint64_t splitmix64(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// The hash tb_hash_key_fast used before the word-at-a-time rewrite.
+static uint64_t bytewise_key(const char *event_id, const char *seat_id)
+{
+    uint64_t h1 = 0x1234567890abcdefULL;
+    for (const unsigned char *p = (const unsigned char *)event_id; *p; ++p)
+        h1 = splitmix64(h1 ^ *p);
+    uint64_t h2 = 0x0fedcba987654321ULL;
+    for (const unsigned char *p = (const unsigned char *)seat_id; *p; ++p)
+        h2 = splitmix64(h2 ^ *p);
+    return h1 ^ (h2 + 0x9e3779b97f4a7c15ULL + (h1 << 6) + (h1 >> 2));
+}
+
+int main(int argc, char **argv)
+{
+    size_t iters = bench_arg_size(argc, argv, 1, 20000000);
+
+    enum { KEYS = 1024 };
+    static char evs[KEYS][32], sids[KEYS][32];
+    for (size_t k = 0; k < KEYS; ++k)
+    {
+        snprintf(evs[k], sizeof evs[k], "EVT-2026-%04zu", k);
+        snprintf(sids[k], sizeof sids[k], "SEC%02zu-ROW%02zu-S%03zu", k % 40, k % 30, k);
+    }
+    printf("key=\"%s\"/\"%s\" (%zu+%zu bytes), default variant %s\n", evs[7], sids[7],
+           strlen(evs[7]), strlen(sids[7]), tb_utils_variant());
+
+    uint64_t sink = 0, t0 = bench_now_ns();
+    for (size_t i = 0; i < iters; ++i)
+        sink += bytewise_key(evs[i & (KEYS - 1)], sids[i & (KEYS - 1)]);
+    uint64_t t1 = bench_now_ns();
+    printf("bytewise splitmix  key %6.2f ns\n", (double)(t1 - t0) / iters);
+
+    static unsigned char buf[4096];
+    memset(buf, 0xa5, sizeof buf);
+    static unsigned char tok[KEYS][32];
+    for (size_t k = 0; k < KEYS; ++k)
+        memset(tok[k], (int)(k & 3), sizeof tok[k]);
+
+    const char *name;
+    for (size_t v = 0; (name = tb_utils_variant_name(v)) != NULL; ++v)
+    {
+        if (!tb_utils_select(name))
+            continue;
+
+        t0 = bench_now_ns();
+        for (size_t i = 0; i < iters; ++i)
+            sink += tb_hash_key_fast(evs[i & (KEYS - 1)], sids[i & (KEYS - 1)]);
+        t1 = bench_now_ns();
+        double key_ns = (double)(t1 - t0) / iters;
+
+        t0 = bench_now_ns();
+        for (size_t i = 0; i < iters; ++i)
+            sink += tb_hash_name_fast(sids[i & (KEYS - 1)]);
+        t1 = bench_now_ns();
+        double name_ns = (double)(t1 - t0) / iters;
+
+        size_t rounds = iters / 64 + 1;
+        t0 = bench_now_ns();
+        for (size_t i = 0; i < rounds; ++i)
+            sink += tb_hash_bytes(buf, sizeof buf, i);
+        t1 = bench_now_ns();
+        double gbs = (double)rounds * sizeof buf / (double)(t1 - t0);
+
+        t0 = bench_now_ns();
+        for (size_t i = 0; i < iters; ++i)
+            sink += (uint64_t)tb_memcmp_token32(tok[i & (KEYS - 1)], tok[(i + 4) & (KEYS - 1)], 32);
+        t1 = bench_now_ns();
+        double cmp_ns = (double)(t1 - t0) / iters;
+
+        printf("%-8s key %6.2f ns  name %6.2f ns  4K %6.2f GB/s  cmp32 %5.2f ns\n",
+               name, key_ns, name_ns, gbs, cmp_ns);
+    }
+
+    printf("(sink %llx)\n", (unsigned long long)sink);
+    return 0;
+}
@@ -0,0 +1,154 @@
+// On-sale simulation: seed a venue, sell every seat (hold + confirm) from
+// several threads, refund a tenth and resell those. Reports order rate and
+// RSS growth, then times the order-row allocation pattern on its own with
+// the slab against malloc/free.
+//
+//   make bench/bench_onsale && ./bench/bench_onsale [seats] [threads]
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench_util.h"
+#include "intern.h"
+#include "reservation.h"
+#include "slab.h"
+
+#define SEATS_PER_EVENT 20000u
+
+typedef struct
+{
+    size_t t, threads, seats;
+    int pass; // 0: sell everything, 1: resell refunded seats
+    uint64_t orders, refunds;
+} seller_t;
+
+static uint32_t (*g_ix)[2];
+static char (*g_orders)[RES_ID_LEN];
+
+static void *seller_fn(void *p)
+{
+    seller_t *w = (seller_t *)p;
+    char user[TB_ID_LEN];
+    snprintf(user, sizeof user, "U%zu", w->t);
+    for (size_t i = w->t; i < w->seats; i += w->threads)
+    {
+        if (w->pass == 1 && i % 10 != 0)
+            continue;
+        hold_result_t h = place_hold_ix(user, g_ix[i][0], g_ix[i][1]);
+        if (h.code != RES_OK)
+            continue;
+        confirm_result_t c = confirm_reservation(h.hold_token, h.token_len, h.price_cents);
+        if (c.code != RES_OK)
+            continue;
+        w->orders++;
+        memcpy(g_orders[i], c.order_id, RES_ID_LEN);
+        if (w->pass == 0 && i % 10 == 0 && refund(user, c.order_id) == RES_OK)
+            w->refunds++;
+    }
+    return NULL;
+}
+
+static void sell(size_t seats, size_t threads, int pass, uint64_t *orders, uint64_t *refunds)
+{
+    enum { MAX_THREADS = 64 };
+    seller_t w[MAX_THREADS];
+    pthread_t th[MAX_THREADS];
+    for (size_t t = 0; t < threads; ++t)
+    {
+        w[t] = (seller_t){.t = t, .threads = threads, .seats = seats, .pass = pass};
+        pthread_create(&th[t], NULL, seller_fn, &w[t]);
+    }
+    for (size_t t = 0; t < threads; ++t)
+    {
+        pthread_join(th[t], NULL);
+        *orders += w[t].orders;
+        *refunds += w[t].refunds;
+    }
+}
+
+// Order-row churn: each thread allocates a batch, then frees it.
+enum { ROW_BYTES = 160, CHURN_BATCH = 1024, CHURN_OPS = 2000000 };
+static tb_slab_t g_rows;
+static int g_use_slab;
+
+static void *churn_fn(void *p)
+{
+    (void)p;
+    void *live[CHURN_BATCH];
+    for (size_t done = 0; done < CHURN_OPS; done += CHURN_BATCH)
+    {
+        for (size_t i = 0; i < CHURN_BATCH; ++i)
+            live[i] = g_use_slab ? tb_slab_alloc(&g_rows) : calloc(1, ROW_BYTES);
+        for (size_t i = 0; i < CHURN_BATCH; ++i)
+            g_use_slab ? tb_slab_free(&g_rows, live[i]) : free(live[i]);
+    }
+    return NULL;
+}
+
+static double churn(size_t threads, int use_slab)
+{
+    pthread_t th[64];
+    g_use_slab = use_slab;
+    uint64_t t0 = bench_now_ns();
+    for (size_t t = 0; t < threads; ++t)
+        pthread_create(&th[t], NULL, churn_fn, NULL);
+    for (size_t t = 0; t < threads; ++t)
+        pthread_join(th[t], NULL);
+    uint64_t t1 = bench_now_ns();
+    return 2.0 * CHURN_OPS * threads / ((t1 - t0) / 1e3); // alloc+free Mops/s
+}
+
+int main(int argc, char **argv)
+{
+    size_t seats = bench_arg_size(argc, argv, 1, 200000);
+    size_t threads = bench_arg_size(argc, argv, 2, 4);
+    if (threads > 64)
+        threads = 64;
+    g_ix = malloc(seats * sizeof *g_ix);
+    g_orders = calloc(seats, sizeof *g_orders);
+    if (!g_ix || !g_orders || !reservation_init())
+        return 1;
+
+    size_t rss0 = bench_rss_bytes();
+    seat_t s = {0};
+    for (size_t i = 0; i < seats; ++i)
+    {
+        snprintf(s.event_id, sizeof s.event_id, "EV%zu", i / SEATS_PER_EVENT);
+        snprintf(s.seat_id, sizeof s.seat_id, "S%zu", i % SEATS_PER_EVENT);
+        s.price_cents = (tb_money_cents_t)(2000 + i % 700);
+        reservation_put_seat(&s);
+        g_ix[i][0] = tb_intern_lookup(TB_NS_EVENT, s.event_id);
+        g_ix[i][1] = tb_intern_lookup(TB_NS_SEAT, s.seat_id);
+    }
+    size_t rss1 = bench_rss_bytes();
+    printf("seats=%zu threads=%zu seeded rss +%.1f MiB\n", seats, threads,
+           (rss1 - rss0) / 1048576.0);
+
+    uint64_t orders = 0, refunds = 0;
+    uint64_t t0 = bench_now_ns();
+    sell(seats, threads, 0, &orders, &refunds);
+    uint64_t t1 = bench_now_ns();
+    size_t rss2 = bench_rss_bytes();
+    printf("sell-out: %llu orders, %llu refunds in %.2f s  (%.0f orders/s)  rss +%.1f MiB (%.0f B/order)\n",
+           (unsigned long long)orders, (unsigned long long)refunds, (t1 - t0) / 1e9,
+           orders / ((t1 - t0) / 1e9), (rss2 - rss1) / 1048576.0,
+           (double)(rss2 - rss1) / (double)(orders ? orders : 1));
+
+    uint64_t resold = 0, unused = 0;
+    t0 = bench_now_ns();
+    sell(seats, threads, 1, &resold, &unused);
+    t1 = bench_now_ns();
+    size_t rss3 = bench_rss_bytes();
+    printf("resale:   %llu orders in %.2f s  rss +%.1f MiB\n",
+           (unsigned long long)resold, (t1 - t0) / 1e9, (rss3 - rss2) / 1048576.0);
+    reservation_shutdown();
+
+    if (!tb_slab_init(&g_rows, ROW_BYTES, 0))
+        return 1;
+    printf("row churn (%d B, batches of %d): malloc %.1f Mops/s  slab %.1f Mops/s\n",
+           ROW_BYTES, CHURN_BATCH, churn(threads, 0), churn(threads, 1));
+    tb_slab_destroy(&g_rows);
+    free(g_ix);
+    free(g_orders);
+    return 0;
+}
@@ -0,0 +1,69 @@
+// Order ids per second over 1..max threads: leased ranges with the fixed
+// base-32 text form, against one shared atomic counter formatted with
+// snprintf (the old gen_order_id, made atomic).
+//
+//   make bench/bench_orderid && ./bench/bench_orderid [ids_per_thread] [max_threads]
+#include <pthread.h>
+#include <stdio.h>
+
+#include "bench_util.h"
+#include "orderid.h"
+
+#define MAX_THREADS 64
+
+static uint64_t g_shared_seq = 1;
+static size_t g_per_thread;
+
+static void *leased_fn(void *p)
+{
+    char s[TB_ORDERID_STR_LEN];
+    unsigned sum = 0;
+    for (size_t i = 0; i < g_per_thread; ++i)
+    {
+        tb_orderid_format(tb_orderid_next(), s);
+        sum += (unsigned char)s[16];
+    }
+    *(unsigned *)p = sum;
+    return NULL;
+}
+
+static void *shared_fn(void *p)
+{
+    char s[32];
+    unsigned sum = 0;
+    for (size_t i = 0; i < g_per_thread; ++i)
+    {
+        uint64_t seq = __atomic_fetch_add(&g_shared_seq, 1, __ATOMIC_RELAXED);
+        snprintf(s, sizeof s, "ORD-%llu", (unsigned long long)seq);
+        sum += (unsigned char)s[4];
+    }
+    *(unsigned *)p = sum;
+    return NULL;
+}
+
+// Ids per second over all threads.
+static double run(size_t threads, void *(*fn)(void *))
+{
+    pthread_t th[MAX_THREADS];
+    unsigned sink[MAX_THREADS];
+    uint64_t t0 = bench_now_ns();
+    for (size_t i = 0; i < threads; ++i)
+        pthread_create(&th[i], NULL, fn, &sink[i]);
+    for (size_t i = 0; i < threads; ++i)
+        pthread_join(th[i], NULL);
+    return (double)(threads * g_per_thread) / ((bench_now_ns() - t0) / 1e9);
+}
+
+int main(int argc, char **argv)
+{
+    g_per_thread = bench_arg_size(argc, argv, 1, 2000000);
+    size_t max_threads = bench_arg_size(argc, argv, 2, 64);
+    if (g_per_thread == 0 || max_threads == 0 || max_threads > MAX_THREADS)
+        return 1;
+
+    printf("ids/thread=%zu  online cpus=%ld\n", g_per_thread, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%8s %18s %18s\n", "threads", "leased ids/s", "shared+snprintf/s");
+    for (size_t n = 1; n <= max_threads; n *= 2)
+        printf("%8zu %16.1f M %16.1f M\n", n, run(n, leased_fn) / 1e6, run(n, shared_fn) / 1e6);
+    return 0;
+}
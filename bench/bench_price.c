@@ -0,0 +1,189 @@
+// Price queries: `events` events of `seats` seats in 20 price tiers laid
+// out by section, the four cheapest tiers all but sold out and a third of
+// the rest sold. Times the cheapest 10 seats, a price-range count and the
+// cheapest 10 over the whole tour from the price index, against the same
+// answers from a full scan (event_export, the only way before the index),
+// plus the index's build time and what keeping it costs a hold and cancel.
+//
+//   make bench/bench_price && ./bench/bench_price [events] [seats] [queries]
+#include <stdio.h>
+#include <string.h>
+
+#include "bench_util.h"
+#include "reservation.h"
+
+#define TOP 10
+#define TIERS 20
+
+typedef struct
+{
+    tb_money_cents_t lo, hi;
+    size_t n;
+    priced_seat_t top[TOP];
+} scan_t;
+
+// Keep the TOP cheapest available seats in range, ties in export order.
+static bool scan_seat(const seat_t *s, void *ctx)
+{
+    scan_t *sc = ctx;
+    if (s->status != SEAT_AVAILABLE || s->price_cents < sc->lo || s->price_cents > sc->hi)
+        return true;
+    if (sc->n == TOP && s->price_cents >= sc->top[TOP - 1].price_cents)
+        return true;
+    size_t at = sc->n < TOP ? sc->n++ : TOP - 1;
+    for (; at > 0 && sc->top[at - 1].price_cents > s->price_cents; --at)
+        sc->top[at] = sc->top[at - 1];
+    memcpy(sc->top[at].event_id, s->event_id, RES_ID_LEN);
+    memcpy(sc->top[at].seat_id, s->seat_id, RES_ID_LEN);
+    sc->top[at].price_cents = s->price_cents;
+    return true;
+}
+
+static void scan_reset(scan_t *sc, tb_money_cents_t lo, tb_money_cents_t hi)
+{
+    memset(sc, 0, sizeof *sc);
+    sc->lo = lo;
+    sc->hi = hi;
+}
+
+static bool count_seat(const seat_t *s, void *ctx)
+{
+    scan_t *sc = ctx;
+    sc->n += s->status == SEAT_AVAILABLE && s->price_cents >= sc->lo && s->price_cents <= sc->hi;
+    return true;
+}
+
+static double us_per(uint64_t t0, size_t n)
+{
+    return (bench_now_ns() - t0) / 1e3 / (double)n;
+}
+
+int main(int argc, char **argv)
+{
+    size_t events = bench_arg_size(argc, argv, 1, 4);
+    size_t n = bench_arg_size(argc, argv, 2, 100000);
+    size_t queries = bench_arg_size(argc, argv, 3, 200);
+    seat_t *seats = calloc(n, sizeof *seats);
+    char (*names)[TB_ID_LEN] = calloc(events, TB_ID_LEN);
+    const char **tour = calloc(events, sizeof *tour);
+    if (events == 0 || n < TIERS || queries == 0 || !seats || !names || !tour ||
+        !reservation_init())
+        return 1;
+    reservation_set_hold_length_seconds(300);
+
+    uint64_t rng = 0x9e3779b97f4a7c15ULL;
+    size_t per_section = n / TIERS;
+    for (size_t e = 0; e < events; ++e)
+    {
+        snprintf(names[e], TB_ID_LEN, "PE%zu", e);
+        tour[e] = names[e];
+        for (size_t s = 0; s < n; ++s)
+        {
+            size_t tier = (s / per_section * 7 + e) % TIERS; // sections priced out of order
+            snprintf(seats[s].event_id, TB_ID_LEN, "%s", names[e]);
+            snprintf(seats[s].seat_id, TB_ID_LEN, "S%02u-%05u", (unsigned)(s / per_section),
+                     (unsigned)(s % per_section));
+            seats[s].price_cents = (tb_money_cents_t)(2500 + tier * 500);
+            bool sold = tier < 4 ? bench_rand(&rng) % 1000 != 0 : bench_rand(&rng) % 3 == 0;
+            seats[s].status = sold ? SEAT_SOLD : SEAT_AVAILABLE;
+        }
+        if (!event_load(names[e], seats, n))
+            return 1;
+    }
+    free(seats);
+    event_inventory_t inv;
+    if (!event_inventory(names[0], &inv))
+        return 1;
+    printf("events=%zu  seats/event=%zu  tiers=%d  available in %s: %zu (%.0f%%)\n", events, n,
+           TIERS, names[0], inv.available, 100.0 * inv.available / n);
+
+    // Holds and cancels before any price query: nothing to keep up yet.
+    char sid[TB_ID_LEN];
+    size_t churn = queries * 50;
+    uint64_t t0 = bench_now_ns();
+    for (size_t i = 0; i < churn; ++i)
+    {
+        snprintf(sid, sizeof sid, "S%02u-%05u", (unsigned)((i * 7) % TIERS),
+                 (unsigned)((i * 13) % per_section));
+        if (place_hold("CHURN", names[0], sid).code == RES_OK)
+            cancel_hold("CHURN", names[0], sid);
+    }
+    double churn_plain = us_per(t0, churn);
+
+    priced_seat_t top[TOP];
+    t0 = bench_now_ns();
+    for (size_t e = 0; e < events; ++e)
+        event_cheapest_seats(names[e], INT32_MIN, INT32_MAX, TOP, top);
+    printf("index build (first query): %.2f ms/event\n\n",
+           (bench_now_ns() - t0) / 1e6 / (double)events);
+
+    t0 = bench_now_ns();
+    for (size_t i = 0; i < churn; ++i)
+    {
+        snprintf(sid, sizeof sid, "S%02u-%05u", (unsigned)((i * 7) % TIERS),
+                 (unsigned)((i * 13) % per_section));
+        if (place_hold("CHURN", names[0], sid).code == RES_OK)
+            cancel_hold("CHURN", names[0], sid);
+    }
+    double churn_indexed = us_per(t0, churn);
+
+    printf("%-34s %12s %12s %9s\n", "", "index us", "scan us", "speedup");
+    scan_t sc;
+    scan_reset(&sc, INT32_MIN, INT32_MAX);
+    size_t got = 0;
+    t0 = bench_now_ns();
+    for (size_t q = 0; q < queries; ++q)
+        got = event_cheapest_seats(names[q % events], INT32_MIN, INT32_MAX, TOP, top);
+    double ix = us_per(t0, queries);
+    size_t scans = queries / 10 ? queries / 10 : 1;
+    t0 = bench_now_ns();
+    for (size_t q = 0; q < scans; ++q)
+    {
+        sc.n = 0;
+        event_export(names[(queries - 1) % events], scan_seat, &sc);
+    }
+    double sv = us_per(t0, scans);
+    if (got != sc.n || memcmp(top, sc.top, got * sizeof *top) != 0)
+        return 1;
+    printf("%-34s %12.1f %12.1f %8.0fx\n", "cheapest 10, one event", ix, sv, sv / ix);
+
+    tb_money_cents_t lo = 2500 + 6 * 500, hi = 2500 + 9 * 500;
+    t0 = bench_now_ns();
+    for (size_t q = 0; q < queries; ++q)
+        got = event_available_in_price_range(names[q % events], lo, hi);
+    ix = us_per(t0, queries);
+    scan_reset(&sc, lo, hi);
+    t0 = bench_now_ns();
+    for (size_t q = 0; q < scans; ++q)
+    {
+        sc.n = 0;
+        event_export(names[(queries - 1) % events], count_seat, &sc);
+    }
+    sv = us_per(t0, scans);
+    if (got != sc.n)
+        return 1;
+    printf("%-34s %12.1f %12.1f %8.0fx\n", "available in 4 of 20 price tiers", ix, sv, sv / ix);
+
+    t0 = bench_now_ns();
+    for (size_t q = 0; q < queries; ++q)
+        got = tour_cheapest_seats(tour, events, INT32_MIN, INT32_MAX, TOP, top);
+    ix = us_per(t0, queries);
+    t0 = bench_now_ns();
+    for (size_t q = 0; q < scans; ++q)
+    {
+        scan_reset(&sc, INT32_MIN, INT32_MAX);
+        for (size_t e = 0; e < events; ++e)
+            event_export(names[e], scan_seat, &sc);
+    }
+    sv = us_per(t0, scans);
+    if (got != sc.n || memcmp(top, sc.top, got * sizeof *top) != 0)
+        return 1;
+    printf("%-34s %12.1f %12.1f %8.0fx\n", "cheapest 10, whole tour", ix, sv, sv / ix);
+
+    printf("\nhold + cancel: %.2f us without an index, %.2f us with one\n", churn_plain,
+           churn_indexed);
+    free(names);
+    free(tour);
+    reservation_shutdown();
+    return 0;
+}
@@ -0,0 +1,110 @@
+// Per-user rate limiting: the limiter's own cost per check, and what it
+// saves when one abusive user hammers place_hold and seat_get. Every call of
+// the abusive loops is timed with the limits off and on (`rate` calls a
+// second, bursts of `rate`).
+//
+//   make bench/bench_ratelimit && ./bench/bench_ratelimit [calls] [rate]
+#include <stdio.h>
+#include <string.h>
+
+#include "bench_util.h"
+#include "ratelimit.h"
+#include "reservation.h"
+
+#define SEATS 4096
+
+static char g_seat_ids[SEATS][TB_ID_LEN];
+
+static void report(const char *what, uint64_t ns, size_t calls, size_t through)
+{
+    printf("  %-34s %8.1f ns/call  %9zu of %zu reached the seat map\n", what, (double)ns / calls,
+           through, calls);
+}
+
+int main(int argc, char **argv)
+{
+    size_t calls = bench_arg_size(argc, argv, 1, 1000000);
+    uint32_t rate = (uint32_t)bench_arg_size(argc, argv, 2, 20);
+    if (calls == 0 || rate == 0)
+        return 1;
+
+    // The limiter alone: one hot key, then keys spread over a full table.
+    tb_ratelimit_t *rl = tb_ratelimit_create(65536, 1000000, 1000000);
+    uint64_t seed = 1, t0 = bench_now_ns();
+    size_t ok = 0;
+    for (size_t i = 0; i < calls; ++i)
+        ok += tb_ratelimit_allow(rl, 42, t0 + i);
+    uint64_t t1 = bench_now_ns();
+    printf("limiter, one key:        %6.1f ns/check\n", (double)(t1 - t0) / calls);
+    t0 = bench_now_ns();
+    for (size_t i = 0; i < calls; ++i)
+        ok += tb_ratelimit_allow(rl, bench_rand(&seed) % 50000, t0 + i);
+    t1 = bench_now_ns();
+    printf("limiter, 50k keys:       %6.1f ns/check\n", (double)(t1 - t0) / calls);
+    t0 = bench_now_ns();
+    for (size_t i = 0; i < calls; ++i)
+        ok += tb_ratelimit_allow(rl, bench_rand(&seed), t0 + i);
+    t1 = bench_now_ns();
+    printf("limiter, new key each:   %6.1f ns/check (%llu evictions)\n", (double)(t1 - t0) / calls,
+           (unsigned long long)tb_ratelimit_evictions(rl));
+    printf("limiter memory: %zu KB for 65536 keys\n", tb_ratelimit_memory_bytes(rl) / 1024);
+    tb_ratelimit_destroy(rl);
+    if (ok == 0)
+        return 1;
+
+    if (!reservation_init())
+        return 1;
+    for (size_t i = 0; i < SEATS; ++i)
+    {
+        seat_t s = {0};
+        strcpy(s.event_id, "EV");
+        snprintf(g_seat_ids[i], TB_ID_LEN, "S%zu", i);
+        strcpy(s.seat_id, g_seat_ids[i]);
+        s.price_cents = 5000;
+        reservation_put_seat(&s);
+    }
+    place_hold("FAN", "EV", g_seat_ids[0]);
+
+    for (int limited = 0; limited < 2; ++limited)
+    {
+        printf("%s\n", limited ? "limits on:" : "limits off:");
+        reservation_set_rate_limit(RES_OP_HOLD, limited ? rate : 0, rate);
+        reservation_set_rate_limit(RES_OP_GET, limited ? rate : 0, rate);
+        reservation_set_rate_limit(RES_OP_CANCEL, limited ? rate : 0, rate);
+
+        // Grabbing a seat someone else holds, over and over.
+        size_t through = 0;
+        t0 = bench_now_ns();
+        for (size_t i = 0; i < calls; ++i)
+            through += place_hold("BOT1", "EV", g_seat_ids[0]).code != RES_RATE_LIMITED;
+        report("place_hold on a held seat", bench_now_ns() - t0, calls, through);
+
+        // Holding free seats and letting go, as a scalper probing the map.
+        through = 0;
+        t0 = bench_now_ns();
+        for (size_t i = 0; i < calls / 10; ++i)
+        {
+            const char *sid = g_seat_ids[1 + i % (SEATS - 1)];
+            if (place_hold("BOT2", "EV", sid).code != RES_RATE_LIMITED)
+            {
+                through++;
+                cancel_hold("BOT2", "EV", sid);
+            }
+        }
+        report("place_hold + cancel on free seats", bench_now_ns() - t0, calls / 10, through);
+
+        // Scraping the map; the front end checks the read limit first.
+        seat_view_t v;
+        through = 0;
+        t0 = bench_now_ns();
+        for (size_t i = 0; i < calls; ++i)
+            if (reservation_admit("BOT3", RES_OP_GET))
+            {
+                seat_get("EV", g_seat_ids[bench_rand(&seed) % SEATS], &v);
+                through++;
+            }
+        report("admit + seat_get", bench_now_ns() - t0, calls, through);
+    }
+    reservation_shutdown();
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Cancelling a sold-out event: `orders` seats are sold, then refunded one
+// by one with refund() (the only way before event_cancel_and_refund), and
+// again for a second, identical event through the pipeline at 1, 2, 4, ...
+// workers, each run on a fresh sale.
+//
+//   make bench/bench_refund && ./bench/bench_refund [orders] [max_threads]
+#include <stdio.h>
+#include <string.h>
+
+#include "bench_util.h"
+#include "reservation.h"
+
+static char (*g_orders)[TB_ID_LEN];
+static char (*g_users)[TB_ID_LEN];
+
+// Load `event_id` with n seats and sell them all, recording the orders.
+static bool sell_out(const char *event_id, size_t n)
+{
+    seat_t *seats = calloc(n, sizeof *seats);
+    if (!seats)
+        return false;
+    for (size_t s = 0; s < n; ++s)
+    {
+        snprintf(seats[s].event_id, TB_ID_LEN, "%s", event_id);
+        snprintf(seats[s].seat_id, TB_ID_LEN, "S%zu", s);
+        seats[s].price_cents = 5000;
+    }
+    bool ok = event_load(event_id, seats, n);
+    free(seats);
+    char sid[TB_ID_LEN];
+    for (size_t s = 0; ok && s < n; ++s)
+    {
+        snprintf(sid, sizeof sid, "S%zu", s);
+        snprintf(g_users[s], TB_ID_LEN, "U%zu", s % 10007);
+        hold_result_t h = place_hold(g_users[s], event_id, sid);
+        confirm_result_t c = confirm_reservation(h.hold_token, h.token_len, 5000);
+        ok = h.code == RES_OK && c.code == RES_OK;
+        memcpy(g_orders[s], c.order_id, TB_ID_LEN);
+    }
+    return ok;
+}
+
+static bool note(const event_refund_progress_t *p, void *ctx)
+{
+    *(event_refund_progress_t *)ctx = *p;
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = bench_arg_size(argc, argv, 1, 100000);
+    unsigned max_threads = (unsigned)bench_arg_size(argc, argv, 2, 8);
+    g_orders = calloc(n, TB_ID_LEN);
+    g_users = calloc(n, TB_ID_LEN);
+    if (n == 0 || max_threads == 0 || !g_orders || !g_users || !reservation_init())
+        return 1;
+    reservation_set_hold_length_seconds(300);
+    printf("orders=%zu  online cpus=%ld\n", n, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-22s %12s %14s %10s\n", "", "total ms", "orders/s", "batches");
+
+    if (!sell_out("EV_SERIAL", n))
+        return 1;
+    uint64_t t0 = bench_now_ns();
+    for (size_t s = 0; s < n; ++s)
+        if (refund(g_users[s], g_orders[s]) != RES_OK)
+            return 1;
+    double ms = (bench_now_ns() - t0) / 1e6;
+    printf("%-22s %12.1f %14.0f %10s\n", "refund() one by one", ms, n / (ms / 1e3), "-");
+
+    char name[TB_ID_LEN], label[32];
+    for (unsigned t = 1; t <= max_threads; t *= 2)
+    {
+        snprintf(name, sizeof name, "EV_CANCEL%u", t);
+        if (!sell_out(name, n))
+            return 1;
+        event_refund_progress_t p = {0};
+        t0 = bench_now_ns();
+        if (!event_cancel_and_refund(name, t, note, &p) || p.refunded != n)
+            return 1;
+        ms = (bench_now_ns() - t0) / 1e6;
+        snprintf(label, sizeof label, "cancel, %u worker%s", t, t == 1 ? "" : "s");
+        printf("%-22s %12.1f %14.0f %10zu\n", label, ms, n / (ms / 1e3), p.batches);
+        event_unload(name);
+    }
+    reservation_shutdown();
+    return 0;
+}
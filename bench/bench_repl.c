@@ -0,0 +1,214 @@
+// Replication to a hot standby in a second process: primary throughput
+// with replication off and on, how far the standby trails while clients
+// hold and cancel seats, and how long a full copy and a promotion take.
+// Lag is sampled every 200 us: the log head then, and the time until the
+// standby acked past it.
+//
+//   make bench/bench_repl && ./bench/bench_repl [clients] [millis] [seats]
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+
+#include "bench_util.h"
+#include "repl.h"
+#include "reservation.h"
+
+#define MAX_CLIENTS 64
+#define MAX_SAMPLES (1u << 20)
+
+static size_t g_seats;
+static volatile int g_stop;
+
+typedef struct
+{
+    uint64_t seed;
+    uint64_t ops;
+} client_t;
+
+static void *client_fn(void *p)
+{
+    client_t *c = (client_t *)p;
+    char user[TB_ID_LEN], sid[TB_ID_LEN];
+    snprintf(user, sizeof user, "BU%llu", (unsigned long long)c->seed);
+    while (!g_stop)
+    {
+        snprintf(sid, sizeof sid, "S%llu", (unsigned long long)(bench_rand(&c->seed) % g_seats));
+        if (place_hold(user, "RE", sid).code == RES_OK)
+        {
+            cancel_hold(user, "RE", sid);
+            c->ops++;
+        }
+        c->ops++;
+    }
+    return NULL;
+}
+
+typedef struct
+{
+    uint64_t *lag_ns; // one per sample that was acked
+    size_t n;
+    uint64_t max_behind; // changes
+} lag_t;
+
+static void *sampler_fn(void *p)
+{
+    lag_t *l = (lag_t *)p;
+    static uint64_t at[MAX_SAMPLES], head[MAX_SAMPLES];
+    size_t taken = 0;
+    tb_repl_status_t st;
+    while (!g_stop || l->n < taken)
+    {
+        uint64_t now = bench_now_ns();
+        tb_repl_primary_status(&st);
+        if (!g_stop && taken < MAX_SAMPLES)
+        {
+            at[taken] = now;
+            head[taken++] = st.head;
+        }
+        if (st.head - st.acked > l->max_behind)
+            l->max_behind = st.head - st.acked;
+        while (l->n < taken && head[l->n] <= st.acked)
+        {
+            l->lag_ns[l->n] = now - at[l->n];
+            l->n++;
+        }
+        usleep(200);
+    }
+    return NULL;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static double run(size_t clients, unsigned millis, lag_t *lag)
+{
+    pthread_t th[MAX_CLIENTS], sampler;
+    client_t cs[MAX_CLIENTS];
+    g_stop = 0;
+    if (lag)
+        pthread_create(&sampler, NULL, sampler_fn, lag);
+    uint64_t t0 = bench_now_ns();
+    for (size_t i = 0; i < clients; ++i)
+    {
+        cs[i] = (client_t){.seed = 0x9E3779B97F4A7C15ULL * (i + 1)};
+        pthread_create(&th[i], NULL, client_fn, &cs[i]);
+    }
+    usleep(millis * 1000u);
+    g_stop = 1;
+    uint64_t ops = 0;
+    for (size_t i = 0; i < clients; ++i)
+    {
+        pthread_join(th[i], NULL);
+        ops += cs[i].ops;
+    }
+    double rate = ops / ((bench_now_ns() - t0) / 1e9);
+    if (lag)
+        pthread_join(sampler, NULL);
+    return rate;
+}
+
+// Wait until the standby has applied everything logged; ns waited.
+static uint64_t catch_up(void)
+{
+    uint64_t t0 = bench_now_ns();
+    tb_repl_status_t st;
+    while (tb_repl_primary_status(&st) && !(st.connected && st.resyncs && st.acked == st.head))
+        usleep(50);
+    return bench_now_ns() - t0;
+}
+
+static int standby_main(const char *path, int cmd_fd, int out_fd)
+{
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    if (!reservation_init())
+        return 1;
+    while (!tb_repl_standby_start(path))
+        usleep(1000);
+    char go;
+    if (read(cmd_fd, &go, 1) != 1)
+        return 1;
+    uint64_t t0 = bench_now_ns();
+    uint64_t res[2];
+    res[1] = tb_repl_promote();
+    res[0] = bench_now_ns() - t0;
+    return write(out_fd, res, sizeof res) == (ssize_t)sizeof res ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    size_t clients = bench_arg_size(argc, argv, 1, 2);
+    unsigned millis = (unsigned)bench_arg_size(argc, argv, 2, 2000);
+    g_seats = bench_arg_size(argc, argv, 3, 100000);
+    if (clients == 0 || clients > MAX_CLIENTS || g_seats == 0)
+        return 1;
+
+    char path[64];
+    snprintf(path, sizeof path, "/tmp/tb_bench_repl_%d.sock", (int)getpid());
+    int cmd[2], out[2];
+    if (pipe(cmd) != 0 || pipe(out) != 0)
+        return 1;
+    pid_t pid = fork();
+    if (pid < 0)
+        return 1;
+    if (pid == 0)
+        _exit(standby_main(path, cmd[0], out[1]));
+
+    if (!reservation_init())
+        return 1;
+    seat_t *seats = calloc(g_seats, sizeof *seats);
+    if (!seats)
+        return 1;
+    for (size_t s = 0; s < g_seats; ++s)
+    {
+        strcpy(seats[s].event_id, "RE");
+        snprintf(seats[s].seat_id, TB_ID_LEN, "S%zu", s);
+        seats[s].price_cents = 5000;
+    }
+    if (!event_load("RE", seats, g_seats))
+        return 1;
+    free(seats);
+
+    printf("seats=%zu  clients=%zu  millis=%u  online cpus=%ld\n", g_seats, clients, millis,
+           sysconf(_SC_NPROCESSORS_ONLN));
+    double off = run(clients, millis, NULL);
+    printf("replication off:  %12.0f calls/s\n", off);
+
+    if (!tb_repl_primary_start(path, 0))
+        return 1;
+    uint64_t copy_ns = catch_up();
+    lag_t lag = {.lag_ns = malloc(MAX_SAMPLES * sizeof(uint64_t))};
+    if (!lag.lag_ns)
+        return 1;
+    double on = run(clients, millis, &lag);
+    uint64_t drain_ns = catch_up();
+    tb_repl_status_t st;
+    tb_repl_primary_status(&st);
+    printf("replication on:   %12.0f calls/s  (%+.1f%%)\n", on, (on / off - 1) * 100);
+    printf("full copy:        %12.1f ms\n", copy_ns / 1e6);
+    printf("log: %llu changes in %llu batches (%.1f changes/batch), %llu full copies\n",
+           (unsigned long long)st.head, (unsigned long long)st.batches,
+           (double)st.head / (st.batches ? st.batches : 1), (unsigned long long)st.resyncs);
+    qsort(lag.lag_ns, lag.n, sizeof *lag.lag_ns, cmp_u64);
+    if (lag.n)
+        printf("lag: p50 %.3f ms  p99 %.3f ms  max %.3f ms  max %llu changes behind  (%zu samples)\n",
+               lag.lag_ns[lag.n / 2] / 1e6, lag.lag_ns[lag.n * 99 / 100] / 1e6,
+               lag.lag_ns[lag.n - 1] / 1e6, (unsigned long long)lag.max_behind, lag.n);
+    printf("drain after load: %12.3f ms\n", drain_ns / 1e6);
+
+    uint64_t res[2];
+    if (write(cmd[1], "p", 1) != 1 || read(out[0], res, sizeof res) != (ssize_t)sizeof res)
+        return 1;
+    printf("promotion:        %12.3f ms  (standby at %llu of %llu)\n", res[0] / 1e6,
+           (unsigned long long)res[1], (unsigned long long)st.head);
+    waitpid(pid, NULL, 0);
+    tb_repl_primary_stop();
+    free(lag.lag_ns);
+    reservation_shutdown();
+    return 0;
+}
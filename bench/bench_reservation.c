@@ -0,0 +1,144 @@
+// Reservation API benchmark: hold/cancel writer throughput while reader
+// threads browse the same seats through seat_get. With a hold limit, also
+// what refusing a user kept at the limit costs.
+//
+//   make bench/bench_reservation && ./bench/bench_reservation [seats] [millis] [writers] [limit]
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench_util.h"
+#include "reservation.h"
+
+typedef struct
+{
+    size_t seats;
+    volatile int stop;
+    uint64_t ops;
+    uint64_t won; // successful holds
+    uint64_t seed;
+} worker_t;
+
+static char g_seat_ids[1 << 16][TB_ID_LEN];
+
+static void *writer_fn(void *p)
+{
+    worker_t *w = (worker_t *)p;
+    char user[TB_ID_LEN];
+    snprintf(user, sizeof user, "U%llu", (unsigned long long)w->seed);
+    while (!__atomic_load_n(&w->stop, __ATOMIC_ACQUIRE))
+    {
+        const char *sid = g_seat_ids[bench_rand(&w->seed) % w->seats];
+        hold_result_t h = place_hold(user, "EV", sid);
+        if (h.code == RES_OK)
+        {
+            cancel_hold(user, "EV", sid);
+            w->won++;
+        }
+        w->ops++;
+    }
+    return NULL;
+}
+
+static void *reader_fn(void *p)
+{
+    worker_t *w = (worker_t *)p;
+    seat_view_t v;
+    while (!__atomic_load_n(&w->stop, __ATOMIC_ACQUIRE))
+    {
+        seat_get("EV", g_seat_ids[bench_rand(&w->seed) % w->seats], &v);
+        w->ops++;
+    }
+    return NULL;
+}
+
+static void run(size_t seats, int writers, int readers, unsigned millis)
+{
+    enum { MAX_THREADS = 16 };
+    worker_t wr[MAX_THREADS];
+    worker_t rd[MAX_THREADS];
+    pthread_t wt[MAX_THREADS], rt[MAX_THREADS];
+
+    for (int i = 0; i < writers; ++i)
+    {
+        wr[i] = (worker_t){.seats = seats, .seed = 1 + (uint64_t)i};
+        pthread_create(&wt[i], NULL, writer_fn, &wr[i]);
+    }
+    for (int i = 0; i < readers; ++i)
+    {
+        rd[i] = (worker_t){.seats = seats, .seed = 100 + (uint64_t)i};
+        pthread_create(&rt[i], NULL, reader_fn, &rd[i]);
+    }
+
+    usleep(millis * 1000u);
+    for (int i = 0; i < writers; ++i)
+        __atomic_store_n(&wr[i].stop, 1, __ATOMIC_RELEASE);
+    for (int i = 0; i < readers; ++i)
+        __atomic_store_n(&rd[i].stop, 1, __ATOMIC_RELEASE);
+    uint64_t writes = 0, won = 0, reads = 0;
+    for (int i = 0; i < writers; ++i)
+    {
+        pthread_join(wt[i], NULL);
+        writes += wr[i].ops;
+        won += wr[i].won;
+    }
+    for (int i = 0; i < readers; ++i)
+    {
+        pthread_join(rt[i], NULL);
+        reads += rd[i].ops;
+    }
+
+    double secs = millis / 1000.0;
+    printf("writers=%2d readers=%2d  place_hold: %8.0f ops/s (%8.0f won+cancelled)  seat_get: %10.0f ops/s\n",
+           writers, readers, writes / secs, won / secs, reads / secs);
+}
+
+int main(int argc, char **argv)
+{
+    size_t seats = bench_arg_size(argc, argv, 1, 64);
+    unsigned millis = (unsigned)bench_arg_size(argc, argv, 2, 1000);
+    int writers = (int)bench_arg_size(argc, argv, 3, 1);
+    size_t limit = bench_arg_size(argc, argv, 4, 0);
+    if (writers < 1 || writers > 16)
+        writers = 1;
+    if (seats == 0 || seats > (1u << 16))
+        seats = 64;
+
+    if (!reservation_init())
+        return 1;
+    reservation_set_hold_limit(limit);
+    for (size_t i = 0; i < seats; ++i)
+    {
+        seat_t s = {0};
+        strcpy(s.event_id, "EV");
+        snprintf(g_seat_ids[i], TB_ID_LEN, "S%zu", i);
+        strcpy(s.seat_id, g_seat_ids[i]);
+        s.price_cents = 5000;
+        reservation_put_seat(&s);
+    }
+
+    const int reader_counts[] = {0, 1, 2, 4, 8};
+    for (size_t i = 0; i < sizeof reader_counts / sizeof reader_counts[0]; ++i)
+        run(seats, writers, reader_counts[i], millis);
+
+    if (limit > 0 && limit < seats)
+    {
+        for (size_t i = 0; i < limit; ++i)
+            place_hold("BOT", "EV", g_seat_ids[i]);
+        const size_t tries = 1000000;
+        size_t refused = 0;
+        uint64_t t0 = bench_now_ns();
+        for (size_t i = 0; i < tries; ++i)
+            refused += place_hold("BOT", "EV", g_seat_ids[limit + i % (seats - limit)]).code ==
+                       RES_HOLD_LIMIT;
+        uint64_t t1 = bench_now_ns();
+        printf("limit=%zu  refused place_hold at the limit: %.1f ns/op (%zu of %zu refused)\n", limit,
+               (double)(t1 - t0) / tries, refused, tries);
+        t0 = bench_now_ns();
+        size_t released = cancel_all_holds("BOT");
+        printf("cancel_all_holds: %zu holds in %.1f us\n", released, (bench_now_ns() - t0) / 1e3);
+    }
+
+    reservation_shutdown();
+    return 0;
+}
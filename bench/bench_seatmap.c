@@ -0,0 +1,150 @@
+// Seat map micro-benchmark: memory per seat and lookup throughput.
+//
+//   make bench/bench_seatmap && ./bench/bench_seatmap [seats] [lookups]
+//   make SEAT_LOCK=futex bench/bench_seatmap   # compact futex lock build
+#include <stdio.h>
+#include <string.h>
+
+#include "bench_util.h"
+#include "hashtable.h"
+
+#define SEATS_PER_EVENT 50000u
+
+static void mkkey(size_t i, char ev[TB_ID_LEN], char sid[TB_ID_LEN])
+{
+    snprintf(ev, TB_ID_LEN, "E%zu", i / SEATS_PER_EVENT);
+    snprintf(sid, TB_ID_LEN, "S%zu", i % SEATS_PER_EVENT);
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = bench_arg_size(argc, argv, 1, 1000000);
+    size_t lookups = bench_arg_size(argc, argv, 2, 5000000);
+
+    printf("lock=%s sizeof(seat_hot_t)=%zu sizeof(seat_cold_t)=%zu seats=%zu\n",
+           TB_SEAT_LOCK_FUTEX ? "futex" : "pthread", sizeof(seat_hot_t),
+           sizeof(seat_cold_t), n);
+
+    size_t rss0 = bench_rss_bytes();
+    seat_map_t *m = seat_map_create(n);
+    if (!m)
+        return 1;
+
+    seat_t s = {0};
+    s.status = SEAT_AVAILABLE;
+    uint64_t t0 = bench_now_ns();
+    for (size_t i = 0; i < n; ++i)
+    {
+        mkkey(i, s.event_id, s.seat_id);
+        s.price_cents = (tb_money_cents_t)(1000 + i % 500);
+        seat_map_put(m, &s);
+    }
+    uint64_t t1 = bench_now_ns();
+    size_t rss1 = bench_rss_bytes();
+    printf("put:    %8.2f Mops/s  rss=%.1f MiB  %.1f bytes/seat (map accounts %.1f)\n",
+           n / ((t1 - t0) / 1e3), (rss1 - rss0) / 1048576.0,
+           (double)(rss1 - rss0) / (double)n,
+           (double)seat_map_memory_bytes(m) / (double)n);
+
+    // Pre-build random lookup keys so snprintf is not on the timed path; the
+    // key set is large enough that lookups miss cache like real traffic.
+    enum { KEYS = 1 << 20 };
+    char (*evs)[TB_ID_LEN] = malloc(KEYS * sizeof *evs);
+    char (*sids)[TB_ID_LEN] = malloc(KEYS * sizeof *sids);
+    uint32_t (*ixs)[2] = malloc(KEYS * sizeof *ixs);
+    if (!evs || !sids || !ixs)
+        return 1;
+    uint64_t rng = 0x9e3779b97f4a7c15ULL;
+    for (size_t k = 0; k < KEYS; ++k)
+    {
+        mkkey(bench_rand(&rng) % n, evs[k], sids[k]);
+        ixs[k][0] = tb_intern_lookup(TB_NS_EVENT, evs[k]);
+        ixs[k][1] = tb_intern_lookup(TB_NS_SEAT, sids[k]);
+    }
+
+    seat_t out;
+    size_t hits = 0;
+    t0 = bench_now_ns();
+    for (size_t i = 0; i < lookups; ++i)
+    {
+        size_t k = i & (KEYS - 1);
+        hits += seat_map_get(m, evs[k], sids[k], &out);
+    }
+    t1 = bench_now_ns();
+    printf("get:    %8.2f Mops/s  %6.1f ns/op  (string keys, %zu hits)\n",
+           lookups / ((t1 - t0) / 1e3), (double)(t1 - t0) / lookups, hits);
+
+    // Same lookups with ids resolved once at the edge.
+    hits = 0;
+    t0 = bench_now_ns();
+    for (size_t i = 0; i < lookups; ++i)
+    {
+        size_t k = i & (KEYS - 1);
+        seat_ref_t r = seat_map_find_ix(m, ixs[k][0], ixs[k][1]);
+        if (r)
+        {
+            seat_map_read(m, r, &out);
+            hits++;
+        }
+    }
+    t1 = bench_now_ns();
+    printf("get_ix: %8.2f Mops/s  %6.1f ns/op  (interned ids, %zu hits)\n",
+           lookups / ((t1 - t0) / 1e3), (double)(t1 - t0) / lookups, hits);
+
+    hits = 0;
+    t0 = bench_now_ns();
+    for (size_t i = 0; i < lookups; ++i)
+    {
+        size_t k = i & (KEYS - 1);
+        hits += seat_map_find_ix(m, ixs[k][0], ixs[k][1]) != 0;
+    }
+    t1 = bench_now_ns();
+    printf("find_ix:%8.2f Mops/s  %6.1f ns/op  (hot array only)\n",
+           lookups / ((t1 - t0) / 1e3), (double)(t1 - t0) / lookups);
+
+    t0 = bench_now_ns();
+    for (size_t i = 0; i < lookups; ++i)
+    {
+        size_t k = i & (KEYS - 1);
+        if (seat_map_lock(m, evs[k], sids[k]))
+            seat_map_unlock(m, evs[k], sids[k]);
+    }
+    t1 = bench_now_ns();
+    printf("lock:   %8.2f Mops/s  (lock+unlock pairs)\n", lookups / ((t1 - t0) / 1e3));
+
+    // Tear down a 100k-seat event: one unload against per-seat deletes.
+    enum { TEARDOWN_SEATS = 100000 };
+    s = (seat_t){0};
+    snprintf(s.event_id, sizeof s.event_id, "TEARDOWN");
+    for (int round = 0; round < 2; ++round)
+    {
+        seat_map_event_load(m, "TEARDOWN", TEARDOWN_SEATS);
+        for (size_t i = 0; i < TEARDOWN_SEATS; ++i)
+        {
+            snprintf(s.seat_id, sizeof s.seat_id, "T%zu", i);
+            seat_map_put(m, &s);
+        }
+        t0 = bench_now_ns();
+        if (round == 0)
+        {
+            seat_map_event_unload(m, "TEARDOWN");
+        }
+        else
+        {
+            for (size_t i = 0; i < TEARDOWN_SEATS; ++i)
+            {
+                snprintf(s.seat_id, sizeof s.seat_id, "T%zu", i);
+                seat_map_delete(m, "TEARDOWN", s.seat_id);
+            }
+        }
+        t1 = bench_now_ns();
+        printf("teardown %dk seats: %8.3f ms  (%s)\n", TEARDOWN_SEATS / 1000,
+               (t1 - t0) / 1e6, round == 0 ? "event_unload" : "seat_map_delete loop");
+    }
+
+    seat_map_destroy(m);
+    free(evs);
+    free(sids);
+    free(ixs);
+    return 0;
+}
@@ -0,0 +1,110 @@
+// Tiered storage: `events` events of `seats` seats each, a tenth of every
+// event sold. Reports the seat map's bytes and the process RSS with every
+// event in memory and after a sweep evicted them all, the segment files'
+// size, how long the sweep took, and the latency of the first seat_get of
+// an evicted event (which faults it back) next to a warm seat_get.
+//
+//   make bench/bench_tier && ./bench/bench_tier [events] [seats] [dir]
+#include <stdio.h>
+#include <string.h>
+
+#include "bench_util.h"
+#include "reservation.h"
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void report(const char *label, uint64_t *ns, size_t n)
+{
+    qsort(ns, n, sizeof *ns, cmp_u64);
+    printf("%-26s p50 %10.1f us  p99 %10.1f us  max %10.1f us\n", label, ns[n / 2] / 1e3,
+           ns[n * 99 / 100] / 1e3, ns[n - 1] / 1e3);
+}
+
+int main(int argc, char **argv)
+{
+    size_t events = bench_arg_size(argc, argv, 1, 200);
+    size_t n = bench_arg_size(argc, argv, 2, 5000);
+    const char *dir = argc > 3 ? argv[3] : "/tmp";
+    seat_t *seats = calloc(n, sizeof *seats);
+    uint64_t *ns = calloc(events, sizeof *ns);
+    if (events == 0 || n == 0 || !seats || !ns || !reservation_init())
+        return 1;
+    reservation_set_hold_length_seconds(300);
+
+    size_t rss0 = bench_rss_bytes();
+    char ev[TB_ID_LEN], sid[TB_ID_LEN];
+    for (size_t e = 0; e < events; ++e)
+    {
+        snprintf(ev, sizeof ev, "TE%zu", e);
+        for (size_t s = 0; s < n; ++s)
+        {
+            snprintf(seats[s].event_id, TB_ID_LEN, "%s", ev);
+            snprintf(seats[s].seat_id, TB_ID_LEN, "R%02zu-%03zu", s / 50, s % 50);
+            seats[s].price_cents = (tb_money_cents_t)(4000 + (s / 500) * 1000);
+        }
+        if (!event_load(ev, seats, n))
+            return 1;
+        for (size_t s = 0; s < n; s += 10)
+        {
+            hold_result_t h = place_hold("BUYER", ev, seats[s].seat_id);
+            if (confirm_reservation(h.hold_token, h.token_len, h.price_cents).code != RES_OK)
+                return 1;
+        }
+    }
+    free(seats);
+    if (!reservation_enable_tiering(dir, 0, 0))
+        return 1;
+    tier_stats_t st;
+    reservation_tier_stats(&st);
+    size_t rss_hot = bench_rss_bytes();
+    printf("events=%zu  seats/event=%zu  seats=%zu  seat_t=%zu bytes\n", events, n, events * n,
+           sizeof(seat_t));
+    printf("all in memory:   map %8.1f MB  RSS %8.1f MB  (%.0f map bytes/seat)\n",
+           st.map_bytes / 1e6, rss_hot / 1e6, (double)st.map_bytes / (events * n));
+    size_t map_hot = st.map_bytes;
+
+    uint64_t t0 = bench_now_ns();
+    size_t evicted = reservation_tier_sweep();
+    double sweep_ms = (bench_now_ns() - t0) / 1e6;
+    reservation_tier_stats(&st);
+    size_t rss_cold = bench_rss_bytes();
+    printf("after sweep:     map %8.1f MB  RSS %8.1f MB  (RSS at start %.1f MB)\n",
+           st.map_bytes / 1e6, rss_cold / 1e6, rss0 / 1e6);
+    printf("segments:        %zu events in %.1f MB (%.1f bytes/seat, %.0fx smaller than the map)\n",
+           evicted, st.segment_bytes / 1e6, (double)st.segment_bytes / (events * n),
+           (double)map_hot / (st.segment_bytes ? st.segment_bytes : 1));
+    printf("sweep:           %.1f ms (%.2f ms/event)\n", sweep_ms, sweep_ms / evicted);
+
+    // First access of each event: the fault; then the same seat again.
+    seat_view_t v;
+    uint64_t *warm = calloc(events, sizeof *warm);
+    if (!warm)
+        return 1;
+    for (size_t e = 0; e < events; ++e)
+    {
+        snprintf(ev, sizeof ev, "TE%zu", e);
+        snprintf(sid, sizeof sid, "R%02zu-%03zu", (e * 7) % (n / 50 ? n / 50 : 1), e % 50);
+        t0 = bench_now_ns();
+        bool ok = seat_get(ev, sid, &v);
+        ns[e] = bench_now_ns() - t0;
+        t0 = bench_now_ns();
+        ok = ok && seat_get(ev, sid, &v);
+        warm[e] = bench_now_ns() - t0;
+        if (!ok)
+            return 1;
+    }
+    reservation_tier_stats(&st);
+    report("seat_get, first (fault):", ns, events);
+    report("seat_get, warm:", warm, events);
+    printf("faults: %llu, %.2f ms average; RSS after faulting all back %.1f MB\n",
+           (unsigned long long)st.faults, st.fault_ns / 1e6 / (st.faults ? st.faults : 1),
+           bench_rss_bytes() / 1e6);
+    free(ns);
+    free(warm);
+    reservation_shutdown();
+    return 0;
+}
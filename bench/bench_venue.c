@@ -0,0 +1,116 @@
+// Venue seeding: one seat_map_put per seat against the mmap'd manifest
+// loader. Writes a CSV tour (events of 50k seats whose seat ids repeat from
+// event to event), converts it, then times each load in a fresh process so
+// interning and page state start cold every time.
+//
+//   make bench/bench_venue && ./bench/bench_venue [seats] [threads]
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "bench_util.h"
+#include "hashtable.h"
+#include "manifest.h"
+
+#define SEATS_PER_EVENT 50000u
+#define SEATS_PER_ROW   100u
+#define ROWS_PER_SECTION 25u
+
+static const char *g_csv = "/tmp/bench_venue.csv";
+static const char *g_bin = "/tmp/bench_venue.tbv";
+
+static void write_csv(size_t seats)
+{
+    FILE *f = fopen(g_csv, "w");
+    if (!f)
+    {
+        perror(g_csv);
+        exit(1);
+    }
+    fputs("event_id,section,row,seat_id,tier,price_cents\n", f);
+    for (size_t i = 0; i < seats; ++i)
+    {
+        size_t e = i / SEATS_PER_EVENT, s = i % SEATS_PER_EVENT;
+        size_t row = s / SEATS_PER_ROW, sec = row / ROWS_PER_SECTION;
+        fprintf(f, "TOUR-%zu,S%zu,R%zu,S%zu-R%zu-%zu,P%zu,%zu\n", e, sec, row % ROWS_PER_SECTION,
+                sec, row % ROWS_PER_SECTION, s % SEATS_PER_ROW, sec % 4, 2500 + 1500 * (sec % 4));
+    }
+    fclose(f);
+}
+
+// Seed with seat_t records built from the manifest's names: the cheapest
+// form of the put-per-seat loop.
+static size_t load_put_loop(const tb_manifest_t *mf, seat_map_t *m)
+{
+    size_t loaded = 0;
+    seat_t s;
+    memset(&s, 0, sizeof s);
+    for (uint32_t e = 0; e < mf->hdr->n_events; ++e)
+    {
+        const tb_manifest_event_t *ev = &mf->events[e];
+        strncpy(s.event_id, tb_manifest_name(mf, ev->name), TB_ID_LEN - 1);
+        for (uint64_t i = ev->first_seat; i < ev->first_seat + ev->n_seats; ++i)
+        {
+            strncpy(s.seat_id, tb_manifest_seat_name(mf, i), TB_ID_LEN - 1);
+            s.price_cents = mf->tiers[mf->seats[i].tier].price_cents;
+            loaded += seat_map_put(m, &s);
+        }
+    }
+    return loaded;
+}
+
+// threads == 0: put loop. Runs in a child process.
+static void run(const char *label, unsigned threads, size_t expect)
+{
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid != 0)
+    {
+        waitpid(pid, NULL, 0);
+        return;
+    }
+    size_t rss0 = bench_rss_bytes();
+    uint64_t t0 = bench_now_ns();
+    tb_manifest_t mf;
+    if (!tb_manifest_open(&mf, g_bin))
+        _exit(1);
+    seat_map_t *m = seat_map_create(1024);
+    size_t loaded = threads ? tb_manifest_load(&mf, m, threads) : load_put_loop(&mf, m);
+    uint64_t t1 = bench_now_ns();
+    printf("%-22s %9.1f ms  %6.2f Mseats/s  rss +%.0f MiB%s\n", label, (t1 - t0) / 1e6,
+           loaded / ((t1 - t0) / 1e3), (bench_rss_bytes() - rss0) / 1048576.0,
+           loaded == expect ? "" : "  (seat count mismatch!)");
+    fflush(stdout);
+    _exit(0);
+}
+
+int main(int argc, char **argv)
+{
+    size_t seats = bench_arg_size(argc, argv, 1, 1000000);
+    unsigned threads = (unsigned)bench_arg_size(argc, argv, 2, 4);
+
+    write_csv(seats);
+    uint64_t t0 = bench_now_ns();
+    size_t bad = 0;
+    if (!tb_manifest_from_csv(g_csv, g_bin, &bad))
+    {
+        fprintf(stderr, "convert failed (line %zu)\n", bad);
+        return 1;
+    }
+    uint64_t t1 = bench_now_ns();
+    tb_manifest_t mf;
+    tb_manifest_open(&mf, g_bin);
+    printf("seats=%zu events=%u manifest=%.1f MiB  convert %.0f ms\n", seats, mf.hdr->n_events,
+           mf.bytes / 1048576.0, (t1 - t0) / 1e6);
+    tb_manifest_close(&mf);
+
+    char label[32];
+    run("seat_map_put loop", 0, seats);
+    run("manifest, 1 thread", 1, seats);
+    snprintf(label, sizeof label, "manifest, %u threads", threads);
+    run(label, threads, seats);
+    remove(g_csv);
+    remove(g_bin);
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Event-partitioned cluster: several TicketBook processes on one machine,
+// each owning a set of events, behind a router that forwards every call to
+// the owner of its event over Unix stream sockets.
+//
+// Ring: each node puts CONFIG_RING_VNODES points on a 64-bit hash ring and
+// an event belongs to the node with the first point at or after the
+// event's hash. A node that joins takes over about 1/n of the events, all
+// of them from the others; a node that leaves hands on only its own.
+//
+// Node: a process running the reservation API behind a socket; its order
+// ids carry its node number (orderid.h). Frames are fixed-size structs in
+// host byte order and seats travel as raw seat_t, so every process must be
+// the same build on the same machine.
+//
+// Router: events loaded through the router move live when nodes join or
+// leave. The event's seats, holds, sales and open orders are exported from
+// the old owner, loaded on the new one and dropped from the old; calls to
+// that event wait for the move, calls to every other event carry on. Each
+// node keeps its own orders (the DB stub is per process), so confirm and
+// refund name the event too and go to its current owner, which has every
+// order of the event whichever node took it.
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "reservation.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TB_NODE_NONE UINT32_MAX
+
+// ---- consistent-hashing ring ----
+typedef struct tb_ring tb_ring_t;
+
+tb_ring_t *tb_ring_create(void);
+void tb_ring_destroy(tb_ring_t *ring);
+
+// False if the node is already on the ring (or out of memory).
+bool tb_ring_add(tb_ring_t *ring, uint32_t node);
+// False if the node is not on the ring.
+bool tb_ring_remove(tb_ring_t *ring, uint32_t node);
+size_t tb_ring_nodes(const tb_ring_t *ring);
+
+// Owner of event_id, TB_NODE_NONE if the ring is empty.
+uint32_t tb_ring_owner(const tb_ring_t *ring, const char *event_id);
+
+// ---- nodes ----
+
+// Serve the reservation API on `path` until tb_node_stop is called for it.
+// Call between reservation_init and reservation_shutdown. False if the
+// socket cannot be set up.
+bool tb_node_serve(const char *path);
+
+// Fork a process that initializes the reservation layer and serves on
+// `path` as `node` (0..TB_ORDERID_MAX_NODE). Returns its pid once it
+// accepts connections, or -1. The node is killed if the caller dies. Fork
+// nodes before the caller starts threads.
+pid_t tb_node_spawn(const char *path, uint32_t node);
+
+// Ask the node serving on `path` to stop. False if it cannot be reached.
+bool tb_node_stop(const char *path);
+
+// ---- router ----
+typedef struct tb_router tb_router_t;
+
+tb_router_t *tb_router_create(void);
+// Disconnects; the nodes keep running.
+void tb_router_destroy(tb_router_t *r);
+
+// Connect to `node` serving on `path`, put it on the ring and move to it
+// the events it now owns. False if it cannot be reached, is already a
+// member, or a move failed (events that did not move stay where they were).
+bool tb_router_add_node(tb_router_t *r, uint32_t node, const char *path);
+
+// Move the node's events to the remaining nodes, take it off the ring and
+// disconnect. False if it is not a member, or it owns events and is the
+// last node, or a move failed (it then stays a member).
+bool tb_router_remove_node(tb_router_t *r, uint32_t node);
+
+// Current owner of event_id, TB_NODE_NONE with no nodes.
+uint32_t tb_router_owner(tb_router_t *r, const char *event_id);
+
+// Events moved between nodes since the router was created.
+size_t tb_router_moves(const tb_router_t *r);
+
+// event_load on the event's owner; the event then moves with the ring.
+bool tb_router_load_event(tb_router_t *r, const char *event_id, const seat_t *seats, size_t n);
+
+// The reservation calls, run on the event's owner. A node that cannot be
+// reached gives RES_INTERNAL_ERR (false for seat_get).
+hold_result_t tb_router_place_hold(tb_router_t *r, const char *user_id, const char *event_id,
+                                   const char *seat_id);
+confirm_result_t tb_router_confirm(tb_router_t *r, const char *event_id,
+                                   const tb_byte_t *hold_token, size_t token_len,
+                                   tb_money_cents_t amount_paid_cents);
+res_code_t tb_router_cancel_hold(tb_router_t *r, const char *user_id, const char *event_id,
+                                 const char *seat_id);
+bool tb_router_seat_get(tb_router_t *r, const char *event_id, const char *seat_id,
+                        seat_view_t *out);
+res_code_t tb_router_refund(tb_router_t *r, const char *user_id, const char *event_id,
+                            const char *order_id);
+
+#ifdef __cplusplus
+}
+#endif
@@ -74,11 +74,58 @@ res_code_t db_seat_mark_sold(db_txn_t* txn,
 // -------------------------------
 
 // Record a refund and flip order/seat state per policy.
+// Returns RES_NOT_FOUND if the order does not exist, belongs to another
+// user, or was already refunded.
 res_code_t db_refund_create(db_txn_t* txn,
                             const char* user_id,
                             const char* order_id,
                             tb_money_cents_t amount_cents);
 
+// -------------------------------
+// Event cancellation
+// -------------------------------
+
+// An order refunded by db_refund_event_batch.
+typedef struct {
+    char order_id[RES_ID_LEN];
+    char user_id[RES_ID_LEN];
+    uint32_t seat_ix; // interned, see intern.h
+    tb_money_cents_t price_cents;
+} db_refund_row_t;
+
+// Open (unrefunded) orders of an event, through the per-event order index.
+size_t db_order_count_by_event(const char* event_id);
+
+// Refund up to `max` open orders of the event in one transaction, writing
+// them to out and their number to *n_out (0 once none are left). Each order
+// is refunded at most once: concurrent batches get disjoint orders, and the
+// refunds commit together with the orders leaving the open set, so a batch
+// that does not commit leaves its orders for the next one (the stub applies
+// them at once). Returns RES_DB_ERROR on DB errors.
+res_code_t db_refund_event_batch(db_txn_t* txn,
+                                 const char* event_id,
+                                 size_t max,
+                                 db_refund_row_t* out,
+                                 size_t* n_out);
+
+// -------------------------------
+// Moving an event's orders
+// -------------------------------
+
+// Copy up to `max` open orders of the event to out. Returns how many the
+// event has in all.
+size_t db_order_export_event(const char* event_id, order_record_t* out, size_t max);
+
+// Insert orders of the event under their existing ids, skipping ids already
+// present. All or nothing: RES_INTERNAL_ERR (none inserted) out of memory.
+res_code_t db_order_import(db_txn_t* txn,
+                           const char* event_id,
+                           const order_record_t* rows,
+                           size_t n);
+
+// Remove the event's open orders without refunding them. Returns how many.
+size_t db_order_drop_event(const char* event_id);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,56 @@
+// Epoch-based reclamation: lets structures be unlinked while lock-free
+// readers may still be walking them, and frees them once no reader can be.
+//
+// Readers bracket every access with tb_ebr_enter/tb_ebr_exit (nestable,
+// per thread; a store and a fence, no shared writes). A writer unlinks an
+// object so new readers cannot reach it, then retires it; the retire
+// callback runs only after every reader that was inside a section at the
+// time has left, i.e. after the global epoch moved on twice. Callbacks run
+// in retire order, so an object retired after its parts is freed after
+// them too.
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct tb_ebr_node tb_ebr_node_t;
+typedef void (*tb_ebr_fn)(tb_ebr_node_t *node);
+
+// Embedded in (or allocated alongside) the object being retired.
+struct tb_ebr_node
+{
+    tb_ebr_node_t *next;
+    uint64_t epoch;
+    tb_ebr_fn fn;
+};
+
+void tb_ebr_enter(void);
+void tb_ebr_exit(void);
+
+// Queue `fn(node)` to run once every current reader is gone. Never runs
+// callbacks itself, so it may be called with locks held that they take.
+void tb_ebr_retire(tb_ebr_node_t *node, tb_ebr_fn fn);
+
+// Advance the epoch if every reader has caught up, and run the callbacks
+// that became safe. Cheap when there is nothing to do; call it outside any
+// lock the callbacks take. Returns the number of callbacks run.
+size_t tb_ebr_reclaim(void);
+
+// Block until every reader inside a section now has left. The calling
+// thread must not be inside one.
+void tb_ebr_synchronize(void);
+
+// Run every callback retired so far, waiting for readers as needed. For
+// teardown; the calling thread must not be inside a section.
+void tb_ebr_barrier(void);
+
+// Retired callbacks not yet run (for tests and stats).
+size_t tb_ebr_pending(void);
+
+#ifdef __cplusplus
+}
+#endif
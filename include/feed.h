@@ -0,0 +1,74 @@
+// Seat change feed: a broadcast ring of seat transitions for clients that
+// would otherwise poll seat_get to keep seat maps fresh.
+//
+// Writers publish into a fixed ring without locks and never wait for
+// subscribers; each subscriber reads at its own cursor. A poll hands back at
+// most one change per seat (the latest), so a subscriber that falls behind
+// catches up in one pass over the seats that moved rather than replaying
+// every transition. A subscriber lapped by the writers (more than the ring's
+// capacity behind) is told so and should resync, e.g. from an event
+// snapshot; nothing ever slows writers down on its behalf.
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+    TB_CHANGE_HELD = 0,     // seat held (possibly taking over a lapsed hold)
+    TB_CHANGE_RELEASED = 1, // hold cancelled or expired
+    TB_CHANGE_SOLD = 2,
+    TB_CHANGE_REFUNDED = 3, // sold seat refunded and on sale again
+    TB_CHANGE_RELOADED = 4, // seat (or with seat_ix 0, event) rewritten; change logs only
+    TB_CHANGE_WITHDRAWN = 5, // seat off sale, its event cancelled (refunded if it was sold)
+} tb_change_kind_t;
+
+typedef struct
+{
+    uint64_t seq;      // feed position, one per published change
+    uint32_t event_ix; // interned in TB_NS_EVENT
+    uint32_t seat_ix;  // interned in TB_NS_SEAT
+    tb_change_kind_t kind;
+} tb_change_t;
+
+typedef struct tb_feed tb_feed_t;
+typedef struct tb_feed_sub tb_feed_sub_t;
+
+// Ring of `capacity` changes, rounded up to a power of two (minimum 64).
+// Returns NULL when out of memory.
+tb_feed_t *tb_feed_create(size_t capacity);
+
+// Every subscriber must be gone, and no publish in flight.
+void tb_feed_destroy(tb_feed_t *f);
+
+// Append a change; safe from any number of threads. Returns its seq.
+uint64_t tb_feed_publish(tb_feed_t *f, uint32_t event_ix, uint32_t seat_ix, tb_change_kind_t kind);
+
+// Seq the next change will get: every change below it is published or
+// being published.
+uint64_t tb_feed_head(const tb_feed_t *f);
+
+// A subscriber sees changes published after it subscribes. A subscriber is
+// polled by one thread at a time. NULL when out of memory.
+tb_feed_sub_t *tb_feed_subscribe(tb_feed_t *f);
+void tb_feed_unsubscribe(tb_feed_sub_t *s);
+
+// Seq of the next change the subscriber will read: it has seen every
+// change below it.
+uint64_t tb_feed_cursor(const tb_feed_sub_t *s);
+
+// Up to `max` changes for distinct seats, each the latest the subscriber
+// has reached for its seat, in order of each seat's first change in the
+// batch. Reads stop at a change not yet fully published. If the subscriber
+// was lapped, *lost is set and it skips to the head of the feed: the
+// changes returned are still valid, but others were dropped. Returns the
+// number of changes written to out.
+size_t tb_feed_poll(tb_feed_sub_t *s, tb_change_t *out, size_t max, bool *lost);
+
+#ifdef __cplusplus
+}
+#endif
@@ -4,53 +4,114 @@
 #include <pthread.h>
 
 #include "types.h"
+#include "ebr.h"
+#include "intern.h"
+#include "seat_lock.h"
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
-    typedef struct bucket bucket_t; // forward declare
     typedef struct seat_map seat_map_t;
+    typedef struct hold_table hold_table_t; // holder/token slots, see hashtable.c
 
-    struct bucket
+    // Handle to a seat record: index into the map's dense arrays, 0 = none.
+    // Lookups are lock-free and may run alongside puts, deletes and event
+    // loads and unloads. A handle stays valid until the seat is deleted or
+    // its event unloaded; a caller that may race those must find and use it
+    // within one tb_ebr_enter/tb_ebr_exit section (ebr.h), which keeps the
+    // record from being reused or unmapped meanwhile. Operations on a
+    // deleted seat's handle fail (see SEAT_STATE_GONE).
+    typedef uint32_t seat_ref_t;
+
+    // Hot record: everything a lookup or hold/cancel touches, packed densely.
+    // 32 bytes with SEAT_LOCK=futex (64 with a pthread mutex).
+    typedef struct seat_hot
     {
-        seat_t seat;
-        pthread_mutex_t mtx;
-        bucket_t *next;
-    };
+        uint64_t key;        // interned (event, seat) ids, see seat_key_make
+        uint64_t state;      // packed status | pin | hold slot | expiry, see seat_state_*
+        uint32_t version;    // seqlock sequence over the cold record; even when stable
+        seat_ref_t next;     // hash chain link
+        tb_seat_lock_t lock; // pthread mutex, or a 4-byte futex word (SEAT_LOCK=futex)
+    } seat_hot_t;
+
+    // Cold record: price and sale data, touched only when needed. Identity is
+    // the interned key in the hot record; holder id and token of an active
+    // hold live in the hold slot table.
+    typedef struct seat_cold
+    {
+        tb_money_cents_t price_cents;
+        char last_order_id[TB_ID_LEN];
+        tb_epoch_t updated_unix;
+    } seat_cold_t;
+
+#define SEAT_SEG_BITS 16
+#define SEAT_SEG_SIZE (1u << SEAT_SEG_BITS)
+#define SEAT_MAX_SEGS 65536u // segment ids share the 32-bit ref with the offset
+
+#define SEAT_EVENT_PAGE_BITS 12
+#define SEAT_EVENT_PAGE_SIZE (1u << SEAT_EVENT_PAGE_BITS)
+#define SEAT_EVENT_PAGES 32768u // 134M interned event ids
+
+    typedef struct seat_event seat_event_t; // one event's region, see hashtable.c
+    typedef struct seat_gate seat_gate_t;   // writer/snapshot handshake, see hashtable.c
+    typedef struct seat_snapshot seat_snapshot_t;
+    typedef struct seat_price_index seat_price_index_t; // see "Price index" below
 
     struct seat_map
     {
-        size_t cap; // number of buckets
-        bucket_t **table;
+        size_t chains_hint; // initial chains for an event created by put
+        // Events by interned id, in lazily allocated pages.
+        seat_event_t **events[SEAT_EVENT_PAGES];
+        // Parallel dense arrays in fixed-size segments that never move:
+        // hot[r] and cold[r] describe the same seat. Every segment belongs to
+        // exactly one event and is released with it.
+        seat_hot_t *hot[SEAT_MAX_SEGS];
+        seat_cold_t *cold[SEAT_MAX_SEGS];
+        uint64_t *avail[SEAT_MAX_SEGS];  // a bit per record, set while AVAILABLE
+        uint16_t seg_pos[SEAT_MAX_SEGS]; // position of a segment within its event
+        uint32_t seg_hwm;         // next never-used segment id; 0 is reserved
+        size_t count;             // live seats
+        pthread_mutex_t grow_mtx; // segment and event page allocation
+        hold_table_t *holds;
+        seat_gate_t *gate;
     };
 
-    // Create a new seat map with given capacity (rounded up internally).
+    // Create a new seat map. `capacity` sizes the chain table of each event
+    // created implicitly by put (tables grow as events fill).
     // Returns NULL on allocation failure.
     seat_map_t *seat_map_create(size_t capacity);
 
-    // Free all buckets and associated locks.
+    // Free all seat records and associated locks.
     void seat_map_destroy(seat_map_t *m);
 
     // Insert or replace a seat entry.
+    // Replacing bumps seat.version as a seqlock sequence (odd while the copy
+    // is in flight); the caller's version field is ignored. Concurrent writers
+    // to the same seat must hold its lock. Inserts serialise on the event's
+    // mutex; readers never wait for them.
     // Returns true on success.
     bool seat_map_put(seat_map_t *m, const seat_t *seat);
 
-    // Remove a seat entry entirely (if it exists).
+    // Remove a seat entry entirely (if it exists). The record is reused only
+    // once every reader that might still hold it has left its EBR section.
+    // Waits for a pinned hold (a confirm in flight) to be released first.
     // Returns true if removed, false if not found.
     bool seat_map_delete(seat_map_t *m,
                          const char *event_id,
                          const char *seat_id);
 
-    // Retrieve a seat by event + seat id.
+    // Retrieve a seat by event + seat id without taking the seat lock.
+    // Retries until it copies a version that no writer touched mid-read, so
+    // *out is never torn; out->version is the (even) sequence observed.
     // Returns true and copies into *out if found.
     bool seat_map_get(seat_map_t *m,
                       const char *event_id,
                       const char *seat_id,
                       seat_t *out);
 
-    // Find a seat by its hold token (no locking performed here).
+    // Find a seat by its hold token (lock-free, O(1) expected).
     // Returns true and copies into *out if found.
     bool seat_map_find_by_token(seat_map_t *m,
                                 const tb_byte_t *token,
@@ -59,19 +120,341 @@ extern "C"
 
     // ---- Concurrency helpers ----
 
-    // Lock the mutex for a specific seat if it exists.
+    // Lock the per-seat lock for a specific seat if it exists.
     // Call before mutating the seat struct in place.
     // Returns true if locked.
     bool seat_map_lock(seat_map_t *m,
                        const char *event_id,
                        const char *seat_id);
 
-    // Unlock the mutex for a specific seat.
+    // Unlock the per-seat lock for a specific seat.
     // Call after mutating seat struct.
     void seat_map_unlock(seat_map_t *m,
                          const char *event_id,
                          const char *seat_id);
 
+    // ---- Packed hot state (lock-free hold/release) ----
+    //
+    // status, hold expiry and a reference to the holder/token slot live in one
+    // 64-bit word so AVAILABLE<->HELD transitions are a single CAS:
+    //
+    //   bits  0-1   seat_status_t
+    //   bit   2     pinned: a confirm owns the hold, no CAS may take it
+    //   bits  3-31  hold slot reference (24-bit index, 5-bit generation)
+    //   bits 32-63  hold expiry, unix seconds (0 = none)
+
+#define SEAT_STATE_PINNED ((uint64_t)1 << 2)
+
+    // State of a deleted seat (or one of an unloaded event): a pinned hold
+    // with neither slot nor expiry, which no live seat has. Every CAS and
+    // write on the record fails from then on.
+#define SEAT_STATE_GONE (SEAT_STATE_PINNED | (uint64_t)SEAT_HELD)
+
+    // Holder data referenced by a HELD state word.
+    typedef struct
+    {
+        char holder_user_id[TB_ID_LEN];
+        tb_byte_t token[TB_TOKEN_LEN];
+        size_t token_len;
+    } seat_hold_t;
+
+    static inline seat_status_t seat_state_status(uint64_t w)
+    {
+        return (seat_status_t)(w & 3u);
+    }
+
+    static inline bool seat_state_pinned(uint64_t w)
+    {
+        return (w & SEAT_STATE_PINNED) != 0;
+    }
+
+    static inline uint32_t seat_state_slot(uint64_t w)
+    {
+        return (uint32_t)(w >> 3) & 0x1fffffffu;
+    }
+
+    static inline bool seat_state_gone(uint64_t w)
+    {
+        return w == SEAT_STATE_GONE;
+    }
+
+    static inline tb_epoch_t seat_state_expires(uint64_t w)
+    {
+        return (tb_epoch_t)(w >> 32);
+    }
+
+    static inline uint64_t seat_state_make(seat_status_t status, uint32_t slot, tb_epoch_t expires)
+    {
+        if (expires < 0)
+            expires = 0;
+        if (expires > (tb_epoch_t)UINT32_MAX)
+            expires = (tb_epoch_t)UINT32_MAX;
+        return ((uint64_t)expires << 32) | ((uint64_t)(slot & 0x1fffffffu) << 3) |
+               ((uint64_t)status & 3u);
+    }
+
+    // Integer key of a seat: interned event id in the high half, seat id in
+    // the low half. Never 0 for a valid seat.
+    static inline uint64_t seat_key_make(uint32_t event_ix, uint32_t seat_ix)
+    {
+        return ((uint64_t)event_ix << 32) | seat_ix;
+    }
+
+    // Resolve a seat to its handle. Returns 0 if not found.
+    // The string form interns nothing: unknown names are simply not found.
+    seat_ref_t seat_map_find(seat_map_t *m,
+                             const char *event_id,
+                             const char *seat_id);
+    seat_ref_t seat_map_find_ix(const seat_map_t *m,
+                                uint32_t event_ix,
+                                uint32_t seat_ix);
+
+    // ---- Batched lookups ----
+    //
+    // Many seats of one event at once (a cart, a group, a chart section).
+    // Every key of a batch is hashed first and the probes are then walked
+    // in lockstep, prefetching each seat's next record before touching the
+    // others', so the cache misses of different seats overlap instead of
+    // queueing one behind another.
+
+    // refs[i] = handle of seat seat_ix[i] of the event, or 0 if not found.
+    // Returns the number found.
+    size_t seat_map_find_many_ix(const seat_map_t *m, uint32_t event_ix,
+                                 const uint32_t *seat_ix, size_t n, seat_ref_t *refs);
+
+    // seat_map_read for each handle; out[i] is zeroed where refs[i] is 0 or
+    // the seat was deleted.
+    void seat_map_read_many(const seat_map_t *m, const seat_ref_t *refs, size_t n, seat_t *out);
+
+    // seat_map_get for each named seat of the event. found[i] tells whether
+    // out[i] was filled (found may be NULL). Returns the number found.
+    size_t seat_map_get_many(seat_map_t *m, const char *event_id,
+                             const char *const *seat_ids, size_t n,
+                             seat_t *out, bool *found);
+
+    // Per-seat lock by handle (see seat_map_lock).
+    bool seat_map_lock_ref(seat_map_t *m, seat_ref_t r);
+    void seat_map_unlock_ref(seat_map_t *m, seat_ref_t r);
+
+    // Seqlock-consistent copy of a seat (as seat_map_get). False (and *out
+    // zeroed) if the seat has been deleted.
+    bool seat_map_read(const seat_map_t *m, seat_ref_t r, seat_t *out);
+
+    // Live seat count, and bytes held by records, chains and hold slots.
+    size_t seat_map_size(const seat_map_t *m);
+    size_t seat_map_memory_bytes(const seat_map_t *m);
+
+    // ---- Event regions ----
+    //
+    // Each event's seats are allocated from the event's own segments and
+    // indexed by its own chain table, so an event is loaded and dropped as a
+    // unit. Structural changes (put of a new seat, delete, load, unload)
+    // serialise on a per-event mutex and may run alongside readers; what
+    // they unlink is freed through EBR.
+
+    // Create an empty region for `event_id` sized for `expected_seats`.
+    // Returns true if the event exists afterwards (including already loaded).
+    bool seat_map_event_load(seat_map_t *m, const char *event_id, size_t expected_seats);
+
+    // Drop an event and every seat in it: segments are returned in one step,
+    // with no per-seat hashing or unlinking, once no reader can still be
+    // inside them. Active holds are released.
+    // Returns false if the event is not loaded.
+    bool seat_map_event_unload(seat_map_t *m, const char *event_id);
+
+    // Live seats of an event (0 if not loaded).
+    size_t seat_map_event_size(const seat_map_t *m, uint32_t event_ix);
+
+    // Bytes held by an event's region, as counted by seat_map_memory_bytes
+    // (0 if not loaded).
+    size_t seat_map_event_memory_bytes(const seat_map_t *m, uint32_t event_ix);
+
+    // ---- Availability ----
+    //
+    // Every record has a bit that is set while its seat is AVAILABLE, kept
+    // up to date by each write and state CAS, so counting or searching an
+    // event reads the bits and never the records. The bits follow the state
+    // word: a hold that lapsed counts as held until the seat is next
+    // written. Positions are record indexes within the event in allocation
+    // order; a bulk load puts seat i of its input at position i.
+
+#define SEAT_AVAIL_MAX_RUN 64
+
+    // A row of seats at positions [first, first + n_seats), left to right.
+    typedef struct
+    {
+        uint32_t section_ix; // interned in TB_NS_SECTION; 0 = none
+        uint32_t first;
+        uint32_t n_seats;
+    } seat_row_t;
+
+    // Give an event a seating layout, replacing any. Rows keep the given
+    // order, which searches treat as preference order. Fails if a row lies
+    // past the event's records. Must not race searches of the event.
+    bool seat_map_event_set_rows(seat_map_t *m, uint32_t event_ix,
+                                 const seat_row_t *rows, size_t n);
+
+    // The event's layout, or NULL (*n = 0) if it has none.
+    const seat_row_t *seat_map_event_rows(const seat_map_t *m, uint32_t event_ix, size_t *n);
+
+    // Records handed out to an event: every position is below this.
+    size_t seat_map_event_records(const seat_map_t *m, uint32_t event_ix);
+
+    // Seat at a position of an event, 0 if the record is unused.
+    seat_ref_t seat_map_event_ref(const seat_map_t *m, uint32_t event_ix, size_t pos);
+
+    // Available seats at positions [first, first + count).
+    size_t seat_map_avail_count(const seat_map_t *m, uint32_t event_ix,
+                                size_t first, size_t count);
+
+    // Find `n` (1..SEAT_AVAIL_MAX_RUN) adjacent available seats within
+    // positions [first, first + count), taking the run that starts closest
+    // to `near`. Returns false if there is none; else *start is its first
+    // position.
+    bool seat_map_avail_find(const seat_map_t *m, uint32_t event_ix, size_t first,
+                             size_t count, size_t n, size_t near, size_t *start);
+
+    // ---- Price index ----
+    //
+    // An event's seats ranked by price (ties in position order) with a bit
+    // per rank, set while the seat is AVAILABLE and kept in step with the
+    // availability bits by every write and state CAS, plus a summary bit per
+    // 64 ranks so sold-out stretches are skipped a word at a time. Distinct
+    // prices form tiers; a price range is the range of ranks found by
+    // binary search over them. The index is built by an event's first price
+    // query and rebuilt by the next one after a seat is added or repriced,
+    // so events nobody asks about by price carry none. Like the
+    // availability bits it follows the state word and is not a snapshot.
+
+    // A walk over the available seats of one event in a price range.
+    typedef struct
+    {
+        const seat_event_t *e;
+        const seat_price_index_t *px;
+        size_t rank, end; // next rank to look at, end of the range
+        size_t tier;      // tier of `rank`
+    } seat_price_cursor_t;
+
+    // Start a walk over the available seats of an event priced in
+    // [lo, hi], cheapest first. The caller stays inside an EBR section
+    // (ebr.h) until done with the cursor. False if the event is not loaded
+    // or the index cannot be built (out of memory).
+    bool seat_map_price_open(seat_map_t *m, uint32_t event_ix, tb_money_cents_t lo,
+                             tb_money_cents_t hi, seat_price_cursor_t *c);
+
+    // The walk's next seat, with its price as indexed. False once there
+    // are no more.
+    bool seat_map_price_next(const seat_map_t *m, seat_price_cursor_t *c, seat_ref_t *r,
+                             tb_money_cents_t *price);
+
+    // Available seats of an event priced in [lo, hi].
+    size_t seat_map_price_count(seat_map_t *m, uint32_t event_ix, tb_money_cents_t lo,
+                                tb_money_cents_t hi);
+
+    // ---- Event counters ----
+    //
+    // Seats of an event by status, kept by every put, delete, write and
+    // state CAS, so reading them is a sum of a few counters and takes no
+    // seat lock. Like the availability bits they follow the state word. A
+    // read racing writers may see a seat mid-move (in both statuses or in
+    // neither); once writers are quiescent the totals are exact.
+
+    typedef struct
+    {
+        size_t seats;        // live seats of the event
+        size_t by_status[4]; // indexed by seat_status_t
+    } seat_counts_t;
+
+    // False if the event is not loaded.
+    bool seat_map_event_counts(const seat_map_t *m, uint32_t event_ix, seat_counts_t *out);
+
+    // Consistency check for tests and audits: walks every record of the
+    // event and compares the counters, the availability bits (and the
+    // price index's, if it is current) and the live seat count with the
+    // records themselves. Writers of the event must be
+    // quiescent. False on any mismatch or if the event is not loaded.
+    bool seat_map_event_verify(const seat_map_t *m, uint32_t event_ix);
+
+    // ---- Event snapshots ----
+    //
+    // Stream every seat of an event as of one instant, without seat locks
+    // and while writers carry on. Writers that touch a seat the scan has not
+    // reached yet first save its pre-image for the scan. At most
+    // SEAT_SNAP_SLOTS snapshots of an event may be open at once; structural
+    // changes to the event must not run while one is open.
+
+#define SEAT_SNAP_SLOTS 8
+
+    // Start a snapshot of `event_ix`. Returns NULL if the event is not
+    // loaded, every slot is taken, or on allocation failure.
+    seat_snapshot_t *seat_map_snapshot_begin(seat_map_t *m, uint32_t event_ix);
+
+    // Copy the next seat into *out (hold token fields are left empty).
+    // Returns false once every seat has been returned.
+    bool seat_map_snapshot_next(seat_snapshot_t *s, seat_t *out);
+
+    // Close a snapshot. Returns false if a writer could not save a
+    // pre-image (out of memory), in which case the seats returned may mix
+    // instants.
+    bool seat_map_snapshot_end(seat_snapshot_t *s);
+
+    // ---- Bulk loading ----
+    //
+    // A new event can be filled from several threads at once: begin reserves
+    // every record and sizes the chain table up front, fill writes disjoint
+    // ranges of those records and links them with a CAS per seat, end
+    // recycles the records left unused. Readers may look the event up
+    // throughout; nothing else may change it until end returns.
+
+    typedef struct
+    {
+        uint32_t seat_ix; // interned seat id; 0 leaves the record unused
+        tb_money_cents_t price_cents;
+    } seat_bulk_t;
+
+    // Create `event_ix` with `n` records reserved. Fails if the event is
+    // already loaded.
+    bool seat_map_bulk_begin(seat_map_t *m, uint32_t event_ix, size_t n);
+
+    // Fill reserved records [first, first + count) as AVAILABLE seats. Safe
+    // from several threads on disjoint ranges. Seats already present in the
+    // event are skipped. Returns the number inserted.
+    size_t seat_map_bulk_fill(seat_map_t *m, uint32_t event_ix, size_t first,
+                              const seat_bulk_t *rows, size_t count, tb_epoch_t now);
+
+    // Finish a bulk load. Returns the event's live seat count.
+    size_t seat_map_bulk_end(seat_map_t *m, uint32_t event_ix);
+
+    static inline seat_hot_t *seat_map_hot(const seat_map_t *m, seat_ref_t r)
+    {
+        return &m->hot[r >> SEAT_SEG_BITS][r & (SEAT_SEG_SIZE - 1)];
+    }
+
+    static inline uint64_t seat_state_load(const seat_map_t *m, seat_ref_t r)
+    {
+        return __atomic_load_n(&seat_map_hot(m, r)->state, __ATOMIC_ACQUIRE);
+    }
+
+    // Copy the holder slot referenced by state word w. Returns false if the
+    // seat moved on from w meanwhile (the copy may then be garbage).
+    bool seat_state_hold(const seat_map_t *m, seat_ref_t r,
+                         uint64_t w, seat_hold_t *out);
+
+    // Allocate a holder slot for seat r. Returns the slot reference to pass
+    // to seat_state_make, or 0 if the slot table is exhausted.
+    uint32_t seat_hold_slot_alloc(seat_map_t *m, seat_ref_t r,
+                                  const char *user_id,
+                                  const tb_byte_t *token, size_t token_len);
+
+    // Return a slot that was never published through seat_state_cas.
+    void seat_hold_slot_free(seat_map_t *m, uint32_t slot);
+
+    // Compare-and-swap the state word. On success the slot referenced by
+    // `expected` is recycled unless `desired` still references it, though
+    // not before every EBR section open now has left: a caller that loads
+    // a word and CASes it within one section cannot see it come back.
+    bool seat_state_cas(seat_map_t *m, seat_ref_t r, uint64_t expected, uint64_t desired);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,54 @@
+// Process-wide string interning for event and seat identifiers.
+//
+// Names are mapped once at the API edge to dense 32-bit ids (starting at 1;
+// 0 means "unknown"). The seat map, its indexes and the DB stub key on these
+// integers and only turn them back into names when building a view.
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    TB_NS_EVENT   = 0,
+    TB_NS_SEAT    = 1,
+    TB_NS_SECTION = 2, // venue sections, see seat_row_t
+    TB_NS_COUNT
+} tb_namespace_t;
+
+// Return the id for `name`, assigning the next dense id if it is new.
+// Names longer than TB_ID_LEN - 1 are truncated. Returns 0 on failure.
+uint32_t tb_intern(tb_namespace_t ns, const char *name);
+
+// Return the id for `name` without assigning one; 0 if never interned.
+// Lock-free; safe to call concurrently with tb_intern.
+uint32_t tb_intern_lookup(tb_namespace_t ns, const char *name);
+
+// tb_intern_lookup for `n` names, with the index probes of a batch issued
+// together so their cache misses overlap. ids[i] receives the id of
+// names[i] (0 if never interned). Returns the number of names found.
+size_t tb_intern_lookup_many(tb_namespace_t ns, const char *const *names, size_t n, uint32_t *ids);
+
+// Resolve `n` names at once, interning new ones under a single lock
+// acquisition. ids[i] receives the id of names[i] (0 on failure). Returns
+// the number of names resolved.
+size_t tb_intern_many(tb_namespace_t ns, const char *const *names, size_t n, uint32_t *ids);
+
+// Name for an id, or NULL if unassigned. The pointer stays valid for the
+// lifetime of the process.
+const char *tb_intern_name(tb_namespace_t ns, uint32_t id);
+
+// Number of ids assigned so far in a namespace.
+uint32_t tb_intern_count(tb_namespace_t ns);
+
+// Convenience wrappers
+static inline uint32_t tb_event_ix(const char *event_id) { return tb_intern(TB_NS_EVENT, event_id); }
+static inline uint32_t tb_seat_ix(const char *seat_id) { return tb_intern(TB_NS_SEAT, seat_id); }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,151 @@
+// Binary venue manifest: the seats of one or more events in a compact,
+// memory-mappable file, and a parallel loader that builds seat map regions
+// straight from it.
+//
+// Layout (little-endian, every table 8-byte aligned):
+//
+//   header | events | sections | rows | tiers | seats | seat names | strings
+//
+// Tables nest by index range: an event owns a contiguous run of sections,
+// tiers and seats, a section a run of rows, a row a run of seats. Names are
+// byte offsets into the string blob, a sequence of NUL-terminated names of
+// at most TB_ID_LEN - 1 bytes; equal names are stored once. Seats refer to
+// their id through the seat name table instead, so a loader resolves each
+// distinct seat id once however many events repeat it.
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "types.h"
+#include "hashtable.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TB_MANIFEST_MAGIC   "TBVENUE"
+#define TB_MANIFEST_VERSION 1u
+
+typedef struct
+{
+    char magic[8]; // TB_MANIFEST_MAGIC, NUL-padded
+    uint32_t version;
+    uint32_t header_bytes;
+    uint32_t n_events;
+    uint32_t n_sections;
+    uint32_t n_rows;
+    uint32_t n_tiers;
+    uint32_t n_seat_names;
+    uint32_t reserved;
+    uint64_t n_seats;
+    uint64_t events_off;
+    uint64_t sections_off;
+    uint64_t rows_off;
+    uint64_t tiers_off;
+    uint64_t seats_off;
+    uint64_t seat_names_off; // uint32_t string offsets
+    uint64_t strings_off;
+    uint64_t strings_bytes;
+    uint64_t file_bytes;
+} tb_manifest_header_t;
+
+typedef struct
+{
+    uint32_t name;
+    uint32_t first_section;
+    uint32_t n_sections;
+    uint32_t first_tier;
+    uint32_t n_tiers;
+    uint32_t reserved;
+    uint64_t first_seat;
+    uint64_t n_seats;
+} tb_manifest_event_t;
+
+typedef struct
+{
+    uint32_t name;
+    uint32_t event;
+    uint32_t first_row;
+    uint32_t n_rows;
+} tb_manifest_section_t;
+
+typedef struct
+{
+    uint32_t name;
+    uint32_t section;
+    uint32_t n_seats;
+    uint32_t reserved;
+    uint64_t first_seat;
+} tb_manifest_row_t;
+
+typedef struct
+{
+    uint32_t name;
+    tb_money_cents_t price_cents;
+} tb_manifest_tier_t;
+
+typedef struct
+{
+    uint32_t name; // index into the seat name table
+    uint32_t tier; // index into the tier table, within the event's run
+} tb_manifest_seat_t;
+
+// An open manifest. The table pointers alias the mapping.
+typedef struct
+{
+    const void *base;
+    size_t bytes;
+    const tb_manifest_header_t *hdr;
+    const tb_manifest_event_t *events;
+    const tb_manifest_section_t *sections;
+    const tb_manifest_row_t *rows;
+    const tb_manifest_tier_t *tiers;
+    const tb_manifest_seat_t *seats;
+    const uint32_t *seat_names;
+    const char *strings;
+} tb_manifest_t;
+
+// Map and validate a manifest. Structure (ranges, nesting, names) is checked
+// here; per-seat name and tier references are checked as they load.
+// Returns false on I/O errors or a malformed file.
+bool tb_manifest_open(tb_manifest_t *mf, const char *path);
+
+// Unmap. Safe on a manifest that failed to open.
+void tb_manifest_close(tb_manifest_t *mf);
+
+// Name at a string offset of an event, section, row or tier.
+static inline const char *tb_manifest_name(const tb_manifest_t *mf, uint32_t off)
+{
+    return mf->strings + off;
+}
+
+// Seat id of seat s, or NULL if its name index is out of range.
+static inline const char *tb_manifest_seat_name(const tb_manifest_t *mf, uint64_t s)
+{
+    uint32_t ix = mf->seats[s].name;
+    return ix < mf->hdr->n_seat_names ? mf->strings + mf->seat_names[ix] : NULL;
+}
+
+// Load every event of the manifest into `m` using `threads` workers (0 picks
+// the online CPU count). Each event gets a region of its own, with its
+// sections and rows as the seating layout (seat_map_event_set_rows); events
+// already loaded in `m` are skipped. Seats with a bad name or tier, or a seat id
+// repeated within an event, are skipped. Returns the number of seats loaded.
+size_t tb_manifest_load(const tb_manifest_t *mf, seat_map_t *m, unsigned threads);
+
+// Convert CSV to a manifest. One seat per line:
+//
+//   event_id,section,row,seat_id,tier,price_cents
+//
+// An optional first line starting with "event_id" is a header. Seats may
+// arrive in any order; they are grouped by event, section and row in order
+// of first appearance. Returns false on I/O errors, names that are empty or
+// too long, a tier given two prices within an event, or a seat id repeated
+// within an event; *err_line (if non-NULL) then holds the 1-based offending
+// line, or 0 when no single line is at fault.
+bool tb_manifest_from_csv(const char *csv_path, const char *out_path, size_t *err_line);
+
+#ifdef __cplusplus
+}
+#endif
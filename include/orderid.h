@@ -0,0 +1,48 @@
+// Order id generator: unique across threads, processes and restarts, with
+// no shared write per id.
+//
+// An id is a 54-bit sequence number above a 10-bit node number. Threads
+// lease blocks of CONFIG_ORDERID_LEASE sequence numbers from one atomic
+// counter and hand them out locally, so the shared cache line is touched
+// once per block. The counter starts at the milliseconds since 2024-01-01
+// times 4096 when the process first needs an id, so a restarted process
+// begins past everything the previous one issued unless that one averaged
+// more than 4096 ids per millisecond. Processes that share an id space
+// must each be given their own node.
+//
+// The text form is "ORD-" plus 13 Crockford base-32 digits, fixed width,
+// so ids sort as text in the order they sort as numbers.
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TB_ORDERID_NODE_BITS 10
+#define TB_ORDERID_MAX_NODE  ((1u << TB_ORDERID_NODE_BITS) - 1)
+#define TB_ORDERID_STR_LEN   18 // "ORD-" + 13 digits + NUL
+
+// Set this process's node (0..TB_ORDERID_MAX_NODE, default 0). False when
+// out of range or once ids have been issued.
+bool tb_orderid_set_node(uint32_t node);
+
+uint64_t tb_orderid_next(void);
+
+// The node an id was issued on.
+static inline uint32_t tb_orderid_node(uint64_t id)
+{
+    return (uint32_t)(id & TB_ORDERID_MAX_NODE);
+}
+
+// Write the text form with its NUL; returns its length (17).
+size_t tb_orderid_format(uint64_t id, char out[TB_ORDERID_STR_LEN]);
+
+// Parse the text form (digits in either case). False if malformed.
+bool tb_orderid_parse(const char *s, uint64_t *out);
+
+#ifdef __cplusplus
+}
+#endif
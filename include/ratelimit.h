@@ -0,0 +1,41 @@
+// Token-bucket rate limiter keyed by a 64-bit id (e.g. a hashed user id).
+//
+// Each key gets a bucket of `burst` tokens that refills at `rate` tokens per
+// second, lazily: a check tops the bucket up for the time since the key was
+// last seen, then takes a token if there is one. Buckets live in a fixed
+// set-associative table, so memory is bounded by the capacity given at
+// creation; a new key evicts the least recently seen key of its set, which
+// then starts again from a full bucket (limits fail open, never closed).
+// Each set has its own spinlock, held for a few dozen instructions.
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct tb_ratelimit tb_ratelimit_t;
+
+// Room for about `max_keys` keys (rounded up to whole sets). NULL when out
+// of memory or rate/burst are 0.
+tb_ratelimit_t *tb_ratelimit_create(size_t max_keys, uint32_t rate_per_sec, uint32_t burst);
+void tb_ratelimit_destroy(tb_ratelimit_t *rl);
+
+// Change the limits; buckets keep their tokens, capped to the new burst.
+// Safe while checks run.
+void tb_ratelimit_set(tb_ratelimit_t *rl, uint32_t rate_per_sec, uint32_t burst);
+
+// Take one token of `key` at time now_ns (any monotonic clock, the same
+// for every call). False if the bucket is empty.
+bool tb_ratelimit_allow(tb_ratelimit_t *rl, uint64_t key, uint64_t now_ns);
+
+// Keys whose bucket was dropped to make room for another.
+uint64_t tb_ratelimit_evictions(const tb_ratelimit_t *rl);
+
+size_t tb_ratelimit_memory_bytes(const tb_ratelimit_t *rl);
+
+#ifdef __cplusplus
+}
+#endif
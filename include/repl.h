@@ -0,0 +1,74 @@
+// Primary/backup replication by log shipping: a hot standby process keeps
+// a copy of the primary's seat map, ready to take over.
+//
+// Primary: enables the change log (reservation_enable_change_log) and runs
+// one shipper thread that serves a standby on a Unix socket. A standby that
+// connects first gets a full copy of every event, then batches of the
+// seats that changed since, each tagged with the log position it brings the
+// standby up to. Shipping is state-based: a batch carries each changed
+// seat's current full record (token included), not the transitions, so it
+// coalesces a busy seat into one record, re-applies harmlessly, and a
+// standby that falls more than the log's capacity behind simply gets a
+// fresh full copy. Writers never wait for the standby.
+//
+// Standby: applies batches in order to its own seat map and hold index and
+// acks each one. Promotion stops applying and leaves a map that is ready
+// as is; the standby can then serve calls and start shipping to a standby
+// of its own. Orders live in the database (the DB stub is per process), and
+// seating layouts from manifests are not shipped: load the same manifest on
+// the standby before it connects and shipped events update it in place.
+// Batches are raw structs, so both processes must be the same build.
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    uint64_t head;     // changes logged so far
+    uint64_t shipped;  // log position the batches sent so far cover
+    uint64_t acked;    // log position the standby has applied
+    uint64_t batches;  // batches sent
+    uint64_t resyncs;  // full copies sent, one per connection plus one per lap
+    bool connected;
+} tb_repl_status_t;
+
+// ---- primary ----
+
+// Enable the change log with room for `log_capacity` changes (0 for the
+// default) and ship it to standbys connecting on `path`, one at a time.
+// Call after reservation_init. False if already started or the socket
+// cannot be set up.
+bool tb_repl_primary_start(const char *path, size_t log_capacity);
+
+// Stop shipping and drop the standby; the change log stays enabled.
+void tb_repl_primary_stop(void);
+
+// False if not started.
+bool tb_repl_primary_status(tb_repl_status_t *out);
+
+// ---- standby ----
+
+// Connect to the primary on `path` and apply what it ships, in a thread of
+// its own. Call after reservation_init, before serving any calls. False if
+// the primary cannot be reached or a standby is already running.
+bool tb_repl_standby_start(const char *path);
+
+// Log position applied so far (0 until the first full copy is in).
+uint64_t tb_repl_standby_applied(void);
+
+// False once the primary went away (or after promotion).
+bool tb_repl_standby_connected(void);
+
+// Stop applying and disconnect: this process now owns its seat map.
+// Returns the log position it holds. Takes as long as applying the batch in
+// progress.
+uint64_t tb_repl_promote(void);
+
+#ifdef __cplusplus
+}
+#endif
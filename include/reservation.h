@@ -6,6 +6,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "feed.h"
 #include "types.h" // seat_t, seat_status_t and TB_* sizes
 
 #ifdef __cplusplus
@@ -26,7 +27,9 @@ typedef enum {
     RES_INVALID_TOKEN,
     RES_HOLD_EXPIRED,
     RES_DB_ERROR,
-    RES_INTERNAL_ERR
+    RES_INTERNAL_ERR,
+    RES_HOLD_LIMIT,  // the user holds as many seats of the event as allowed
+    RES_RATE_LIMITED // the user called too often; nothing was looked up
 } res_code_t;
 
 // Lightweight seat view returned to callers (safe, read-only fields)
@@ -62,12 +65,327 @@ bool reservation_init(void);
 void reservation_shutdown(void);
 
 // Test/utility helpers
-// Insert or replace a seat in the in-memory map (used by tests/seed data).
+// Insert or replace a seat in the in-memory map (used by tests/seed data and
+// replicas). A live hold joins its user's hold index.
 bool reservation_put_seat(const seat_t *seat);
 
 // Adjust the default hold length (seconds). Useful for tests.
 void reservation_set_hold_length_seconds(tb_epoch_t seconds);
 
+// Holds per user
+// Every active hold is indexed by its user, so a user's holds in an event
+// are counted in O(1) and all of them released in O(holds).
+//
+// At most `per_user_per_event` active holds per user in one event, 0 for no
+// limit (CONFIG_HOLD_LIMIT_PER_EVENT by default). Placing one more fails
+// with RES_HOLD_LIMIT. Lapsed holds do not count; a hold whose seat was
+// deleted (or its event unloaded) counts until it would have lapsed.
+void reservation_set_hold_limit(size_t per_user_per_event);
+
+// Release every active hold of user_id in every event, e.g. on logout or a
+// fraud action. Holds mid-checkout are left to their confirm, and holds
+// placed while this runs may survive it. Returns the number released.
+size_t cancel_all_holds(const char *user_id);
+
+// Rate limits
+// Per-user token buckets checked before a call touches the seat map: a user
+// may make `burst` calls at once and `per_second` calls a second after
+// that. Over the limit, place_hold, cancel_hold and find_best_available
+// return RES_RATE_LIMITED. Memory is bounded (CONFIG_RATE_LIMIT_USERS users
+// per operation); a user forgotten to make room starts with a full bucket.
+typedef enum {
+    RES_OP_HOLD = 0,   // place_hold, place_hold_ix
+    RES_OP_CANCEL,     // cancel_hold, cancel_hold_ix
+    RES_OP_SEARCH,     // find_best_available, including its holds
+    RES_OP_GET,        // checked by callers, see reservation_admit
+    RES_OP_COUNT
+} res_op_t;
+
+// per_second 0 lifts the limit (burst 0 counts as 1). False if op is
+// unknown or out of memory. Limits are cleared by reservation_shutdown.
+bool reservation_set_rate_limit(res_op_t op, uint32_t per_second, uint32_t burst);
+
+// Take one call of `op` from user_id's bucket; false if over the limit (or
+// true if op is not limited). The calls above do this themselves; reads
+// carry no user id, so a front end serving seat_get or seat_get_many to a
+// known user checks RES_OP_GET here first.
+bool reservation_admit(const char *user_id, res_op_t op);
+
+// Event lifecycle
+// Load an event's seats into a region of their own. Seats whose event_id
+// differs from `event_id` are rejected. Seats may come held or sold (see
+// event_export); live holds join their user's hold index. Returns false if
+// any seat failed.
+bool event_load(const char *event_id, const seat_t *seats, size_t n);
+
+// Load every event of a binary venue manifest (manifest.h) using `threads`
+// workers, 0 for one per CPU. Events already loaded are skipped. Returns the
+// number of seats loaded, 0 if the file cannot be opened or is malformed.
+size_t reservation_load_manifest(const char *path, unsigned threads);
+
+// Drop an event and all its seats (and active holds) at once. The event must
+// not be in use by other threads. Returns false if it is not loaded.
+bool event_unload(const char *event_id);
+
+// Seating chart
+// Stream every seat of an event as one consistent point-in-time snapshot,
+// without seat locks and while holds and sales continue. At most a few
+// snapshots of an event may be open at once; begin returns NULL when the
+// event is not loaded or none is free. Always pair begin with end.
+typedef struct seat_snapshot seat_snapshot_t;
+
+seat_snapshot_t *event_snapshot_begin(const char *event_id);
+
+// Next seat of the snapshot; false once all seats were returned.
+bool event_snapshot_next(seat_snapshot_t *snap, seat_view_t *out);
+
+// Close the snapshot. Returns false if it could not be kept consistent
+// (out of memory); the views returned may then mix instants.
+bool event_snapshot_end(seat_snapshot_t *snap);
+
+// Event transfer
+// Hand every seat of an event to `emit` as full records, hold tokens and
+// sales included; event_load takes them back, e.g. on another instance.
+// Unlike a snapshot this is not one instant, so calls that change the
+// event must be held off meanwhile. Stops when emit returns false. Returns
+// false if the event is not loaded or emit stopped.
+typedef bool (*seat_emit_fn)(const seat_t *seat, void *ctx);
+bool event_export(const char *event_id, seat_emit_fn emit, void *ctx);
+
+// An open order, as it travels with its event to another instance.
+typedef struct {
+    char order_id[RES_ID_LEN];
+    char user_id[RES_ID_LEN];
+    char seat_id[RES_ID_LEN];
+    tb_money_cents_t price_cents;
+    uint32_t token_len;
+    tb_byte_t token[RES_TOKEN_LEN];
+} order_record_t;
+
+// Copy up to `max` open orders of an event to out; returns how many there
+// are in all. Like event_export, calls that change the event must be held
+// off meanwhile.
+size_t event_export_orders(const char *event_id, order_record_t *out, size_t max);
+
+// Take over orders exported by another instance, ids unchanged, so that
+// refunds and confirm retries find them here. Orders already present are
+// skipped. False (nothing imported) on failure.
+bool event_import_orders(const char *event_id, const order_record_t *orders, size_t n);
+
+// Forget the event's open orders once they were imported elsewhere;
+// nothing is refunded. Returns the number dropped.
+size_t event_drop_orders(const char *event_id);
+
+// Make the event hold exactly `seats` (full records, as from event_export):
+// in place when it already holds the same seats, keeping its seating layout,
+// otherwise by unloading and loading it afresh. Live holds join their user's
+// hold index. Used by replicas; returns false if any seat failed.
+bool event_replace(const char *event_id, const seat_t *seats, size_t n);
+
+// Full record of one seat by interned ids, hold token included. False if
+// the seat does not exist.
+bool seat_export_ix(uint32_t event_ix, uint32_t seat_ix, seat_t *out);
+
+// Seating chart cache
+// A ready-made, serialized chart of an event, shared by every reader until
+// a seat changes: acquiring one is a cache hit plus a reference count when
+// nothing moved, and otherwise patches just the seats that did (from the
+// change feed) before handing it out. Buffers are immutable once handed
+// out; release each one exactly once, also after shutdown.
+//
+// CHART_BINARY (integers little-endian):
+//   "TBC1", u32 seat count, then per seat: u8 status (seat_status_t),
+//   u8 id length, the id bytes, i32 price in cents
+// CHART_JSON:
+//   {"event":"E1","seats":[{"id":"A1","price":2500,"status":"A"},...]}
+//   with status one of "A" (available), "H" (held), "S" (sold) or
+//   "R" (refunded and off sale)
+//
+// Expired holds show as available when the chart is built, but a hold that
+// lapses later stays "held" until its expiry is published (the next writer
+// of the seat, or event_expire_holds). Seats added or deleted are picked up
+// when the event's seat count changes.
+typedef enum {
+    CHART_BINARY = 0,
+    CHART_JSON   = 1
+} chart_format_t;
+
+typedef struct {
+    const unsigned char *data; // data[len] is 0
+    size_t len;
+    uint64_t seq; // every feed change below this seq is in the chart
+} event_chart_t;
+
+// NULL if the event is not loaded or out of memory.
+const event_chart_t *event_chart_acquire(const char *event_id, chart_format_t format);
+void event_chart_release(const event_chart_t *chart);
+
+// Availability
+// Seats left in an event, or in one of its sections when `section` is
+// non-NULL (sections come from the venue manifest). Read from per-seat
+// availability bits rather than the seats, so it is not a snapshot, and a
+// hold that lapsed counts as taken until the seat is next touched.
+size_t event_available_count(const char *event_id, const char *section);
+
+#define RES_MAX_GROUP 64
+
+// One seat of a group held by find_best_available.
+typedef struct {
+    char seat_id[RES_ID_LEN];
+    hold_result_t hold;
+} group_seat_t;
+
+// Find `n` (1..RES_MAX_GROUP) adjacent available seats in one row of the
+// event, or of `section` if non-NULL, and hold them all for `user_id`. Rows
+// are tried in manifest order; within a row the block nearest its centre
+// wins. An event not loaded from a manifest is one row in load order.
+// Returns RES_OK with out[0..n) filled, RES_NOT_FOUND if the event or
+// section is unknown or no row has n seats together, RES_HELD_BY_OTHER if
+// other buyers kept taking the chosen seats first, RES_HOLD_LIMIT if the
+// group would take the user past the hold limit, or RES_INTERNAL_ERR if n
+// is out of range or hold slots ran out. Nothing stays held on failure.
+res_code_t find_best_available(const char *user_id,
+                               const char *event_id,
+                               const char *section,
+                               size_t n,
+                               group_seat_t *out);
+
+// Seats by price
+// Available seats come from a per-event price index (see hashtable.h)
+// built by an event's first price query and kept up to date by every hold,
+// cancel, confirm and refund after that, so a query touches the seats it
+// returns rather than scanning the event. As with event_available_count, a
+// hold that lapsed counts as taken until the seat is next touched.
+typedef struct {
+    char event_id[RES_ID_LEN];
+    char seat_id[RES_ID_LEN];
+    tb_money_cents_t price_cents;
+} priced_seat_t;
+
+// Up to `n` available seats of the event priced in [min_cents, max_cents],
+// cheapest first, ties in load order. Returns the number written to out.
+size_t event_cheapest_seats(const char *event_id, tb_money_cents_t min_cents,
+                            tb_money_cents_t max_cents, size_t n, priced_seat_t *out);
+
+// The same across several events (a tour): up to `n` seats in price order
+// over all of them, ties in the order the events are given. Events not
+// loaded are skipped.
+size_t tour_cheapest_seats(const char *const *event_ids, size_t n_events,
+                           tb_money_cents_t min_cents, tb_money_cents_t max_cents, size_t n,
+                           priced_seat_t *out);
+
+// Available seats of the event priced in [min_cents, max_cents].
+size_t event_available_in_price_range(const char *event_id, tb_money_cents_t min_cents,
+                                      tb_money_cents_t max_cents);
+
+// Inventory
+// Seats of an event by status, from counters that every hold, cancel,
+// confirm, refund and expiry keeps up to date: O(1) in the event's size and
+// taking no seat lock. Expiry is lazy, so a lapsed hold counts as held until
+// the seat is next touched or event_expire_holds sweeps it. While writers
+// run, a seat changing status may briefly be counted in neither or both.
+typedef struct {
+    size_t seats;
+    size_t available;
+    size_t held;
+    size_t sold;
+    size_t refunded;
+} event_inventory_t;
+
+// False if the event is not loaded.
+bool event_inventory(const char *event_id, event_inventory_t *out);
+
+// Release every lapsed hold of the event (holds mid-checkout are left
+// alone). Returns the number of seats made available again.
+size_t event_expire_holds(const char *event_id);
+
+// Event cancellation
+// Take every seat of the event off sale (SEAT_REFUNDED: holds are dropped,
+// checkouts in flight finish first, place_hold answers RES_NOT_FOUND) and
+// refund all its orders. `threads` workers (0 for one per CPU) each refund
+// CONFIG_REFUND_BATCH orders per database transaction, found through the
+// database's per-event order index. The database is the work list: orders
+// leave it as they are refunded, so calling again after a crash, a failure
+// or an early stop resumes with the orders left and refunds none twice.
+// `progress`, if not NULL, is called after every batch, from the workers
+// one at a time; returning false stops the run after the batches in flight.
+typedef struct {
+    size_t orders;   // open orders when this run started
+    size_t refunded; // by this run so far
+    size_t batches;
+} event_refund_progress_t;
+
+typedef bool (*event_refund_progress_fn)(const event_refund_progress_t *p, void *ctx);
+
+// True once the event has no open orders left; false if it is not loaded,
+// a batch failed or the run was stopped with orders left.
+bool event_cancel_and_refund(const char *event_id, unsigned threads,
+                             event_refund_progress_fn progress, void *ctx);
+
+// Check the inventory counters against a full walk of the event's seats.
+// Holds and sales of the event must be quiescent. False on a mismatch or if
+// the event is not loaded.
+bool event_inventory_verify(const char *event_id);
+
+// Change feed
+// Every hold, cancel, expiry, sale and refund is published to a feed of
+// seat changes (see feed.h); subscribe with tb_feed_subscribe on this feed
+// instead of polling seat_get. Valid between init and shutdown.
+tb_feed_t *reservation_feed(void);
+
+// Change log
+// A second feed for replication (repl.h): every change of the feed above,
+// plus TB_CHANGE_RELOADED for seats written by reservation_put_seat and,
+// with seat_ix 0, for events loaded, replaced or unloaded. Off until
+// enabled; the first call creates it with room for `capacity` changes and
+// later calls keep it. False when out of memory.
+bool reservation_enable_change_log(size_t capacity);
+// NULL until enabled.
+tb_feed_t *reservation_change_log(void);
+
+// Tiered storage
+// Events nobody has called on for a while are compacted into a segment file
+// (segment.h) and dropped from memory; the first call that needs one again
+// - seat_get, place_hold, a search, a chart, an inventory, a refund, a load
+// of more seats - reads it back in place before going on, so callers never
+// see the difference but for that call's latency. Events with live holds are
+// never evicted, which is why confirms and cancels need no fault. Segments
+// are a cache of this process's memory: they live in `dir` under names of
+// the process's own, and are deleted once read back or at shutdown.
+//
+// Turn tiering on (the first call; later calls just change the limits).
+// A sweep evicts every event idle for `idle_seconds` or more, and then, if
+// the seat map still takes more than `max_bytes` (0 for no limit), further
+// events least recently used first. `dir` must exist. False if it does not
+// or when out of memory.
+bool reservation_enable_tiering(const char *dir, size_t max_bytes, tb_epoch_t idle_seconds);
+
+// Evict what the limits call for; events in use at that moment are skipped.
+// Run it periodically. Snapshots (event_snapshot_begin) are not tracked as
+// use: sweep with an idle time longer than a snapshot stays open. Returns the
+// number of events evicted.
+size_t reservation_tier_sweep(void);
+
+// Evict one event now, whatever its idle time, waiting for calls in flight.
+// False if tiering is off, the event is not loaded, has live holds, or its
+// segment cannot be written. True if it was already evicted.
+bool event_evict(const char *event_id);
+
+// True while the event is evicted.
+bool event_is_cold(const char *event_id);
+
+typedef struct {
+    size_t map_bytes;       // seat_map_memory_bytes of the hot events
+    size_t cold_events;
+    uint64_t segment_bytes; // on disk, for the cold events
+    uint64_t evictions;
+    uint64_t faults;        // events read back
+    uint64_t fault_ns;      // total time spent reading them back
+} tier_stats_t;
+
+// False if tiering is off.
+bool reservation_tier_stats(tier_stats_t *out);
+
 // Core operations
 hold_result_t place_hold(const char *user_id,
                          const char *event_id,
@@ -88,6 +406,31 @@ bool seat_get(const char *event_id,
 res_code_t refund(const char *user_id,
                   const char *order_id);
 
+// seat_get for many seats of one event, e.g. a cart or a section of the map.
+// Lookups are batched so their memory misses overlap; reads are as in
+// seat_get. found[i] tells whether out[i] was filled (found may be NULL).
+// Returns the number of seats found.
+size_t seat_get_many(const char *event_id,
+                     const char *const *seat_ids,
+                     size_t n,
+                     seat_view_t *out,
+                     bool *found);
+
+// Integer-keyed variants. Callers that resolve names once with
+// tb_intern_lookup (intern.h) skip per-call string hashing; the string
+// functions above are thin wrappers over these.
+hold_result_t place_hold_ix(const char *user_id,
+                            uint32_t event_ix,
+                            uint32_t seat_ix);
+
+res_code_t cancel_hold_ix(const char *user_id,
+                          uint32_t event_ix,
+                          uint32_t seat_ix);
+
+bool seat_get_ix(uint32_t event_ix,
+                 uint32_t seat_ix,
+                 seat_view_t *out);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,99 @@
+// Per-seat lock primitive used by the seat map.
+//
+// The default build embeds a pthread_mutex_t in every bucket. Building with
+// CONFIG_SEATMAP_FUTEX_LOCK=1 (`make SEAT_LOCK=futex`) swaps in a 4-byte futex
+// word on Linux: no init/destroy calls, and 36 fewer bytes per seat.
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef CONFIG_SEATMAP_FUTEX_LOCK
+#define CONFIG_SEATMAP_FUTEX_LOCK 0
+#endif
+
+#if CONFIG_SEATMAP_FUTEX_LOCK && defined(__linux__)
+#define TB_SEAT_LOCK_FUTEX 1
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#define TB_SEAT_LOCK_FUTEX 0
+#include <pthread.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if TB_SEAT_LOCK_FUTEX
+
+// 0 = unlocked, 1 = locked, 2 = locked with (possible) waiters.
+typedef struct {
+    uint32_t word;
+} tb_seat_lock_t;
+
+static inline void tb_seat_lock_init(tb_seat_lock_t *l)
+{
+    __atomic_store_n(&l->word, 0u, __ATOMIC_RELAXED);
+}
+
+static inline void tb_seat_lock_destroy(tb_seat_lock_t *l)
+{
+    (void)l;
+}
+
+static inline bool tb_seat_lock_acquire(tb_seat_lock_t *l)
+{
+    uint32_t c = 0;
+    if (__atomic_compare_exchange_n(&l->word, &c, 1u, false,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return true;
+
+    // Contended: advertise a waiter and sleep until the holder hands off.
+    if (c != 2)
+        c = __atomic_exchange_n(&l->word, 2u, __ATOMIC_ACQUIRE);
+    while (c != 0)
+    {
+        syscall(SYS_futex, &l->word, FUTEX_WAIT_PRIVATE, 2u, NULL, NULL, 0);
+        c = __atomic_exchange_n(&l->word, 2u, __ATOMIC_ACQUIRE);
+    }
+    return true;
+}
+
+static inline void tb_seat_lock_release(tb_seat_lock_t *l)
+{
+    if (__atomic_exchange_n(&l->word, 0u, __ATOMIC_RELEASE) == 2)
+        syscall(SYS_futex, &l->word, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+#else
+
+typedef struct {
+    pthread_mutex_t mtx;
+} tb_seat_lock_t;
+
+static inline void tb_seat_lock_init(tb_seat_lock_t *l)
+{
+    pthread_mutex_init(&l->mtx, NULL);
+}
+
+static inline void tb_seat_lock_destroy(tb_seat_lock_t *l)
+{
+    pthread_mutex_destroy(&l->mtx);
+}
+
+static inline bool tb_seat_lock_acquire(tb_seat_lock_t *l)
+{
+    return pthread_mutex_lock(&l->mtx) == 0;
+}
+
+static inline void tb_seat_lock_release(tb_seat_lock_t *l)
+{
+    pthread_mutex_unlock(&l->mtx);
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
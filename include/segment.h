@@ -0,0 +1,108 @@
+// Event segments: one event's seats compacted into a file, for events that
+// are evicted from memory (see reservation_enable_tiering) and read back
+// whole when next needed.
+//
+// Layout, after the 8-byte magic (integers are LEB128 varints, signed ones
+// zigzag-coded):
+//
+//   event id | records | seats | base updated | rows | records... | checksum
+//
+// One record per position of the event's region, in position order, so an
+// event read back keeps its positions and seating layout. Each record is a
+// flags byte (status, present, and which optional fields follow); a present
+// seat then has its id front-coded against the previous seat's id and its
+// price as a delta from the previous price. The order id, a hold, and an
+// update time other than the segment's base time are stored only when the
+// seat has them. A freshly loaded seat costs about 4 bytes against 80 or
+// more in the seat map. The checksum is tb_hash_bytes of everything before
+// it, little-endian. Row section ids are interned ids (intern.h), so a
+// segment is only meaningful to the process that wrote it.
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "types.h"
+#include "hashtable.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TB_SEGMENT_MAGIC "TBSEG01"
+
+// A segment being built in memory.
+typedef struct
+{
+    unsigned char *buf;
+    size_t len, cap;
+    size_t records;  // announced by begin
+    size_t added;    // records added so far
+    size_t seats;    // present records added so far
+    size_t seats_at; // offset of the seat count, written by finish
+    tb_epoch_t base_updated;
+    tb_money_cents_t prev_price;
+    char prev_id[TB_ID_LEN];
+    bool failed; // out of memory
+} tb_segment_writer_t;
+
+// Start a segment of `records` positions, with the event's seating layout.
+// Seats updated at `base_updated` store no update time. False when out of
+// memory.
+bool tb_segment_begin(tb_segment_writer_t *w, const char *event_id, size_t records,
+                      tb_epoch_t base_updated, const seat_row_t *rows, size_t n_rows);
+
+// Append the record at the next position; NULL for an unused one.
+void tb_segment_add(tb_segment_writer_t *w, const seat_t *seat);
+
+// Write the segment to `path` (through a temporary file renamed into place)
+// and free the writer. False on I/O errors, out of memory, or a record count
+// other than announced; nothing is left at `path` then. *bytes (if non-NULL)
+// receives the file size.
+bool tb_segment_finish(tb_segment_writer_t *w, const char *path, size_t *bytes);
+
+// Free a writer without writing anything.
+void tb_segment_discard(tb_segment_writer_t *w);
+
+// A segment read back, decoded one record at a time.
+typedef struct
+{
+    unsigned char *data;
+    size_t len;
+    size_t body; // offset of the first record
+    size_t pos;
+    char event_id[TB_ID_LEN];
+    size_t records;
+    size_t seats; // present records
+    tb_epoch_t base_updated;
+    seat_row_t *rows;
+    size_t n_rows;
+    size_t next; // records decoded so far
+    tb_money_cents_t prev_price;
+    char prev_id[TB_ID_LEN];
+} tb_segment_t;
+
+// Read and check a segment file. False on I/O errors, a bad checksum or a
+// malformed header.
+bool tb_segment_open(tb_segment_t *s, const char *path);
+
+// Decode the next record into *out (zeroed first, event_id filled in).
+// *present tells whether the position holds a seat. Returns false after the
+// last record or on a malformed one; tb_segment_done tells which.
+bool tb_segment_next(tb_segment_t *s, seat_t *out, bool *present);
+
+// True once every record was decoded.
+static inline bool tb_segment_done(const tb_segment_t *s)
+{
+    return s->next == s->records;
+}
+
+// Back to the first record.
+void tb_segment_rewind(tb_segment_t *s);
+
+// Free. Safe on a segment that failed to open.
+void tb_segment_close(tb_segment_t *s);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,61 @@
+// Fixed-size object allocator for small, high-churn records (order rows,
+// transactions).
+//
+// Objects are carved from large chunks and recycled through per-thread free
+// lists; threads trade objects with a shared list in batches, so the slab
+// mutex is taken once per TB_SLAB_BATCH operations. Destroying a slab frees
+// every chunk at once, including objects never returned.
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef TB_SLAB_BATCH
+#define TB_SLAB_BATCH 32 // objects moved between a thread and the shared list
+#endif
+
+#ifndef TB_SLAB_MAX_CACHED
+#define TB_SLAB_MAX_CACHED 64 // live slabs that get per-thread caches
+#endif
+
+typedef struct tb_slab_chunk tb_slab_chunk_t;
+
+typedef struct tb_slab
+{
+    pthread_mutex_t mtx;
+    size_t obj_size;         // rounded up to 16 bytes
+    size_t chunk_objs;       // objects per chunk
+    tb_slab_chunk_t *chunks; // every chunk, for bulk release
+    char *carve;             // unused tail of the newest chunk
+    char *carve_end;
+    void *free_head;         // shared free list, linked through the first word
+    size_t reserved_bytes;   // chunk memory obtained from the system
+    uint32_t reg;            // thread-cache registry slot + 1; 0 = uncached
+    uint64_t serial;         // identifies this slab to thread caches
+} tb_slab_t;
+
+// Prepare a slab for objects of `obj_size` bytes, allocated `objs_per_chunk`
+// at a time (0 picks a default). Returns false on bad arguments.
+bool tb_slab_init(tb_slab_t *s, size_t obj_size, size_t objs_per_chunk);
+
+// Release every chunk. Objects still handed out become invalid; other
+// threads must not use the slab concurrently.
+void tb_slab_destroy(tb_slab_t *s);
+
+// Zero-filled object, or NULL when out of memory.
+void *tb_slab_alloc(tb_slab_t *s);
+
+// Return an object to the slab it came from. NULL is ignored.
+void tb_slab_free(tb_slab_t *s, void *obj);
+
+// Bytes of chunk memory the slab holds.
+size_t tb_slab_reserved_bytes(tb_slab_t *s);
+
+#ifdef __cplusplus
+}
+#endif
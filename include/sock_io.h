@@ -0,0 +1,89 @@
+// Blocking Unix stream socket helpers shared by the cluster and replication
+// code: whole-buffer send/recv and connecting to or listening on a path.
+#pragma once
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static inline bool tb_send_all(int fd, const void *buf, size_t len)
+{
+    const char *p = (const char *)buf;
+    while (len > 0)
+    {
+        ssize_t k = send(fd, p, len, MSG_NOSIGNAL);
+        if (k < 0 && errno == EINTR)
+            continue;
+        if (k <= 0)
+            return false;
+        p += k;
+        len -= (size_t)k;
+    }
+    return true;
+}
+
+// False on EOF or error, including EOF part-way.
+static inline bool tb_recv_all(int fd, void *buf, size_t len)
+{
+    char *p = (char *)buf;
+    while (len > 0)
+    {
+        ssize_t k = recv(fd, p, len, 0);
+        if (k < 0 && errno == EINTR)
+            continue;
+        if (k <= 0)
+            return false;
+        p += k;
+        len -= (size_t)k;
+    }
+    return true;
+}
+
+// False if the path does not fit.
+static inline bool tb_unix_addr(const char *path, struct sockaddr_un *a)
+{
+    memset(a, 0, sizeof *a);
+    a->sun_family = AF_UNIX;
+    if (!path || strlen(path) >= sizeof a->sun_path)
+        return false;
+    memcpy(a->sun_path, path, strlen(path) + 1);
+    return true;
+}
+
+// Connected socket, or -1.
+static inline int tb_unix_dial(const char *path)
+{
+    struct sockaddr_un a;
+    if (!tb_unix_addr(path, &a))
+        return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    if (connect(fd, (struct sockaddr *)&a, sizeof a) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Listening socket on path (replacing a stale one), or -1.
+static inline int tb_unix_listen(const char *path)
+{
+    struct sockaddr_un a;
+    if (!tb_unix_addr(path, &a))
+        return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&a, sizeof a) != 0 || listen(fd, 128) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
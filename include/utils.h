@@ -1,5 +1,7 @@
-// Utility helpers with RISC-V optimized paths and portable fallbacks
+// Utility helpers with SIMD (x86-64 SSE4.1/AVX2, RISC-V Vector) kernels and
+// portable fallbacks, dispatched at runtime.
 #pragma once
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -8,14 +10,41 @@ extern "C" {
 #endif
 
 // Compare up to 32 bytes quickly; returns 0 if equal, non-zero otherwise.
+// Constant-time in the contents (not the length).
 int tb_memcmp_token32(const void *a, const void *b, size_t n);
 
+// Keyed 64-bit hash of `len` bytes, consumed 32 bytes per step. Every
+// variant returns the same value.
+uint64_t tb_hash_bytes(const void *data, size_t len, uint64_t seed);
+
 // Fast 64-bit hash for (event_id, seat_id) pair.
 uint64_t tb_hash_key_fast(const char *event_id, const char *seat_id);
 
+// Fast 64-bit hash of a single NUL-terminated identifier (interning).
+uint64_t tb_hash_name_fast(const char *name);
+
+// Number of set bits in `n` 64-bit words.
+size_t tb_popcount_words(const uint64_t *words, size_t n);
+
 // Fill buffer with random bytes using best available source on this platform.
 void tb_random_bytes_fast(unsigned char *out, size_t n);
 
+// ---- CPU dispatch ----
+//
+// The kernels above bind on first use to the best variant this CPU supports:
+// "scalar", then "sse4" and "avx2" on x86-64, or "rvv" on RISC-V with V.
+// Build with -DCONFIG_TB_UTILS_SIMD=0 to compile the scalar variant only.
+
+// Name of the active variant.
+const char *tb_utils_variant(void);
+
+// Name of the i-th compiled-in variant, or NULL past the end.
+const char *tb_utils_variant_name(size_t i);
+
+// Force a variant (tests, benchmarks). Returns false if it is unknown or
+// this CPU lacks the instructions.
+bool tb_utils_select(const char *name);
+
 #ifdef __cplusplus
 }
 #endif
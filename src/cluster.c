@@ -0,0 +1,888 @@
+// Event-partitioned cluster (see cluster.h).
+//
+// A router keeps, per node, a few socket connections each behind a mutex;
+// a call borrows one for a single request/response. Events loaded through
+// the router sit in an insert-only registry whose entries record the owner
+// and a rwlock: calls hold it shared while they run on the owner, a move
+// holds it exclusive. Joins and leaves are serialized by topo_mtx, and the
+// ring itself is guarded by ring_lock, which lookups hold only briefly.
+
+#include "cluster.h"
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "orderid.h"
+#include "sock_io.h"
+#include "utils.h"
+
+#ifndef CONFIG_RING_VNODES
+#define CONFIG_RING_VNODES 128
+#endif
+
+#ifndef CONFIG_ROUTER_CONNS
+#define CONFIG_ROUTER_CONNS 8 // sockets per node
+#endif
+
+#ifndef CONFIG_ROUTER_EVENT_BUCKETS
+#define CONFIG_ROUTER_EVENT_BUCKETS 4096
+#endif
+
+#define RING_SEED 0x7462636c75737472ull // fixed: owners agree across processes
+#define NODE_SLOTS (TB_ORDERID_MAX_NODE + 1)
+
+// ---- ring ----
+
+typedef struct
+{
+    uint64_t point;
+    uint32_t node;
+} ring_point_t;
+
+struct tb_ring
+{
+    ring_point_t *points; // sorted by point
+    size_t n;
+};
+
+static uint64_t event_hash(const char *event_id)
+{
+    return tb_hash_bytes(event_id, strnlen(event_id, TB_ID_LEN), RING_SEED);
+}
+
+static int cmp_point(const void *a, const void *b)
+{
+    const ring_point_t *x = a, *y = b;
+    if (x->point != y->point)
+        return x->point < y->point ? -1 : 1;
+    return (x->node > y->node) - (x->node < y->node);
+}
+
+tb_ring_t *tb_ring_create(void)
+{
+    return calloc(1, sizeof(tb_ring_t));
+}
+
+void tb_ring_destroy(tb_ring_t *ring)
+{
+    if (!ring)
+        return;
+    free(ring->points);
+    free(ring);
+}
+
+static bool ring_has(const tb_ring_t *ring, uint32_t node)
+{
+    for (size_t i = 0; i < ring->n; ++i)
+        if (ring->points[i].node == node)
+            return true;
+    return false;
+}
+
+bool tb_ring_add(tb_ring_t *ring, uint32_t node)
+{
+    if (!ring || node == TB_NODE_NONE || ring_has(ring, node))
+        return false;
+    ring_point_t *p = realloc(ring->points, (ring->n + CONFIG_RING_VNODES) * sizeof *p);
+    if (!p)
+        return false;
+    for (uint64_t v = 0; v < CONFIG_RING_VNODES; ++v)
+    {
+        uint64_t id = (uint64_t)node << 32 | v;
+        p[ring->n + v] = (ring_point_t){tb_hash_bytes(&id, sizeof id, RING_SEED), node};
+    }
+    ring->points = p;
+    ring->n += CONFIG_RING_VNODES;
+    qsort(ring->points, ring->n, sizeof *p, cmp_point);
+    return true;
+}
+
+bool tb_ring_remove(tb_ring_t *ring, uint32_t node)
+{
+    if (!ring)
+        return false;
+    size_t kept = 0;
+    for (size_t i = 0; i < ring->n; ++i)
+        if (ring->points[i].node != node)
+            ring->points[kept++] = ring->points[i];
+    bool found = kept != ring->n;
+    ring->n = kept;
+    return found;
+}
+
+size_t tb_ring_nodes(const tb_ring_t *ring)
+{
+    return ring ? ring->n / CONFIG_RING_VNODES : 0;
+}
+
+uint32_t tb_ring_owner(const tb_ring_t *ring, const char *event_id)
+{
+    if (!ring || ring->n == 0 || !event_id)
+        return TB_NODE_NONE;
+    uint64_t h = event_hash(event_id);
+    size_t lo = 0, hi = ring->n; // first point >= h, wrapping to 0
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (ring->points[mid].point < h)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return ring->points[lo == ring->n ? 0 : lo].node;
+}
+
+// ---- wire ----
+
+typedef enum
+{
+    OP_PING = 1,
+    OP_HOLD,
+    OP_CONFIRM,
+    OP_CANCEL,
+    OP_GET,
+    OP_REFUND,
+    OP_LOAD,   // followed by n seat_t
+    OP_EXPORT, // answered by n seat_t
+    OP_UNLOAD,
+    OP_STOP,
+    OP_EXPORT_ORDERS, // answered by n order_record_t
+    OP_IMPORT_ORDERS, // followed by n order_record_t
+    OP_DROP_ORDERS,
+} wire_op_t;
+
+typedef struct
+{
+    uint32_t op;
+    uint32_t n;
+    int32_t amount;
+    uint32_t token_len;
+    char user_id[TB_ID_LEN];
+    char event_id[TB_ID_LEN];
+    char seat_id[TB_ID_LEN]; // the order id for OP_REFUND
+    tb_byte_t token[TB_TOKEN_LEN];
+} wire_req_t;
+
+typedef struct
+{
+    int32_t code; // res_code_t
+    uint32_t n;
+    union
+    {
+        hold_result_t hold;
+        confirm_result_t confirm;
+        seat_view_t view;
+    } u;
+} wire_resp_t;
+
+static void copy_id(char dst[TB_ID_LEN], const char *src)
+{
+    memset(dst, 0, TB_ID_LEN);
+    if (src)
+        strncpy(dst, src, TB_ID_LEN - 1);
+}
+
+// Size of the records that follow a request or response of this op.
+static size_t wire_item_size(uint32_t op)
+{
+    return op == OP_EXPORT_ORDERS || op == OP_IMPORT_ORDERS ? sizeof(order_record_t) : sizeof(seat_t);
+}
+
+// ---- node ----
+
+typedef struct
+{
+    pthread_mutex_t mtx;
+    pthread_cond_t idle;
+    int listen_fd;
+    bool stopping;
+    size_t n_conns;
+    int *conns; // open connection fds, for shutdown on stop
+    size_t cap;
+} node_server_t;
+
+typedef struct
+{
+    node_server_t *srv;
+    int fd;
+} node_conn_arg_t;
+
+typedef struct
+{
+    seat_t *seats;
+    size_t n, cap;
+} seat_buf_t;
+
+static bool collect_seat(const seat_t *seat, void *ctx)
+{
+    seat_buf_t *b = ctx;
+    if (b->n == b->cap)
+    {
+        size_t cap = b->cap ? b->cap * 2 : 1024;
+        seat_t *s = realloc(b->seats, cap * sizeof *s);
+        if (!s)
+            return false;
+        b->seats = s;
+        b->cap = cap;
+    }
+    b->seats[b->n++] = *seat;
+    return true;
+}
+
+static void node_stop_locked(node_server_t *srv)
+{
+    srv->stopping = true;
+    shutdown(srv->listen_fd, SHUT_RDWR); // wakes accept
+    for (size_t i = 0; i < srv->n_conns; ++i)
+        shutdown(srv->conns[i], SHUT_RDWR);
+}
+
+// Run one request; false when the connection should close.
+static bool node_handle(node_server_t *srv, int fd, wire_req_t *q)
+{
+    q->user_id[TB_ID_LEN - 1] = q->event_id[TB_ID_LEN - 1] = q->seat_id[TB_ID_LEN - 1] = '\0';
+    wire_resp_t a;
+    memset(&a, 0, sizeof a);
+    seat_buf_t buf = {0};
+    order_record_t *orders = NULL;
+    size_t n_orders;
+    switch (q->op)
+    {
+    case OP_PING:
+        a.code = RES_OK;
+        break;
+    case OP_HOLD:
+        a.u.hold = place_hold(q->user_id, q->event_id, q->seat_id);
+        a.code = a.u.hold.code;
+        break;
+    case OP_CONFIRM:
+        a.u.confirm = confirm_reservation(q->token, q->token_len > TB_TOKEN_LEN ? TB_TOKEN_LEN : q->token_len,
+                                          q->amount);
+        a.code = a.u.confirm.code;
+        break;
+    case OP_CANCEL:
+        a.code = cancel_hold(q->user_id, q->event_id, q->seat_id);
+        break;
+    case OP_GET:
+        a.code = seat_get(q->event_id, q->seat_id, &a.u.view) ? RES_OK : RES_NOT_FOUND;
+        break;
+    case OP_REFUND:
+        a.code = refund(q->user_id, q->seat_id);
+        break;
+    case OP_LOAD:
+        buf.seats = malloc((q->n ? q->n : 1) * sizeof(seat_t));
+        if (!buf.seats || !tb_recv_all(fd, buf.seats, q->n * sizeof(seat_t)))
+        {
+            free(buf.seats);
+            return false;
+        }
+        a.code = event_load(q->event_id, buf.seats, q->n) ? RES_OK : RES_INTERNAL_ERR;
+        break;
+    case OP_EXPORT:
+        a.code = event_export(q->event_id, collect_seat, &buf) ? RES_OK : RES_NOT_FOUND;
+        a.n = a.code == RES_OK ? (uint32_t)buf.n : 0;
+        break;
+    case OP_UNLOAD:
+        a.code = event_unload(q->event_id) ? RES_OK : RES_NOT_FOUND;
+        break;
+    case OP_STOP:
+        a.code = RES_OK;
+        break;
+    case OP_EXPORT_ORDERS:
+        n_orders = event_export_orders(q->event_id, NULL, 0);
+        orders = malloc((n_orders ? n_orders : 1) * sizeof *orders);
+        a.code = orders ? RES_OK : RES_INTERNAL_ERR;
+        if (orders)
+            a.n = (uint32_t)event_export_orders(q->event_id, orders, n_orders);
+        if (a.n > n_orders) // the total: only n_orders were copied
+            a.n = (uint32_t)n_orders;
+        break;
+    case OP_IMPORT_ORDERS:
+        orders = malloc((q->n ? q->n : 1) * sizeof *orders);
+        if (!orders || !tb_recv_all(fd, orders, q->n * sizeof *orders))
+        {
+            free(orders);
+            return false;
+        }
+        a.code = event_import_orders(q->event_id, orders, q->n) ? RES_OK : RES_INTERNAL_ERR;
+        free(orders);
+        orders = NULL;
+        break;
+    case OP_DROP_ORDERS:
+        event_drop_orders(q->event_id);
+        a.code = RES_OK;
+        break;
+    default:
+        return false;
+    }
+    const void *items = orders ? (const void *)orders : (const void *)buf.seats;
+    bool ok = tb_send_all(fd, &a, sizeof a) &&
+              (a.n == 0 || tb_send_all(fd, items, a.n * wire_item_size(q->op)));
+    free(buf.seats);
+    free(orders);
+    if (q->op == OP_STOP)
+    {
+        pthread_mutex_lock(&srv->mtx);
+        node_stop_locked(srv);
+        pthread_mutex_unlock(&srv->mtx);
+    }
+    return ok;
+}
+
+static void *node_conn_main(void *p)
+{
+    node_conn_arg_t arg = *(node_conn_arg_t *)p;
+    free(p);
+    wire_req_t q;
+    while (tb_recv_all(arg.fd, &q, sizeof q) && node_handle(arg.srv, arg.fd, &q))
+        ;
+    node_server_t *srv = arg.srv;
+    pthread_mutex_lock(&srv->mtx);
+    for (size_t i = 0; i < srv->n_conns; ++i)
+        if (srv->conns[i] == arg.fd)
+        {
+            srv->conns[i] = srv->conns[--srv->n_conns];
+            break;
+        }
+    close(arg.fd);
+    if (srv->n_conns == 0)
+        pthread_cond_broadcast(&srv->idle);
+    pthread_mutex_unlock(&srv->mtx);
+    return NULL;
+}
+
+// Track fd and start its thread; false (fd closed) when stopping or out of
+// memory.
+static bool node_add_conn(node_server_t *srv, int fd)
+{
+    node_conn_arg_t *arg = malloc(sizeof *arg);
+    pthread_mutex_lock(&srv->mtx);
+    bool ok = arg && !srv->stopping;
+    if (ok && srv->n_conns == srv->cap)
+    {
+        size_t cap = srv->cap ? srv->cap * 2 : 16;
+        int *c = realloc(srv->conns, cap * sizeof *c);
+        ok = c != NULL;
+        if (ok)
+        {
+            srv->conns = c;
+            srv->cap = cap;
+        }
+    }
+    pthread_t th;
+    if (ok)
+    {
+        *arg = (node_conn_arg_t){srv, fd};
+        ok = pthread_create(&th, NULL, node_conn_main, arg) == 0;
+    }
+    if (ok)
+    {
+        srv->conns[srv->n_conns++] = fd;
+        pthread_detach(th);
+    }
+    pthread_mutex_unlock(&srv->mtx);
+    if (!ok)
+    {
+        free(arg);
+        close(fd);
+    }
+    return ok;
+}
+
+bool tb_node_serve(const char *path)
+{
+    node_server_t srv = {.mtx = PTHREAD_MUTEX_INITIALIZER, .idle = PTHREAD_COND_INITIALIZER};
+    srv.listen_fd = tb_unix_listen(path);
+    if (srv.listen_fd < 0)
+        return false;
+    for (;;)
+    {
+        int fd = accept(srv.listen_fd, NULL, NULL);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            break; // stopped (or the socket failed)
+        }
+        node_add_conn(&srv, fd);
+    }
+    pthread_mutex_lock(&srv.mtx);
+    node_stop_locked(&srv);
+    while (srv.n_conns > 0)
+        pthread_cond_wait(&srv.idle, &srv.mtx);
+    pthread_mutex_unlock(&srv.mtx);
+    close(srv.listen_fd);
+    unlink(path);
+    free(srv.conns);
+    return true;
+}
+
+pid_t tb_node_spawn(const char *path, uint32_t node)
+{
+    struct sockaddr_un a;
+    if (!tb_unix_addr(path, &a) || node > TB_ORDERID_MAX_NODE)
+        return -1;
+    unlink(path);
+    pid_t pid = fork();
+    if (pid < 0)
+        return -1;
+    if (pid == 0)
+    {
+        prctl(PR_SET_PDEATHSIG, SIGKILL); // never outlive the spawner
+        bool ok = tb_orderid_set_node(node) && reservation_init() && tb_node_serve(path);
+        reservation_shutdown();
+        _exit(ok ? 0 : 1);
+    }
+    // Wait for the socket, up to 5 s.
+    for (int i = 0; i < 500; ++i)
+    {
+        int fd = tb_unix_dial(path);
+        if (fd >= 0)
+        {
+            close(fd);
+            return pid;
+        }
+        if (waitpid(pid, NULL, WNOHANG) == pid)
+            return -1;
+        nanosleep(&(struct timespec){0, 10000000}, NULL);
+    }
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+    return -1;
+}
+
+bool tb_node_stop(const char *path)
+{
+    int fd = tb_unix_dial(path);
+    if (fd < 0)
+        return false;
+    wire_req_t q = {.op = OP_STOP};
+    wire_resp_t a;
+    bool ok = tb_send_all(fd, &q, sizeof q) && tb_recv_all(fd, &a, sizeof a);
+    close(fd);
+    return ok;
+}
+
+// ---- router ----
+
+typedef struct
+{
+    pthread_mutex_t mtx;
+    int fd; // -1 until dialled, or after an I/O error
+} router_conn_t;
+
+typedef struct
+{
+    char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+    bool member;
+    router_conn_t conns[CONFIG_ROUTER_CONNS];
+} router_node_t;
+
+typedef struct router_event
+{
+    char event_id[TB_ID_LEN];
+    uint64_t hash;
+    uint32_t owner;
+    pthread_rwlock_t move; // shared by calls, exclusive while moving
+    struct router_event *next;
+} router_event_t;
+
+struct tb_router
+{
+    pthread_mutex_t topo_mtx; // joins, leaves and loads
+    pthread_rwlock_t ring_lock;
+    tb_ring_t *ring;
+    router_node_t *nodes[NODE_SLOTS]; // by node id, kept until destroy
+    router_event_t *events[CONFIG_ROUTER_EVENT_BUCKETS];
+    size_t moves;
+};
+
+static __thread uint32_t t_conn_pick; // 1-based, 0 = unassigned
+static uint32_t g_conn_next;
+
+tb_router_t *tb_router_create(void)
+{
+    tb_router_t *r = calloc(1, sizeof *r);
+    if (!r || !(r->ring = tb_ring_create()))
+    {
+        free(r);
+        return NULL;
+    }
+    pthread_mutex_init(&r->topo_mtx, NULL);
+    pthread_rwlock_init(&r->ring_lock, NULL);
+    return r;
+}
+
+void tb_router_destroy(tb_router_t *r)
+{
+    if (!r)
+        return;
+    for (size_t i = 0; i < NODE_SLOTS; ++i)
+    {
+        router_node_t *n = r->nodes[i];
+        for (size_t c = 0; n && c < CONFIG_ROUTER_CONNS; ++c)
+        {
+            if (n->conns[c].fd >= 0)
+                close(n->conns[c].fd);
+            pthread_mutex_destroy(&n->conns[c].mtx);
+        }
+        free(n);
+    }
+    for (size_t b = 0; b < CONFIG_ROUTER_EVENT_BUCKETS; ++b)
+        for (router_event_t *e = r->events[b], *next; e; e = next)
+        {
+            next = e->next;
+            pthread_rwlock_destroy(&e->move);
+            free(e);
+        }
+    tb_ring_destroy(r->ring);
+    pthread_rwlock_destroy(&r->ring_lock);
+    pthread_mutex_destroy(&r->topo_mtx);
+    free(r);
+}
+
+// One request/response on node `node`; `items_out` receives the n records
+// of an export, `items_in` are sent after a load or import (seat_t or
+// order_record_t, by op). False on I/O errors or when the node is not a
+// member.
+static bool router_call(tb_router_t *r, uint32_t node, const wire_req_t *q, const void *items_in,
+                        wire_resp_t *a, void **items_out)
+{
+    router_node_t *n = node < NODE_SLOTS ? r->nodes[node] : NULL;
+    if (!n || !__atomic_load_n(&n->member, __ATOMIC_ACQUIRE))
+        return false;
+    if (t_conn_pick == 0)
+        t_conn_pick = __atomic_add_fetch(&g_conn_next, 1, __ATOMIC_RELAXED);
+    router_conn_t *c = &n->conns[t_conn_pick % CONFIG_ROUTER_CONNS];
+    pthread_mutex_lock(&c->mtx);
+    if (c->fd < 0)
+        c->fd = tb_unix_dial(n->path);
+    size_t item = wire_item_size(q->op);
+    bool sends = q->op == OP_LOAD || q->op == OP_IMPORT_ORDERS;
+    bool ok = c->fd >= 0 && tb_send_all(c->fd, q, sizeof *q) &&
+              (!sends || q->n == 0 || tb_send_all(c->fd, items_in, q->n * item)) &&
+              tb_recv_all(c->fd, a, sizeof *a);
+    if (ok && a->n > 0)
+    {
+        void *s = malloc(a->n * item);
+        ok = s && tb_recv_all(c->fd, s, a->n * item);
+        if (ok && items_out)
+            *items_out = s;
+        else
+            free(s);
+    }
+    if (!ok && c->fd >= 0)
+    {
+        close(c->fd); // the stream may be mid-frame: start over next time
+        c->fd = -1;
+    }
+    pthread_mutex_unlock(&c->mtx);
+    return ok;
+}
+
+static router_event_t *event_find(tb_router_t *r, const char *event_id, uint64_t h)
+{
+    router_event_t *e =
+        __atomic_load_n(&r->events[h & (CONFIG_ROUTER_EVENT_BUCKETS - 1)], __ATOMIC_ACQUIRE);
+    for (; e; e = e->next)
+        if (e->hash == h && strncmp(e->event_id, event_id, TB_ID_LEN) == 0)
+            return e;
+    return NULL;
+}
+
+static uint32_t ring_owner(tb_router_t *r, const char *event_id)
+{
+    pthread_rwlock_rdlock(&r->ring_lock);
+    uint32_t owner = tb_ring_owner(r->ring, event_id);
+    pthread_rwlock_unlock(&r->ring_lock);
+    return owner;
+}
+
+// Run q on the event's owner, holding a registered event still meanwhile.
+static bool route(tb_router_t *r, const char *event_id, wire_req_t *q, wire_resp_t *a)
+{
+    if (!event_id)
+        return false;
+    copy_id(q->event_id, event_id);
+    router_event_t *e = event_find(r, q->event_id, event_hash(q->event_id));
+    if (!e)
+        return router_call(r, ring_owner(r, q->event_id), q, NULL, a, NULL);
+    pthread_rwlock_rdlock(&e->move);
+    bool ok = router_call(r, e->owner, q, NULL, a, NULL);
+    pthread_rwlock_unlock(&e->move);
+    return ok;
+}
+
+// Send op for e's event to `node`, with n records after it.
+static bool event_call(tb_router_t *r, router_event_t *e, uint32_t node, uint32_t op,
+                       const void *items, uint32_t n)
+{
+    wire_req_t q = {.op = op, .n = n};
+    memcpy(q.event_id, e->event_id, TB_ID_LEN);
+    wire_resp_t a;
+    return router_call(r, node, &q, items, &a, NULL) && a.code == RES_OK;
+}
+
+// Move e to node `to`: export its seats and open orders, load both there,
+// drop both from the old owner. The orders go along so that refunds and
+// confirm retries, routed to the current owner, still find them.
+static bool event_move(tb_router_t *r, router_event_t *e, uint32_t to)
+{
+    pthread_rwlock_wrlock(&e->move);
+    uint32_t from = e->owner;
+    wire_req_t q = {.op = OP_EXPORT};
+    memcpy(q.event_id, e->event_id, TB_ID_LEN);
+    wire_resp_t a;
+    void *seats = NULL, *orders = NULL;
+    uint32_t n_seats = 0, n_orders = 0;
+    bool ok = router_call(r, from, &q, NULL, &a, &seats) && a.code == RES_OK;
+    n_seats = ok ? a.n : 0;
+    q.op = OP_EXPORT_ORDERS;
+    ok = ok && router_call(r, from, &q, NULL, &a, &orders) && a.code == RES_OK;
+    n_orders = ok ? a.n : 0;
+    if (ok)
+    {
+        ok = event_call(r, e, to, OP_LOAD, seats, n_seats) &&
+             event_call(r, e, to, OP_IMPORT_ORDERS, orders, n_orders);
+        if (!ok)
+        {
+            event_call(r, e, to, OP_UNLOAD, NULL, 0); // whatever half loaded
+            event_call(r, e, to, OP_DROP_ORDERS, NULL, 0);
+        }
+        else
+        {
+            event_call(r, e, from, OP_UNLOAD, NULL, 0);
+            event_call(r, e, from, OP_DROP_ORDERS, NULL, 0);
+            e->owner = to;
+            r->moves++;
+        }
+    }
+    free(seats);
+    free(orders);
+    pthread_rwlock_unlock(&e->move);
+    return ok;
+}
+
+// Move every registered event the ring now places elsewhere. Caller holds
+// topo_mtx.
+static bool rebalance(tb_router_t *r)
+{
+    bool ok = true;
+    for (size_t b = 0; b < CONFIG_ROUTER_EVENT_BUCKETS; ++b)
+        for (router_event_t *e = r->events[b]; e; e = e->next)
+        {
+            uint32_t to = ring_owner(r, e->event_id);
+            if (to != e->owner && to != TB_NODE_NONE && !event_move(r, e, to))
+                ok = false;
+        }
+    return ok;
+}
+
+bool tb_router_add_node(tb_router_t *r, uint32_t node, const char *path)
+{
+    struct sockaddr_un a;
+    if (!r || node >= NODE_SLOTS || !tb_unix_addr(path, &a))
+        return false;
+    pthread_mutex_lock(&r->topo_mtx);
+    router_node_t *n = r->nodes[node];
+    if (!n && (n = calloc(1, sizeof *n)))
+    {
+        for (size_t c = 0; c < CONFIG_ROUTER_CONNS; ++c)
+        {
+            pthread_mutex_init(&n->conns[c].mtx, NULL);
+            n->conns[c].fd = -1;
+        }
+        r->nodes[node] = n;
+    }
+    bool ok = n && !n->member;
+    if (ok)
+    {
+        strcpy(n->path, path);
+        __atomic_store_n(&n->member, true, __ATOMIC_RELEASE);
+        wire_req_t q = {.op = OP_PING};
+        wire_resp_t resp;
+        ok = router_call(r, node, &q, NULL, &resp, NULL);
+        if (ok)
+        {
+            pthread_rwlock_wrlock(&r->ring_lock);
+            ok = tb_ring_add(r->ring, node);
+            pthread_rwlock_unlock(&r->ring_lock);
+        }
+        if (!ok)
+            __atomic_store_n(&n->member, false, __ATOMIC_RELEASE);
+        else
+            ok = rebalance(r);
+    }
+    pthread_mutex_unlock(&r->topo_mtx);
+    return ok;
+}
+
+bool tb_router_remove_node(tb_router_t *r, uint32_t node)
+{
+    if (!r || node >= NODE_SLOTS)
+        return false;
+    pthread_mutex_lock(&r->topo_mtx);
+    router_node_t *n = r->nodes[node];
+    bool ok = n && n->member;
+    bool owns = false;
+    for (size_t b = 0; ok && b < CONFIG_ROUTER_EVENT_BUCKETS; ++b)
+        for (router_event_t *e = r->events[b]; e; e = e->next)
+            owns |= e->owner == node;
+    pthread_rwlock_wrlock(&r->ring_lock);
+    if (ok && owns && tb_ring_nodes(r->ring) == 1)
+        ok = false;
+    if (ok)
+        tb_ring_remove(r->ring, node);
+    pthread_rwlock_unlock(&r->ring_lock);
+    if (ok && !rebalance(r))
+    {
+        pthread_rwlock_wrlock(&r->ring_lock);
+        tb_ring_add(r->ring, node);
+        pthread_rwlock_unlock(&r->ring_lock);
+        ok = false;
+    }
+    if (ok)
+    {
+        __atomic_store_n(&n->member, false, __ATOMIC_RELEASE);
+        for (size_t c = 0; c < CONFIG_ROUTER_CONNS; ++c)
+        {
+            pthread_mutex_lock(&n->conns[c].mtx);
+            if (n->conns[c].fd >= 0)
+                close(n->conns[c].fd);
+            n->conns[c].fd = -1;
+            pthread_mutex_unlock(&n->conns[c].mtx);
+        }
+    }
+    pthread_mutex_unlock(&r->topo_mtx);
+    return ok;
+}
+
+uint32_t tb_router_owner(tb_router_t *r, const char *event_id)
+{
+    if (!r || !event_id)
+        return TB_NODE_NONE;
+    char id[TB_ID_LEN];
+    copy_id(id, event_id);
+    router_event_t *e = event_find(r, id, event_hash(id));
+    if (!e)
+        return ring_owner(r, id);
+    pthread_rwlock_rdlock(&e->move);
+    uint32_t owner = e->owner;
+    pthread_rwlock_unlock(&e->move);
+    return owner;
+}
+
+size_t tb_router_moves(const tb_router_t *r)
+{
+    return r ? r->moves : 0;
+}
+
+bool tb_router_load_event(tb_router_t *r, const char *event_id, const seat_t *seats, size_t n)
+{
+    if (!r || !event_id || (!seats && n > 0) || n > UINT32_MAX)
+        return false;
+    wire_req_t q = {.op = OP_LOAD, .n = (uint32_t)n};
+    copy_id(q.event_id, event_id);
+    uint64_t h = event_hash(q.event_id);
+    pthread_mutex_lock(&r->topo_mtx);
+    router_event_t *e = event_find(r, q.event_id, h);
+    bool fresh = !e;
+    if (fresh && (e = calloc(1, sizeof *e)))
+    {
+        memcpy(e->event_id, q.event_id, TB_ID_LEN);
+        e->hash = h;
+        e->owner = ring_owner(r, q.event_id);
+        pthread_rwlock_init(&e->move, NULL);
+    }
+    wire_resp_t a;
+    bool ok = e && e->owner != TB_NODE_NONE;
+    if (ok)
+    {
+        pthread_rwlock_wrlock(&e->move);
+        ok = router_call(r, e->owner, &q, seats, &a, NULL) && a.code == RES_OK;
+        pthread_rwlock_unlock(&e->move);
+    }
+    if (fresh && e && ok)
+    {
+        router_event_t **head = &r->events[h & (CONFIG_ROUTER_EVENT_BUCKETS - 1)];
+        e->next = *head;
+        __atomic_store_n(head, e, __ATOMIC_RELEASE);
+    }
+    else if (fresh && e)
+    {
+        pthread_rwlock_destroy(&e->move);
+        free(e);
+    }
+    pthread_mutex_unlock(&r->topo_mtx);
+    return ok;
+}
+
+hold_result_t tb_router_place_hold(tb_router_t *r, const char *user_id, const char *event_id,
+                                   const char *seat_id)
+{
+    hold_result_t out = {.code = RES_INTERNAL_ERR};
+    wire_req_t q = {.op = OP_HOLD};
+    wire_resp_t a;
+    copy_id(q.user_id, user_id);
+    copy_id(q.seat_id, seat_id);
+    if (r && user_id && seat_id && route(r, event_id, &q, &a))
+        out = a.u.hold;
+    return out;
+}
+
+confirm_result_t tb_router_confirm(tb_router_t *r, const char *event_id,
+                                   const tb_byte_t *hold_token, size_t token_len,
+                                   tb_money_cents_t amount_paid_cents)
+{
+    confirm_result_t out = {.code = RES_INTERNAL_ERR};
+    if (!r || !hold_token || token_len > TB_TOKEN_LEN)
+        return out;
+    wire_req_t q = {.op = OP_CONFIRM, .amount = amount_paid_cents, .token_len = (uint32_t)token_len};
+    memcpy(q.token, hold_token, token_len);
+    wire_resp_t a;
+    if (route(r, event_id, &q, &a))
+        out = a.u.confirm;
+    return out;
+}
+
+res_code_t tb_router_cancel_hold(tb_router_t *r, const char *user_id, const char *event_id,
+                                 const char *seat_id)
+{
+    wire_req_t q = {.op = OP_CANCEL};
+    wire_resp_t a;
+    copy_id(q.user_id, user_id);
+    copy_id(q.seat_id, seat_id);
+    if (!r || !user_id || !seat_id || !route(r, event_id, &q, &a))
+        return RES_INTERNAL_ERR;
+    return (res_code_t)a.code;
+}
+
+bool tb_router_seat_get(tb_router_t *r, const char *event_id, const char *seat_id,
+                        seat_view_t *out)
+{
+    wire_req_t q = {.op = OP_GET};
+    wire_resp_t a;
+    copy_id(q.seat_id, seat_id);
+    if (!r || !seat_id || !out || !route(r, event_id, &q, &a) || a.code != RES_OK)
+        return false;
+    *out = a.u.view;
+    return true;
+}
+
+res_code_t tb_router_refund(tb_router_t *r, const char *user_id, const char *event_id,
+                            const char *order_id)
+{
+    wire_req_t q = {.op = OP_REFUND};
+    wire_resp_t a;
+    copy_id(q.user_id, user_id);
+    copy_id(q.seat_id, order_id);
+    if (!r || !user_id || !order_id || !route(r, event_id, &q, &a))
+        return RES_INTERNAL_ERR;
+    return (res_code_t)a.code;
+}
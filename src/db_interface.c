@@ -4,48 +4,219 @@
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
-#include <stdio.h>
 
 #include "db_interface.h"
+#include "intern.h"
+#include "orderid.h"
+#include "slab.h"
+#include "utils.h"
 
 typedef struct order_row {
     char order_id[RES_ID_LEN];
     char user_id[RES_ID_LEN];
-    char event_id[RES_ID_LEN];
-    char seat_id[RES_ID_LEN];
+    uint32_t event_ix; // interned, see intern.h
+    uint32_t seat_ix;
     tb_money_cents_t price;
     tb_byte_t token[RES_TOKEN_LEN];
     size_t token_len;
-    struct order_row *next;
+    struct order_row *next_by_token; // hash chains, see g_by_token / g_by_id
+    struct order_row *next_by_id;
+    struct order_row *prev_by_event; // per-event list, see g_by_event
+    struct order_row *next_by_event;
 } order_row_t;
 
+#define DB_MIN_BUCKETS 1024u
+
 static pthread_mutex_t g_db_mtx = PTHREAD_MUTEX_INITIALIZER;
-static order_row_t *g_orders = NULL;
-static uint64_t g_order_seq = 1;
+static order_row_t **g_by_token = NULL; // chains keyed by hold token
+static order_row_t **g_by_id = NULL;    // chains keyed by order id
+static size_t g_buckets = 0;            // power of two, >= g_order_count
+static size_t g_order_count = 0;
+
+// Open orders of each event, indexed by interned event id.
+typedef struct
+{
+    order_row_t *head;
+    size_t n;
+} event_orders_t;
+
+static event_orders_t *g_by_event = NULL;
+static size_t g_event_slots = 0;
 
 struct db_txn { int dummy; };
 
+// Order rows and transactions come from slabs: selling out a venue creates
+// millions of each, and refunds hand rows back for reuse.
+static pthread_once_t g_slab_once = PTHREAD_ONCE_INIT;
+static tb_slab_t g_order_slab;
+static tb_slab_t g_txn_slab;
+static bool g_slab_ok = false;
+
+static void slab_do_init(void)
+{
+    g_slab_ok = tb_slab_init(&g_order_slab, sizeof(order_row_t), 0) &&
+                tb_slab_init(&g_txn_slab, sizeof(db_txn_t), 0);
+}
+
+static inline bool slabs_ready(void)
+{
+    pthread_once(&g_slab_once, slab_do_init);
+    return g_slab_ok;
+}
+
+static inline size_t token_bucket(const tb_byte_t *token, size_t len)
+{
+    return (size_t)tb_hash_bytes(token, len, 0) & (g_buckets - 1);
+}
+
+static inline size_t id_bucket(const char *order_id)
+{
+    return (size_t)tb_hash_name_fast(order_id) & (g_buckets - 1);
+}
+
+// Caller holds g_db_mtx. Doubles both indexes once rows outnumber buckets.
+static bool index_reserve(size_t want)
+{
+    if (want <= g_buckets)
+        return true;
+    size_t n = g_buckets ? g_buckets * 2 : DB_MIN_BUCKETS;
+    order_row_t **by_token = calloc(n, sizeof(*by_token));
+    order_row_t **by_id = calloc(n, sizeof(*by_id));
+    if (!by_token || !by_id)
+    {
+        free(by_token);
+        free(by_id);
+        return false;
+    }
+    size_t old = g_buckets;
+    order_row_t **old_token = g_by_token, **old_id = g_by_id;
+    g_by_token = by_token;
+    g_by_id = by_id;
+    g_buckets = n;
+    for (size_t b = 0; b < old; ++b)
+    {
+        for (order_row_t *r = old_token[b], *next; r; r = next)
+        {
+            next = r->next_by_token;
+            size_t i = token_bucket(r->token, r->token_len);
+            r->next_by_token = g_by_token[i];
+            g_by_token[i] = r;
+        }
+        for (order_row_t *r = old_id[b], *next; r; r = next)
+        {
+            next = r->next_by_id;
+            size_t i = id_bucket(r->order_id);
+            r->next_by_id = g_by_id[i];
+            g_by_id[i] = r;
+        }
+    }
+    free(old_token);
+    free(old_id);
+    return true;
+}
+
+// Caller holds g_db_mtx. The event's list, grown to reach it if `grow`.
+static event_orders_t *event_orders_locked(uint32_t event_ix, bool grow)
+{
+    if (event_ix < g_event_slots)
+        return &g_by_event[event_ix];
+    if (!grow)
+        return NULL;
+    size_t n = g_event_slots ? g_event_slots : 64;
+    while (n <= event_ix)
+        n *= 2;
+    event_orders_t *e = realloc(g_by_event, n * sizeof *e);
+    if (!e)
+        return NULL;
+    memset(e + g_event_slots, 0, (n - g_event_slots) * sizeof *e);
+    g_by_event = e;
+    g_event_slots = n;
+    return &g_by_event[event_ix];
+}
+
+// Caller holds g_db_mtx. Takes the row out of all three indexes; pp is its
+// link in the id chain.
+static void unlink_locked(order_row_t **pp)
+{
+    order_row_t *row = *pp;
+    *pp = row->next_by_id;
+    for (order_row_t **tp = &g_by_token[token_bucket(row->token, row->token_len)]; *tp;
+         tp = &(*tp)->next_by_token)
+    {
+        if (*tp == row)
+        {
+            *tp = row->next_by_token;
+            break;
+        }
+    }
+    event_orders_t *e = &g_by_event[row->event_ix];
+    if (row->prev_by_event)
+        row->prev_by_event->next_by_event = row->next_by_event;
+    else
+        e->head = row->next_by_event;
+    if (row->next_by_event)
+        row->next_by_event->prev_by_event = row->prev_by_event;
+    e->n--;
+    g_order_count--;
+}
+
+// Caller holds g_db_mtx, and room in the indexes (index_reserve). Puts the
+// row into all three.
+static void link_locked(order_row_t *row, event_orders_t *e)
+{
+    size_t t = token_bucket(row->token, row->token_len);
+    size_t i = id_bucket(row->order_id);
+    row->next_by_token = g_by_token[t];
+    g_by_token[t] = row;
+    row->next_by_id = g_by_id[i];
+    g_by_id[i] = row;
+    row->prev_by_event = NULL;
+    row->next_by_event = e->head;
+    if (e->head)
+        e->head->prev_by_event = row;
+    e->head = row;
+    e->n++;
+    g_order_count++;
+}
+
+// Caller holds g_db_mtx.
+static order_row_t **find_by_id_locked(const char *order_id)
+{
+    if (g_buckets == 0)
+        return NULL;
+    for (order_row_t **pp = &g_by_id[id_bucket(order_id)]; *pp; pp = &(*pp)->next_by_id)
+    {
+        if (strncmp((*pp)->order_id, order_id, RES_ID_LEN) == 0)
+            return pp;
+    }
+    return NULL;
+}
+
+// Runs outside g_db_mtx: ids come from this thread's lease (orderid.h).
 static void gen_order_id(char out[RES_ID_LEN])
 {
-    // Simple monotonic counter id: ORD-<seq>
-    snprintf(out, RES_ID_LEN, "ORD-%llu", (unsigned long long)g_order_seq++);
+    _Static_assert(RES_ID_LEN >= TB_ORDERID_STR_LEN, "order id does not fit");
+    tb_orderid_format(tb_orderid_next(), out);
 }
 
 db_txn_t* db_txn_begin(void)
 {
-    db_txn_t *t = (db_txn_t*)malloc(sizeof(db_txn_t));
-    return t;
+    if (!slabs_ready())
+        return NULL;
+    return (db_txn_t*)tb_slab_alloc(&g_txn_slab);
 }
 
 bool db_txn_commit(db_txn_t* txn)
 {
-    free(txn);
+    if (txn)
+        tb_slab_free(&g_txn_slab, txn);
     return true;
 }
 
 void db_txn_rollback(db_txn_t* txn)
 {
-    free(txn);
+    if (txn)
+        tb_slab_free(&g_txn_slab, txn);
 }
 
 res_code_t db_authoritative_price(const char* event_id,
@@ -65,7 +236,8 @@ res_code_t db_order_find_by_token(const tb_byte_t* hold_token,
     if (!hold_token || token_len == 0)
         return RES_NOT_FOUND;
     pthread_mutex_lock(&g_db_mtx);
-    for (order_row_t *r = g_orders; r; r = r->next)
+    order_row_t *r = g_buckets ? g_by_token[token_bucket(hold_token, token_len)] : NULL;
+    for (; r; r = r->next_by_token)
     {
         if (r->token_len == token_len && memcmp(r->token, hold_token, token_len) == 0)
         {
@@ -88,17 +260,18 @@ res_code_t db_order_find_by_id(const char* order_id,
     if (!order_id)
         return RES_NOT_FOUND;
     pthread_mutex_lock(&g_db_mtx);
-    for (order_row_t *r = g_orders; r; r = r->next)
+    order_row_t **pp = find_by_id_locked(order_id);
+    if (pp)
     {
-        if (strncmp(r->order_id, order_id, RES_ID_LEN) == 0)
-        {
-            if (out_user_id) strncpy(out_user_id, r->user_id, RES_ID_LEN - 1);
-            if (out_event_id) strncpy(out_event_id, r->event_id, RES_ID_LEN - 1);
-            if (out_seat_id) strncpy(out_seat_id, r->seat_id, RES_ID_LEN - 1);
-            if (out_price) *out_price = r->price;
-            pthread_mutex_unlock(&g_db_mtx);
-            return RES_OK;
-        }
+        order_row_t *r = *pp;
+        if (out_user_id) strncpy(out_user_id, r->user_id, RES_ID_LEN - 1);
+        const char *ev = tb_intern_name(TB_NS_EVENT, r->event_ix);
+        const char *st = tb_intern_name(TB_NS_SEAT, r->seat_ix);
+        if (out_event_id && ev) memcpy(out_event_id, ev, RES_ID_LEN);
+        if (out_seat_id && st) memcpy(out_seat_id, st, RES_ID_LEN);
+        if (out_price) *out_price = r->price;
+        pthread_mutex_unlock(&g_db_mtx);
+        return RES_OK;
     }
     pthread_mutex_unlock(&g_db_mtx);
     return RES_NOT_FOUND;
@@ -117,20 +290,26 @@ res_code_t db_order_create(db_txn_t* txn,
     if (!user_id || !event_id || !seat_id || !hold_token || token_len == 0)
         return RES_INTERNAL_ERR;
 
-    order_row_t *row = (order_row_t*)calloc(1, sizeof(order_row_t));
+    order_row_t *row = slabs_ready() ? (order_row_t*)tb_slab_alloc(&g_order_slab) : NULL;
     if (!row)
         return RES_INTERNAL_ERR;
     strncpy(row->user_id, user_id, RES_ID_LEN - 1);
-    strncpy(row->event_id, event_id, RES_ID_LEN - 1);
-    strncpy(row->seat_id, seat_id, RES_ID_LEN - 1);
+    row->event_ix = tb_intern(TB_NS_EVENT, event_id);
+    row->seat_ix = tb_intern(TB_NS_SEAT, seat_id);
     row->price = price_cents;
     row->token_len = token_len > RES_TOKEN_LEN ? RES_TOKEN_LEN : token_len;
     memcpy(row->token, hold_token, row->token_len);
     gen_order_id(row->order_id);
 
     pthread_mutex_lock(&g_db_mtx);
-    row->next = g_orders;
-    g_orders = row;
+    event_orders_t *e = event_orders_locked(row->event_ix, true);
+    if (!e || !index_reserve(g_order_count + 1))
+    {
+        pthread_mutex_unlock(&g_db_mtx);
+        tb_slab_free(&g_order_slab, row);
+        return RES_INTERNAL_ERR;
+    }
+    link_locked(row, e);
     if (out_order_id) strncpy(out_order_id, row->order_id, RES_ID_LEN - 1);
     pthread_mutex_unlock(&g_db_mtx);
 
@@ -152,7 +331,196 @@ res_code_t db_refund_create(db_txn_t* txn,
                             const char* order_id,
                             tb_money_cents_t amount_cents)
 {
-    (void)txn; (void)user_id; (void)order_id; (void)amount_cents;
-    // Accept refund in stub
+    (void)txn; (void)amount_cents;
+    if (!user_id || !order_id)
+        return RES_NOT_FOUND;
+
+    // The stub keeps no refund ledger: the order row is removed and recycled,
+    // so a second refund of the same order finds nothing.
+    pthread_mutex_lock(&g_db_mtx);
+    order_row_t **pp = find_by_id_locked(order_id);
+    if (!pp || strncmp((*pp)->user_id, user_id, RES_ID_LEN) != 0)
+    {
+        pthread_mutex_unlock(&g_db_mtx);
+        return RES_NOT_FOUND;
+    }
+    order_row_t *row = *pp;
+    unlink_locked(pp);
+    pthread_mutex_unlock(&g_db_mtx);
+
+    tb_slab_free(&g_order_slab, row);
+    return RES_OK;
+}
+
+size_t db_order_count_by_event(const char* event_id)
+{
+    if (!event_id)
+        return 0;
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, event_id);
+    pthread_mutex_lock(&g_db_mtx);
+    event_orders_t *e = ev ? event_orders_locked(ev, false) : NULL;
+    size_t n = e ? e->n : 0;
+    pthread_mutex_unlock(&g_db_mtx);
+    return n;
+}
+
+res_code_t db_refund_event_batch(db_txn_t* txn,
+                                 const char* event_id,
+                                 size_t max,
+                                 db_refund_row_t* out,
+                                 size_t* n_out)
+{
+    (void)txn;
+    if (!event_id || !n_out || (!out && max > 0))
+        return RES_INTERNAL_ERR;
+    *n_out = 0;
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, event_id);
+    if (ev == 0)
+        return RES_OK;
+
+    // Rows are unlinked under the lock and recycled after it.
+    order_row_t *taken = NULL;
+    size_t n = 0;
+    pthread_mutex_lock(&g_db_mtx);
+    event_orders_t *e = event_orders_locked(ev, false);
+    while (e && e->head && n < max)
+    {
+        order_row_t *row = e->head;
+        order_row_t **pp = find_by_id_locked(row->order_id);
+        unlink_locked(pp);
+        db_refund_row_t *o = &out[n++];
+        memcpy(o->order_id, row->order_id, RES_ID_LEN);
+        memcpy(o->user_id, row->user_id, RES_ID_LEN);
+        o->seat_ix = row->seat_ix;
+        o->price_cents = row->price;
+        row->next_by_event = taken;
+        taken = row;
+    }
+    pthread_mutex_unlock(&g_db_mtx);
+
+    while (taken)
+    {
+        order_row_t *next = taken->next_by_event;
+        tb_slab_free(&g_order_slab, taken);
+        taken = next;
+    }
+    *n_out = n;
     return RES_OK;
 }
+
+// Recycle a chain of unlinked rows (through next_by_event).
+static void free_rows(order_row_t *row)
+{
+    while (row)
+    {
+        order_row_t *next = row->next_by_event;
+        tb_slab_free(&g_order_slab, row);
+        row = next;
+    }
+}
+
+size_t db_order_export_event(const char* event_id, order_record_t* out, size_t max)
+{
+    if (!event_id || (!out && max > 0))
+        return 0;
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, event_id);
+    pthread_mutex_lock(&g_db_mtx);
+    event_orders_t *e = ev ? event_orders_locked(ev, false) : NULL;
+    size_t k = 0;
+    for (order_row_t *row = e ? e->head : NULL; row && k < max; row = row->next_by_event, ++k)
+    {
+        order_record_t *o = &out[k];
+        memset(o, 0, sizeof *o);
+        memcpy(o->order_id, row->order_id, RES_ID_LEN);
+        memcpy(o->user_id, row->user_id, RES_ID_LEN);
+        const char *st = tb_intern_name(TB_NS_SEAT, row->seat_ix);
+        if (st) memcpy(o->seat_id, st, RES_ID_LEN);
+        o->price_cents = row->price;
+        o->token_len = (uint32_t)row->token_len;
+        memcpy(o->token, row->token, row->token_len);
+    }
+    size_t n = e ? e->n : 0;
+    pthread_mutex_unlock(&g_db_mtx);
+    return n;
+}
+
+res_code_t db_order_import(db_txn_t* txn,
+                           const char* event_id,
+                           const order_record_t* rows,
+                           size_t n)
+{
+    (void)txn;
+    if (!event_id || (!rows && n > 0))
+        return RES_INTERNAL_ERR;
+    if (n == 0)
+        return RES_OK;
+    uint32_t ev = tb_intern(TB_NS_EVENT, event_id);
+
+    // Rows are built outside the lock, chained through next_by_event.
+    order_row_t *built = NULL;
+    bool ok = ev != 0 && slabs_ready();
+    for (size_t k = 0; ok && k < n; ++k)
+    {
+        order_row_t *row = (order_row_t*)tb_slab_alloc(&g_order_slab);
+        if (!(ok = row != NULL))
+            break;
+        memset(row, 0, sizeof *row);
+        memcpy(row->order_id, rows[k].order_id, RES_ID_LEN - 1);
+        memcpy(row->user_id, rows[k].user_id, RES_ID_LEN - 1);
+        row->event_ix = ev;
+        row->seat_ix = tb_intern(TB_NS_SEAT, rows[k].seat_id);
+        row->price = rows[k].price_cents;
+        row->token_len = rows[k].token_len > RES_TOKEN_LEN ? RES_TOKEN_LEN : rows[k].token_len;
+        memcpy(row->token, rows[k].token, row->token_len);
+        row->next_by_event = built;
+        built = row;
+        ok = row->seat_ix != 0;
+    }
+
+    order_row_t *skipped = NULL;
+    if (ok)
+    {
+        pthread_mutex_lock(&g_db_mtx);
+        event_orders_t *e = event_orders_locked(ev, true);
+        ok = e && index_reserve(g_order_count + n);
+        while (ok && built)
+        {
+            order_row_t *row = built;
+            built = row->next_by_event;
+            if (find_by_id_locked(row->order_id))
+            {
+                row->next_by_event = skipped;
+                skipped = row;
+            }
+            else
+                link_locked(row, e);
+        }
+        pthread_mutex_unlock(&g_db_mtx);
+    }
+
+    free_rows(built);
+    free_rows(skipped);
+    return ok ? RES_OK : RES_INTERNAL_ERR;
+}
+
+size_t db_order_drop_event(const char* event_id)
+{
+    uint32_t ev = event_id ? tb_intern_lookup(TB_NS_EVENT, event_id) : 0;
+    if (ev == 0)
+        return 0;
+    order_row_t *taken = NULL;
+    size_t n = 0;
+    pthread_mutex_lock(&g_db_mtx);
+    event_orders_t *e = event_orders_locked(ev, false);
+    while (e && e->head)
+    {
+        order_row_t *row = e->head;
+        unlink_locked(find_by_id_locked(row->order_id));
+        row->next_by_event = taken;
+        taken = row;
+        n++;
+    }
+    pthread_mutex_unlock(&g_db_mtx);
+    free_rows(taken);
+    return n;
+}
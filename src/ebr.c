@@ -0,0 +1,214 @@
+// Epoch-based reclamation (see ebr.h).
+//
+// Every thread that ever entered a section owns a record in a push-only
+// registry; a thread that exits gives its record back for reuse. A record's
+// `active` word is 0 outside a section and epoch * 2 + 1 inside one, where
+// epoch is the global epoch the thread saw on entry. The epoch advances
+// only when every active record has seen the current one, so once it has
+// moved twice past an object's retire epoch, no reader can still hold it.
+// Retired nodes wait in one FIFO; a single reclaimer at a time runs them,
+// which keeps callbacks in retire order.
+
+#include "ebr.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct ebr_thread
+{
+    _Alignas(64) uint64_t active; // 0, or entry epoch * 2 + 1
+    struct ebr_thread *next;      // registry link, never unlinked
+    uint32_t in_use;              // owned by a live thread
+    uint32_t nest;                // section depth, owner only
+} ebr_thread_t;
+
+static uint64_t g_epoch = 1;
+static ebr_thread_t *g_registry;
+static pthread_key_t g_key;
+static pthread_once_t g_key_once = PTHREAD_ONCE_INIT;
+static __thread ebr_thread_t *t_self;
+
+static pthread_mutex_t g_limbo_mtx = PTHREAD_MUTEX_INITIALIZER;
+static tb_ebr_node_t *g_limbo_head, *g_limbo_tail; // by retire epoch, oldest first
+static size_t g_pending;
+static pthread_mutex_t g_reclaim_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+static void thread_gone(void *p)
+{
+    ebr_thread_t *t = (ebr_thread_t *)p;
+    t->nest = 0;
+    __atomic_store_n(&t->active, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&t->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void key_create(void)
+{
+    pthread_key_create(&g_key, thread_gone);
+}
+
+// This thread's record: a free one from the registry, else a new one.
+static ebr_thread_t *self(void)
+{
+    if (t_self)
+        return t_self;
+    pthread_once(&g_key_once, key_create);
+    ebr_thread_t *t = NULL;
+    while (!t)
+    {
+        for (t = __atomic_load_n(&g_registry, __ATOMIC_ACQUIRE); t; t = t->next)
+        {
+            uint32_t free_rec = 0;
+            if (__atomic_compare_exchange_n(&t->in_use, &free_rec, 1, false, __ATOMIC_ACQUIRE,
+                                            __ATOMIC_RELAXED))
+                break;
+        }
+        if (t)
+            break;
+        t = aligned_alloc(_Alignof(ebr_thread_t), sizeof(ebr_thread_t));
+        if (!t)
+        {
+            sched_yield(); // out of memory: wait for an exiting thread's record
+            continue;
+        }
+        memset(t, 0, sizeof *t);
+        t->in_use = 1;
+        t->next = __atomic_load_n(&g_registry, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&g_registry, &t->next, t, true, __ATOMIC_RELEASE,
+                                            __ATOMIC_RELAXED))
+            ;
+    }
+    pthread_setspecific(g_key, t);
+    t_self = t;
+    return t;
+}
+
+void tb_ebr_enter(void)
+{
+    ebr_thread_t *t = self();
+    if (t->nest++ != 0)
+        return;
+    uint64_t e = __atomic_load_n(&g_epoch, __ATOMIC_RELAXED);
+    __atomic_store_n(&t->active, e << 1 | 1u, __ATOMIC_RELAXED);
+    // Announce before touching shared pointers: an advance either sees us
+    // or happened before our loads, which then miss what it frees.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void tb_ebr_exit(void)
+{
+    ebr_thread_t *t = t_self;
+    if (t && t->nest > 0 && --t->nest == 0)
+        __atomic_store_n(&t->active, 0, __ATOMIC_RELEASE);
+}
+
+void tb_ebr_retire(tb_ebr_node_t *node, tb_ebr_fn fn)
+{
+    if (!node || !fn)
+        return;
+    node->fn = fn;
+    node->next = NULL;
+    // The latest epoch, not a stale one: a reader that entered under it may
+    // still hold the node.
+    node->epoch = __atomic_fetch_add(&g_epoch, 0, __ATOMIC_SEQ_CST);
+    pthread_mutex_lock(&g_limbo_mtx);
+    if (g_limbo_tail)
+        g_limbo_tail->next = node;
+    else
+        g_limbo_head = node;
+    g_limbo_tail = node;
+    __atomic_add_fetch(&g_pending, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&g_limbo_mtx);
+}
+
+// Move the epoch on if every active reader has seen it. Returns the epoch
+// afterwards.
+static uint64_t try_advance(void)
+{
+    uint64_t g = __atomic_load_n(&g_epoch, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    for (const ebr_thread_t *t = __atomic_load_n(&g_registry, __ATOMIC_ACQUIRE); t; t = t->next)
+    {
+        uint64_t a = __atomic_load_n(&t->active, __ATOMIC_ACQUIRE);
+        if ((a & 1u) && (a >> 1) != g)
+            return g;
+    }
+    if (__atomic_compare_exchange_n(&g_epoch, &g, g + 1, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        return g + 1;
+    return g; // someone else advanced it
+}
+
+// Caller holds g_reclaim_mtx.
+static size_t reclaim_locked(void)
+{
+    // Advance as far as the oldest node needs and the readers allow: with
+    // no reader in the way, a node retired just now is run at once.
+    pthread_mutex_lock(&g_limbo_mtx);
+    uint64_t need = g_limbo_head ? g_limbo_head->epoch + 2 : 0;
+    pthread_mutex_unlock(&g_limbo_mtx);
+    uint64_t g = try_advance();
+    for (uint64_t next; g < need && (next = try_advance()) > g;)
+        g = next;
+    pthread_mutex_lock(&g_limbo_mtx);
+    tb_ebr_node_t *due = g_limbo_head, *last = NULL;
+    for (tb_ebr_node_t *n = g_limbo_head; n && n->epoch + 2 <= g; n = n->next)
+        last = n;
+    if (last)
+    {
+        g_limbo_head = last->next;
+        if (!g_limbo_head)
+            g_limbo_tail = NULL;
+        last->next = NULL;
+    }
+    else
+    {
+        due = NULL;
+    }
+    pthread_mutex_unlock(&g_limbo_mtx);
+
+    size_t ran = 0;
+    for (tb_ebr_node_t *n = due, *next; n; n = next)
+    {
+        next = n->next;
+        n->fn(n);
+        ran++;
+    }
+    __atomic_sub_fetch(&g_pending, ran, __ATOMIC_RELAXED);
+    return ran;
+}
+
+size_t tb_ebr_reclaim(void)
+{
+    if (__atomic_load_n(&g_pending, __ATOMIC_RELAXED) == 0)
+        return 0;
+    if (pthread_mutex_trylock(&g_reclaim_mtx) != 0)
+        return 0; // another thread is reclaiming
+    size_t ran = reclaim_locked();
+    pthread_mutex_unlock(&g_reclaim_mtx);
+    return ran;
+}
+
+void tb_ebr_synchronize(void)
+{
+    uint64_t target = __atomic_fetch_add(&g_epoch, 0, __ATOMIC_SEQ_CST) + 2;
+    for (unsigned spins = 0; try_advance() < target; ++spins)
+        if (spins >= 16)
+            sched_yield();
+}
+
+void tb_ebr_barrier(void)
+{
+    pthread_mutex_lock(&g_reclaim_mtx);
+    while (__atomic_load_n(&g_pending, __ATOMIC_ACQUIRE) > 0)
+    {
+        tb_ebr_synchronize();
+        reclaim_locked();
+    }
+    pthread_mutex_unlock(&g_reclaim_mtx);
+}
+
+size_t tb_ebr_pending(void)
+{
+    return __atomic_load_n(&g_pending, __ATOMIC_RELAXED);
+}
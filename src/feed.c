@@ -0,0 +1,212 @@
+// Seat change feed (see feed.h).
+//
+// Publishers claim a sequence number with one fetch_add and write the slot
+// it maps to under a per-slot seqlock: the tag is FEED_BUSY while the slot
+// is written and seq + 1 once it is published. A publisher only waits for
+// the publisher one lap before it on the same slot, and only if that one is
+// still mid-write. Subscribers read slots at their own cursor and recognise
+// a slot overwritten under them by its tag.
+
+#include "feed.h"
+
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FEED_MIN_CAPACITY 64u
+#define FEED_BUSY UINT64_MAX
+
+typedef struct
+{
+    uint64_t tag; // 0 never written, FEED_BUSY being written, else seq + 1
+    uint64_t key; // event_ix << 32 | seat_ix
+    uint64_t kind;
+    uint64_t pad;
+} feed_slot_t;
+
+struct tb_feed
+{
+    _Alignas(64) uint64_t claim; // next seq to hand out
+    _Alignas(64) size_t mask;
+    feed_slot_t *slots;
+};
+
+// Per-subscriber seat index for coalescing one poll's changes: entries of
+// an older poll carry an older generation and count as empty.
+typedef struct
+{
+    uint64_t key;
+    uint32_t gen;
+    uint32_t pos; // index into the caller's out[]
+} feed_ix_t;
+
+struct tb_feed_sub
+{
+    tb_feed_t *feed;
+    uint64_t cursor; // next seq to read
+    feed_ix_t *ix;
+    size_t ix_mask;
+    uint32_t gen;
+};
+
+tb_feed_t *tb_feed_create(size_t capacity)
+{
+    size_t cap = FEED_MIN_CAPACITY;
+    while (cap < capacity && cap < ((size_t)1 << 40))
+        cap <<= 1;
+    tb_feed_t *f = aligned_alloc(_Alignof(tb_feed_t), sizeof(tb_feed_t));
+    feed_slot_t *slots = aligned_alloc(64, cap * sizeof(feed_slot_t));
+    if (!f || !slots)
+    {
+        free(f);
+        free(slots);
+        return NULL;
+    }
+    memset(f, 0, sizeof *f);
+    memset(slots, 0, cap * sizeof(feed_slot_t));
+    f->mask = cap - 1;
+    f->slots = slots;
+    return f;
+}
+
+void tb_feed_destroy(tb_feed_t *f)
+{
+    if (!f)
+        return;
+    free(f->slots);
+    free(f);
+}
+
+uint64_t tb_feed_publish(tb_feed_t *f, uint32_t event_ix, uint32_t seat_ix, tb_change_kind_t kind)
+{
+    uint64_t seq = __atomic_fetch_add(&f->claim, 1, __ATOMIC_RELAXED);
+    feed_slot_t *sl = &f->slots[seq & f->mask];
+    // Tag left by the previous lap's publisher of this slot, seq - capacity.
+    uint64_t prev = seq > f->mask ? seq - f->mask : 0;
+    for (unsigned spins = 0; __atomic_load_n(&sl->tag, __ATOMIC_ACQUIRE) != prev; ++spins)
+        if (spins >= 64)
+            sched_yield();
+    __atomic_store_n(&sl->tag, FEED_BUSY, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&sl->key, (uint64_t)event_ix << 32 | seat_ix, __ATOMIC_RELAXED);
+    __atomic_store_n(&sl->kind, (uint64_t)kind, __ATOMIC_RELAXED);
+    __atomic_store_n(&sl->tag, seq + 1, __ATOMIC_RELEASE);
+    return seq;
+}
+
+uint64_t tb_feed_head(const tb_feed_t *f)
+{
+    return f ? __atomic_load_n(&f->claim, __ATOMIC_ACQUIRE) : 0;
+}
+
+tb_feed_sub_t *tb_feed_subscribe(tb_feed_t *f)
+{
+    if (!f)
+        return NULL;
+    tb_feed_sub_t *s = calloc(1, sizeof *s);
+    if (!s)
+        return NULL;
+    s->feed = f;
+    s->cursor = tb_feed_head(f);
+    return s;
+}
+
+void tb_feed_unsubscribe(tb_feed_sub_t *s)
+{
+    if (!s)
+        return;
+    free(s->ix);
+    free(s);
+}
+
+uint64_t tb_feed_cursor(const tb_feed_sub_t *s)
+{
+    return s ? s->cursor : 0;
+}
+
+// Room to index `max` seats at half load at most.
+static bool sub_reserve(tb_feed_sub_t *s, size_t max)
+{
+    size_t want = 16;
+    while (want < 2 * max)
+        want <<= 1;
+    if (s->ix && s->ix_mask + 1 >= want)
+        return true;
+    feed_ix_t *ix = calloc(want, sizeof *ix);
+    if (!ix)
+        return false;
+    free(s->ix);
+    s->ix = ix;
+    s->ix_mask = want - 1;
+    s->gen = 0;
+    return true;
+}
+
+size_t tb_feed_poll(tb_feed_sub_t *s, tb_change_t *out, size_t max, bool *lost)
+{
+    if (lost)
+        *lost = false;
+    if (!s || !out || max == 0 || max > UINT32_MAX || !sub_reserve(s, max))
+        return 0;
+    if (++s->gen == 0)
+    {
+        memset(s->ix, 0, (s->ix_mask + 1) * sizeof(feed_ix_t));
+        s->gen = 1;
+    }
+    const tb_feed_t *f = s->feed;
+    uint64_t c = s->cursor;
+    size_t n = 0;
+    for (;;)
+    {
+        const feed_slot_t *sl = &f->slots[c & f->mask];
+        uint64_t t1 = __atomic_load_n(&sl->tag, __ATOMIC_ACQUIRE);
+        bool lapped = false;
+        if (t1 != c + 1)
+        {
+            // Busy or older: ours still being written, or a later lap's.
+            if (t1 == FEED_BUSY || t1 < c + 1)
+                lapped = __atomic_load_n(&f->claim, __ATOMIC_ACQUIRE) - c > f->mask + 1;
+            else
+                lapped = true;
+            if (!lapped)
+                break;
+        }
+        uint64_t key = 0, kind = 0;
+        if (!lapped)
+        {
+            key = __atomic_load_n(&sl->key, __ATOMIC_RELAXED);
+            kind = __atomic_load_n(&sl->kind, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            lapped = __atomic_load_n(&sl->tag, __ATOMIC_RELAXED) != t1;
+        }
+        if (lapped)
+        {
+            if (lost)
+                *lost = true;
+            c = __atomic_load_n(&f->claim, __ATOMIC_ACQUIRE);
+            break;
+        }
+
+        // Latest change per seat: update the seat's entry or add one.
+        size_t h = (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & s->ix_mask;
+        while (s->ix[h].gen == s->gen && s->ix[h].key != key)
+            h = (h + 1) & s->ix_mask;
+        tb_change_t *o;
+        if (s->ix[h].gen == s->gen)
+            o = &out[s->ix[h].pos];
+        else if (n == max)
+            break; // leave this change for the next poll
+        else
+        {
+            s->ix[h] = (feed_ix_t){.key = key, .gen = s->gen, .pos = (uint32_t)n};
+            o = &out[n++];
+            o->event_ix = (uint32_t)(key >> 32);
+            o->seat_ix = (uint32_t)key;
+        }
+        o->seq = c;
+        o->kind = (tb_change_kind_t)kind;
+        c++;
+    }
+    s->cursor = c;
+    return n;
+}
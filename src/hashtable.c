@@ -1,197 +1,2445 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <sched.h>
+#include <sys/mman.h>
 
 #include "hashtable.h"
+#include "ebr.h"
 #include "types.h"
+#include "intern.h"
 #include "utils.h"
 
-static inline uint64_t hash_key(const char *event_id, const char *seat_id)
+
+/* ---- Atomic word copies ----
+ * Records shared with lock-free readers are moved as 64-bit relaxed atomics,
+ * so a reader racing a writer sees stale-or-new words (never a C data race)
+ * and validates afterwards with a sequence or state-word recheck. */
+
+typedef uint64_t __attribute__((may_alias)) tb_word_t;
+
+static inline void words_store(void *dst, const void *src, size_t nbytes)
+{
+    tb_word_t *d = (tb_word_t *)dst;
+    const tb_word_t *s = (const tb_word_t *)src;
+    for (size_t i = 0; i < nbytes / sizeof(uint64_t); ++i)
+        __atomic_store_n(&d[i], s[i], __ATOMIC_RELAXED);
+}
+
+static inline void words_load(void *dst, const void *src, size_t nbytes)
+{
+    tb_word_t *d = (tb_word_t *)dst;
+    const tb_word_t *s = (const tb_word_t *)src;
+    for (size_t i = 0; i < nbytes / sizeof(uint64_t); ++i)
+        d[i] = __atomic_load_n(&s[i], __ATOMIC_RELAXED);
+}
+
+/* ---- Hold slot table ----
+ * Holder id and token of every active hold live in a slot referenced from
+ * the seat's state word. Slots sit in lazily allocated segments that never
+ * move, and are recycled through a tagged lock-free free list. A reader
+ * trusts a slot copy only if the seat's state word is unchanged afterwards,
+ * and a CAS on a HELD word trusts that the word cannot come back. So a slot
+ * that was published in a state word is retired through EBR and reused
+ * only once every section that might have seen it has left: however many
+ * hold/cancel cycles a seat goes through meanwhile, a caller that loads the
+ * word and CASes it within one section never meets the same reference
+ * again. The 5-bit generation only tells reuses apart in debugging.
+ *
+ * Slots are also chained by token hash, so a confirm finds its hold in
+ * O(1) expected instead of scanning the table. Readers walk the chains in
+ * an EBR section; writers link a slot when it is allocated and unlink it
+ * when it is retired, under a striped lock. An unlinked slot keeps its
+ * next link until it is reused, so a reader standing on it walks on. */
+
+#define HOLD_SEG_BITS 14
+#define HOLD_SEG_SIZE (1u << HOLD_SEG_BITS)
+#define HOLD_INDEX_BITS 24
+#define HOLD_MAX_SEGS (1u << (HOLD_INDEX_BITS - HOLD_SEG_BITS))
+#define HOLD_GEN_BITS 5
+#define HOLD_GEN_MASK ((1u << HOLD_GEN_BITS) - 1u)
+#define HOLD_TOKEN_BUCKET_BITS 20 // chain heads, reserved with mmap
+#define HOLD_TOKEN_BUCKETS (1u << HOLD_TOKEN_BUCKET_BITS)
+#define HOLD_TOKEN_STRIPES 64
+
+typedef struct hold_slot
+{
+    char holder_user_id[TB_ID_LEN];
+    tb_byte_t token[TB_TOKEN_LEN];
+    uint64_t token_len;
+    seat_ref_t owner; // 0 while free
+    uint32_t index;   // own index, for the deferred free
+    uint32_t gen;
+    uint32_t next_free;
+    uint32_t next_token; // token chain, 0 ends it
+    uint32_t prev_token; // 0 at the head; writers only
+    uint32_t bucket;     // token chain the slot is linked into
+    uint32_t pad;
+    hold_table_t *table;
+    tb_ebr_node_t retire;
+} hold_slot_t;
+
+#define HOLD_PAYLOAD_BYTES offsetof(hold_slot_t, owner)
+
+struct hold_table
+{
+    hold_slot_t *segs[HOLD_MAX_SEGS];
+    uint32_t hwm;       // next never-used index; 0 is reserved for "no slot"
+    uint64_t free_head; // (ABA tag << 32) | index
+    pthread_mutex_t grow_mtx;
+    uint32_t *token_heads; // HOLD_TOKEN_BUCKETS slot indices
+    tb_seat_lock_t token_locks[HOLD_TOKEN_STRIPES];
+};
+
+static void *region_map(size_t bytes);
+
+static inline uint32_t slot_index(uint32_t ref) { return ref >> HOLD_GEN_BITS; }
+
+static inline hold_slot_t *slot_at(const hold_table_t *t, uint32_t idx)
+{
+    hold_slot_t *seg = __atomic_load_n(&t->segs[idx >> HOLD_SEG_BITS], __ATOMIC_ACQUIRE);
+    return seg ? &seg[idx & (HOLD_SEG_SIZE - 1)] : NULL;
+}
+
+static hold_table_t *hold_table_create(void)
+{
+    hold_table_t *t = calloc(1, sizeof(*t));
+    if (!t)
+        return NULL;
+    t->token_heads = region_map(HOLD_TOKEN_BUCKETS * sizeof(uint32_t));
+    if (!t->token_heads)
+    {
+        free(t);
+        return NULL;
+    }
+    t->hwm = 1;
+    pthread_mutex_init(&t->grow_mtx, NULL);
+    for (size_t i = 0; i < HOLD_TOKEN_STRIPES; ++i)
+        tb_seat_lock_init(&t->token_locks[i]);
+    return t;
+}
+
+static void hold_table_destroy(hold_table_t *t)
+{
+    if (!t)
+        return;
+    for (size_t i = 0; i < HOLD_MAX_SEGS; ++i)
+        free(t->segs[i]);
+    munmap(t->token_heads, HOLD_TOKEN_BUCKETS * sizeof(uint32_t));
+    for (size_t i = 0; i < HOLD_TOKEN_STRIPES; ++i)
+        tb_seat_lock_destroy(&t->token_locks[i]);
+    pthread_mutex_destroy(&t->grow_mtx);
+    free(t);
+}
+
+static uint32_t hold_index_alloc(hold_table_t *t)
+{
+    uint64_t head = __atomic_load_n(&t->free_head, __ATOMIC_ACQUIRE);
+    while ((uint32_t)head != 0)
+    {
+        hold_slot_t *s = slot_at(t, (uint32_t)head);
+        uint64_t next = ((head >> 32) + 1) << 32 |
+                        __atomic_load_n(&s->next_free, __ATOMIC_RELAXED);
+        if (__atomic_compare_exchange_n(&t->free_head, &head, next, true,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+            return (uint32_t)head;
+    }
+
+    uint32_t idx = __atomic_fetch_add(&t->hwm, 1u, __ATOMIC_RELAXED);
+    if (idx >= HOLD_MAX_SEGS * HOLD_SEG_SIZE)
+        return 0;
+    uint32_t seg = idx >> HOLD_SEG_BITS;
+    if (!__atomic_load_n(&t->segs[seg], __ATOMIC_ACQUIRE))
+    {
+        pthread_mutex_lock(&t->grow_mtx);
+        if (!t->segs[seg])
+        {
+            hold_slot_t *mem = calloc(HOLD_SEG_SIZE, sizeof(hold_slot_t));
+            if (mem)
+                __atomic_store_n(&t->segs[seg], mem, __ATOMIC_RELEASE);
+        }
+        pthread_mutex_unlock(&t->grow_mtx);
+        if (!t->segs[seg])
+            return 0;
+    }
+    return idx;
+}
+
+static void hold_index_free(hold_table_t *t, uint32_t idx)
+{
+    hold_slot_t *s = slot_at(t, idx);
+    if (!s)
+        return;
+    __atomic_store_n(&s->owner, 0u, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->gen, s->gen + 1, __ATOMIC_RELAXED);
+    uint64_t head = __atomic_load_n(&t->free_head, __ATOMIC_RELAXED);
+    uint64_t next;
+    do
+    {
+        __atomic_store_n(&s->next_free, (uint32_t)head, __ATOMIC_RELAXED);
+        next = ((head >> 32) + 1) << 32 | idx;
+    } while (!__atomic_compare_exchange_n(&t->free_head, &head, next, true,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+static inline uint32_t token_bucket(const tb_byte_t *token, size_t len)
+{
+    return (uint32_t)(tb_hash_bytes(token, len, 0) >> (64 - HOLD_TOKEN_BUCKET_BITS));
+}
+
+static void token_link(hold_table_t *t, hold_slot_t *s, uint32_t idx, uint32_t bucket)
+{
+    tb_seat_lock_t *l = &t->token_locks[bucket % HOLD_TOKEN_STRIPES];
+    tb_seat_lock_acquire(l);
+    uint32_t next = t->token_heads[bucket];
+    s->bucket = bucket;
+    s->prev_token = 0;
+    __atomic_store_n(&s->next_token, next, __ATOMIC_RELAXED);
+    if (next != 0)
+        slot_at(t, next)->prev_token = idx;
+    __atomic_store_n(&t->token_heads[bucket], idx, __ATOMIC_RELEASE); // publishes the payload
+    tb_seat_lock_release(l);
+}
+
+static void token_unlink(hold_table_t *t, hold_slot_t *s)
+{
+    tb_seat_lock_t *l = &t->token_locks[s->bucket % HOLD_TOKEN_STRIPES];
+    tb_seat_lock_acquire(l);
+    uint32_t next = s->next_token;
+    uint32_t *link = s->prev_token ? &slot_at(t, s->prev_token)->next_token
+                                   : &t->token_heads[s->bucket];
+    __atomic_store_n(link, next, __ATOMIC_RELEASE);
+    if (next != 0)
+        slot_at(t, next)->prev_token = s->prev_token;
+    tb_seat_lock_release(l); // s keeps its next link for readers still on it
+}
+
+static void hold_slot_reclaim(tb_ebr_node_t *n)
+{
+    hold_slot_t *s = (hold_slot_t *)((char *)n - offsetof(hold_slot_t, retire));
+    hold_index_free(s->table, s->index);
+}
+
+// Free slot reference `slot` once no reader can still hold a state word
+// naming it or stand on it in a token chain.
+static void hold_slot_retire(seat_map_t *m, uint32_t slot)
+{
+    uint32_t idx = slot_index(slot);
+    hold_slot_t *s = idx != 0 ? slot_at(m->holds, idx) : NULL;
+    if (!s)
+        return;
+    __atomic_store_n(&s->owner, 0u, __ATOMIC_RELAXED);
+    token_unlink(m->holds, s);
+    s->table = m->holds;
+    s->index = idx;
+    tb_ebr_retire(&s->retire, hold_slot_reclaim);
+}
+
+uint32_t seat_hold_slot_alloc(seat_map_t *m, seat_ref_t r,
+                              const char *user_id,
+                              const tb_byte_t *token, size_t token_len)
+{
+    if (!m || r == 0)
+        return 0;
+    uint32_t idx = hold_index_alloc(m->holds);
+    if (idx == 0)
+        return 0;
+
+    hold_slot_t *s = slot_at(m->holds, idx);
+    hold_slot_t tmp;
+    memset(&tmp, 0, HOLD_PAYLOAD_BYTES);
+    if (user_id)
+        strncpy(tmp.holder_user_id, user_id, TB_ID_LEN - 1);
+    if (token_len > TB_TOKEN_LEN)
+        token_len = TB_TOKEN_LEN;
+    if (token)
+        memcpy(tmp.token, token, token_len);
+    tmp.token_len = token_len;
+    words_store(s, &tmp, HOLD_PAYLOAD_BYTES);
+    __atomic_store_n(&s->owner, r, __ATOMIC_RELAXED);
+    token_link(m->holds, s, idx, token_bucket(tmp.token, token_len));
+    // Published by the release CAS/exchange that installs the reference.
+    return idx << HOLD_GEN_BITS | (__atomic_load_n(&s->gen, __ATOMIC_RELAXED) & HOLD_GEN_MASK);
+}
+
+void seat_hold_slot_free(seat_map_t *m, uint32_t slot)
+{
+    if (m)
+        hold_slot_retire(m, slot); // token lookups may have seen it
+}
+
+/* ---- Event regions ----
+ * An event owns whole record segments and a power-of-two chain table keyed
+ * by seat. Segments are reserved with mmap, so a small event only touches the
+ * pages it uses and unloading returns them in one call. Growing the table
+ * relinks records in place; every intermediate state is a set of acyclic
+ * chains, and a reader that misses while the table changed under it retries.
+ *
+ * Readers walk chains without locks inside an EBR section (ebr.h). Writers
+ * that change an event's structure (insert, delete, grow, unload) take the
+ * event's mutex; whatever they unlink (a deleted record, an old chain table
+ * or segment list, the event itself) is retired and only reused or freed
+ * once no reader can still be looking at it. */
+
+#define EVENT_MIN_CHAINS 16u
+#define EVENT_MAX_DEFAULT_CHAINS 1024u
+
+typedef struct seat_chains
+{
+    size_t mask;
+    tb_ebr_node_t retire; // freed through EBR once replaced
+    seat_ref_t heads[];
+} seat_chains_t;
+
+// Segment ids of an event, in allocation order; replaced (and retired) as
+// a whole when it runs out of room.
+typedef struct
+{
+    tb_ebr_node_t retire;
+    uint32_t ids[];
+} seg_list_t;
+
+struct seat_event
+{
+    uint32_t event_ix;
+    seat_chains_t *chains;
+    uint32_t *segs; // ids[] of a seg_list_t
+    uint32_t nsegs;
+    uint32_t segs_cap;
+    uint32_t seg_used;    // records handed out from segs[nsegs - 1]
+    size_t records;       // records handed out, published for readers
+    seat_ref_t free_head; // reclaimed records, linked through hot.next
+    size_t count;         // live seats
+    pthread_mutex_t mtx;  // structural writers of this event
+    bool dead;            // unloaded; writers must look the event up again
+    seat_map_t *map;
+    tb_ebr_node_t retire;
+    uint32_t resize_seq;  // odd while the chain table is being rebuilt
+    uint32_t snap_mask;   // open snapshots, a bit per slot
+    seat_snapshot_t *snaps[SEAT_SNAP_SLOTS];
+    seat_row_t *rows;     // seating layout, NULL if none
+    uint32_t n_rows;
+    struct count_shard *counts; // seats by status, EVENT_COUNT_SHARDS shards
+    seat_price_index_t *prices; // NULL until the first price query
+    uint32_t price_epoch;       // bumped when a seat is added or repriced
+};
+
+static inline seat_cold_t *seat_map_cold(const seat_map_t *m, seat_ref_t r)
+{
+    return &m->cold[r >> SEAT_SEG_BITS][r & (SEAT_SEG_SIZE - 1)];
+}
+
+// Chain index of a seat within its event's table (splitmix64 finalizer).
+static inline size_t chain_of(const seat_chains_t *c, uint64_t key)
+{
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+    return (size_t)(key ^ (key >> 31)) & c->mask;
+}
+
+static inline seat_event_t *event_at(const seat_map_t *m, uint32_t ev)
+{
+    if ((ev >> SEAT_EVENT_PAGE_BITS) >= SEAT_EVENT_PAGES)
+        return NULL;
+    seat_event_t **page = __atomic_load_n(&m->events[ev >> SEAT_EVENT_PAGE_BITS], __ATOMIC_ACQUIRE);
+    return page ? __atomic_load_n(&page[ev & (SEAT_EVENT_PAGE_SIZE - 1)], __ATOMIC_ACQUIRE) : NULL;
+}
+
+// Event owning live record r.
+static inline seat_event_t *event_of(const seat_map_t *m, seat_ref_t r)
+{
+    return event_at(m, (uint32_t)(seat_map_hot(m, r)->key >> 32));
+}
+
+static void *region_map(size_t bytes)
+{
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+    flags |= MAP_NORESERVE;
+#endif
+    void *p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, flags, -1, 0);
+    return p == MAP_FAILED ? NULL : p;
+}
+
+static void free_chains(tb_ebr_node_t *n)
+{
+    free((char *)n - offsetof(seat_chains_t, retire));
+}
+
+static void free_seg_list(tb_ebr_node_t *n)
+{
+    free((char *)n - offsetof(seg_list_t, retire));
+}
+
+static inline seg_list_t *seg_list_of(uint32_t *ids)
+{
+    return ids ? (seg_list_t *)((char *)ids - offsetof(seg_list_t, ids)) : NULL;
+}
+
+static seat_chains_t *chains_create(size_t want)
+{
+    size_t n = EVENT_MIN_CHAINS;
+    while (n < want)
+        n <<= 1;
+    seat_chains_t *c = calloc(1, sizeof(*c) + n * sizeof(seat_ref_t));
+    if (c)
+        c->mask = n - 1;
+    return c;
+}
+
+// Add a segment to event e. Caller holds e->mtx (or owns a bulk load).
+// A full segment list is copied, not grown in place: readers may be
+// walking the old one.
+static bool event_add_segment(seat_map_t *m, seat_event_t *e)
+{
+    if (e->nsegs == e->segs_cap)
+    {
+        uint32_t cap = e->segs_cap ? e->segs_cap * 2 : 4;
+        seg_list_t *sl = malloc(sizeof(seg_list_t) + cap * sizeof(uint32_t));
+        if (!sl)
+            return false;
+        if (e->nsegs)
+            memcpy(sl->ids, e->segs, e->nsegs * sizeof(uint32_t));
+        seg_list_t *old = seg_list_of(e->segs);
+        __atomic_store_n(&e->segs, sl->ids, __ATOMIC_RELEASE);
+        e->segs_cap = cap;
+        if (old)
+            tb_ebr_retire(&old->retire, free_seg_list);
+    }
+
+    pthread_mutex_lock(&m->grow_mtx);
+    uint32_t id = 0;
+    if (m->seg_hwm < SEAT_MAX_SEGS)
+        id = m->seg_hwm++;
+    for (uint32_t i = 1; id == 0 && i < SEAT_MAX_SEGS; ++i)
+        if (!m->hot[i]) // reuse an id released by an unloaded event
+            id = i;
+    seat_hot_t *hot = id ? region_map(SEAT_SEG_SIZE * sizeof(seat_hot_t)) : NULL;
+    seat_cold_t *cold = hot ? region_map(SEAT_SEG_SIZE * sizeof(seat_cold_t)) : NULL;
+    uint64_t *avail = cold ? calloc(SEAT_SEG_SIZE / 64, sizeof(uint64_t)) : NULL;
+    if (avail)
+    {
+        m->cold[id] = cold;
+        m->avail[id] = avail;
+        __atomic_store_n(&m->hot[id], hot, __ATOMIC_RELEASE);
+    }
+    else
+    {
+        if (cold)
+            munmap(cold, SEAT_SEG_SIZE * sizeof(seat_cold_t));
+        if (hot)
+            munmap(hot, SEAT_SEG_SIZE * sizeof(seat_hot_t));
+    }
+    pthread_mutex_unlock(&m->grow_mtx);
+    if (!avail)
+        return false;
+
+    m->seg_pos[id] = (uint16_t)e->nsegs;
+    e->segs[e->nsegs++] = id;
+    e->seg_used = 0;
+    return true;
+}
+
+// Publish the records handed out so far to readers.
+static inline void event_publish_records(seat_event_t *e)
+{
+    size_t n = e->nsegs ? (size_t)(e->nsegs - 1) * SEAT_SEG_SIZE + e->seg_used : 0;
+    __atomic_store_n(&e->records, n, __ATOMIC_RELEASE);
+}
+
+/* ---- Event counters ----
+ * Seats of an event by status, as deltas in per-thread shards: a transition
+ * adds to the shard of the thread making it, and a reader sums the shards.
+ * Shard deltas may go negative (a thread that only sells); the sums never
+ * do once writers settle. */
+
+#define EVENT_COUNT_SHARDS 16u
+#define SEAT_STATUSES 4
+#define STATUS_NONE (-1) // record not (or no longer) a live seat
+
+struct count_shard
+{
+    _Alignas(64) int64_t by_status[SEAT_STATUSES];
+};
+
+static uint32_t g_threads;
+static __thread uint32_t t_thread_slot; // 1-based, 0 = unassigned
+
+// Small per-thread number that spreads threads over shards.
+static inline uint32_t thread_slot(void)
+{
+    if (t_thread_slot == 0)
+        t_thread_slot = __atomic_add_fetch(&g_threads, 1, __ATOMIC_RELAXED);
+    return t_thread_slot;
+}
+
+static struct count_shard *counts_create(void)
+{
+    struct count_shard *c = aligned_alloc(_Alignof(struct count_shard),
+                                          EVENT_COUNT_SHARDS * sizeof(struct count_shard));
+    if (c)
+        memset(c, 0, EVENT_COUNT_SHARDS * sizeof(struct count_shard));
+    return c;
+}
+
+// Move `n` seats of event e from one status to another (STATUS_NONE for a
+// seat that appears or goes away).
+static inline void count_move(seat_event_t *e, int from, int to, int64_t n)
+{
+    if (from == to || !e)
+        return;
+    struct count_shard *c = &e->counts[thread_slot() % EVENT_COUNT_SHARDS];
+    if (from != STATUS_NONE)
+        __atomic_fetch_sub(&c->by_status[from], n, __ATOMIC_RELAXED);
+    if (to != STATUS_NONE)
+        __atomic_fetch_add(&c->by_status[to], n, __ATOMIC_RELAXED);
+}
+
+static seat_event_t *event_create(seat_map_t *m, uint32_t ev, size_t expected_seats)
+{
+    if ((ev >> SEAT_EVENT_PAGE_BITS) >= SEAT_EVENT_PAGES)
+        return NULL;
+    seat_event_t *e = calloc(1, sizeof(*e));
+    if (!e || !(e->chains = chains_create(expected_seats)) || !(e->counts = counts_create()))
+    {
+        if (e)
+            free(e->chains);
+        free(e);
+        return NULL;
+    }
+    e->event_ix = ev;
+    e->map = m;
+    pthread_mutex_init(&e->mtx, NULL);
+
+    // Publish unless a racing writer created the event first.
+    pthread_mutex_lock(&m->grow_mtx);
+    seat_event_t **page = m->events[ev >> SEAT_EVENT_PAGE_BITS];
+    if (!page && (page = calloc(SEAT_EVENT_PAGE_SIZE, sizeof(seat_event_t *))) != NULL)
+        __atomic_store_n(&m->events[ev >> SEAT_EVENT_PAGE_BITS], page, __ATOMIC_RELEASE);
+    seat_event_t *cur = page ? page[ev & (SEAT_EVENT_PAGE_SIZE - 1)] : NULL;
+    if (page && !cur)
+        __atomic_store_n(&page[ev & (SEAT_EVENT_PAGE_SIZE - 1)], e, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&m->grow_mtx);
+    if (page && !cur)
+        return e;
+    pthread_mutex_destroy(&e->mtx);
+    free(e->counts);
+    free(e->chains);
+    free(e);
+    return cur;
+}
+
+// Quadruple the chain table once the event averages two seats per chain.
+// resize_seq is odd while records are being relinked. Caller holds e->mtx.
+static void event_maybe_grow(seat_map_t *m, seat_event_t *e)
+{
+    seat_chains_t *old = e->chains;
+    if (__atomic_load_n(&e->count, __ATOMIC_RELAXED) <= 2 * (old->mask + 1))
+        return;
+    seat_chains_t *c = chains_create(4 * (old->mask + 1));
+    if (!c)
+        return; // keep the longer chains
+
+    __atomic_store_n(&e->resize_seq, e->resize_seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for (size_t b = 0; b <= old->mask; ++b)
+    {
+        seat_ref_t r = old->heads[b];
+        while (r != 0)
+        {
+            seat_hot_t *h = seat_map_hot(m, r);
+            seat_ref_t next = h->next;
+            size_t idx = chain_of(c, h->key);
+            __atomic_store_n(&h->next, c->heads[idx], __ATOMIC_RELAXED);
+            c->heads[idx] = r;
+            r = next;
+        }
+    }
+    __atomic_store_n(&e->chains, c, __ATOMIC_RELEASE);
+    __atomic_store_n(&e->resize_seq, e->resize_seq + 1, __ATOMIC_RELEASE);
+    tb_ebr_retire(&old->retire, free_chains);
+}
+
+// Records handed out so far, live or on the free list.
+static inline size_t event_records(const seat_event_t *e)
+{
+    return __atomic_load_n(&e->records, __ATOMIC_ACQUIRE);
+}
+
+// Id of segment k of event e.
+static inline uint32_t event_seg(const seat_event_t *e, size_t k)
+{
+    return __atomic_load_n(&e->segs, __ATOMIC_ACQUIRE)[k];
+}
+
+// Record i of event e, counting in allocation order, and the reverse.
+static inline seat_ref_t event_ref(const seat_event_t *e, size_t i)
+{
+    return event_seg(e, i >> SEAT_SEG_BITS) << SEAT_SEG_BITS | (seat_ref_t)(i & (SEAT_SEG_SIZE - 1));
+}
+
+static inline size_t event_pos(const seat_map_t *m, seat_ref_t r)
+{
+    return (size_t)m->seg_pos[r >> SEAT_SEG_BITS] << SEAT_SEG_BITS | (r & (SEAT_SEG_SIZE - 1));
+}
+
+// Hand out a record of event e: recycled from deletes first, else the next
+// unused record of its newest segment. Caller holds e->mtx.
+static seat_ref_t seat_ref_alloc(seat_map_t *m, seat_event_t *e)
+{
+    seat_ref_t r = e->free_head;
+    if (r != 0)
+    {
+        e->free_head = seat_map_hot(m, r)->next;
+        return r;
+    }
+    if ((e->nsegs == 0 || e->seg_used == SEAT_SEG_SIZE) && !event_add_segment(m, e))
+        return 0;
+    r = e->segs[e->nsegs - 1] << SEAT_SEG_BITS | e->seg_used++;
+    event_publish_records(e);
+    return r;
+}
+
+/* ---- Availability bits ----
+ * A record's bit sits in its segment's bitmap at the record's offset, so
+ * position p of an event is bit p % 64 of word p / 64 of the event's bitmap
+ * words taken in segment order. Writers update bits after changing the
+ * state word; readers load the words without synchronising with them. */
+
+static inline uint64_t *avail_word(const seat_map_t *m, seat_ref_t r)
+{
+    return &m->avail[r >> SEAT_SEG_BITS][(r & (SEAT_SEG_SIZE - 1)) >> 6];
+}
+
+static void price_sync(seat_map_t *m, seat_event_t *e, seat_ref_t r);
+
+// Make r's bit (in e's bitmap and price index) match its state word. Racing
+// writers of one seat may store their bits out of order, but each re-reads
+// the state after its store and goes round again if the status moved, so
+// the last store is a right one.
+static void avail_sync(seat_map_t *m, seat_event_t *e, seat_ref_t r)
+{
+    const seat_hot_t *h = seat_map_hot(m, r);
+    uint64_t *word = avail_word(m, r);
+    uint64_t bit = 1ull << (r & 63);
+    for (;;)
+    {
+        seat_status_t st = seat_state_status(__atomic_load_n(&h->state, __ATOMIC_SEQ_CST));
+        bool on = st == SEAT_AVAILABLE;
+        if (((__atomic_load_n(word, __ATOMIC_SEQ_CST) & bit) != 0) == on)
+            break;
+        if (on)
+            __atomic_fetch_or(word, bit, __ATOMIC_SEQ_CST);
+        else
+            __atomic_fetch_and(word, ~bit, __ATOMIC_SEQ_CST);
+        if (seat_state_status(__atomic_load_n(&h->state, __ATOMIC_SEQ_CST)) == st)
+            break;
+    }
+    price_sync(m, e, r);
+}
+
+// A seat was added or repriced: the next price query rebuilds the index.
+static inline void price_touch(seat_event_t *e)
+{
+    __atomic_add_fetch(&e->price_epoch, 1, __ATOMIC_SEQ_CST);
+}
+
+// Bitmap word q of event e (positions 64q .. 64q + 63).
+static inline uint64_t event_avail_word(const seat_map_t *m, const seat_event_t *e, size_t q)
+{
+    const uint64_t *bits = m->avail[event_seg(e, q >> (SEAT_SEG_BITS - 6))];
+    return __atomic_load_n(&bits[q & (SEAT_SEG_SIZE / 64 - 1)], __ATOMIC_RELAXED);
+}
+
+// Put record r back on e's free list. Caller holds e->mtx, and no reader
+// may still reach r.
+static void seat_ref_release(seat_map_t *m, seat_event_t *e, seat_ref_t r)
+{
+    seat_hot_t *h = seat_map_hot(m, r);
+    __atomic_fetch_and(avail_word(m, r), ~(1ull << (r & 63)), __ATOMIC_RELAXED);
+    tb_seat_lock_destroy(&h->lock);
+    h->key = 0;
+    h->state = 0;
+    h->next = e->free_head;
+    e->free_head = r;
+}
+
+/* ---- Price index ----
+ * Ranks are an event's seats as of the build, in ascending price with ties
+ * in position order. bits has a bit per rank kept like the availability
+ * bits (price_sync runs from avail_sync); summary has a bit per word of
+ * bits, set while the word may be nonzero, so a walk skips 64 sold ranks
+ * per clear bit. Apart from the bits an index never changes: a rebuild
+ * publishes a new one and retires the old through EBR. Its epoch is the
+ * event's price_epoch from before the build read any price, so a seat
+ * added or repriced meanwhile still leaves the new index out of date. */
+
+#define PRICE_UNRANKED UINT32_MAX
+#define PRICE_SIGN 0x80000000u // flips a price's sign bit so keys sort as unsigned
+
+struct seat_price_index
+{
+    tb_ebr_node_t retire;
+    uint32_t epoch;
+    size_t records;               // positions covered
+    size_t ranks;                 // seats indexed
+    uint32_t *pos_of;             // rank -> position
+    uint32_t *rank_of;            // position -> rank, PRICE_UNRANKED if none
+    size_t n_tiers;
+    tb_money_cents_t *tier_price; // distinct prices, ascending
+    uint32_t *tier_first;         // first rank of each tier, then `ranks`
+    uint64_t *bits;               // a bit per rank, set while AVAILABLE
+    uint64_t *summary;            // a bit per word of bits
+};
+
+// Words of bits for n ranks (one spare, so even an empty index has one).
+static inline size_t price_words(size_t n)
+{
+    return n / 64 + 1;
+}
+
+static void price_index_free(seat_price_index_t *px)
+{
+    if (!px)
+        return;
+    free(px->pos_of);
+    free(px->rank_of);
+    free(px->tier_price);
+    free(px->tier_first);
+    free(px->bits);
+    free(px->summary);
+    free(px);
+}
+
+static void price_index_reclaim(tb_ebr_node_t *n)
+{
+    price_index_free((seat_price_index_t *)((char *)n - offsetof(seat_price_index_t, retire)));
+}
+
+static size_t price_index_bytes(const seat_price_index_t *px)
+{
+    if (!px)
+        return 0;
+    size_t words = price_words(px->ranks);
+    return sizeof(*px) + (px->records + px->ranks) * sizeof(uint32_t) +
+           px->n_tiers * sizeof(tb_money_cents_t) + (px->n_tiers + 1) * sizeof(uint32_t) +
+           (words + words / 64 + 1) * sizeof(uint64_t);
+}
+
+// Make r's rank bit in e's index (if it has one) match the state word, the
+// way avail_sync does. A summary bit is cleared only by the writer that
+// emptied its word, which sets it again if a racing writer refilled the
+// word in between.
+static void price_sync(seat_map_t *m, seat_event_t *e, seat_ref_t r)
+{
+    seat_price_index_t *px = __atomic_load_n(&e->prices, __ATOMIC_SEQ_CST);
+    size_t pos = px ? event_pos(m, r) : 0;
+    if (!px || pos >= px->records || px->rank_of[pos] == PRICE_UNRANKED)
+        return;
+    size_t k = px->rank_of[pos];
+    const seat_hot_t *h = seat_map_hot(m, r);
+    uint64_t *word = &px->bits[k / 64], bit = 1ull << (k & 63);
+    uint64_t *sum = &px->summary[k / 4096], sum_bit = 1ull << ((k / 64) & 63);
+    for (;;)
+    {
+        seat_status_t st = seat_state_status(__atomic_load_n(&h->state, __ATOMIC_SEQ_CST));
+        bool on = st == SEAT_AVAILABLE;
+        if (((__atomic_load_n(word, __ATOMIC_SEQ_CST) & bit) != 0) == on)
+            return;
+        if (on)
+        {
+            __atomic_fetch_or(word, bit, __ATOMIC_SEQ_CST);
+            __atomic_fetch_or(sum, sum_bit, __ATOMIC_SEQ_CST);
+        }
+        else if (__atomic_and_fetch(word, ~bit, __ATOMIC_SEQ_CST) == 0)
+        {
+            __atomic_fetch_and(sum, ~sum_bit, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(word, __ATOMIC_SEQ_CST) != 0)
+                __atomic_fetch_or(sum, sum_bit, __ATOMIC_SEQ_CST);
+        }
+        if (seat_state_status(__atomic_load_n(&h->state, __ATOMIC_SEQ_CST)) == st)
+            return;
+    }
+}
+
+// Stable sort of (price << 32 | position) keys by price, a byte per pass;
+// a pass where every key has the same byte is skipped, so prices that fit
+// in two bytes take two passes.
+static void sort_by_price(uint64_t *keys, uint64_t *tmp, size_t n)
+{
+    for (unsigned shift = 32; n > 0 && shift < 64; shift += 8)
+    {
+        size_t at[257] = {0};
+        for (size_t i = 0; i < n; ++i)
+            at[((keys[i] >> shift) & 0xff) + 1]++;
+        if (at[((keys[0] >> shift) & 0xff) + 1] == n)
+            continue;
+        for (unsigned b = 0; b < 256; ++b)
+            at[b + 1] += at[b];
+        for (size_t i = 0; i < n; ++i)
+            tmp[at[(keys[i] >> shift) & 0xff]++] = keys[i];
+        memcpy(keys, tmp, n * sizeof *keys);
+    }
+}
+
+// Build an index of e's live seats, publish it and retire the old one.
+// Caller holds e->mtx and is inside an EBR section. NULL when out of memory.
+static seat_price_index_t *price_build(seat_map_t *m, seat_event_t *e)
+{
+    uint32_t epoch = __atomic_load_n(&e->price_epoch, __ATOMIC_SEQ_CST);
+    size_t records = event_records(e);
+    if (records >= PRICE_UNRANKED)
+        return NULL;
+    seat_price_index_t *px = calloc(1, sizeof *px);
+    uint64_t *keys = malloc((records + 1) * sizeof(uint64_t));
+    uint64_t *tmp = malloc((records + 1) * sizeof(uint64_t));
+    bool ok = px && keys && tmp && (px->rank_of = malloc((records + 1) * sizeof(uint32_t)));
+    size_t n = 0, tiers = 0;
+    for (size_t pos = 0; ok && pos < records; ++pos)
+    {
+        seat_ref_t r = event_ref(e, pos);
+        const seat_hot_t *h = seat_map_hot(m, r);
+        px->rank_of[pos] = PRICE_UNRANKED;
+        if (!__atomic_load_n(&h->key, __ATOMIC_RELAXED) ||
+            seat_state_gone(__atomic_load_n(&h->state, __ATOMIC_ACQUIRE)))
+            continue;
+        tb_money_cents_t price = __atomic_load_n(&seat_map_cold(m, r)->price_cents, __ATOMIC_RELAXED);
+        keys[n++] = (uint64_t)((uint32_t)price ^ PRICE_SIGN) << 32 | pos;
+    }
+    if (ok)
+    {
+        sort_by_price(keys, tmp, n);
+        for (size_t k = 0; k < n; ++k)
+            tiers += k == 0 || keys[k] >> 32 != keys[k - 1] >> 32;
+        size_t words = price_words(n);
+        px->pos_of = malloc((n + 1) * sizeof(uint32_t));
+        px->tier_price = malloc((tiers + 1) * sizeof(tb_money_cents_t));
+        px->tier_first = malloc((tiers + 1) * sizeof(uint32_t));
+        px->bits = calloc(words, sizeof(uint64_t));
+        px->summary = calloc(words / 64 + 1, sizeof(uint64_t));
+        ok = px->pos_of && px->tier_price && px->tier_first && px->bits && px->summary;
+    }
+    if (ok)
+    {
+        px->epoch = epoch;
+        px->records = records;
+        px->ranks = n;
+        px->n_tiers = tiers;
+        for (size_t k = 0, t = 0; k < n; ++k)
+        {
+            uint32_t pos = (uint32_t)keys[k];
+            px->pos_of[k] = pos;
+            px->rank_of[pos] = (uint32_t)k;
+            if (k == 0 || keys[k] >> 32 != keys[k - 1] >> 32)
+            {
+                px->tier_price[t] = (tb_money_cents_t)((uint32_t)(keys[k] >> 32) ^ PRICE_SIGN);
+                px->tier_first[t++] = (uint32_t)k;
+            }
+        }
+        px->tier_first[tiers] = (uint32_t)n;
+    }
+    free(keys);
+    free(tmp);
+    if (!ok)
+    {
+        price_index_free(px);
+        return NULL;
+    }
+
+    // Publish, then sync every rank: a writer that moved a seat before it
+    // could see the new index is caught here, any later one syncs itself.
+    seat_price_index_t *old = e->prices;
+    __atomic_store_n(&e->prices, px, __ATOMIC_SEQ_CST);
+    for (size_t k = 0; k < n; ++k)
+        price_sync(m, e, event_ref(e, px->pos_of[k]));
+    if (old)
+        tb_ebr_retire(&old->retire, price_index_reclaim);
+    return px;
+}
+
+// e's index, rebuilt first if a seat was added or repriced since it was
+// built. Caller is inside an EBR section. NULL if e was unloaded meanwhile
+// or out of memory.
+static const seat_price_index_t *price_index(seat_map_t *m, seat_event_t *e)
+{
+    const seat_price_index_t *px = __atomic_load_n(&e->prices, __ATOMIC_ACQUIRE);
+    if (px && px->epoch == __atomic_load_n(&e->price_epoch, __ATOMIC_SEQ_CST))
+        return px;
+    pthread_mutex_lock(&e->mtx);
+    px = e->dead ? NULL : e->prices;
+    if (!e->dead && (!px || px->epoch != __atomic_load_n(&e->price_epoch, __ATOMIC_SEQ_CST)))
+        px = price_build(m, e);
+    pthread_mutex_unlock(&e->mtx);
+    return px;
+}
+
+/* ---- Write gate ----
+ * Every in-place write to a seat runs inside the gate, which makes opening a
+ * snapshot a handshake: publish it, then flip the gate phase and wait for
+ * writers that entered under the old phase (and so may have missed it) to
+ * leave. Writers count themselves in one of a few cache-line shards per
+ * phase, so entering never contends across threads. */
+
+#define GATE_SHARDS 16u
+
+typedef struct
+{
+    _Alignas(64) uint32_t active[2]; // writers inside, per phase
+} gate_shard_t;
+
+struct seat_gate
+{
+    gate_shard_t shards[GATE_SHARDS];
+    uint32_t phase;
+    pthread_mutex_t mtx; // serialises snapshot open/close
+};
+
+static inline uint32_t *gate_counter(seat_map_t *m, uint32_t phase)
+{
+    return &m->gate->shards[thread_slot() % GATE_SHARDS].active[phase];
+}
+
+// Returns the phase entered under, for gate_exit.
+static inline uint32_t gate_enter(seat_map_t *m)
+{
+    for (;;)
+    {
+        uint32_t p = __atomic_load_n(&m->gate->phase, __ATOMIC_RELAXED) & 1u;
+        uint32_t *c = gate_counter(m, p);
+        __atomic_fetch_add(c, 1, __ATOMIC_SEQ_CST);
+        if ((__atomic_load_n(&m->gate->phase, __ATOMIC_SEQ_CST) & 1u) == p)
+            return p;
+        __atomic_fetch_sub(c, 1, __ATOMIC_RELEASE); // raced a flip; retry under the new phase
+    }
+}
+
+static inline void gate_exit(seat_map_t *m, uint32_t phase)
+{
+    __atomic_fetch_sub(gate_counter(m, phase), 1, __ATOMIC_RELEASE);
+}
+
+// Wait out every writer already inside. Caller holds gate->mtx.
+static void gate_sync(seat_map_t *m)
+{
+    uint32_t old = __atomic_fetch_add(&m->gate->phase, 1, __ATOMIC_SEQ_CST) & 1u;
+    for (uint32_t i = 0; i < GATE_SHARDS; ++i)
+        while (__atomic_load_n(&m->gate->shards[i].active[old], __ATOMIC_ACQUIRE) != 0)
+            sched_yield();
+}
+
+static void snap_preserve(seat_map_t *m, seat_event_t *e, seat_ref_t r);
+
+/* ---- Seqlock record copies ----
+ * hot.version is the seqlock sequence covering the cold record and the state
+ * word; lock-free CAS transitions only move the state word. */
+
+_Static_assert(sizeof(seat_cold_t) % sizeof(uint64_t) == 0, "seat_cold_t must be word-sized");
+_Static_assert(sizeof(hold_slot_t) % sizeof(uint64_t) == 0, "hold_slot_t must be word-sized");
+
+// Encode the hold fields of `seat` as a state word (allocating a slot if HELD).
+static uint64_t state_from_seat(seat_map_t *m, seat_ref_t r, const seat_t *seat)
+{
+    uint32_t slot = 0;
+    if (seat->status == SEAT_HELD)
+        slot = seat_hold_slot_alloc(m, r, seat->holder_user_id,
+                                    seat->hold_token, seat->hold_token_len);
+    return seat_state_make(seat->status, slot, seat->hold_expires_unix);
+}
+
+static void cold_from_seat(seat_cold_t *c, const seat_t *seat)
+{
+    memset(c, 0, sizeof(*c));
+    c->price_cents = seat->price_cents;
+    memcpy(c->last_order_id, seat->last_order_id, TB_ID_LEN);
+    c->last_order_id[TB_ID_LEN - 1] = '\0';
+    c->updated_unix = seat->updated_unix;
+}
+
+// False if the seat was deleted under the caller (nothing is written).
+static bool seat_write(seat_map_t *m, seat_ref_t r, const seat_t *seat)
+{
+    seat_hot_t *h = seat_map_hot(m, r);
+    seat_cold_t tmp;
+    cold_from_seat(&tmp, seat);
+    uint64_t nw = state_from_seat(m, r, seat);
+    seat_event_t *e = event_of(m, r);
+    tb_money_cents_t was = __atomic_load_n(&seat_map_cold(m, r)->price_cents, __ATOMIC_RELAXED);
+
+    uint32_t gp = gate_enter(m);
+    snap_preserve(m, e, r);
+    uint32_t v = __atomic_load_n(&h->version, __ATOMIC_RELAXED);
+    __atomic_store_n(&h->version, v + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    uint64_t old = __atomic_load_n(&h->state, __ATOMIC_ACQUIRE);
+    bool live = !seat_state_gone(old);
+    if (live)
+    {
+        words_store(seat_map_cold(m, r), &tmp, sizeof tmp);
+        while (!__atomic_compare_exchange_n(&h->state, &old, nw, true, __ATOMIC_ACQ_REL,
+                                            __ATOMIC_ACQUIRE))
+            if ((live = !seat_state_gone(old)) == false)
+                break;
+    }
+    __atomic_store_n(&h->version, v + 2, __ATOMIC_RELEASE);
+    gate_exit(m, gp);
+    if (!live)
+    {
+        seat_hold_slot_free(m, seat_state_slot(nw));
+        return false;
+    }
+    hold_slot_retire(m, seat_state_slot(old));
+    count_move(e, (int)seat_state_status(old), (int)seat_state_status(nw), 1);
+    if (tmp.price_cents != was)
+        price_touch(e);
+    avail_sync(m, e, r);
+    return true;
+}
+
+// False if the seat was deleted (*out is then zeroed).
+static bool seat_read(const seat_map_t *m, seat_ref_t r, seat_t *out)
+{
+    const seat_hot_t *h = seat_map_hot(m, r);
+    for (;;)
+    {
+        uint32_t v1 = __atomic_load_n(&h->version, __ATOMIC_ACQUIRE);
+        if (v1 & 1u)
+            continue; // writer mid-copy
+        seat_cold_t c;
+        words_load(&c, seat_map_cold(m, r), sizeof c);
+        uint64_t w = __atomic_load_n(&h->state, __ATOMIC_ACQUIRE);
+        seat_hold_t hold;
+        bool hold_ok = true;
+        if (seat_state_status(w) == SEAT_HELD)
+            hold_ok = seat_state_hold(m, r, w, &hold);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (!hold_ok || __atomic_load_n(&h->version, __ATOMIC_RELAXED) != v1)
+            continue;
+
+        memset(out, 0, sizeof(*out));
+        if (seat_state_gone(w))
+            return false;
+        const char *ev = tb_intern_name(TB_NS_EVENT, (uint32_t)(h->key >> 32));
+        const char *sid = tb_intern_name(TB_NS_SEAT, (uint32_t)h->key);
+        if (ev)
+            memcpy(out->event_id, ev, TB_ID_LEN);
+        if (sid)
+            memcpy(out->seat_id, sid, TB_ID_LEN);
+        out->price_cents = c.price_cents;
+        memcpy(out->last_order_id, c.last_order_id, TB_ID_LEN);
+        out->updated_unix = c.updated_unix;
+        out->version = v1;
+        out->status = seat_state_status(w);
+        out->hold_expires_unix = seat_state_expires(w);
+        if (out->status == SEAT_HELD)
+        {
+            memcpy(out->holder_user_id, hold.holder_user_id, TB_ID_LEN);
+            memcpy(out->hold_token, hold.token, TB_TOKEN_LEN);
+            out->hold_token_len = hold.token_len;
+        }
+        return true;
+    }
+}
+
+bool seat_map_read(const seat_map_t *m, seat_ref_t r, seat_t *out)
+{
+    return seat_read(m, r, out);
+}
+
+bool seat_state_hold(const seat_map_t *m, seat_ref_t r,
+                     uint64_t w, seat_hold_t *out)
+{
+    uint32_t idx = slot_index(seat_state_slot(w));
+    if (!m || r == 0 || !out)
+        return false;
+    hold_slot_t tmp;
+    memset(&tmp, 0, HOLD_PAYLOAD_BYTES);
+    if (idx != 0) // a HELD word without a slot (table exhausted) has no holder data
+    {
+        const hold_slot_t *s = slot_at(m->holds, idx);
+        if (!s)
+            return false;
+        words_load(&tmp, s, HOLD_PAYLOAD_BYTES);
+    }
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&seat_map_hot(m, r)->state, __ATOMIC_RELAXED) != w)
+        return false;
+    memcpy(out->holder_user_id, tmp.holder_user_id, TB_ID_LEN);
+    out->holder_user_id[TB_ID_LEN - 1] = '\0';
+    memcpy(out->token, tmp.token, TB_TOKEN_LEN);
+    out->token_len = tmp.token_len > TB_TOKEN_LEN ? TB_TOKEN_LEN : (size_t)tmp.token_len;
+    return true;
+}
+
+bool seat_state_cas(seat_map_t *m, seat_ref_t r, uint64_t expected, uint64_t desired)
+{
+    if (seat_state_gone(expected) || seat_state_gone(desired))
+        return false; // only a delete moves a seat to or from GONE
+    seat_event_t *e = event_of(m, r);
+    uint32_t gp = gate_enter(m);
+    snap_preserve(m, e, r);
+    bool ok = __atomic_compare_exchange_n(&seat_map_hot(m, r)->state, &expected, desired, false,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    gate_exit(m, gp);
+    if (!ok)
+        return false;
+    if (seat_state_slot(expected) != seat_state_slot(desired))
+        hold_slot_retire(m, seat_state_slot(expected));
+    count_move(e, (int)seat_state_status(expected), (int)seat_state_status(desired), 1);
+    if ((seat_state_status(expected) == SEAT_AVAILABLE) != (seat_state_status(desired) == SEAT_AVAILABLE))
+        avail_sync(m, e, r);
+    return true;
+}
+
+/* ---- Lifecycle ---- */
+
+seat_map_t *seat_map_create(size_t capacity)
+{
+    seat_map_t *map = calloc(1, sizeof(seat_map_t));
+    if (!map)
+        return NULL;
+    map->chains_hint = capacity < EVENT_MAX_DEFAULT_CHAINS ? capacity : EVENT_MAX_DEFAULT_CHAINS;
+    map->holds = hold_table_create();
+    map->gate = aligned_alloc(_Alignof(seat_gate_t), sizeof(seat_gate_t));
+    map->seg_hwm = 1;
+    pthread_mutex_init(&map->grow_mtx, NULL);
+    if (map->gate)
+    {
+        memset(map->gate, 0, sizeof(seat_gate_t));
+        pthread_mutex_init(&map->gate->mtx, NULL);
+    }
+    if (!map->holds || !map->gate)
+    {
+        seat_map_destroy(map);
+        return NULL;
+    }
+    return map;
+}
+
+// Release everything event e owns. One sequential sweep of its hot records
+// frees hold slots (and pthread locks); segments go back with munmap. No
+// reader may still reach e.
+static void event_release(seat_map_t *m, seat_event_t *e)
+{
+    for (uint32_t i = 0; i < e->nsegs; ++i)
+    {
+        uint32_t id = e->segs[i];
+        uint32_t used = i + 1 == e->nsegs ? e->seg_used : SEAT_SEG_SIZE;
+        seat_hot_t *hot = m->hot[id];
+        for (uint32_t j = 0; j < used; ++j)
+        {
+            if (hot[j].key == 0)
+                continue; // deleted
+            if (!seat_state_gone(hot[j].state))
+                seat_hold_slot_free(m, seat_state_slot(hot[j].state));
+            tb_seat_lock_destroy(&hot[j].lock);
+        }
+        pthread_mutex_lock(&m->grow_mtx);
+        __atomic_store_n(&m->hot[id], NULL, __ATOMIC_RELEASE);
+        munmap(hot, SEAT_SEG_SIZE * sizeof(seat_hot_t));
+        munmap(m->cold[id], SEAT_SEG_SIZE * sizeof(seat_cold_t));
+        free(m->avail[id]);
+        m->cold[id] = NULL;
+        m->avail[id] = NULL;
+        pthread_mutex_unlock(&m->grow_mtx);
+    }
+    free(e->chains);
+    free(e->rows);
+    free(e->counts);
+    price_index_free(e->prices);
+    free(seg_list_of(e->segs));
+    pthread_mutex_destroy(&e->mtx);
+    free(e);
+}
+
+static void event_reclaim(tb_ebr_node_t *n)
+{
+    seat_event_t *e = (seat_event_t *)((char *)n - offsetof(seat_event_t, retire));
+    event_release(e->map, e);
+}
+
+// Stop every seat of e (as a delete does) and give back its hold slot, so
+// that neither the chains nor the hold slot table lead new readers to e's
+// records. Caller holds e->mtx and has unpublished e.
+static void event_stop_seats(seat_map_t *m, seat_event_t *e)
+{
+    size_t records = event_records(e);
+    for (size_t i = 0; i < records; ++i)
+    {
+        seat_hot_t *h = seat_map_hot(m, event_ref(e, i));
+        if (h->key == 0)
+            continue;
+        uint64_t w = __atomic_load_n(&h->state, __ATOMIC_ACQUIRE);
+        while (!seat_state_gone(w))
+        {
+            if (seat_state_pinned(w))
+            {
+                sched_yield(); // a confirm is finishing
+                w = __atomic_load_n(&h->state, __ATOMIC_ACQUIRE);
+            }
+            else if (__atomic_compare_exchange_n(&h->state, &w, SEAT_STATE_GONE, false,
+                                                 __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            {
+                hold_slot_retire(m, seat_state_slot(w));
+                break;
+            }
+        }
+    }
+}
+
+// Unpublish event e and retire it: readers may still be inside. False if
+// another writer dropped it first.
+static bool event_drop(seat_map_t *m, seat_event_t *e)
+{
+    pthread_mutex_lock(&e->mtx);
+    bool first = !e->dead;
+    if (first)
+    {
+        e->dead = true;
+        pthread_mutex_lock(&m->grow_mtx);
+        seat_event_t **page = m->events[e->event_ix >> SEAT_EVENT_PAGE_BITS];
+        __atomic_store_n(&page[e->event_ix & (SEAT_EVENT_PAGE_SIZE - 1)], NULL, __ATOMIC_RELEASE);
+        pthread_mutex_unlock(&m->grow_mtx);
+        __atomic_sub_fetch(&m->count, __atomic_load_n(&e->count, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+        event_stop_seats(m, e);
+    }
+    pthread_mutex_unlock(&e->mtx);
+    if (first)
+        tb_ebr_retire(&e->retire, event_reclaim);
+    return first;
+}
+
+void seat_map_destroy(seat_map_t *m)
+{
+    if (!m)
+        return;
+
+    tb_ebr_barrier(); // finish deferred frees of this map's records, events and hold slots
+
+    for (size_t p = 0; p < SEAT_EVENT_PAGES; ++p)
+    {
+        seat_event_t **page = m->events[p];
+        if (!page)
+            continue;
+        for (size_t i = 0; i < SEAT_EVENT_PAGE_SIZE; ++i)
+            if (page[i])
+                event_release(m, page[i]);
+        free(page);
+    }
+
+    tb_ebr_barrier(); // the hold slots those events gave back
+    hold_table_destroy(m->holds);
+    if (m->gate)
+        pthread_mutex_destroy(&m->gate->mtx);
+    free(m->gate);
+    pthread_mutex_destroy(&m->grow_mtx);
+    free(m);
+}
+
+// Record h holds seat `key` and has not been deleted.
+static inline bool hot_matches(const seat_hot_t *h, uint64_t key)
+{
+    return h->key == key && !seat_state_gone(__atomic_load_n(&h->state, __ATOMIC_RELAXED));
+}
+
+// Walk a chain of the seat's event comparing integer keys in the hot array
+// only. A miss during a concurrent table rebuild is retried. Caller is
+// inside an EBR section.
+static seat_ref_t chain_find(const seat_map_t *m, uint64_t key)
+{
+    const seat_event_t *e = event_at(m, (uint32_t)(key >> 32));
+    if (!e)
+        return 0;
+    for (;;)
+    {
+        uint32_t seq = __atomic_load_n(&e->resize_seq, __ATOMIC_ACQUIRE);
+        const seat_chains_t *c = __atomic_load_n(&e->chains, __ATOMIC_ACQUIRE);
+        seat_ref_t r = __atomic_load_n(&c->heads[chain_of(c, key)], __ATOMIC_ACQUIRE);
+        while (r != 0)
+        {
+            const seat_hot_t *h = seat_map_hot(m, r);
+            if (hot_matches(h, key))
+                return r;
+            r = __atomic_load_n(&h->next, __ATOMIC_RELAXED);
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (!(seq & 1u) && __atomic_load_n(&e->resize_seq, __ATOMIC_RELAXED) == seq)
+            return 0;
+    }
+}
+
+// Resolve names to a key without interning; 0 if either name is unknown.
+static inline uint64_t lookup_key(const char *event_id, const char *seat_id)
+{
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, event_id);
+    uint32_t st = ev ? tb_intern_lookup(TB_NS_SEAT, seat_id) : 0;
+    return st ? seat_key_make(ev, st) : 0;
+}
+
+// Link a new seat into event e. Caller holds e->mtx.
+static bool seat_insert(seat_map_t *m, seat_event_t *e, uint64_t key, const seat_t *seat)
+{
+    seat_ref_t r = seat_ref_alloc(m, e);
+    if (r == 0)
+        return false;
+    seat_hot_t *h = seat_map_hot(m, r);
+    cold_from_seat(seat_map_cold(m, r), seat);
+    h->key = key;
+    h->version = 0;
+    uint64_t w = state_from_seat(m, r, seat);
+    h->state = w;
+    tb_seat_lock_init(&h->lock);
+    seat_chains_t *c = e->chains;
+    size_t idx = chain_of(c, key);
+    h->next = c->heads[idx];
+    __atomic_store_n(&c->heads[idx], r, __ATOMIC_RELEASE);
+    // Readers may move the state from here on; count what was published.
+    price_touch(e);
+    avail_sync(m, e, r);
+    count_move(e, STATUS_NONE, (int)seat_state_status(w), 1);
+    __atomic_add_fetch(&e->count, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&m->count, 1, __ATOMIC_RELAXED);
+    event_maybe_grow(m, e);
+    return true;
+}
+
+// Replace in place when the seat exists; else insert it under the event's
+// mutex, looking again there since another writer may have got in first.
+static bool seat_put(seat_map_t *m, uint64_t key, const seat_t *seat)
+{
+    seat_ref_t r = chain_find(m, key);
+    if (r != 0 && seat_write(m, r, seat))
+        return true;
+    for (;;)
+    {
+        seat_event_t *e = event_at(m, (uint32_t)(key >> 32));
+        if (!e && !(e = event_create(m, (uint32_t)(key >> 32), m->chains_hint)))
+            return false;
+        pthread_mutex_lock(&e->mtx);
+        bool ok = false;
+        r = 0;
+        if (!e->dead)
+        {
+            r = chain_find(m, key);
+            ok = r != 0 ? seat_write(m, r, seat) : seat_insert(m, e, key, seat);
+        }
+        bool retry = e->dead || (r != 0 && !ok); // unloaded, or deleted under us
+        pthread_mutex_unlock(&e->mtx);
+        if (!retry)
+            return ok;
+    }
+}
+
+bool seat_map_put(seat_map_t *m, const seat_t *seat)
+{
+    if (!m || !seat)
+        return false;
+    uint32_t ev = tb_intern(TB_NS_EVENT, seat->event_id);
+    uint32_t st = tb_intern(TB_NS_SEAT, seat->seat_id);
+    if (ev == 0 || st == 0)
+        return false;
+    tb_ebr_enter();
+    bool ok = seat_put(m, seat_key_make(ev, st), seat);
+    tb_ebr_exit();
+    tb_ebr_reclaim();
+    return ok;
+}
+
+typedef struct
+{
+    tb_ebr_node_t node;
+    seat_event_t *e;
+    seat_ref_t r;
+} seat_retired_t;
+
+// A deleted record is reused once no reader can be on it.
+static void seat_reclaim(tb_ebr_node_t *n)
+{
+    seat_retired_t *d = (seat_retired_t *)n;
+    pthread_mutex_lock(&d->e->mtx);
+    seat_ref_release(d->e->map, d->e, d->r);
+    pthread_mutex_unlock(&d->e->mtx);
+    free(d);
+}
+
+// Delete seat r. Its state word goes to GONE first, which fails every later
+// CAS or write on it (a pinned hold is waited out: a confirm is finishing).
+// Then it is unlinked and retired; readers already on it see GONE, and
+// walk on through its intact chain link. False if another delete won.
+static bool seat_remove(seat_map_t *m, seat_ref_t r)
+{
+    seat_hot_t *h = seat_map_hot(m, r);
+    uint64_t w = __atomic_load_n(&h->state, __ATOMIC_ACQUIRE);
+    for (;;)
+    {
+        if (seat_state_gone(w))
+            return false;
+        if (seat_state_pinned(w))
+        {
+            sched_yield();
+            w = __atomic_load_n(&h->state, __ATOMIC_ACQUIRE);
+            continue;
+        }
+        if (__atomic_compare_exchange_n(&h->state, &w, SEAT_STATE_GONE, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            break;
+    }
+    uint64_t key = h->key;
+    seat_event_t *e = event_of(m, r);
+    hold_slot_retire(m, seat_state_slot(w));
+    count_move(e, (int)seat_state_status(w), STATUS_NONE, 1);
+    avail_sync(m, e, r);
+
+    // An event unloaded meanwhile takes the record with it.
+    pthread_mutex_lock(&e->mtx);
+    if (!e->dead)
+    {
+        seat_chains_t *c = e->chains;
+        seat_ref_t *link = &c->heads[chain_of(c, key)];
+        while (*link != 0 && *link != r)
+            link = &seat_map_hot(m, *link)->next;
+        if (*link == r)
+            __atomic_store_n(link, h->next, __ATOMIC_RELEASE);
+        __atomic_sub_fetch(&e->count, 1, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&m->count, 1, __ATOMIC_RELAXED);
+        // Without memory to retire it, the record is simply never reused.
+        seat_retired_t *d = malloc(sizeof *d);
+        if (d)
+        {
+            *d = (seat_retired_t){.e = e, .r = r};
+            tb_ebr_retire(&d->node, seat_reclaim);
+        }
+    }
+    pthread_mutex_unlock(&e->mtx);
+    return true;
+}
+
+bool seat_map_delete(seat_map_t *m,
+                     const char *event_id,
+                     const char *seat_id)
+{
+    if (!m || !event_id || !seat_id)
+        return false;
+    uint64_t key = lookup_key(event_id, seat_id);
+    if (key == 0)
+        return false;
+    tb_ebr_enter();
+    seat_ref_t r = chain_find(m, key);
+    bool ok = r != 0 && seat_remove(m, r);
+    tb_ebr_exit();
+    tb_ebr_reclaim();
+    return ok;
+}
+
+seat_ref_t seat_map_find(seat_map_t *m,
+                         const char *event_id,
+                         const char *seat_id)
+{
+    if (!m || !event_id || !seat_id)
+        return 0;
+    uint64_t key = lookup_key(event_id, seat_id);
+    if (key == 0)
+        return 0;
+    tb_ebr_enter();
+    seat_ref_t r = chain_find(m, key);
+    tb_ebr_exit();
+    return r;
+}
+
+seat_ref_t seat_map_find_ix(const seat_map_t *m,
+                            uint32_t event_ix,
+                            uint32_t seat_ix)
+{
+    if (!m || event_ix == 0 || seat_ix == 0)
+        return 0;
+    tb_ebr_enter();
+    seat_ref_t r = chain_find(m, seat_key_make(event_ix, seat_ix));
+    tb_ebr_exit();
+    return r;
+}
+
+bool seat_map_get(seat_map_t *m,
+                  const char *event_id,
+                  const char *seat_id,
+                  seat_t *out)
 {
-    return tb_hash_key_fast(event_id, seat_id);
+    if (!m || !event_id || !seat_id || !out)
+        return false;
+    uint64_t key = lookup_key(event_id, seat_id);
+    if (key == 0)
+        return false;
+    tb_ebr_enter();
+    seat_ref_t r = chain_find(m, key);
+    bool found = r != 0 && seat_read(m, r, out);
+    tb_ebr_exit();
+    return found;
 }
 
-void destroy_bucket(bucket_t *bucket)
+/* ---- Batched lookups ----
+ * A batch of SEAT_BATCH keys moves through each stage together: chain
+ * heads, then the records they name, then the cold records and seat names
+ * a read copies. Each stage prefetches for the whole batch before the next
+ * stage touches anything, so one seat's misses overlap the others'. */
+
+#define SEAT_BATCH 16u
+
+size_t seat_map_find_many_ix(const seat_map_t *m, uint32_t event_ix,
+                             const uint32_t *seat_ix, size_t n, seat_ref_t *refs)
 {
-    pthread_mutex_destroy(&bucket->mtx);
-    free(bucket);
+    if (!seat_ix || !refs)
+        return 0;
+    memset(refs, 0, n * sizeof(seat_ref_t));
+    if (!m || event_ix == 0)
+        return 0;
+    tb_ebr_enter();
+    const seat_event_t *e = event_at(m, event_ix);
+    size_t found = 0;
+    for (size_t b = 0; e && b < n; b += SEAT_BATCH)
+    {
+        size_t k = n - b < SEAT_BATCH ? n - b : SEAT_BATCH;
+        uint64_t key[SEAT_BATCH];
+        seat_ref_t r[SEAT_BATCH]; // record each probe is at, 0 once done
+        const seat_ref_t *head[SEAT_BATCH];
+        uint32_t seq = __atomic_load_n(&e->resize_seq, __ATOMIC_ACQUIRE);
+        const seat_chains_t *c = __atomic_load_n(&e->chains, __ATOMIC_ACQUIRE);
+        for (size_t i = 0; i < k; ++i)
+        {
+            key[i] = seat_key_make(event_ix, seat_ix[b + i]);
+            head[i] = &c->heads[chain_of(c, key[i])];
+            __builtin_prefetch(head[i]);
+        }
+        for (size_t i = 0; i < k; ++i)
+        {
+            r[i] = seat_ix[b + i] ? __atomic_load_n(head[i], __ATOMIC_ACQUIRE) : 0;
+            if (r[i])
+                __builtin_prefetch(seat_map_hot(m, r[i]));
+        }
+        // One record per probe per round; most seats are found in the first.
+        for (bool more = true; more;)
+        {
+            more = false;
+            for (size_t i = 0; i < k; ++i)
+            {
+                if (!r[i])
+                    continue;
+                const seat_hot_t *h = seat_map_hot(m, r[i]);
+                if (hot_matches(h, key[i]))
+                {
+                    refs[b + i] = r[i];
+                    r[i] = 0;
+                    continue;
+                }
+                if ((r[i] = __atomic_load_n(&h->next, __ATOMIC_RELAXED)) != 0)
+                {
+                    __builtin_prefetch(seat_map_hot(m, r[i]));
+                    more = true;
+                }
+            }
+        }
+        // Misses are only trusted if the table did not change meanwhile.
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        bool stable = !(seq & 1u) && __atomic_load_n(&e->resize_seq, __ATOMIC_RELAXED) == seq;
+        for (size_t i = 0; i < k; ++i)
+        {
+            if (!refs[b + i] && seat_ix[b + i] && !stable)
+                refs[b + i] = chain_find(m, key[i]);
+            found += refs[b + i] != 0;
+        }
+    }
+    tb_ebr_exit();
+    return found;
 }
-/* ---- Lifecycle ---- */
 
-seat_map_t *seat_map_create(size_t capacity)
+// ok[i] (if given) tells whether out[i] holds a live seat.
+static void read_many(const seat_map_t *m, const seat_ref_t *refs, size_t n, seat_t *out, bool *ok)
 {
-    seat_map_t *map = malloc(sizeof(seat_map_t));
-    map->cap = capacity;
-    map->table = calloc(capacity, sizeof(bucket_t *));
-    return map;
+    for (size_t b = 0; b < n; b += SEAT_BATCH)
+    {
+        size_t k = n - b < SEAT_BATCH ? n - b : SEAT_BATCH;
+        for (size_t i = 0; i < k; ++i)
+            if (refs[b + i])
+            {
+                __builtin_prefetch(seat_map_hot(m, refs[b + i]));
+                __builtin_prefetch(seat_map_cold(m, refs[b + i]));
+            }
+        for (size_t i = 0; i < k; ++i)
+            if (refs[b + i])
+                __builtin_prefetch(tb_intern_name(TB_NS_SEAT, (uint32_t)seat_map_hot(m, refs[b + i])->key));
+        for (size_t i = 0; i < k; ++i)
+        {
+            bool live = refs[b + i] && seat_read(m, refs[b + i], &out[b + i]);
+            if (!refs[b + i])
+                memset(&out[b + i], 0, sizeof(seat_t));
+            if (ok)
+                ok[b + i] = live;
+        }
+    }
 }
 
-void seat_map_destroy(seat_map_t *m)
+void seat_map_read_many(const seat_map_t *m, const seat_ref_t *refs, size_t n, seat_t *out)
 {
-    if (!m)
-        return;
+    if (m && refs && out)
+        read_many(m, refs, n, out, NULL);
+}
 
-    for (size_t i = 0; i < m->cap; ++i)
+size_t seat_map_get_many(seat_map_t *m, const char *event_id,
+                         const char *const *seat_ids, size_t n,
+                         seat_t *out, bool *found)
+{
+    if (!m || !event_id || !seat_ids || !out)
+        return 0;
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, event_id);
+    size_t hits = 0;
+    tb_ebr_enter();
+    for (size_t b = 0; b < n; b += 4 * SEAT_BATCH)
     {
-        bucket_t *curr = m->table[i];
-        while (curr)
+        size_t k = n - b < 4 * SEAT_BATCH ? n - b : 4 * SEAT_BATCH;
+        uint32_t ix[4 * SEAT_BATCH];
+        seat_ref_t refs[4 * SEAT_BATCH];
+        bool ok[4 * SEAT_BATCH];
+        if (ev)
+            tb_intern_lookup_many(TB_NS_SEAT, seat_ids + b, k, ix);
+        else
+            memset(ix, 0, sizeof ix);
+        seat_map_find_many_ix(m, ev, ix, k, refs);
+        read_many(m, refs, k, out + b, ok);
+        for (size_t i = 0; i < k; ++i)
         {
-            bucket_t *next = curr->next;
-            pthread_mutex_destroy(&curr->mtx);
-            free(curr);
-            curr = next;
+            hits += ok[i];
+            if (found)
+                found[b + i] = ok[i];
         }
     }
+    tb_ebr_exit();
+    return hits;
+}
 
-    free(m->table);
-    free(m);
+size_t seat_map_size(const seat_map_t *m)
+{
+    return m ? __atomic_load_n(&m->count, __ATOMIC_RELAXED) : 0;
 }
 
-bool seat_map_put(seat_map_t *m, const seat_t *seat)
+// Bytes of one event region: records handed out (touched pages), not
+// reserved address space.
+static size_t event_memory_bytes(const seat_event_t *e)
 {
-    if (!m || !seat)
+    size_t records = event_records(e);
+    return sizeof(*e) + price_index_bytes(__atomic_load_n(&e->prices, __ATOMIC_ACQUIRE)) + e->segs_cap * sizeof(uint32_t) +
+           sizeof(seat_chains_t) + (e->chains->mask + 1) * sizeof(seat_ref_t) +
+           records * (sizeof(seat_hot_t) + sizeof(seat_cold_t)) +
+           e->nsegs * SEAT_SEG_SIZE / 8 + e->n_rows * sizeof(seat_row_t) +
+           EVENT_COUNT_SHARDS * sizeof(struct count_shard);
+}
+
+// Counts records handed out (touched pages), not reserved address space.
+size_t seat_map_memory_bytes(const seat_map_t *m)
+{
+    if (!m)
+        return 0;
+    size_t bytes = sizeof(*m);
+    for (size_t p = 0; p < SEAT_EVENT_PAGES; ++p)
+    {
+        seat_event_t **page = m->events[p];
+        if (!page)
+            continue;
+        bytes += SEAT_EVENT_PAGE_SIZE * sizeof(seat_event_t *);
+        for (size_t i = 0; i < SEAT_EVENT_PAGE_SIZE; ++i)
+        {
+            if (page[i])
+                bytes += event_memory_bytes(page[i]);
+        }
+    }
+    size_t hold_segs = 0;
+    for (size_t i = 0; i < HOLD_MAX_SEGS && m->holds->segs[i]; ++i)
+        hold_segs++;
+    return bytes + sizeof(hold_table_t) + hold_segs * HOLD_SEG_SIZE * sizeof(hold_slot_t);
+}
+
+/* ---- Event regions (public) ---- */
+
+size_t seat_map_event_memory_bytes(const seat_map_t *m, uint32_t event_ix)
+{
+    if (!m || event_ix == 0)
+        return 0;
+    tb_ebr_enter();
+    const seat_event_t *e = event_at(m, event_ix);
+    size_t bytes = e ? event_memory_bytes(e) : 0;
+    tb_ebr_exit();
+    return bytes;
+}
+
+bool seat_map_event_load(seat_map_t *m, const char *event_id, size_t expected_seats)
+{
+    if (!m || !event_id)
+        return false;
+    uint32_t ev = tb_intern(TB_NS_EVENT, event_id);
+    if (ev == 0)
+        return false;
+    return event_at(m, ev) || event_create(m, ev, expected_seats);
+}
+
+bool seat_map_event_unload(seat_map_t *m, const char *event_id)
+{
+    if (!m || !event_id)
+        return false;
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, event_id);
+    if (ev == 0)
+        return false;
+    tb_ebr_enter();
+    seat_event_t *e = event_at(m, ev);
+    bool dropped = e && event_drop(m, e);
+    tb_ebr_exit();
+    tb_ebr_reclaim();
+    return dropped;
+}
+
+size_t seat_map_event_size(const seat_map_t *m, uint32_t event_ix)
+{
+    if (!m || event_ix == 0)
+        return 0;
+    tb_ebr_enter();
+    const seat_event_t *e = event_at(m, event_ix);
+    size_t n = e ? __atomic_load_n(&e->count, __ATOMIC_RELAXED) : 0;
+    tb_ebr_exit();
+    return n;
+}
+
+/* ---- Availability (public) ---- */
+
+bool seat_map_event_set_rows(seat_map_t *m, uint32_t event_ix,
+                             const seat_row_t *rows, size_t n)
+{
+    seat_event_t *e = m && event_ix ? event_at(m, event_ix) : NULL;
+    if (!e || (!rows && n > 0) || n > UINT32_MAX)
         return false;
-    size_t idx = hash_key(seat->event_id, seat->seat_id) % m->cap;
-    bucket_t *curr = m->table[idx];
-    while (curr)
+    size_t records = event_records(e);
+    for (size_t i = 0; i < n; ++i)
+        if ((size_t)rows[i].first + rows[i].n_seats > records)
+            return false;
+    seat_row_t *copy = NULL;
+    if (n > 0)
     {
-        if (strcmp(curr->seat.event_id, seat->event_id) == 0 &&
-            strcmp(curr->seat.seat_id, seat->seat_id) == 0)
+        copy = malloc(n * sizeof(seat_row_t));
+        if (!copy)
+            return false;
+        memcpy(copy, rows, n * sizeof(seat_row_t));
+    }
+    free(e->rows);
+    e->rows = copy;
+    e->n_rows = (uint32_t)n;
+    return true;
+}
+
+const seat_row_t *seat_map_event_rows(const seat_map_t *m, uint32_t event_ix, size_t *n)
+{
+    const seat_event_t *e = m && event_ix ? event_at(m, event_ix) : NULL;
+    if (n)
+        *n = e ? e->n_rows : 0;
+    return e ? e->rows : NULL;
+}
+
+size_t seat_map_event_records(const seat_map_t *m, uint32_t event_ix)
+{
+    if (!m || event_ix == 0)
+        return 0;
+    tb_ebr_enter();
+    const seat_event_t *e = event_at(m, event_ix);
+    size_t n = e ? event_records(e) : 0;
+    tb_ebr_exit();
+    return n;
+}
+
+seat_ref_t seat_map_event_ref(const seat_map_t *m, uint32_t event_ix, size_t pos)
+{
+    if (!m || event_ix == 0)
+        return 0;
+    tb_ebr_enter();
+    const seat_event_t *e = event_at(m, event_ix);
+    seat_ref_t r = e && pos < event_records(e) ? event_ref(e, pos) : 0;
+    if (r && (!__atomic_load_n(&seat_map_hot(m, r)->key, __ATOMIC_RELAXED) ||
+              seat_state_gone(seat_state_load(m, r))))
+        r = 0;
+    tb_ebr_exit();
+    return r;
+}
+
+// Clip [first, first + count) to the event's records; false if empty.
+static bool avail_range(const seat_event_t *e, size_t first, size_t count, size_t *end)
+{
+    size_t records = event_records(e);
+    if (first >= records)
+        return false;
+    *end = count < records - first ? first + count : records;
+    return count > 0;
+}
+
+// Bits of word q that fall inside positions [first, end).
+static inline uint64_t range_mask(size_t q, size_t first, size_t end)
+{
+    uint64_t mask = ~0ull;
+    if (first > q * 64)
+        mask &= ~0ull << (first - q * 64);
+    if (end < q * 64 + 64)
+        mask &= (1ull << (end - q * 64)) - 1;
+    return mask;
+}
+
+static size_t avail_count(const seat_map_t *m, const seat_event_t *e, size_t first, size_t count)
+{
+    size_t end;
+    if (!e || !avail_range(e, first, count, &end))
+        return 0;
+    size_t qa = first / 64, qb = (end - 1) / 64, total = 0;
+    total += (size_t)__builtin_popcountll(event_avail_word(m, e, qa) & range_mask(qa, first, end));
+    if (qb == qa)
+        return total;
+    total += (size_t)__builtin_popcountll(event_avail_word(m, e, qb) & range_mask(qb, first, end));
+    // Whole words in between, a segment's bitmap at a time.
+    for (size_t q = qa + 1; q < qb;)
+    {
+        size_t off = q & (SEAT_SEG_SIZE / 64 - 1);
+        size_t n = SEAT_SEG_SIZE / 64 - off;
+        if (n > qb - q)
+            n = qb - q;
+        total += tb_popcount_words(&m->avail[event_seg(e, q >> (SEAT_SEG_BITS - 6))][off], n);
+        q += n;
+    }
+    return total;
+}
+
+static bool avail_find(const seat_map_t *m, const seat_event_t *e, size_t first,
+                       size_t count, size_t n, size_t near, size_t *start)
+{
+    size_t end;
+    if (!e || n == 0 || n > SEAT_AVAIL_MAX_RUN || !start || !avail_range(e, first, count, &end))
+        return false;
+    bool found = false;
+    size_t qa = first / 64, qb = (end - 1) / 64;
+    uint64_t next = event_avail_word(m, e, qa) & range_mask(qa, first, end);
+    for (size_t q = qa; q <= qb; ++q)
+    {
+        // Runs starting in word q may end in word q + 1: search the pair as
+        // one 128-bit window, doubling the run length each step.
+        uint64_t cur = next;
+        next = q < qb ? event_avail_word(m, e, q + 1) & range_mask(q + 1, first, end) : 0;
+        if (cur == 0)
+            continue;
+        unsigned __int128 runs = (unsigned __int128)next << 64 | cur;
+        for (size_t len = 1; len < n;)
         {
-            curr->seat = *seat;
-            return true;
+            size_t step = len < n - len ? len : n - len;
+            runs &= runs >> step;
+            len += step;
+        }
+        for (uint64_t starts = (uint64_t)runs; starts != 0; starts &= starts - 1)
+        {
+            size_t pos = q * 64 + (size_t)__builtin_ctzll(starts);
+            size_t dist = pos < near ? near - pos : pos - near;
+            if (!found || dist < (*start < near ? near - *start : *start - near))
+                *start = pos;
+            found = true;
+            if (pos >= near)
+                return true; // later starts are only further away
         }
-        curr = curr->next;
     }
+    return found;
+}
+
+size_t seat_map_avail_count(const seat_map_t *m, uint32_t event_ix,
+                            size_t first, size_t count)
+{
+    if (!m || event_ix == 0)
+        return 0;
+    tb_ebr_enter();
+    size_t n = avail_count(m, event_at(m, event_ix), first, count);
+    tb_ebr_exit();
+    return n;
+}
 
-    bucket_t *node = malloc(sizeof(*node));
-    if (!node)
+bool seat_map_avail_find(const seat_map_t *m, uint32_t event_ix, size_t first,
+                         size_t count, size_t n, size_t near, size_t *start)
+{
+    if (!m || event_ix == 0)
         return false;
-    node->seat = *seat;
-    pthread_mutex_init(&node->mtx, NULL);
-    node->next = m->table[idx];
-    m->table[idx] = node;
+    tb_ebr_enter();
+    bool found = avail_find(m, event_at(m, event_ix), first, count, n, near, start);
+    tb_ebr_exit();
+    return found;
+}
+
+/* ---- Price index (public) ---- */
+
+// Ranks [*a, *b) of the seats priced in [lo, hi]; *tier is the first one's.
+static void price_ranks(const seat_price_index_t *px, tb_money_cents_t lo, tb_money_cents_t hi,
+                        size_t *tier, size_t *a, size_t *b)
+{
+    size_t l = 0, h = px->n_tiers;
+    while (l < h) // first tier priced lo or more
+    {
+        size_t mid = l + (h - l) / 2;
+        if (px->tier_price[mid] < lo)
+            l = mid + 1;
+        else
+            h = mid;
+    }
+    *tier = l;
+    *a = px->tier_first[l];
+    h = px->n_tiers;
+    while (l < h) // first tier priced above hi
+    {
+        size_t mid = l + (h - l) / 2;
+        if (px->tier_price[mid] <= hi)
+            l = mid + 1;
+        else
+            h = mid;
+    }
+    *b = px->tier_first[l];
+}
+
+// First word of bits at or after q that the summary marks, or the word
+// past the one holding rank end - 1 if none is marked before it.
+static size_t price_next_word(const seat_price_index_t *px, size_t q, size_t end)
+{
+    size_t last = (end + 63) / 64;
+    while (q < last)
+    {
+        uint64_t s = __atomic_load_n(&px->summary[q / 64], __ATOMIC_RELAXED) & (~0ull << (q & 63));
+        if (s != 0)
+        {
+            size_t w = q / 64 * 64 + (size_t)__builtin_ctzll(s);
+            return w < last ? w : last;
+        }
+        q = (q / 64 + 1) * 64;
+    }
+    return last;
+}
 
+bool seat_map_price_open(seat_map_t *m, uint32_t event_ix, tb_money_cents_t lo,
+                         tb_money_cents_t hi, seat_price_cursor_t *c)
+{
+    if (!c)
+        return false;
+    memset(c, 0, sizeof *c);
+    seat_event_t *e = m && event_ix ? event_at(m, event_ix) : NULL;
+    const seat_price_index_t *px = e ? price_index(m, e) : NULL;
+    if (!px)
+        return false;
+    c->e = e;
+    c->px = px;
+    price_ranks(px, lo, hi, &c->tier, &c->rank, &c->end);
     return true;
 }
 
-bool seat_map_delete(seat_map_t *m,
-                     const char *event_id,
-                     const char *seat_id)
+bool seat_map_price_next(const seat_map_t *m, seat_price_cursor_t *c, seat_ref_t *r,
+                         tb_money_cents_t *price)
 {
-    if (!m || !event_id || !seat_id)
+    if (!m || !c || !c->px || !r)
         return false;
-    size_t idx = hash_key(event_id, seat_id) % m->cap;
-    bucket_t *curr = m->table[idx];
-    bucket_t *prev = NULL;
-    while (curr)
+    const seat_price_index_t *px = c->px;
+    while (c->rank < c->end)
     {
-        if (strcmp(curr->seat.event_id, event_id) == 0 &&
-            strcmp(curr->seat.seat_id, seat_id) == 0)
+        size_t q = c->rank / 64;
+        uint64_t w = __atomic_load_n(&px->bits[q], __ATOMIC_RELAXED) & (~0ull << (c->rank & 63));
+        if (w == 0)
         {
-            if (prev)
-            {
-                prev->next = curr->next;
-            }
-            else
-            {
-                m->table[idx] = curr->next;
-            }
-            destroy_bucket(curr);
-            return true;
+            c->rank = price_next_word(px, q + 1, c->end) * 64;
+            continue;
         }
-        prev = curr;
-        curr = curr->next;
+        size_t k = q * 64 + (size_t)__builtin_ctzll(w);
+        if (k >= c->end)
+            break;
+        c->rank = k + 1;
+        while (px->tier_first[c->tier + 1] <= k)
+            c->tier++;
+        *r = event_ref(c->e, px->pos_of[k]);
+        if (price)
+            *price = px->tier_price[c->tier];
+        return true;
     }
+    c->rank = c->end;
     return false;
 }
 
-bool seat_map_get(seat_map_t *m,
-                  const char *event_id,
-                  const char *seat_id,
-                  seat_t *out)
+size_t seat_map_price_count(seat_map_t *m, uint32_t event_ix, tb_money_cents_t lo,
+                            tb_money_cents_t hi)
 {
-    if (!m || !event_id || !seat_id)
+    if (!m || event_ix == 0)
+        return 0;
+    tb_ebr_enter();
+    seat_event_t *e = event_at(m, event_ix);
+    const seat_price_index_t *px = e ? price_index(m, e) : NULL;
+    size_t tier, a = 0, b = 0, total = 0;
+    if (px)
+        price_ranks(px, lo, hi, &tier, &a, &b);
+    if (a < b)
+    {
+        size_t qa = a / 64, qb = (b - 1) / 64;
+        total = (size_t)__builtin_popcountll(__atomic_load_n(&px->bits[qa], __ATOMIC_RELAXED) &
+                                             range_mask(qa, a, b));
+        if (qb > qa)
+            total += (size_t)__builtin_popcountll(__atomic_load_n(&px->bits[qb], __ATOMIC_RELAXED) &
+                                                  range_mask(qb, a, b)) +
+                     tb_popcount_words(&px->bits[qa + 1], qb - qa - 1);
+    }
+    tb_ebr_exit();
+    tb_ebr_reclaim(); // a rebuild retires the index it replaced
+    return total;
+}
+
+/* ---- Event counters (public) ---- */
+
+static bool event_counts(const seat_event_t *e, seat_counts_t *out)
+{
+    if (!e || !out)
+        return false;
+    int64_t sum[SEAT_STATUSES] = {0};
+    for (unsigned i = 0; i < EVENT_COUNT_SHARDS; ++i)
+        for (int st = 0; st < SEAT_STATUSES; ++st)
+            sum[st] += __atomic_load_n(&e->counts[i].by_status[st], __ATOMIC_RELAXED);
+    out->seats = __atomic_load_n(&e->count, __ATOMIC_RELAXED);
+    for (int st = 0; st < SEAT_STATUSES; ++st)
+        out->by_status[st] = sum[st] > 0 ? (size_t)sum[st] : 0;
+    return true;
+}
+
+bool seat_map_event_counts(const seat_map_t *m, uint32_t event_ix, seat_counts_t *out)
+{
+    if (!m || event_ix == 0)
+        return false;
+    tb_ebr_enter();
+    bool ok = event_counts(event_at(m, event_ix), out);
+    tb_ebr_exit();
+    return ok;
+}
+
+static bool event_verify(const seat_map_t *m, const seat_event_t *e)
+{
+    seat_counts_t c;
+    if (!event_counts(e, &c))
         return false;
-    size_t idx = hash_key(event_id, seat_id) % m->cap;
-    bucket_t *curr = m->table[idx];
-    while (curr)
+    size_t live = 0, by_status[SEAT_STATUSES] = {0};
+    size_t records = event_records(e);
+    for (size_t pos = 0; pos < records; ++pos)
     {
-        if (strcmp(curr->seat.event_id, event_id) == 0 &&
-            strcmp(curr->seat.seat_id, seat_id) == 0)
+        seat_ref_t r = event_ref(e, pos);
+        const seat_hot_t *h = seat_map_hot(m, r);
+        bool bit = (event_avail_word(m, e, pos / 64) >> (pos & 63)) & 1;
+        uint64_t w = __atomic_load_n(&h->state, __ATOMIC_ACQUIRE);
+        if (!__atomic_load_n(&h->key, __ATOMIC_ACQUIRE) || seat_state_gone(w))
         {
-            *out = curr->seat;
-            return true;
+            if (bit)
+                return false;
+            continue;
         }
-        curr = curr->next;
+        seat_status_t st = seat_state_status(w);
+        if (bit != (st == SEAT_AVAILABLE))
+            return false;
+        live++;
+        by_status[st]++;
     }
-    return false;
+    if (live != c.seats)
+        return false;
+    for (int st = 0; st < SEAT_STATUSES; ++st)
+        if (by_status[st] != c.by_status[st])
+            return false;
+
+    // A current price index: every rank's bit and price match its seat's.
+    const seat_price_index_t *px = __atomic_load_n(&e->prices, __ATOMIC_ACQUIRE);
+    if (!px || px->epoch != __atomic_load_n(&e->price_epoch, __ATOMIC_ACQUIRE))
+        return true;
+    for (size_t k = 0, t = 0; k < px->ranks; ++k)
+    {
+        size_t pos = px->pos_of[k];
+        while (px->tier_first[t + 1] <= k)
+            t++;
+        bool bit = (px->bits[k / 64] >> (k & 63)) & 1;
+        bool marked = (px->summary[k / 4096] >> ((k / 64) & 63)) & 1;
+        if (bit != ((event_avail_word(m, e, pos / 64) >> (pos & 63)) & 1) || (bit && !marked) ||
+            seat_map_cold(m, event_ref(e, pos))->price_cents != px->tier_price[t])
+            return false;
+    }
+    return true;
 }
 
-/* ---- Concurrency helpers ---- */
+bool seat_map_event_verify(const seat_map_t *m, uint32_t event_ix)
+{
+    if (!m || event_ix == 0)
+        return false;
+    tb_ebr_enter();
+    bool ok = event_verify(m, event_at(m, event_ix));
+    tb_ebr_exit();
+    return ok;
+}
 
-bool seat_map_lock(seat_map_t *m,
-                   const char *event_id,
-                   const char *seat_id)
+/* ---- Event snapshots ----
+ * A snapshot covers the records its event had when it opened, scanned in
+ * allocation order. Per record it keeps two bits: `claimed` is taken by the
+ * first writer to touch the record after the snapshot opened, which then
+ * copies the record as it still is into a pre-image and sets `ready`;
+ * later writers wait for `ready` before writing. The scan reads the live
+ * record and uses it only if nobody had claimed it by the time the read
+ * finished; otherwise it takes the pre-image. */
+
+#define SNAP_PAGE_BITS 8
+#define SNAP_PAGE_SIZE (1u << SNAP_PAGE_BITS)
+
+typedef struct
 {
-    if (!m || !event_id || !seat_id)
+    tb_money_cents_t price_cents;
+    seat_status_t status;
+    tb_epoch_t hold_expires_unix;
+    tb_epoch_t updated_unix;
+    char holder_user_id[TB_ID_LEN];
+    char last_order_id[TB_ID_LEN];
+} snap_pre_t;
+
+struct seat_snapshot
+{
+    seat_map_t *m;
+    seat_event_t *e;
+    uint32_t slot;
+    bool failed;     // a pre-image could not be saved
+    size_t records;  // scanned: records of the event at open
+    size_t next;
+    uint64_t *claimed;
+    uint64_t *ready;
+    snap_pre_t **pages; // pre-images, allocated on first use
+};
+
+static snap_pre_t *snap_page(seat_snapshot_t *s, size_t i)
+{
+    snap_pre_t **slot = &s->pages[i >> SNAP_PAGE_BITS];
+    snap_pre_t *p = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+    if (p)
+        return p;
+    snap_pre_t *fresh = malloc(SNAP_PAGE_SIZE * sizeof(snap_pre_t));
+    if (!fresh)
+        return NULL;
+    if (__atomic_compare_exchange_n(slot, &p, fresh, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        return fresh;
+    free(fresh); // another writer installed one first
+    return p;
+}
+
+static void snap_wait_ready(const seat_snapshot_t *s, size_t i)
+{
+    uint64_t bit = 1ull << (i & 63);
+    while (!(__atomic_load_n(&s->ready[i >> 6], __ATOMIC_ACQUIRE) & bit))
+        sched_yield();
+}
+
+// Save record r (position i) for snapshot s unless it already is. Runs
+// inside the gate, before the caller's write.
+static void snap_save(seat_snapshot_t *s, seat_ref_t r, size_t i)
+{
+    uint64_t bit = 1ull << (i & 63);
+    if (__atomic_load_n(&s->ready[i >> 6], __ATOMIC_ACQUIRE) & bit)
+        return;
+    if (__atomic_fetch_or(&s->claimed[i >> 6], bit, __ATOMIC_SEQ_CST) & bit)
+    {
+        snap_wait_ready(s, i);
+        return;
+    }
+    snap_pre_t *page = snap_page(s, i);
+    if (page)
+    {
+        seat_t cur;
+        seat_read(s->m, r, &cur);
+        snap_pre_t *pre = &page[i & (SNAP_PAGE_SIZE - 1)];
+        pre->price_cents = cur.price_cents;
+        pre->status = cur.status;
+        pre->hold_expires_unix = cur.hold_expires_unix;
+        pre->updated_unix = cur.updated_unix;
+        memcpy(pre->holder_user_id, cur.holder_user_id, TB_ID_LEN);
+        memcpy(pre->last_order_id, cur.last_order_id, TB_ID_LEN);
+    }
+    else
+    {
+        __atomic_store_n(&s->failed, true, __ATOMIC_RELAXED);
+    }
+    __atomic_fetch_or(&s->ready[i >> 6], bit, __ATOMIC_RELEASE);
+}
+
+static void snap_preserve(seat_map_t *m, seat_event_t *e, seat_ref_t r)
+{
+    uint32_t mask = e ? __atomic_load_n(&e->snap_mask, __ATOMIC_SEQ_CST) : 0;
+    if (mask == 0)
+        return;
+    size_t i = event_pos(m, r);
+    for (uint32_t b = 0; b < SEAT_SNAP_SLOTS; ++b)
+    {
+        seat_snapshot_t *s = mask & (1u << b) ? __atomic_load_n(&e->snaps[b], __ATOMIC_ACQUIRE) : NULL;
+        if (s && i < s->records)
+            snap_save(s, r, i);
+    }
+}
+
+static void snap_free(seat_snapshot_t *s)
+{
+    for (size_t p = 0; s->pages && p < (s->records + SNAP_PAGE_SIZE - 1) / SNAP_PAGE_SIZE; ++p)
+        free(s->pages[p]);
+    free(s->pages);
+    free(s->claimed);
+    free(s->ready);
+    free(s);
+}
+
+seat_snapshot_t *seat_map_snapshot_begin(seat_map_t *m, uint32_t event_ix)
+{
+    seat_event_t *e = m && event_ix ? event_at(m, event_ix) : NULL;
+    if (!e)
+        return NULL;
+    seat_snapshot_t *s = calloc(1, sizeof(*s));
+    if (!s)
+        return NULL;
+    s->m = m;
+    s->e = e;
+    s->records = event_records(e);
+    size_t words = (s->records + 63) / 64 + 1;
+    s->claimed = calloc(words, sizeof(uint64_t));
+    s->ready = calloc(words, sizeof(uint64_t));
+    s->pages = calloc((s->records + SNAP_PAGE_SIZE - 1) / SNAP_PAGE_SIZE + 1, sizeof(snap_pre_t *));
+    if (!s->claimed || !s->ready || !s->pages)
+    {
+        snap_free(s);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&m->gate->mtx);
+    uint32_t mask = e->snap_mask;
+    s->slot = 0;
+    while (s->slot < SEAT_SNAP_SLOTS && (mask & (1u << s->slot)))
+        s->slot++;
+    if (s->slot == SEAT_SNAP_SLOTS)
+    {
+        pthread_mutex_unlock(&m->gate->mtx);
+        snap_free(s);
+        return NULL;
+    }
+    __atomic_store_n(&e->snaps[s->slot], s, __ATOMIC_RELEASE);
+    __atomic_store_n(&e->snap_mask, mask | 1u << s->slot, __ATOMIC_SEQ_CST);
+    gate_sync(m); // the snapshot's instant: every later write saves first
+    pthread_mutex_unlock(&m->gate->mtx);
+    return s;
+}
+
+bool seat_map_snapshot_next(seat_snapshot_t *s, seat_t *out)
+{
+    if (!s || !out)
         return false;
-    size_t idx = hash_key(event_id, seat_id) % m->cap;
-    bucket_t *curr = m->table[idx];
-    while (curr)
+    while (s->next < s->records)
     {
-        if (strcmp(curr->seat.event_id, event_id) == 0 &&
-            strcmp(curr->seat.seat_id, seat_id) == 0)
+        size_t i = s->next++;
+        seat_ref_t r = event_ref(s->e, i);
+        if (__atomic_load_n(&seat_map_hot(s->m, r)->key, __ATOMIC_RELAXED) == 0)
+            continue; // unused record
+        if (!seat_read(s->m, r, out))
+            continue; // deleted
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        uint64_t bit = 1ull << (i & 63);
+        if (__atomic_load_n(&s->claimed[i >> 6], __ATOMIC_SEQ_CST) & bit)
         {
-            return pthread_mutex_lock(&(curr->mtx)) == 0;
+            // Written since the snapshot opened: the read may be too new.
+            snap_wait_ready(s, i);
+            const snap_pre_t *page = s->pages[i >> SNAP_PAGE_BITS];
+            if (page)
+            {
+                const snap_pre_t *pre = &page[i & (SNAP_PAGE_SIZE - 1)];
+                out->price_cents = pre->price_cents;
+                out->status = pre->status;
+                out->hold_expires_unix = pre->hold_expires_unix;
+                out->updated_unix = pre->updated_unix;
+                memcpy(out->holder_user_id, pre->holder_user_id, TB_ID_LEN);
+                memcpy(out->last_order_id, pre->last_order_id, TB_ID_LEN);
+            }
         }
-        curr = curr->next;
+        memset(out->hold_token, 0, sizeof out->hold_token);
+        out->hold_token_len = 0;
+        return true;
     }
     return false;
 }
 
-void seat_map_unlock(seat_map_t *m,
-                     const char *event_id,
-                     const char *seat_id)
+bool seat_map_snapshot_end(seat_snapshot_t *s)
 {
-    if (!m || !event_id || !seat_id)
-        return;
-    size_t idx = hash_key(event_id, seat_id) % m->cap;
-    bucket_t *curr = m->table[idx];
-    while (curr)
+    if (!s)
+        return false;
+    seat_map_t *m = s->m;
+    pthread_mutex_lock(&m->gate->mtx);
+    __atomic_store_n(&s->e->snap_mask, s->e->snap_mask & ~(1u << s->slot), __ATOMIC_SEQ_CST);
+    __atomic_store_n(&s->e->snaps[s->slot], NULL, __ATOMIC_RELEASE);
+    gate_sync(m); // no writer still holds s
+    pthread_mutex_unlock(&m->gate->mtx);
+    bool ok = !__atomic_load_n(&s->failed, __ATOMIC_RELAXED);
+    snap_free(s);
+    return ok;
+}
+
+/* ---- Bulk loading ----
+ * Records are reserved in segment order, so record i of the load is a pure
+ * function of i and fillers never touch the allocator. */
+
+bool seat_map_bulk_begin(seat_map_t *m, uint32_t event_ix, size_t n)
+{
+    if (!m || event_ix == 0 || event_at(m, event_ix))
+        return false;
+    // Size the table for the steady-state load of two seats per chain.
+    seat_event_t *e = event_create(m, event_ix, n / 2);
+    if (!e)
+        return false;
+    pthread_mutex_lock(&e->mtx);
+    bool owner = e->nsegs == 0 && !e->dead; // not an event a racing put filled
+    bool ok = owner;
+    for (size_t left = n; ok && left > 0;)
+    {
+        if (!(ok = event_add_segment(m, e)))
+            break;
+        e->seg_used = left < SEAT_SEG_SIZE ? (uint32_t)left : SEAT_SEG_SIZE;
+        left -= e->seg_used;
+    }
+    event_publish_records(e);
+    pthread_mutex_unlock(&e->mtx);
+    if (owner && !ok)
     {
-        if (strcmp(curr->seat.event_id, event_id) == 0 &&
-            strcmp(curr->seat.seat_id, seat_id) == 0)
+        event_drop(m, e);
+        tb_ebr_reclaim();
+    }
+    return ok;
+}
+
+size_t seat_map_bulk_fill(seat_map_t *m, uint32_t event_ix, size_t first,
+                          const seat_bulk_t *rows, size_t count, tb_epoch_t now)
+{
+    seat_event_t *e = m && rows ? event_at(m, event_ix) : NULL;
+    if (!e || first + count > event_records(e))
+        return 0;
+    seat_chains_t *c = e->chains;
+    size_t inserted = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (rows[i].seat_ix == 0)
+            continue;
+        seat_ref_t r = event_ref(e, first + i);
+        seat_hot_t *h = seat_map_hot(m, r);
+        seat_cold_t *cd = seat_map_cold(m, r);
+        uint64_t key = seat_key_make(event_ix, rows[i].seat_ix);
+        cd->price_cents = rows[i].price_cents;
+        cd->updated_unix = now;
+        tb_seat_lock_init(&h->lock);
+        h->key = key;
+
+        // Push onto the chain unless the seat is already there; a failed CAS
+        // means the chain changed, so look again before retrying.
+        seat_ref_t *head = &c->heads[chain_of(c, key)];
+        seat_ref_t old = __atomic_load_n(head, __ATOMIC_ACQUIRE);
+        bool dup = false;
+        do
         {
-            pthread_mutex_unlock(&(curr->mtx));
-            return;
+            for (seat_ref_t q = old; q != 0 && !dup; q = seat_map_hot(m, q)->next)
+                dup = q != r && seat_map_hot(m, q)->key == key;
+            if (dup)
+                break;
+            __atomic_store_n(&h->next, old, __ATOMIC_RELAXED);
+        } while (!__atomic_compare_exchange_n(head, &old, r, false,
+                                              __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+        if (dup)
+        {
+            h->key = 0; // recycled by seat_map_bulk_end
+            continue;
         }
-        curr = curr->next;
+        __atomic_fetch_or(avail_word(m, r), 1ull << (r & 63), __ATOMIC_RELAXED);
+        inserted++;
     }
+    count_move(e, STATUS_NONE, SEAT_AVAILABLE, (int64_t)inserted);
+    __atomic_add_fetch(&e->count, inserted, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&m->count, inserted, __ATOMIC_RELAXED);
+    return inserted;
 }
 
+size_t seat_map_bulk_end(seat_map_t *m, uint32_t event_ix)
+{
+    seat_event_t *e = m ? event_at(m, event_ix) : NULL;
+    if (!e)
+        return 0;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    pthread_mutex_lock(&e->mtx);
+    size_t records = event_records(e);
+    size_t count = __atomic_load_n(&e->count, __ATOMIC_RELAXED);
+    size_t unused = records - count;
+    for (size_t i = records; unused > 0 && i-- > 0;)
+    {
+        seat_ref_t r = event_ref(e, i);
+        if (seat_map_hot(m, r)->key == 0)
+        {
+            seat_ref_release(m, e, r); // never linked, so no reader is on it
+            unused--;
+        }
+    }
+    event_maybe_grow(m, e);
+    price_touch(e); // fill sets bits directly, bypassing any index
+    pthread_mutex_unlock(&e->mtx);
+    tb_ebr_reclaim();
+    return count;
+}
+
+/* ---- Concurrency helpers ---- */
+
+bool seat_map_lock(seat_map_t *m,
+                   const char *event_id,
+                   const char *seat_id)
+{
+    return seat_map_lock_ref(m, seat_map_find(m, event_id, seat_id));
+}
+
+void seat_map_unlock(seat_map_t *m,
+                     const char *event_id,
+                     const char *seat_id)
+{
+    seat_map_unlock_ref(m, seat_map_find(m, event_id, seat_id));
+}
+
+bool seat_map_lock_ref(seat_map_t *m, seat_ref_t r)
+{
+    return m && r ? tb_seat_lock_acquire(&seat_map_hot(m, r)->lock) : false;
+}
+
+void seat_map_unlock_ref(seat_map_t *m, seat_ref_t r)
+{
+    if (m && r)
+        tb_seat_lock_release(&seat_map_hot(m, r)->lock);
+}
+
+// Walks the token's hash chain: O(1) expected.
 bool seat_map_find_by_token(seat_map_t *m,
                             const tb_byte_t *token,
                             size_t token_len,
                             seat_t *out)
 {
-    if (!m || !token || token_len == 0 || !out)
+    if (!m || !token || token_len == 0 || token_len > TB_TOKEN_LEN || !out)
         return false;
 
-    for (size_t i = 0; i < m->cap; ++i)
+    hold_table_t *t = m->holds;
+    uint32_t bucket = token_bucket(token, token_len);
+    bool found = false;
+    tb_ebr_enter();
+    uint32_t idx = __atomic_load_n(&t->token_heads[bucket], __ATOMIC_ACQUIRE);
+    for (const hold_slot_t *s; !found && idx != 0;
+         idx = __atomic_load_n(&s->next_token, __ATOMIC_ACQUIRE))
     {
-        bucket_t *curr = m->table[i];
-        while (curr)
-        {
-            if (curr->seat.status == SEAT_HELD &&
-                curr->seat.hold_token_len == token_len &&
-                tb_memcmp_token32(curr->seat.hold_token, token, token_len) == 0)
-            {
-                *out = curr->seat;
-                return true;
-            }
-            curr = curr->next;
-        }
+        s = slot_at(t, idx);
+        seat_ref_t owner = __atomic_load_n(&s->owner, __ATOMIC_RELAXED);
+        if (owner == 0)
+            continue;
+        uint64_t w = seat_state_load(m, owner);
+        if (seat_state_status(w) != SEAT_HELD || slot_index(seat_state_slot(w)) != idx)
+            continue;
+        seat_hold_t hold;
+        if (!seat_state_hold(m, owner, w, &hold))
+            continue;
+        if (hold.token_len == token_len &&
+            tb_memcmp_token32(hold.token, token, token_len) == 0)
+            found = seat_read(m, owner, out);
     }
-    return false;
+    tb_ebr_exit();
+    return found;
 }
@@ -0,0 +1,248 @@
+// String interning for event/seat identifiers (see intern.h).
+//
+// Each namespace keeps names in fixed segments indexed by id, plus an
+// open-addressing index of (hash tag, id) words. Inserts serialise on a
+// mutex; lookups are lock-free. A grown index is published atomically and
+// the previous one is kept alive for readers still probing it.
+
+#include "intern.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils.h"
+
+#define INTERN_SEG_BITS 14
+#define INTERN_SEG_SIZE (1u << INTERN_SEG_BITS)
+#define INTERN_MAX_SEGS 8192u // 134M names per namespace
+#define INTERN_MIN_SLOTS 1024u
+
+typedef struct
+{
+    char name[TB_ID_LEN];
+} intern_name_t;
+
+typedef struct intern_index
+{
+    size_t mask;
+    uint64_t *slots; // (hash tag << 32) | id, 0 = empty
+    struct intern_index *retired;
+} intern_index_t;
+
+typedef struct
+{
+    pthread_mutex_t mtx;
+    intern_index_t *index;
+    intern_name_t *segs[INTERN_MAX_SEGS];
+    uint32_t count;
+} intern_space_t;
+
+static intern_space_t g_spaces[TB_NS_COUNT] = {
+    {.mtx = PTHREAD_MUTEX_INITIALIZER},
+    {.mtx = PTHREAD_MUTEX_INITIALIZER},
+    {.mtx = PTHREAD_MUTEX_INITIALIZER},
+};
+
+// Copy into a zero-padded, truncated buffer so hashing and comparison work on
+// exactly what is stored.
+static inline void name_key(const char *name, char out[TB_ID_LEN])
+{
+    memset(out, 0, TB_ID_LEN);
+    strncpy(out, name, TB_ID_LEN - 1);
+}
+
+static inline const intern_name_t *name_at(const intern_space_t *sp, uint32_t id)
+{
+    const intern_name_t *seg = __atomic_load_n(&sp->segs[id >> INTERN_SEG_BITS], __ATOMIC_ACQUIRE);
+    return seg ? &seg[id & (INTERN_SEG_SIZE - 1)] : NULL;
+}
+
+static uint32_t index_find(const intern_space_t *sp, const intern_index_t *ix,
+                           uint64_t h, const char key[TB_ID_LEN])
+{
+    uint32_t tag = (uint32_t)(h >> 32);
+    for (size_t i = (size_t)h & ix->mask;; i = (i + 1) & ix->mask)
+    {
+        uint64_t e = __atomic_load_n(&ix->slots[i], __ATOMIC_ACQUIRE);
+        if (e == 0)
+            return 0;
+        if ((uint32_t)(e >> 32) == tag)
+        {
+            const intern_name_t *n = name_at(sp, (uint32_t)e);
+            if (n && memcmp(n->name, key, TB_ID_LEN) == 0)
+                return (uint32_t)e;
+        }
+    }
+}
+
+static void index_insert(intern_index_t *ix, uint64_t h, uint32_t id)
+{
+    size_t i = (size_t)h & ix->mask;
+    while (ix->slots[i] != 0)
+        i = (i + 1) & ix->mask;
+    __atomic_store_n(&ix->slots[i], (h >> 32) << 32 | id, __ATOMIC_RELEASE);
+}
+
+// Caller holds sp->mtx. Keeps the load factor at or below 1/2.
+static bool index_reserve(intern_space_t *sp, uint32_t want)
+{
+    intern_index_t *old = sp->index;
+    if (old && (size_t)want * 2 <= old->mask + 1)
+        return true;
+
+    size_t slots = old ? (old->mask + 1) * 2 : INTERN_MIN_SLOTS;
+    intern_index_t *ix = calloc(1, sizeof(*ix));
+    if (!ix || !(ix->slots = calloc(slots, sizeof(uint64_t))))
+    {
+        free(ix);
+        return false;
+    }
+    ix->mask = slots - 1;
+    ix->retired = old;
+    for (uint32_t id = 1; id <= sp->count; ++id)
+        index_insert(ix, tb_hash_name_fast(name_at(sp, id)->name), id);
+    __atomic_store_n(&sp->index, ix, __ATOMIC_RELEASE);
+    return true;
+}
+
+uint32_t tb_intern_lookup(tb_namespace_t ns, const char *name)
+{
+    if ((unsigned)ns >= TB_NS_COUNT || !name || !*name)
+        return 0;
+    const intern_space_t *sp = &g_spaces[ns];
+    const intern_index_t *ix = __atomic_load_n(&sp->index, __ATOMIC_ACQUIRE);
+    if (!ix)
+        return 0;
+    char key[TB_ID_LEN];
+    name_key(name, key);
+    return index_find(sp, ix, tb_hash_name_fast(key), key);
+}
+
+#define INTERN_BATCH 16u
+
+size_t tb_intern_lookup_many(tb_namespace_t ns, const char *const *names, size_t n, uint32_t *ids)
+{
+    if ((unsigned)ns >= TB_NS_COUNT || !names || !ids)
+        return 0;
+    const intern_space_t *sp = &g_spaces[ns];
+    const intern_index_t *ix = __atomic_load_n(&sp->index, __ATOMIC_ACQUIRE);
+    if (!ix)
+    {
+        memset(ids, 0, n * sizeof(uint32_t));
+        return 0;
+    }
+    size_t found = 0;
+    for (size_t b = 0; b < n; b += INTERN_BATCH)
+    {
+        size_t k = n - b < INTERN_BATCH ? n - b : INTERN_BATCH;
+        char key[INTERN_BATCH][TB_ID_LEN];
+        uint64_t h[INTERN_BATCH];
+        // Hash every name and prefetch its home slot, then the name the
+        // slot points at, then probe.
+        for (size_t i = 0; i < k; ++i)
+        {
+            const char *name = names[b + i];
+            h[i] = 0;
+            if (!name || !*name)
+                continue;
+            name_key(name, key[i]);
+            h[i] = tb_hash_name_fast(key[i]);
+            __builtin_prefetch(&ix->slots[(size_t)h[i] & ix->mask]);
+        }
+        for (size_t i = 0; i < k; ++i)
+        {
+            uint64_t e = h[i] ? __atomic_load_n(&ix->slots[(size_t)h[i] & ix->mask], __ATOMIC_ACQUIRE) : 0;
+            if (e != 0 && (uint32_t)(e >> 32) == (uint32_t)(h[i] >> 32))
+                __builtin_prefetch(name_at(sp, (uint32_t)e));
+        }
+        for (size_t i = 0; i < k; ++i)
+        {
+            ids[b + i] = h[i] ? index_find(sp, ix, h[i], key[i]) : 0;
+            found += ids[b + i] != 0;
+        }
+    }
+    return found;
+}
+
+// Caller holds sp->mtx.
+static uint32_t intern_locked(intern_space_t *sp, uint64_t h, const char key[TB_ID_LEN])
+{
+    uint32_t id;
+    if (sp->index && (id = index_find(sp, sp->index, h, key)) != 0)
+        return id; // lost the race to another inserter
+
+    id = sp->count + 1;
+    uint32_t seg = id >> INTERN_SEG_BITS;
+    if (seg >= INTERN_MAX_SEGS || !index_reserve(sp, id))
+        return 0;
+    if (!sp->segs[seg])
+    {
+        intern_name_t *mem = calloc(INTERN_SEG_SIZE, sizeof(intern_name_t));
+        if (!mem)
+            return 0;
+        __atomic_store_n(&sp->segs[seg], mem, __ATOMIC_RELEASE);
+    }
+    memcpy(sp->segs[seg][id & (INTERN_SEG_SIZE - 1)].name, key, TB_ID_LEN);
+    __atomic_store_n(&sp->count, id, __ATOMIC_RELEASE);
+    index_insert(sp->index, h, id);
+    return id;
+}
+
+uint32_t tb_intern(tb_namespace_t ns, const char *name)
+{
+    uint32_t id = tb_intern_lookup(ns, name);
+    if (id != 0 || (unsigned)ns >= TB_NS_COUNT || !name || !*name)
+        return id;
+
+    intern_space_t *sp = &g_spaces[ns];
+    char key[TB_ID_LEN];
+    name_key(name, key);
+    uint64_t h = tb_hash_name_fast(key);
+
+    pthread_mutex_lock(&sp->mtx);
+    id = intern_locked(sp, h, key);
+    pthread_mutex_unlock(&sp->mtx);
+    return id;
+}
+
+size_t tb_intern_many(tb_namespace_t ns, const char *const *names, size_t n, uint32_t *ids)
+{
+    if ((unsigned)ns >= TB_NS_COUNT || !names || !ids)
+        return 0;
+    size_t done = tb_intern_lookup_many(ns, names, n, ids);
+    if (done == n)
+        return done;
+
+    intern_space_t *sp = &g_spaces[ns];
+    char key[TB_ID_LEN];
+    pthread_mutex_lock(&sp->mtx);
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (ids[i] != 0 || !names[i] || !*names[i])
+            continue;
+        name_key(names[i], key);
+        ids[i] = intern_locked(sp, tb_hash_name_fast(key), key);
+        if (ids[i] != 0)
+            done++;
+    }
+    pthread_mutex_unlock(&sp->mtx);
+    return done;
+}
+
+const char *tb_intern_name(tb_namespace_t ns, uint32_t id)
+{
+    if ((unsigned)ns >= TB_NS_COUNT || id == 0 ||
+        id > __atomic_load_n(&g_spaces[ns].count, __ATOMIC_ACQUIRE))
+        return NULL;
+    const intern_name_t *n = name_at(&g_spaces[ns], id);
+    return n ? n->name : NULL;
+}
+
+uint32_t tb_intern_count(tb_namespace_t ns)
+{
+    if ((unsigned)ns >= TB_NS_COUNT)
+        return 0;
+    return __atomic_load_n(&g_spaces[ns].count, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,791 @@
+// Binary venue manifests (see manifest.h): validation, the parallel loader
+// and the CSV converter.
+//
+// The loader never builds seat_t records. Each event's records are reserved
+// up front (seat_map_bulk_begin); workers then claim fixed blocks of the seat
+// table, resolve a block's seat names with one batched intern call and fill
+// the matching records directly.
+
+#include "manifest.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "intern.h"
+#include "utils.h"
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "manifest files are little-endian; add byte swapping for this target"
+#endif
+
+#define MANIFEST_LOAD_BLOCK 4096u // seats claimed by a worker at a time
+#define MANIFEST_MAX_THREADS 64u
+
+/* ---- Open / validate ---- */
+
+static inline bool name_ok(const tb_manifest_t *mf, uint32_t off)
+{
+    return off < mf->hdr->strings_bytes;
+}
+
+static bool table_ok(const tb_manifest_header_t *h, uint64_t off, uint64_t count, size_t elem)
+{
+    return off % 8 == 0 && off >= h->header_bytes && off <= h->file_bytes &&
+           count <= (h->file_bytes - off) / elem;
+}
+
+// Nesting: every event, section and row covers the next run of its children,
+// and the runs tile each table exactly.
+static bool structure_ok(const tb_manifest_t *mf)
+{
+    const tb_manifest_header_t *h = mf->hdr;
+    uint64_t sec = 0, tier = 0, seat = 0;
+    uint32_t row = 0;
+    for (uint32_t e = 0; e < h->n_events; ++e)
+    {
+        const tb_manifest_event_t *ev = &mf->events[e];
+        if (!name_ok(mf, ev->name) || ev->first_section != sec ||
+            ev->first_tier != tier || ev->first_seat != seat ||
+            ev->n_sections > h->n_sections - sec || ev->n_tiers > h->n_tiers - tier)
+            return false;
+        sec += ev->n_sections;
+        tier += ev->n_tiers;
+        for (uint32_t s = ev->first_section; s < sec; ++s)
+        {
+            const tb_manifest_section_t *sc = &mf->sections[s];
+            if (!name_ok(mf, sc->name) || sc->event != e || sc->first_row != row ||
+                sc->n_rows > h->n_rows - row)
+                return false;
+            row += sc->n_rows;
+            for (uint32_t r = sc->first_row; r < row; ++r)
+            {
+                const tb_manifest_row_t *rw = &mf->rows[r];
+                if (!name_ok(mf, rw->name) || rw->section != s ||
+                    rw->first_seat != seat || rw->n_seats > h->n_seats - seat)
+                    return false;
+                seat += rw->n_seats;
+            }
+        }
+        if (seat - ev->first_seat != ev->n_seats)
+            return false;
+    }
+    for (uint32_t t = 0; t < h->n_tiers; ++t)
+        if (!name_ok(mf, mf->tiers[t].name))
+            return false;
+    for (uint32_t n = 0; n < h->n_seat_names; ++n)
+        if (!name_ok(mf, mf->seat_names[n]))
+            return false;
+    return sec == h->n_sections && row == h->n_rows && tier == h->n_tiers && seat == h->n_seats;
+}
+
+bool tb_manifest_open(tb_manifest_t *mf, const char *path)
+{
+    if (!mf)
+        return false;
+    memset(mf, 0, sizeof(*mf));
+    if (!path)
+        return false;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    void *base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(tb_manifest_header_t))
+        base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return false;
+    mf->base = base;
+    mf->bytes = (size_t)st.st_size;
+    madvise(base, mf->bytes, MADV_WILLNEED);
+
+    const tb_manifest_header_t *h = mf->hdr = base;
+    char magic[8] = TB_MANIFEST_MAGIC;
+    bool ok = memcmp(h->magic, magic, sizeof magic) == 0 && h->version == TB_MANIFEST_VERSION &&
+              h->header_bytes == sizeof(*h) && h->file_bytes == mf->bytes &&
+              table_ok(h, h->events_off, h->n_events, sizeof(tb_manifest_event_t)) &&
+              table_ok(h, h->sections_off, h->n_sections, sizeof(tb_manifest_section_t)) &&
+              table_ok(h, h->rows_off, h->n_rows, sizeof(tb_manifest_row_t)) &&
+              table_ok(h, h->tiers_off, h->n_tiers, sizeof(tb_manifest_tier_t)) &&
+              table_ok(h, h->seats_off, h->n_seats, sizeof(tb_manifest_seat_t)) &&
+              table_ok(h, h->seat_names_off, h->n_seat_names, sizeof(uint32_t)) &&
+              table_ok(h, h->strings_off, h->strings_bytes, 1) &&
+              h->strings_bytes > 0 && h->strings_bytes <= UINT32_MAX;
+    if (ok)
+    {
+        const char *b = base;
+        mf->events = (const void *)(b + h->events_off);
+        mf->sections = (const void *)(b + h->sections_off);
+        mf->rows = (const void *)(b + h->rows_off);
+        mf->tiers = (const void *)(b + h->tiers_off);
+        mf->seats = (const void *)(b + h->seats_off);
+        mf->seat_names = (const void *)(b + h->seat_names_off);
+        mf->strings = b + h->strings_off;
+        ok = mf->strings[h->strings_bytes - 1] == '\0' && structure_ok(mf);
+    }
+    if (!ok)
+        tb_manifest_close(mf);
+    return ok;
+}
+
+void tb_manifest_close(tb_manifest_t *mf)
+{
+    if (!mf)
+        return;
+    if (mf->base)
+        munmap((void *)mf->base, mf->bytes);
+    memset(mf, 0, sizeof(*mf));
+}
+
+/* ---- Parallel load ---- */
+
+typedef struct
+{
+    const tb_manifest_t *mf;
+    seat_map_t *m;
+    const uint32_t *event_ix; // per manifest event; 0 = skipped
+    uint32_t *seat_ix;        // per seat name, filled by the first pass
+    tb_epoch_t now;
+    uint64_t next_block;
+    uint64_t loaded;
+} load_job_t;
+
+// Manifest event owning seat s.
+static uint32_t event_of_seat(const tb_manifest_t *mf, uint64_t s)
+{
+    uint32_t lo = 0, hi = mf->hdr->n_events;
+    while (hi - lo > 1)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (mf->events[mid].first_seat <= s)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// First pass: intern each distinct seat id once, a block per lock round.
+static void *intern_worker(void *arg)
+{
+    load_job_t *job = arg;
+    const tb_manifest_t *mf = job->mf;
+    uint32_t total = mf->hdr->n_seat_names;
+    const char *names[MANIFEST_LOAD_BLOCK];
+    for (;;)
+    {
+        uint64_t s = __atomic_fetch_add(&job->next_block, 1, __ATOMIC_RELAXED) * MANIFEST_LOAD_BLOCK;
+        if (s >= total)
+            break;
+        size_t n = total - s < MANIFEST_LOAD_BLOCK ? (size_t)(total - s) : MANIFEST_LOAD_BLOCK;
+        for (size_t i = 0; i < n; ++i)
+            names[i] = mf->strings + mf->seat_names[s + i];
+        tb_intern_many(TB_NS_SEAT, names, n, &job->seat_ix[s]);
+    }
+    return NULL;
+}
+
+// Load seats [s, end) of manifest event e.
+static uint64_t load_run(load_job_t *job, uint32_t e, uint64_t s, uint64_t end)
+{
+    const tb_manifest_t *mf = job->mf;
+    const tb_manifest_event_t *ev = &mf->events[e];
+    seat_bulk_t rows[MANIFEST_LOAD_BLOCK];
+    size_t n = (size_t)(end - s);
+    if (n > MANIFEST_LOAD_BLOCK)
+        return 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const tb_manifest_seat_t *st = &mf->seats[s + i];
+        bool ok = st->name < mf->hdr->n_seat_names && st->tier - ev->first_tier < ev->n_tiers;
+        rows[i].seat_ix = ok ? job->seat_ix[st->name] : 0;
+        rows[i].price_cents = ok ? mf->tiers[st->tier].price_cents : 0;
+    }
+    return seat_map_bulk_fill(job->m, job->event_ix[e], (size_t)(s - ev->first_seat),
+                              rows, n, job->now);
+}
+
+// Second pass: fill records, a block of the seat table at a time.
+static void *fill_worker(void *arg)
+{
+    load_job_t *job = arg;
+    const tb_manifest_t *mf = job->mf;
+    uint64_t total = mf->hdr->n_seats, loaded = 0;
+    for (;;)
+    {
+        uint64_t s = __atomic_fetch_add(&job->next_block, 1, __ATOMIC_RELAXED) * MANIFEST_LOAD_BLOCK;
+        if (s >= total)
+            break;
+        uint64_t block_end = s + MANIFEST_LOAD_BLOCK < total ? s + MANIFEST_LOAD_BLOCK : total;
+        while (s < block_end)
+        {
+            uint32_t e = event_of_seat(mf, s);
+            const tb_manifest_event_t *ev = &mf->events[e];
+            uint64_t end = ev->first_seat + ev->n_seats;
+            if (end > block_end)
+                end = block_end;
+            if (job->event_ix[e] != 0)
+                loaded += load_run(job, e, s, end);
+            s = end;
+        }
+    }
+    __atomic_add_fetch(&job->loaded, loaded, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+// Give loaded event e its rows, in manifest order. Positions match manifest
+// seats because the bulk load fills record i with seat i of the event.
+static void set_layout(const tb_manifest_t *mf, seat_map_t *m, uint32_t e, uint32_t event_ix)
+{
+    const tb_manifest_event_t *ev = &mf->events[e];
+    size_t n = 0;
+    for (uint32_t s = ev->first_section; s < ev->first_section + ev->n_sections; ++s)
+        n += mf->sections[s].n_rows;
+    seat_row_t *rows = malloc((n ? n : 1) * sizeof(seat_row_t));
+    if (!rows)
+        return; // loaded without a layout
+    n = 0;
+    for (uint32_t s = ev->first_section; s < ev->first_section + ev->n_sections; ++s)
+    {
+        const tb_manifest_section_t *sec = &mf->sections[s];
+        uint32_t section_ix = tb_intern(TB_NS_SECTION, tb_manifest_name(mf, sec->name));
+        for (uint32_t r = sec->first_row; r < sec->first_row + sec->n_rows; ++r)
+        {
+            rows[n].section_ix = section_ix;
+            rows[n].first = (uint32_t)(mf->rows[r].first_seat - ev->first_seat);
+            rows[n].n_seats = mf->rows[r].n_seats;
+            n++;
+        }
+    }
+    seat_map_event_set_rows(m, event_ix, rows, n);
+    free(rows);
+}
+
+// Run fn on `threads` threads (the caller being one of them) over `items`.
+static void run_pass(void *(*fn)(void *), load_job_t *job, unsigned threads, uint64_t items)
+{
+    uint64_t blocks = (items + MANIFEST_LOAD_BLOCK - 1) / MANIFEST_LOAD_BLOCK;
+    if (threads > blocks)
+        threads = blocks ? (unsigned)blocks : 1;
+    job->next_block = 0;
+    pthread_t th[MANIFEST_MAX_THREADS];
+    unsigned started = 0;
+    while (started + 1 < threads && pthread_create(&th[started], NULL, fn, job) == 0)
+        started++;
+    fn(job);
+    for (unsigned t = 0; t < started; ++t)
+        pthread_join(th[t], NULL);
+}
+
+size_t tb_manifest_load(const tb_manifest_t *mf, seat_map_t *m, unsigned threads)
+{
+    if (!mf || !mf->hdr || !m)
+        return 0;
+    const tb_manifest_header_t *h = mf->hdr;
+    uint32_t *evs = calloc((size_t)h->n_events + 1, sizeof(uint32_t));
+    uint32_t *seat_ix = calloc((size_t)h->n_seat_names + 1, sizeof(uint32_t));
+    if (!evs || !seat_ix)
+    {
+        free(evs);
+        free(seat_ix);
+        return 0;
+    }
+    for (uint32_t e = 0; e < h->n_events; ++e)
+    {
+        uint32_t ix = tb_intern(TB_NS_EVENT, tb_manifest_name(mf, mf->events[e].name));
+        if (ix != 0 && seat_map_bulk_begin(m, ix, (size_t)mf->events[e].n_seats))
+            evs[e] = ix;
+    }
+
+    if (threads == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (unsigned)cpus : 1;
+    }
+    if (threads > MANIFEST_MAX_THREADS)
+        threads = MANIFEST_MAX_THREADS;
+    load_job_t job = {.mf = mf, .m = m, .event_ix = evs, .seat_ix = seat_ix,
+                      .now = (tb_epoch_t)time(NULL)};
+    run_pass(intern_worker, &job, threads, h->n_seat_names);
+    run_pass(fill_worker, &job, threads, h->n_seats);
+
+    for (uint32_t e = 0; e < h->n_events; ++e)
+    {
+        if (evs[e] != 0)
+        {
+            seat_map_bulk_end(m, evs[e]);
+            set_layout(mf, m, e, evs[e]);
+        }
+    }
+    free(evs);
+    free(seat_ix);
+    return (size_t)job.loaded;
+}
+
+/* ---- CSV conversion ---- */
+
+// Growable array of `elem`-sized items.
+static bool vec_reserve(void **p, size_t *cap, size_t need, size_t elem)
+{
+    if (need <= *cap)
+        return true;
+    size_t n = *cap ? *cap : 64;
+    while (n < need)
+        n *= 2;
+    void *q = realloc(*p, n * elem);
+    if (!q)
+        return false;
+    *p = q;
+    *cap = n;
+    return true;
+}
+
+// Open-addressing map from a 64-bit key to a 32-bit index.
+typedef struct
+{
+    uint64_t *keys;
+    uint32_t *vals; // index + 1; 0 = empty
+    size_t mask;
+    size_t count;
+} conv_map_t;
+
+static inline size_t conv_slot(uint64_t key, size_t mask)
+{
+    key = (key ^ (key >> 33)) * 0xff51afd7ed558ccdULL;
+    return (size_t)(key ^ (key >> 29)) & mask;
+}
+
+static bool conv_map_grow(conv_map_t *mp)
+{
+    size_t slots = mp->keys ? (mp->mask + 1) * 2 : 1024;
+    conv_map_t n = {calloc(slots, sizeof(uint64_t)), calloc(slots, sizeof(uint32_t)), slots - 1, mp->count};
+    if (!n.keys || !n.vals)
+    {
+        free(n.keys);
+        free(n.vals);
+        return false;
+    }
+    for (size_t i = 0; mp->keys && i <= mp->mask; ++i)
+    {
+        if (!mp->vals[i])
+            continue;
+        size_t j = conv_slot(mp->keys[i], n.mask);
+        while (n.vals[j])
+            j = (j + 1) & n.mask;
+        n.keys[j] = mp->keys[i];
+        n.vals[j] = mp->vals[i];
+    }
+    free(mp->keys);
+    free(mp->vals);
+    *mp = n;
+    return true;
+}
+
+// Index stored for key, inserting `fresh` if absent. *added tells which.
+// Returns UINT32_MAX on allocation failure.
+static uint32_t conv_map_get(conv_map_t *mp, uint64_t key, uint32_t fresh, bool *added)
+{
+    if ((mp->count + 1) * 2 > (mp->keys ? mp->mask + 1 : 0) && !conv_map_grow(mp))
+        return UINT32_MAX;
+    size_t i = conv_slot(key, mp->mask);
+    for (; mp->vals[i]; i = (i + 1) & mp->mask)
+    {
+        if (mp->keys[i] == key)
+        {
+            *added = false;
+            return mp->vals[i] - 1;
+        }
+    }
+    mp->keys[i] = key;
+    mp->vals[i] = fresh + 1;
+    mp->count++;
+    *added = true;
+    return fresh;
+}
+
+static void conv_map_free(conv_map_t *mp)
+{
+    free(mp->keys);
+    free(mp->vals);
+}
+
+typedef struct { uint32_t name; } conv_event_t;
+typedef struct { uint32_t parent, name; } conv_node_t;          // section, row
+typedef struct { uint32_t event, name; tb_money_cents_t price; } conv_tier_t;
+typedef struct { uint32_t row, name, tier; } conv_seat_t;
+
+typedef struct
+{
+    char *strings;
+    size_t strings_len, strings_cap;
+    conv_map_t by_string, by_event, by_section, by_row, by_tier, by_seat, by_seat_name;
+    conv_event_t *events;
+    conv_node_t *sections, *rows;
+    conv_tier_t *tiers;
+    conv_seat_t *seats;
+    uint32_t *seat_names; // string offsets
+    size_t n_events, n_sections, n_rows, n_tiers, n_seats, n_seat_names;
+    size_t events_cap, sections_cap, rows_cap, tiers_cap, seats_cap, seat_names_cap;
+} conv_t;
+
+static void conv_free(conv_t *cv)
+{
+    free(cv->strings);
+    conv_map_free(&cv->by_string);
+    conv_map_free(&cv->by_event);
+    conv_map_free(&cv->by_section);
+    conv_map_free(&cv->by_row);
+    conv_map_free(&cv->by_tier);
+    conv_map_free(&cv->by_seat);
+    conv_map_free(&cv->by_seat_name);
+    free(cv->events);
+    free(cv->sections);
+    free(cv->rows);
+    free(cv->tiers);
+    free(cv->seats);
+    free(cv->seat_names);
+}
+
+// Offset of `name` in the string blob, adding it once. UINT32_MAX on failure.
+static uint32_t conv_string(conv_t *cv, const char *name, size_t len)
+{
+    // The map is keyed by hash; colliding names are told apart by content.
+    uint64_t h = tb_hash_bytes(name, len, 0);
+    for (uint64_t probe = 0;; ++probe)
+    {
+        bool added;
+        uint32_t off = conv_map_get(&cv->by_string, h + probe, (uint32_t)cv->strings_len, &added);
+        if (off == UINT32_MAX)
+            return UINT32_MAX;
+        if (!added)
+        {
+            if (strncmp(cv->strings + off, name, len) == 0 && cv->strings[off + len] == '\0')
+                return off;
+            continue;
+        }
+        if (cv->strings_len + len + 1 > UINT32_MAX ||
+            !vec_reserve((void **)&cv->strings, &cv->strings_cap, cv->strings_len + len + 1, 1))
+            return UINT32_MAX;
+        memcpy(cv->strings + cv->strings_len, name, len);
+        cv->strings[cv->strings_len + len] = '\0';
+        cv->strings_len += len + 1;
+        return off;
+    }
+}
+
+// Index of the child `name` under `parent` in a node list, adding it.
+static uint32_t conv_node(conv_map_t *mp, conv_node_t **list, size_t *n, size_t *cap,
+                          uint32_t parent, uint32_t name)
+{
+    bool added;
+    uint32_t ix = conv_map_get(mp, (uint64_t)parent << 32 | name, (uint32_t)*n, &added);
+    if (ix == UINT32_MAX || !added)
+        return ix;
+    if (!vec_reserve((void **)list, cap, *n + 1, sizeof(conv_node_t)))
+        return UINT32_MAX;
+    (*list)[(*n)++] = (conv_node_t){parent, name};
+    return ix;
+}
+
+typedef enum { CONV_OK, CONV_BAD_LINE, CONV_NOMEM } conv_status_t;
+
+// Split a line into exactly `want` comma-separated fields, in place.
+static bool split_fields(char *line, char **f, size_t *len, size_t want)
+{
+    size_t n = 0;
+    for (char *p = line;; ++p)
+    {
+        if (n == want)
+            return false;
+        f[n] = p;
+        while (*p && *p != ',')
+            ++p;
+        len[n] = (size_t)(p - f[n]);
+        n++;
+        if (*p == '\0')
+            return n == want;
+        *p = '\0';
+    }
+}
+
+static conv_status_t conv_line(conv_t *cv, char *line)
+{
+    enum { F_EVENT, F_SECTION, F_ROW, F_SEAT, F_TIER, F_PRICE, F_COUNT };
+    char *f[F_COUNT];
+    size_t len[F_COUNT];
+    if (!split_fields(line, f, len, F_COUNT))
+        return CONV_BAD_LINE;
+    uint32_t off[F_TIER + 1];
+    for (int i = 0; i <= F_TIER; ++i)
+    {
+        if (len[i] == 0 || len[i] >= TB_ID_LEN)
+            return CONV_BAD_LINE;
+        if ((off[i] = conv_string(cv, f[i], len[i])) == UINT32_MAX)
+            return CONV_NOMEM;
+    }
+    char *endp;
+    long price = strtol(f[F_PRICE], &endp, 10);
+    if (len[F_PRICE] == 0 || *endp != '\0' || price < 0 || price > INT32_MAX)
+        return CONV_BAD_LINE;
+
+    bool added;
+    uint32_t ev = conv_map_get(&cv->by_event, off[F_EVENT], (uint32_t)cv->n_events, &added);
+    if (ev == UINT32_MAX)
+        return CONV_NOMEM;
+    if (added)
+    {
+        if (!vec_reserve((void **)&cv->events, &cv->events_cap, cv->n_events + 1, sizeof(conv_event_t)))
+            return CONV_NOMEM;
+        cv->events[cv->n_events++].name = off[F_EVENT];
+    }
+    uint32_t sec = conv_node(&cv->by_section, &cv->sections, &cv->n_sections, &cv->sections_cap,
+                             ev, off[F_SECTION]);
+    uint32_t row = sec == UINT32_MAX ? UINT32_MAX
+                                     : conv_node(&cv->by_row, &cv->rows, &cv->n_rows, &cv->rows_cap,
+                                                 sec, off[F_ROW]);
+    if (row == UINT32_MAX)
+        return CONV_NOMEM;
+
+    uint32_t tier = conv_map_get(&cv->by_tier, (uint64_t)ev << 32 | off[F_TIER], (uint32_t)cv->n_tiers, &added);
+    if (tier == UINT32_MAX)
+        return CONV_NOMEM;
+    if (added)
+    {
+        if (!vec_reserve((void **)&cv->tiers, &cv->tiers_cap, cv->n_tiers + 1, sizeof(conv_tier_t)))
+            return CONV_NOMEM;
+        cv->tiers[cv->n_tiers++] = (conv_tier_t){ev, off[F_TIER], (tb_money_cents_t)price};
+    }
+    else if (cv->tiers[tier].price != (tb_money_cents_t)price)
+    {
+        return CONV_BAD_LINE;
+    }
+
+    uint32_t name = conv_map_get(&cv->by_seat_name, off[F_SEAT], (uint32_t)cv->n_seat_names, &added);
+    if (name == UINT32_MAX)
+        return CONV_NOMEM;
+    if (added)
+    {
+        if (!vec_reserve((void **)&cv->seat_names, &cv->seat_names_cap, cv->n_seat_names + 1, sizeof(uint32_t)))
+            return CONV_NOMEM;
+        cv->seat_names[cv->n_seat_names++] = off[F_SEAT];
+    }
+    if (conv_map_get(&cv->by_seat, (uint64_t)ev << 32 | name, 0, &added) == UINT32_MAX)
+        return CONV_NOMEM;
+    if (!added)
+        return CONV_BAD_LINE; // seat repeated within the event
+    if (!vec_reserve((void **)&cv->seats, &cv->seats_cap, cv->n_seats + 1, sizeof(conv_seat_t)))
+        return CONV_NOMEM;
+    cv->seats[cv->n_seats++] = (conv_seat_t){row, name, tier};
+    return CONV_OK;
+}
+
+// Stable counting sort of n items by group: out[i] is item i's new position.
+// `groups` group ids come from key(i); start receives each group's first slot.
+static bool group_order(size_t n, size_t groups, const uint32_t *key, uint32_t *out, uint32_t *start)
+{
+    uint32_t *next = calloc(groups + 1, sizeof(uint32_t));
+    if (!next)
+        return false;
+    for (size_t i = 0; i < n; ++i)
+        next[key[i] + 1]++;
+    for (size_t g = 0; g < groups; ++g)
+        next[g + 1] += next[g];
+    if (start)
+        memcpy(start, next, (groups + 1) * sizeof(uint32_t));
+    for (size_t i = 0; i < n; ++i)
+        out[i] = next[key[i]]++;
+    free(next);
+    return true;
+}
+
+static size_t align8(size_t n)
+{
+    return (n + 7) & ~(size_t)7;
+}
+
+static bool write_at(FILE *f, uint64_t off, const void *p, size_t bytes)
+{
+    return fseeko(f, (off_t)off, SEEK_SET) == 0 && fwrite(p, 1, bytes, f) == bytes;
+}
+
+// Arrange the parsed seats into nested runs and write the file.
+static bool conv_write(conv_t *cv, const char *out_path)
+{
+    size_t ne = cv->n_events, ns = cv->n_sections, nr = cv->n_rows, nt = cv->n_tiers, nz = cv->n_seats;
+    size_t nn = cv->n_seat_names;
+    if (ne > UINT32_MAX - 1 || ns > UINT32_MAX - 1 || nr > UINT32_MAX - 1 || nt > UINT32_MAX - 1 ||
+        nz > UINT32_MAX - 1)
+        return false;
+    size_t most = nz > ns ? nz : ns;
+    most = most > nr ? most : nr;
+    most = most > nt ? most : nt;
+    uint32_t *key = malloc((most + 1) * sizeof(uint32_t));
+    uint32_t *sec_pos = malloc((ns + 1) * sizeof(uint32_t));
+    uint32_t *row_pos = malloc((nr + 1) * sizeof(uint32_t));
+    uint32_t *tier_pos = malloc((nt + 1) * sizeof(uint32_t));
+    uint32_t *seat_pos = malloc((nz + 1) * sizeof(uint32_t));
+    uint32_t *sec_start = malloc((ne + 1) * sizeof(uint32_t));
+    uint32_t *row_start = malloc((ns + 1) * sizeof(uint32_t));
+    uint32_t *tier_start = malloc((ne + 1) * sizeof(uint32_t));
+    uint32_t *seat_start = malloc((nr + 1) * sizeof(uint32_t));
+    tb_manifest_event_t *events = calloc(ne + 1, sizeof(*events));
+    tb_manifest_section_t *sections = calloc(ns + 1, sizeof(*sections));
+    tb_manifest_row_t *rows = calloc(nr + 1, sizeof(*rows));
+    tb_manifest_tier_t *tiers = calloc(nt + 1, sizeof(*tiers));
+    tb_manifest_seat_t *seats = calloc(nz + 1, sizeof(*seats));
+    bool ok = key && sec_pos && row_pos && tier_pos && seat_pos && sec_start && row_start &&
+              tier_start && seat_start && events && sections && rows && tiers && seats;
+
+    // Sections by event, rows by (sorted) section, seats by (sorted) row.
+    for (size_t i = 0; ok && i < ns; ++i)
+        key[i] = cv->sections[i].parent;
+    ok = ok && group_order(ns, ne, key, sec_pos, sec_start);
+    for (size_t i = 0; ok && i < nr; ++i)
+        key[i] = sec_pos[cv->rows[i].parent];
+    ok = ok && group_order(nr, ns, key, row_pos, row_start);
+    for (size_t i = 0; ok && i < nt; ++i)
+        key[i] = cv->tiers[i].event;
+    ok = ok && group_order(nt, ne, key, tier_pos, tier_start);
+    for (size_t i = 0; ok && i < nz; ++i)
+        key[i] = row_pos[cv->seats[i].row];
+    ok = ok && group_order(nz, nr, key, seat_pos, seat_start);
+
+    if (ok)
+    {
+        for (size_t e = 0; e < ne; ++e)
+        {
+            // Every event has a section and every section a row, since both
+            // are created by a seat.
+            uint32_t s0 = sec_start[e], s1 = sec_start[e + 1];
+            uint32_t r0 = row_start[s0], r1 = row_start[s1];
+            events[e] = (tb_manifest_event_t){
+                .name = cv->events[e].name,
+                .first_section = s0,
+                .n_sections = s1 - s0,
+                .first_tier = tier_start[e],
+                .n_tiers = tier_start[e + 1] - tier_start[e],
+                .first_seat = seat_start[r0],
+                .n_seats = seat_start[r1] - seat_start[r0],
+            };
+        }
+        for (size_t i = 0; i < ns; ++i)
+        {
+            uint32_t p = sec_pos[i];
+            sections[p] = (tb_manifest_section_t){cv->sections[i].name, cv->sections[i].parent,
+                                                  row_start[p], row_start[p + 1] - row_start[p]};
+        }
+        for (size_t i = 0; i < nr; ++i)
+        {
+            uint32_t p = row_pos[i];
+            rows[p] = (tb_manifest_row_t){.name = cv->rows[i].name, .section = sec_pos[cv->rows[i].parent],
+                                          .n_seats = seat_start[p + 1] - seat_start[p],
+                                          .first_seat = seat_start[p]};
+        }
+        for (size_t i = 0; i < nt; ++i)
+            tiers[tier_pos[i]] = (tb_manifest_tier_t){cv->tiers[i].name, cv->tiers[i].price};
+        for (size_t i = 0; i < nz; ++i)
+            seats[seat_pos[i]] = (tb_manifest_seat_t){cv->seats[i].name, tier_pos[cv->seats[i].tier]};
+    }
+
+    tb_manifest_header_t h = {
+        .magic = TB_MANIFEST_MAGIC,
+        .version = TB_MANIFEST_VERSION,
+        .header_bytes = sizeof h,
+        .n_events = (uint32_t)ne,
+        .n_sections = (uint32_t)ns,
+        .n_rows = (uint32_t)nr,
+        .n_tiers = (uint32_t)nt,
+        .n_seat_names = (uint32_t)nn,
+        .n_seats = nz,
+    };
+    h.events_off = align8(sizeof h);
+    h.sections_off = align8(h.events_off + ne * sizeof(*events));
+    h.rows_off = align8(h.sections_off + ns * sizeof(*sections));
+    h.tiers_off = align8(h.rows_off + nr * sizeof(*rows));
+    h.seats_off = align8(h.tiers_off + nt * sizeof(*tiers));
+    h.seat_names_off = align8(h.seats_off + nz * sizeof(*seats));
+    h.strings_off = align8(h.seat_names_off + nn * sizeof(uint32_t));
+    h.strings_bytes = cv->strings_len ? cv->strings_len : 1;
+    h.file_bytes = h.strings_off + h.strings_bytes;
+
+    FILE *f = ok ? fopen(out_path, "wb") : NULL;
+    if (f)
+    {
+        static const char nul = '\0';
+        ok = write_at(f, 0, &h, sizeof h) &&
+             write_at(f, h.events_off, events, ne * sizeof(*events)) &&
+             write_at(f, h.sections_off, sections, ns * sizeof(*sections)) &&
+             write_at(f, h.rows_off, rows, nr * sizeof(*rows)) &&
+             write_at(f, h.tiers_off, tiers, nt * sizeof(*tiers)) &&
+             write_at(f, h.seats_off, seats, nz * sizeof(*seats)) &&
+             write_at(f, h.seat_names_off, cv->seat_names, nn * sizeof(uint32_t)) &&
+             write_at(f, h.strings_off, cv->strings_len ? cv->strings : &nul, h.strings_bytes);
+        ok = fclose(f) == 0 && ok;
+        if (!ok)
+            remove(out_path);
+    }
+    else
+    {
+        ok = false;
+    }
+
+    free(key);
+    free(sec_pos);
+    free(row_pos);
+    free(tier_pos);
+    free(seat_pos);
+    free(sec_start);
+    free(row_start);
+    free(tier_start);
+    free(seat_start);
+    free(events);
+    free(sections);
+    free(rows);
+    free(tiers);
+    free(seats);
+    return ok;
+}
+
+bool tb_manifest_from_csv(const char *csv_path, const char *out_path, size_t *err_line)
+{
+    if (err_line)
+        *err_line = 0;
+    if (!csv_path || !out_path)
+        return false;
+    FILE *in = fopen(csv_path, "r");
+    if (!in)
+        return false;
+
+    conv_t cv;
+    memset(&cv, 0, sizeof cv);
+    char *line = NULL;
+    size_t line_cap = 0, lineno = 0;
+    ssize_t got;
+    conv_status_t st = CONV_OK;
+    while (st == CONV_OK && (got = getline(&line, &line_cap, in)) >= 0)
+    {
+        lineno++;
+        while (got > 0 && (line[got - 1] == '\n' || line[got - 1] == '\r'))
+            line[--got] = '\0';
+        if (got == 0 || (lineno == 1 && strncmp(line, "event_id", 8) == 0))
+            continue;
+        st = conv_line(&cv, line);
+    }
+    bool ok = st == CONV_OK && !ferror(in);
+    free(line);
+    fclose(in);
+    if (!ok && st == CONV_BAD_LINE && err_line)
+        *err_line = lineno;
+
+    ok = ok && conv_write(&cv, out_path);
+    conv_free(&cv);
+    return ok;
+}
@@ -0,0 +1,95 @@
+// Order id generator (see orderid.h).
+//
+// g_next is the only shared state ids are drawn from; each thread keeps the
+// rest of its current lease in thread-locals. A thread that exits drops the
+// unused part of its lease, leaving a gap, never a repeat.
+
+#include "orderid.h"
+
+#include <string.h>
+#include <time.h>
+
+#ifndef CONFIG_ORDERID_LEASE
+#define CONFIG_ORDERID_LEASE 256
+#endif
+
+#define SEQ_PER_MS   4096ull
+#define EPOCH_2024_S 1704067200ull
+
+static uint64_t g_next;  // next unleased sequence number, 0 = not started
+static uint32_t g_node;
+static __thread uint64_t t_seq, t_end; // this thread's lease [t_seq, t_end)
+
+static const char k_digits[32] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+
+static uint64_t start_seq(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t ms = (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+    ms = ms > EPOCH_2024_S * 1000u ? ms - EPOCH_2024_S * 1000u : 0;
+    return ms * SEQ_PER_MS + 1;
+}
+
+bool tb_orderid_set_node(uint32_t node)
+{
+    if (node > TB_ORDERID_MAX_NODE || __atomic_load_n(&g_next, __ATOMIC_ACQUIRE) != 0)
+        return false;
+    __atomic_store_n(&g_node, node, __ATOMIC_RELAXED);
+    return true;
+}
+
+static void lease(void)
+{
+    uint64_t cur = __atomic_load_n(&g_next, __ATOMIC_RELAXED);
+    if (cur == 0)
+    {
+        // First id of the process: whoever wins the CAS sets the start.
+        uint64_t start = start_seq();
+        __atomic_compare_exchange_n(&g_next, &cur, start, false, __ATOMIC_ACQ_REL,
+                                    __ATOMIC_RELAXED);
+    }
+    t_seq = __atomic_fetch_add(&g_next, CONFIG_ORDERID_LEASE, __ATOMIC_RELAXED);
+    t_end = t_seq + CONFIG_ORDERID_LEASE;
+}
+
+uint64_t tb_orderid_next(void)
+{
+    if (t_seq == t_end)
+        lease();
+    return (t_seq++ << TB_ORDERID_NODE_BITS) | __atomic_load_n(&g_node, __ATOMIC_RELAXED);
+}
+
+size_t tb_orderid_format(uint64_t id, char out[TB_ORDERID_STR_LEN])
+{
+    memcpy(out, "ORD-", 4);
+    for (int i = 16; i >= 4; --i, id >>= 5)
+        out[i] = k_digits[id & 31];
+    out[17] = '\0';
+    return 17;
+}
+
+static int digit_value(char c)
+{
+    if (c >= 'a' && c <= 'z')
+        c = (char)(c - 'a' + 'A');
+    const char *p = c ? memchr(k_digits, c, sizeof k_digits) : NULL;
+    return p ? (int)(p - k_digits) : -1;
+}
+
+bool tb_orderid_parse(const char *s, uint64_t *out)
+{
+    if (!s || strncmp(s, "ORD-", 4) != 0 || strlen(s) != 17)
+        return false;
+    uint64_t id = 0;
+    for (int i = 4; i < 17; ++i)
+    {
+        int d = digit_value(s[i]);
+        if (d < 0 || (i == 4 && d > 15)) // the first digit holds 4 bits
+            return false;
+        id = id << 5 | (uint64_t)d;
+    }
+    if (out)
+        *out = id;
+    return true;
+}
@@ -0,0 +1,145 @@
+// Token-bucket rate limiter (see ratelimit.h).
+//
+// A set is one 256-byte block: a spinlock and RL_WAYS buckets. A key maps to
+// one set by its hash and may sit in any of its ways; a miss takes an empty
+// way or the one seen longest ago. Tokens are kept in billionths, so a
+// refill is elapsed_ns * rate with no division.
+
+#include "ratelimit.h"
+
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RL_WAYS 10
+#define RL_UNIT 1000000000ull // token fraction per whole token
+
+typedef struct
+{
+    uint64_t key; // 0 = empty
+    uint64_t seen_ns;
+    uint64_t tokens; // in 1/RL_UNIT tokens
+} rl_bucket_t;
+
+typedef struct
+{
+    _Alignas(64) uint32_t lock;
+    rl_bucket_t way[RL_WAYS];
+} rl_set_t;
+
+struct tb_ratelimit
+{
+    rl_set_t *sets;
+    size_t mask;
+    uint32_t rate;
+    uint32_t burst;
+    uint64_t evictions;
+};
+
+tb_ratelimit_t *tb_ratelimit_create(size_t max_keys, uint32_t rate_per_sec, uint32_t burst)
+{
+    if (rate_per_sec == 0 || burst == 0)
+        return NULL;
+    size_t n = 1;
+    while (n * RL_WAYS < max_keys && n < ((size_t)1 << 40))
+        n <<= 1;
+    tb_ratelimit_t *rl = calloc(1, sizeof *rl);
+    rl_set_t *sets = aligned_alloc(_Alignof(rl_set_t), n * sizeof(rl_set_t));
+    if (!rl || !sets)
+    {
+        free(rl);
+        free(sets);
+        return NULL;
+    }
+    memset(sets, 0, n * sizeof(rl_set_t));
+    rl->sets = sets;
+    rl->mask = n - 1;
+    rl->rate = rate_per_sec;
+    rl->burst = burst;
+    return rl;
+}
+
+void tb_ratelimit_destroy(tb_ratelimit_t *rl)
+{
+    if (!rl)
+        return;
+    free(rl->sets);
+    free(rl);
+}
+
+void tb_ratelimit_set(tb_ratelimit_t *rl, uint32_t rate_per_sec, uint32_t burst)
+{
+    if (!rl || rate_per_sec == 0 || burst == 0)
+        return;
+    __atomic_store_n(&rl->rate, rate_per_sec, __ATOMIC_RELAXED);
+    __atomic_store_n(&rl->burst, burst, __ATOMIC_RELAXED);
+}
+
+static void set_lock(rl_set_t *s)
+{
+    for (unsigned spins = 0; __atomic_exchange_n(&s->lock, 1u, __ATOMIC_ACQUIRE) != 0; ++spins)
+        if (spins >= 64)
+            sched_yield(); // holder preempted
+}
+
+static void set_unlock(rl_set_t *s)
+{
+    __atomic_store_n(&s->lock, 0u, __ATOMIC_RELEASE);
+}
+
+bool tb_ratelimit_allow(tb_ratelimit_t *rl, uint64_t key, uint64_t now_ns)
+{
+    if (!rl)
+        return true;
+    key |= key == 0; // 0 marks an empty way
+    uint64_t rate = __atomic_load_n(&rl->rate, __ATOMIC_RELAXED);
+    uint64_t full = (uint64_t)__atomic_load_n(&rl->burst, __ATOMIC_RELAXED) * RL_UNIT;
+    rl_set_t *s = &rl->sets[(size_t)((key * 0x9E3779B97F4A7C15ULL) >> 24) & rl->mask];
+
+    set_lock(s);
+    rl_bucket_t *b = NULL, *victim = &s->way[0];
+    for (int i = 0; i < RL_WAYS; ++i)
+    {
+        rl_bucket_t *w = &s->way[i];
+        if (w->key == key)
+        {
+            b = w;
+            break;
+        }
+        if (victim->key != 0 && (w->key == 0 || w->seen_ns < victim->seen_ns))
+            victim = w;
+    }
+    if (!b)
+    {
+        if (victim->key != 0)
+            __atomic_add_fetch(&rl->evictions, 1, __ATOMIC_RELAXED);
+        b = victim;
+        b->key = key;
+        b->seen_ns = now_ns;
+        b->tokens = full;
+    }
+    else if (now_ns > b->seen_ns)
+    {
+        uint64_t elapsed = now_ns - b->seen_ns;
+        uint64_t room = b->tokens < full ? full - b->tokens : 0;
+        b->tokens = elapsed >= room / rate + 1 ? full : b->tokens + elapsed * rate;
+        b->seen_ns = now_ns;
+    }
+    if (b->tokens > full)
+        b->tokens = full; // the burst was lowered
+    bool ok = b->tokens >= RL_UNIT;
+    if (ok)
+        b->tokens -= RL_UNIT;
+    set_unlock(s);
+    return ok;
+}
+
+uint64_t tb_ratelimit_evictions(const tb_ratelimit_t *rl)
+{
+    return rl ? __atomic_load_n(&rl->evictions, __ATOMIC_RELAXED) : 0;
+}
+
+size_t tb_ratelimit_memory_bytes(const tb_ratelimit_t *rl)
+{
+    return rl ? sizeof *rl + (rl->mask + 1) * sizeof(rl_set_t) : 0;
+}
@@ -0,0 +1,559 @@
+// Primary/backup replication (see repl.h).
+//
+// Wire: a batch is a wire_batch_t followed by n_ops ops, each a wire_op_t
+// followed by its n seats as raw seat_t. PUT carries changed seats of any
+// events, LOAD the full export of one event, DROP none. The standby acks
+// each batch with its lsn once applied. A full copy is a SYNC_BEGIN batch
+// and one LOAD batch per event, all marked REPL_COPY and not acked, then a
+// SYNC_END batch tagged with the log position the copy started at; the
+// standby drops the events the copy did not mention.
+//
+// The shipper subscribes to the change log before copying, so every change
+// made during the copy is shipped again afterwards; for each change it
+// reads the seat (or event) as it is now, so applying in order converges
+// on the primary's state whatever the interleaving.
+
+#include "repl.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "intern.h"
+#include "reservation.h"
+#include "sock_io.h"
+
+#ifndef CONFIG_REPL_LOG_CAPACITY
+#define CONFIG_REPL_LOG_CAPACITY (1u << 20) // changes
+#endif
+
+#ifndef CONFIG_REPL_BATCH
+#define CONFIG_REPL_BATCH 1024 // changes per batch
+#endif
+
+#ifndef CONFIG_REPL_IDLE_US
+#define CONFIG_REPL_IDLE_US 100 // shipper nap when the log is drained
+#endif
+
+enum
+{
+    REPL_SYNC_BEGIN = 1u << 0,
+    REPL_SYNC_END = 1u << 1,
+    REPL_COPY = 1u << 2, // part of a full copy: no lsn, no ack
+};
+
+enum
+{
+    OP_PUT = 1,
+    OP_LOAD,
+    OP_DROP,
+};
+
+typedef struct
+{
+    uint64_t lsn; // log position the batch brings the standby to
+    uint32_t n_ops;
+    uint32_t flags;
+} wire_batch_t;
+
+typedef struct
+{
+    uint32_t op;
+    uint32_t n; // seats that follow
+    char event_id[TB_ID_LEN]; // LOAD and DROP
+} wire_op_t;
+
+// ---- batch buffer ----
+
+typedef struct
+{
+    unsigned char *p;
+    size_t len, cap;
+    size_t op_at; // offset of the open PUT op, 0 for none
+    bool oom;
+} repl_buf_t;
+
+static void *buf_grow(repl_buf_t *b, size_t n)
+{
+    if (b->oom)
+        return NULL;
+    if (b->len + n > b->cap)
+    {
+        size_t cap = b->cap ? b->cap : 64 * 1024;
+        while (cap < b->len + n)
+            cap *= 2;
+        unsigned char *p = realloc(b->p, cap);
+        if (!p)
+        {
+            b->oom = true;
+            return NULL;
+        }
+        b->p = p;
+        b->cap = cap;
+    }
+    void *at = b->p + b->len;
+    b->len += n;
+    return at;
+}
+
+static void buf_begin(repl_buf_t *b, uint64_t lsn, uint32_t flags)
+{
+    b->len = 0;
+    b->op_at = 0;
+    b->oom = false;
+    wire_batch_t *h = buf_grow(b, sizeof *h);
+    if (h)
+        *h = (wire_batch_t){.lsn = lsn, .flags = flags};
+}
+
+static wire_op_t *buf_op(repl_buf_t *b, uint32_t op, const char *event_id)
+{
+    wire_op_t *o = buf_grow(b, sizeof *o);
+    if (!o)
+        return NULL;
+    memset(o, 0, sizeof *o);
+    o->op = op;
+    if (event_id)
+        strncpy(o->event_id, event_id, TB_ID_LEN - 1);
+    ((wire_batch_t *)b->p)->n_ops++;
+    b->op_at = op == OP_PUT ? (size_t)((unsigned char *)o - b->p) : 0;
+    return o;
+}
+
+// Append a seat to the open PUT op, opening one if needed.
+static void buf_put(repl_buf_t *b, const seat_t *s)
+{
+    if (b->op_at == 0 && !buf_op(b, OP_PUT, NULL))
+        return;
+    size_t at = b->op_at;
+    seat_t *out = buf_grow(b, sizeof *out);
+    if (!out)
+        return;
+    *out = *s;
+    ((wire_op_t *)(b->p + at))->n++;
+}
+
+static bool emit_seat(const seat_t *s, void *ctx)
+{
+    repl_buf_t *b = ctx;
+    seat_t *out = buf_grow(b, sizeof *out);
+    if (!out)
+        return false;
+    *out = *s;
+    return true;
+}
+
+// Append the event as it is now: LOAD with every seat, or DROP if it is not
+// loaded (any longer).
+static void buf_event(repl_buf_t *b, uint32_t ev)
+{
+    const char *id = tb_intern_name(TB_NS_EVENT, ev);
+    if (!id)
+        return;
+    size_t at = b->len;
+    wire_op_t *o = buf_op(b, OP_LOAD, id);
+    if (!o)
+        return;
+    size_t seats_at = b->len;
+    if (!event_export(id, emit_seat, b))
+    {
+        if (b->oom)
+            return;
+        b->len = seats_at; // not loaded
+        ((wire_op_t *)(b->p + at))->op = OP_DROP;
+        return;
+    }
+    ((wire_op_t *)(b->p + at))->n = (uint32_t)((b->len - seats_at) / sizeof(seat_t));
+}
+
+// ---- primary ----
+
+static struct
+{
+    pthread_mutex_t mtx; // start and stop
+    pthread_t thread;
+    bool running;
+    int stop;
+    int listen_fd;
+    int conn_fd;
+    char path[108];
+    tb_repl_status_t st; // fields updated atomically
+} g_primary = {.mtx = PTHREAD_MUTEX_INITIALIZER, .listen_fd = -1, .conn_fd = -1};
+
+static bool primary_stopping(void)
+{
+    return __atomic_load_n(&g_primary.stop, __ATOMIC_ACQUIRE) != 0;
+}
+
+static bool ship(int fd, repl_buf_t *b)
+{
+    if (b->oom || !tb_send_all(fd, b->p, b->len))
+        return false;
+    const wire_batch_t *h = (const wire_batch_t *)b->p;
+    if (!(h->flags & REPL_COPY))
+        __atomic_store_n(&g_primary.st.shipped, h->lsn, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&g_primary.st.batches, 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+// Take in the standby's acks; false once it went away.
+static bool drain_acks(int fd)
+{
+    uint64_t acks[64];
+    for (;;)
+    {
+        ssize_t k = recv(fd, acks, sizeof acks, MSG_DONTWAIT);
+        if (k < 0 && errno == EINTR)
+            continue;
+        if (k < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return true;
+        if (k <= 0)
+            return false;
+        // Finish an ack cut in two.
+        size_t rest = (size_t)k % sizeof acks[0];
+        if (rest && !tb_recv_all(fd, (char *)acks + k, sizeof acks[0] - rest))
+            return false;
+        size_t n = ((size_t)k + sizeof acks[0] - 1) / sizeof acks[0];
+        __atomic_store_n(&g_primary.st.acked, acks[n - 1], __ATOMIC_RELEASE);
+    }
+}
+
+// Send every loaded event, tagged with the log position the copy started at.
+static bool full_copy(int fd, tb_feed_sub_t *sub, repl_buf_t *b)
+{
+    uint64_t base = tb_feed_cursor(sub);
+    buf_begin(b, 0, REPL_SYNC_BEGIN | REPL_COPY);
+    if (!ship(fd, b))
+        return false;
+    uint32_t events = tb_intern_count(TB_NS_EVENT);
+    for (uint32_t ev = 1; ev <= events && !primary_stopping(); ++ev)
+    {
+        event_inventory_t inv;
+        const char *id = tb_intern_name(TB_NS_EVENT, ev);
+        if (!id || !event_inventory(id, &inv))
+            continue;
+        buf_begin(b, 0, REPL_COPY);
+        buf_event(b, ev);
+        if (!ship(fd, b) || !drain_acks(fd))
+            return false;
+    }
+    buf_begin(b, base, REPL_SYNC_END);
+    __atomic_add_fetch(&g_primary.st.resyncs, 1, __ATOMIC_RELAXED);
+    return ship(fd, b);
+}
+
+// Ship to one standby until it goes away or we stop.
+static void serve_standby(int fd, tb_feed_t *log)
+{
+    tb_feed_sub_t *sub = tb_feed_subscribe(log);
+    tb_change_t *changes = malloc(CONFIG_REPL_BATCH * sizeof *changes);
+    repl_buf_t b = {0};
+    bool ok = sub && changes && full_copy(fd, sub, &b);
+    while (ok && !primary_stopping())
+    {
+        bool lost;
+        size_t n = tb_feed_poll(sub, changes, CONFIG_REPL_BATCH, &lost);
+        if (lost)
+        {
+            ok = full_copy(fd, sub, &b);
+            continue;
+        }
+        if (n == 0)
+        {
+            ok = drain_acks(fd);
+            struct timespec ts = {0, CONFIG_REPL_IDLE_US * 1000L};
+            nanosleep(&ts, NULL);
+            continue;
+        }
+        buf_begin(&b, tb_feed_cursor(sub), 0);
+        seat_t s;
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (changes[i].seat_ix == 0)
+                buf_event(&b, changes[i].event_ix);
+            else if (seat_export_ix(changes[i].event_ix, changes[i].seat_ix, &s))
+                buf_put(&b, &s);
+            // else: its event was unloaded; that change comes in turn
+        }
+        ok = ship(fd, &b) && drain_acks(fd);
+    }
+    free(b.p);
+    free(changes);
+    tb_feed_unsubscribe(sub);
+}
+
+static void *shipper_main(void *arg)
+{
+    tb_feed_t *log = arg;
+    while (!primary_stopping())
+    {
+        int fd = accept(g_primary.listen_fd, NULL, NULL);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            break; // stopped (or the socket failed)
+        }
+        pthread_mutex_lock(&g_primary.mtx);
+        bool stopping = primary_stopping();
+        if (!stopping)
+            g_primary.conn_fd = fd;
+        pthread_mutex_unlock(&g_primary.mtx);
+        if (!stopping)
+        {
+            __atomic_store_n(&g_primary.st.acked, 0, __ATOMIC_RELEASE);
+            __atomic_store_n(&g_primary.st.shipped, 0, __ATOMIC_RELEASE);
+            __atomic_store_n(&g_primary.st.connected, true, __ATOMIC_RELEASE);
+            serve_standby(fd, log);
+            __atomic_store_n(&g_primary.st.connected, false, __ATOMIC_RELEASE);
+        }
+        pthread_mutex_lock(&g_primary.mtx);
+        g_primary.conn_fd = -1;
+        pthread_mutex_unlock(&g_primary.mtx);
+        close(fd);
+    }
+    return NULL;
+}
+
+bool tb_repl_primary_start(const char *path, size_t log_capacity)
+{
+    if (!path || strlen(path) >= sizeof g_primary.path)
+        return false;
+    if (!reservation_enable_change_log(log_capacity ? log_capacity : CONFIG_REPL_LOG_CAPACITY))
+        return false;
+    pthread_mutex_lock(&g_primary.mtx);
+    if (g_primary.running)
+    {
+        pthread_mutex_unlock(&g_primary.mtx);
+        return false;
+    }
+    bool ok = (g_primary.listen_fd = tb_unix_listen(path)) >= 0;
+    if (ok)
+    {
+        strcpy(g_primary.path, path);
+        g_primary.stop = 0;
+        memset(&g_primary.st, 0, sizeof g_primary.st);
+        ok = pthread_create(&g_primary.thread, NULL, shipper_main, reservation_change_log()) == 0;
+        if (!ok)
+        {
+            close(g_primary.listen_fd);
+            g_primary.listen_fd = -1;
+            unlink(path);
+        }
+    }
+    __atomic_store_n(&g_primary.running, ok, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&g_primary.mtx);
+    return ok;
+}
+
+void tb_repl_primary_stop(void)
+{
+    pthread_mutex_lock(&g_primary.mtx);
+    if (!g_primary.running)
+    {
+        pthread_mutex_unlock(&g_primary.mtx);
+        return;
+    }
+    __atomic_store_n(&g_primary.stop, 1, __ATOMIC_RELEASE);
+    shutdown(g_primary.listen_fd, SHUT_RDWR); // wakes accept
+    if (g_primary.conn_fd >= 0)
+        shutdown(g_primary.conn_fd, SHUT_RDWR);
+    pthread_mutex_unlock(&g_primary.mtx);
+    pthread_join(g_primary.thread, NULL);
+    pthread_mutex_lock(&g_primary.mtx);
+    close(g_primary.listen_fd);
+    g_primary.listen_fd = -1;
+    unlink(g_primary.path);
+    __atomic_store_n(&g_primary.running, false, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&g_primary.mtx);
+}
+
+bool tb_repl_primary_status(tb_repl_status_t *out)
+{
+    tb_feed_t *log = reservation_change_log();
+    if (!out || !log || !__atomic_load_n(&g_primary.running, __ATOMIC_ACQUIRE))
+        return false;
+    out->head = tb_feed_head(log);
+    out->shipped = __atomic_load_n(&g_primary.st.shipped, __ATOMIC_ACQUIRE);
+    out->acked = __atomic_load_n(&g_primary.st.acked, __ATOMIC_ACQUIRE);
+    out->batches = __atomic_load_n(&g_primary.st.batches, __ATOMIC_RELAXED);
+    out->resyncs = __atomic_load_n(&g_primary.st.resyncs, __ATOMIC_RELAXED);
+    out->connected = __atomic_load_n(&g_primary.st.connected, __ATOMIC_ACQUIRE);
+    return true;
+}
+
+// ---- standby ----
+
+static struct
+{
+    pthread_mutex_t mtx; // start and promote
+    pthread_t thread;
+    bool running;
+    bool connected;
+    int fd;
+    uint64_t applied;
+    uint32_t sync_gen;
+    uint32_t *seen; // per event ix: sync_gen of the copy that mentioned it
+    size_t n_seen;
+} g_standby = {.mtx = PTHREAD_MUTEX_INITIALIZER, .fd = -1};
+
+static void mark_seen(uint32_t ev)
+{
+    if (ev >= g_standby.n_seen)
+    {
+        size_t n = g_standby.n_seen ? g_standby.n_seen : 1024;
+        while (n <= ev)
+            n *= 2;
+        uint32_t *p = realloc(g_standby.seen, n * sizeof *p);
+        if (!p)
+            return;
+        memset(p + g_standby.n_seen, 0, (n - g_standby.n_seen) * sizeof *p);
+        g_standby.seen = p;
+        g_standby.n_seen = n;
+    }
+    g_standby.seen[ev] = g_standby.sync_gen;
+}
+
+// A full copy is in: drop the events it did not mention.
+static void drop_unseen(void)
+{
+    uint32_t events = tb_intern_count(TB_NS_EVENT);
+    for (uint32_t ev = 1; ev <= events; ++ev)
+    {
+        event_inventory_t inv;
+        const char *id = tb_intern_name(TB_NS_EVENT, ev);
+        bool seen = ev < g_standby.n_seen && g_standby.seen[ev] == g_standby.sync_gen;
+        if (id && !seen && event_inventory(id, &inv))
+            event_unload(id);
+    }
+}
+
+static bool apply_op(int fd, bool syncing, seat_t **seats, size_t *cap)
+{
+    wire_op_t o;
+    if (!tb_recv_all(fd, &o, sizeof o))
+        return false;
+    o.event_id[TB_ID_LEN - 1] = '\0';
+    if (o.n > *cap)
+    {
+        seat_t *p = realloc(*seats, o.n * sizeof *p);
+        if (!p)
+            return false;
+        *seats = p;
+        *cap = o.n;
+    }
+    if (o.n && !tb_recv_all(fd, *seats, o.n * sizeof **seats))
+        return false;
+    switch (o.op)
+    {
+    case OP_PUT:
+        for (uint32_t i = 0; i < o.n; ++i)
+            reservation_put_seat(&(*seats)[i]);
+        break;
+    case OP_LOAD:
+        event_replace(o.event_id, *seats, o.n);
+        if (syncing)
+            mark_seen(tb_intern_lookup(TB_NS_EVENT, o.event_id));
+        break;
+    case OP_DROP:
+        event_unload(o.event_id);
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+static void *applier_main(void *arg)
+{
+    (void)arg;
+    int fd = g_standby.fd;
+    seat_t *seats = NULL;
+    size_t cap = 0;
+    bool syncing = false;
+    wire_batch_t b;
+    while (tb_recv_all(fd, &b, sizeof b))
+    {
+        if (b.flags & REPL_SYNC_BEGIN)
+        {
+            syncing = true;
+            g_standby.sync_gen++;
+        }
+        uint32_t i = 0;
+        while (i < b.n_ops && apply_op(fd, syncing, &seats, &cap))
+            i++;
+        if (i < b.n_ops)
+            break;
+        if (b.flags & REPL_SYNC_END)
+        {
+            drop_unseen();
+            syncing = false;
+        }
+        if (!(b.flags & REPL_COPY))
+        {
+            __atomic_store_n(&g_standby.applied, b.lsn, __ATOMIC_RELEASE);
+            if (!tb_send_all(fd, &b.lsn, sizeof b.lsn))
+                break;
+        }
+    }
+    free(seats);
+    __atomic_store_n(&g_standby.connected, false, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+bool tb_repl_standby_start(const char *path)
+{
+    pthread_mutex_lock(&g_standby.mtx);
+    if (g_standby.running)
+    {
+        pthread_mutex_unlock(&g_standby.mtx);
+        return false;
+    }
+    bool ok = (g_standby.fd = tb_unix_dial(path)) >= 0;
+    if (ok)
+    {
+        g_standby.applied = 0;
+        g_standby.connected = true;
+        ok = pthread_create(&g_standby.thread, NULL, applier_main, NULL) == 0;
+        if (!ok)
+        {
+            close(g_standby.fd);
+            g_standby.fd = -1;
+            g_standby.connected = false;
+        }
+    }
+    g_standby.running = ok;
+    pthread_mutex_unlock(&g_standby.mtx);
+    return ok;
+}
+
+uint64_t tb_repl_standby_applied(void)
+{
+    return __atomic_load_n(&g_standby.applied, __ATOMIC_ACQUIRE);
+}
+
+bool tb_repl_standby_connected(void)
+{
+    return __atomic_load_n(&g_standby.connected, __ATOMIC_ACQUIRE);
+}
+
+uint64_t tb_repl_promote(void)
+{
+    pthread_mutex_lock(&g_standby.mtx);
+    if (g_standby.running)
+    {
+        shutdown(g_standby.fd, SHUT_RDWR);
+        pthread_join(g_standby.thread, NULL);
+        close(g_standby.fd);
+        g_standby.fd = -1;
+        g_standby.running = false;
+        free(g_standby.seen);
+        g_standby.seen = NULL;
+        g_standby.n_seen = 0;
+    }
+    pthread_mutex_unlock(&g_standby.mtx);
+    return tb_repl_standby_applied();
+}
@@ -3,25 +3,84 @@
 #include "types.h"
 #include "config.h"
 #include <pthread.h>
+#include <sched.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "db_interface.h"
 #include "utils.h"
+#include "intern.h"
+#include "manifest.h"
+#include "feed.h"
+#include "ratelimit.h"
+#include "segment.h"
 
 #ifndef CONFIG_SEATMAP_INITIAL_CAPACITY
 #define CONFIG_SEATMAP_INITIAL_CAPACITY 16384u
 #endif
 
+// Searches for a group before giving up when other buyers keep winning seats.
+#ifndef CONFIG_BEST_AVAILABLE_ATTEMPTS
+#define CONFIG_BEST_AVAILABLE_ATTEMPTS 8
+#endif
+
+// Seat changes the feed keeps for subscribers that fall behind.
+#ifndef CONFIG_FEED_CAPACITY
+#define CONFIG_FEED_CAPACITY 65536u
+#endif
+
+// Events whose seating charts are cached (power of two). Charts of further
+// events are built per request.
+#ifndef CONFIG_CHART_CACHE_EVENTS
+#define CONFIG_CHART_CACHE_EVENTS 256u
+#endif
+
+// Active holds one user may have in one event; 0 for no limit.
+#ifndef CONFIG_HOLD_LIMIT_PER_EVENT
+#define CONFIG_HOLD_LIMIT_PER_EVENT 0u
+#endif
+
+// Lock stripes of the per-user hold index (power of two).
+#ifndef CONFIG_HOLD_INDEX_SHARDS
+#define CONFIG_HOLD_INDEX_SHARDS 64u
+#endif
+
+// Users each operation's rate limiter tracks; beyond that the least
+// recently seen are forgotten.
+#ifndef CONFIG_RATE_LIMIT_USERS
+#define CONFIG_RATE_LIMIT_USERS 65536u
+#endif
+
+// Orders one event_cancel_and_refund transaction refunds, and the most
+// workers it runs.
+#ifndef CONFIG_REFUND_BATCH
+#define CONFIG_REFUND_BATCH 256u
+#endif
+
+#ifndef CONFIG_REFUND_MAX_THREADS
+#define CONFIG_REFUND_MAX_THREADS 64u
+#endif
+
+// Lock stripes that keep tiered events from being evicted mid-call (power
+// of two).
+#ifndef CONFIG_TIER_LOCK_STRIPES
+#define CONFIG_TIER_LOCK_STRIPES 256u
+#endif
+
 // Default hold length (seconds). Can be adjusted by configuration.
 static tb_epoch_t g_hold_length_secs = 300; // 5 minutes
+static size_t g_hold_limit = CONFIG_HOLD_LIMIT_PER_EVENT;
 
 static pthread_once_t g_reservation_once = PTHREAD_ONCE_INIT;
 static bool g_reservation_init_ok = false;
 
 // ---- internal state ----
 static seat_map_t *g_map = NULL;
+static tb_feed_t *g_feed = NULL;
+static tb_feed_t *g_change_log = NULL; // replication log, NULL until enabled
 
 // Lookup a seat by its hold token. Returns true and fills *out on success.
 // This function should NOT lock; we will lock by (event_id, seat_id) once resolved.
@@ -30,6 +89,9 @@ extern bool seat_map_find_by_token(seat_map_t *map,
                                    size_t token_len,
                                    seat_t *out);
 
+static void index_init(void);
+static void index_clear(void);
+
 static void reservation_do_init(void)
 {
     // Guard against double-init in case this is ever called directly.
@@ -41,11 +103,17 @@ static void reservation_do_init(void)
 
     // Create the seat map with a default capacity; override via config.h if desired.
     g_map = seat_map_create(CONFIG_SEATMAP_INITIAL_CAPACITY);
-    if (g_map == NULL)
+    g_feed = tb_feed_create(CONFIG_FEED_CAPACITY);
+    if (g_map == NULL || g_feed == NULL)
     {
+        seat_map_destroy(g_map);
+        g_map = NULL;
+        tb_feed_destroy(g_feed);
+        g_feed = NULL;
         g_reservation_init_ok = false;
         return;
     }
+    index_init();
 
     g_reservation_init_ok = true;
 }
@@ -60,6 +128,11 @@ static long now_unix(void)
 static inline void random_bytes(unsigned char *out, size_t n)
 { tb_random_bytes_fast(out, n); }
 
+static bool hold_expired(tb_epoch_t expires_unix, tb_epoch_t now)
+{
+    return expires_unix > 0 && now >= expires_unix;
+}
+
 static void clear_hold_fields(seat_t *s)
 {
     if (!s)
@@ -86,6 +159,447 @@ static void to_view(const seat_t *in, seat_view_t *out)
     }
 }
 
+// Record a change in the replication log, if there is one.
+static void log_change(uint32_t ev, uint32_t seat_ix, tb_change_kind_t kind)
+{
+    tb_feed_t *log = __atomic_load_n(&g_change_log, __ATOMIC_ACQUIRE);
+    if (log && ev != 0)
+        tb_feed_publish(log, ev, seat_ix, kind);
+}
+
+// Tell feed subscribers about a transition of seat r.
+static void publish(seat_ref_t r, tb_change_kind_t kind)
+{
+    uint64_t key = seat_map_hot(g_map, r)->key;
+    tb_feed_publish(g_feed, (uint32_t)(key >> 32), (uint32_t)key, kind);
+    log_change((uint32_t)(key >> 32), (uint32_t)key, kind);
+}
+
+// Drop a confirm's pin (restoring the plain HELD word) and the seat lock.
+// Nothing else may move a pinned word, so the CAS cannot fail.
+static void unpin_and_unlock(seat_ref_t r, uint64_t held)
+{
+    seat_state_cas(g_map, r, held | SEAT_STATE_PINNED, held);
+    seat_map_unlock_ref(g_map, r);
+}
+
+static void chart_cache_clear(void);
+static void limiters_clear(void);
+static pthread_rwlock_t *tier_enter(uint32_t ev);
+static void tier_exit(pthread_rwlock_t *l);
+static void tier_clear(void);
+
+// ---- per-user hold index ----
+//
+// user -> event -> the seats it holds there, so a user's holds are counted
+// in O(1) and released in O(holds). Users hash to lock-striped shards, each
+// its own chained table. Holds are added and removed by the paths that move
+// a seat's state; a hold that ends elsewhere (a lapse nobody swept, a seat
+// deleted or its event unloaded) leaves a stale entry, which is skipped by
+// cancel_all_holds and pruned once a hold of the user at the limit may have
+// lapsed, so a user kept at the limit is refused in O(1). Each entry keeps
+// the hold's token so a stale one is told from a newer hold of the seat.
+
+typedef struct
+{
+    uint32_t seat_ix;
+    tb_epoch_t expires;
+    tb_byte_t token[RES_TOKEN_LEN];
+} user_hold_t;
+
+typedef struct
+{
+    uint32_t event_ix;
+    uint32_t pending;      // reserved by holds being placed
+    tb_epoch_t next_lapse; // no hold lapses before this; 0 if none held
+    size_t n, cap;
+    user_hold_t *holds;
+} user_event_t;
+
+typedef struct user_holds
+{
+    struct user_holds *next; // shard chain
+    uint64_t hash;
+    char user_id[RES_ID_LEN];
+    size_t n_events, cap_events;
+    user_event_t *events; // few per user: searched linearly
+} user_holds_t;
+
+typedef struct
+{
+    _Alignas(64) pthread_mutex_t mtx;
+    user_holds_t **buckets;
+    size_t mask, users;
+} hold_shard_t;
+
+static hold_shard_t g_hold_shards[CONFIG_HOLD_INDEX_SHARDS];
+
+static uint64_t user_hash(const char *user_id)
+{
+    char id[RES_ID_LEN] = {0};
+    strncpy(id, user_id, RES_ID_LEN - 1);
+    return tb_hash_name_fast(id);
+}
+
+static hold_shard_t *user_shard(uint64_t hash)
+{
+    return &g_hold_shards[(hash >> 48) & (CONFIG_HOLD_INDEX_SHARDS - 1)];
+}
+
+// Find (or create) a user's record. Caller holds the shard's mutex.
+static user_holds_t *user_find(hold_shard_t *sh, const char *user_id, uint64_t hash, bool create)
+{
+    if (sh->buckets)
+        for (user_holds_t *u = sh->buckets[hash & sh->mask]; u; u = u->next)
+            if (u->hash == hash && strncmp(u->user_id, user_id, RES_ID_LEN - 1) == 0)
+                return u;
+    if (!create)
+        return NULL;
+    if (!sh->buckets || sh->users >= sh->mask + 1)
+    {
+        size_t size = sh->buckets ? 2 * (sh->mask + 1) : 16;
+        user_holds_t **b = calloc(size, sizeof *b);
+        if (!b)
+            return NULL;
+        for (size_t i = 0; sh->buckets && i <= sh->mask; ++i)
+            for (user_holds_t *u = sh->buckets[i], *next; u; u = next)
+            {
+                next = u->next;
+                u->next = b[u->hash & (size - 1)];
+                b[u->hash & (size - 1)] = u;
+            }
+        free(sh->buckets);
+        sh->buckets = b;
+        sh->mask = size - 1;
+    }
+    user_holds_t *u = calloc(1, sizeof *u);
+    if (!u)
+        return NULL;
+    u->hash = hash;
+    strncpy(u->user_id, user_id, RES_ID_LEN - 1);
+    u->next = sh->buckets[hash & sh->mask];
+    sh->buckets[hash & sh->mask] = u;
+    sh->users++;
+    return u;
+}
+
+static void user_unlink(hold_shard_t *sh, user_holds_t *u)
+{
+    user_holds_t **p = &sh->buckets[u->hash & sh->mask];
+    while (*p != u)
+        p = &(*p)->next;
+    *p = u->next;
+    sh->users--;
+}
+
+static void user_free(user_holds_t *u)
+{
+    for (size_t i = 0; i < u->n_events; ++i)
+        free(u->events[i].holds);
+    free(u->events);
+    free(u);
+}
+
+static user_event_t *user_event(user_holds_t *u, uint32_t ev, bool create)
+{
+    for (size_t i = 0; i < u->n_events; ++i)
+        if (u->events[i].event_ix == ev)
+            return &u->events[i];
+    if (!create)
+        return NULL;
+    if (u->n_events == u->cap_events)
+    {
+        size_t cap = u->cap_events ? 2 * u->cap_events : 4;
+        user_event_t *e = realloc(u->events, cap * sizeof *e);
+        if (!e)
+            return NULL;
+        u->events = e;
+        u->cap_events = cap;
+    }
+    user_event_t *ue = &u->events[u->n_events++];
+    memset(ue, 0, sizeof *ue);
+    ue->event_ix = ev;
+    return ue;
+}
+
+// Room for one more hold in ue without allocating later.
+static bool user_event_reserve(user_event_t *ue)
+{
+    size_t want = ue->n + ue->pending + 1;
+    if (want <= ue->cap)
+        return true;
+    size_t cap = ue->cap ? 2 * ue->cap : 4;
+    while (cap < want)
+        cap *= 2;
+    user_hold_t *h = realloc(ue->holds, cap * sizeof *h);
+    if (!h)
+        return false;
+    ue->holds = h;
+    ue->cap = cap;
+    return true;
+}
+
+// Drop empty events, and the user once it has none.
+static void user_tidy(hold_shard_t *sh, user_holds_t *u)
+{
+    for (size_t i = 0; i < u->n_events;)
+    {
+        user_event_t *ue = &u->events[i];
+        if (ue->n || ue->pending)
+        {
+            i++;
+            continue;
+        }
+        free(ue->holds);
+        *ue = u->events[--u->n_events];
+    }
+    if (u->n_events == 0)
+    {
+        user_unlink(sh, u);
+        user_free(u);
+    }
+}
+
+// Whether the hold is still the seat's current one and in force.
+static bool hold_live(uint32_t ev, const user_hold_t *h, tb_epoch_t now)
+{
+    tb_ebr_enter();
+    seat_ref_t r = seat_map_find_ix(g_map, ev, h->seat_ix);
+    bool live = false;
+    for (uint64_t w; r != 0;)
+    {
+        w = seat_state_load(g_map, r);
+        seat_hold_t cur;
+        if (seat_state_status(w) != SEAT_HELD || seat_state_gone(w))
+            break;
+        if (!seat_state_hold(g_map, r, w, &cur))
+            continue;
+        live = cur.token_len == RES_TOKEN_LEN &&
+               tb_memcmp_token32(cur.token, h->token, RES_TOKEN_LEN) == 0 &&
+               (seat_state_pinned(w) || !hold_expired(seat_state_expires(w), now));
+        break;
+    }
+    tb_ebr_exit();
+    return live;
+}
+
+// Claim room for one more hold of user_id in ev: RES_HOLD_LIMIT if the user
+// is at the limit, counting only holds still in force. Every RES_OK is
+// followed by index_commit or index_abort.
+static res_code_t index_reserve(const char *user_id, uint32_t ev)
+{
+    uint64_t hash = user_hash(user_id);
+    hold_shard_t *sh = user_shard(hash);
+    size_t limit = __atomic_load_n(&g_hold_limit, __ATOMIC_RELAXED);
+    res_code_t rc = RES_OK;
+    pthread_mutex_lock(&sh->mtx);
+    user_holds_t *u = user_find(sh, user_id, hash, true);
+    user_event_t *ue = u ? user_event(u, ev, true) : NULL;
+    if (!ue || !user_event_reserve(ue))
+        rc = RES_INTERNAL_ERR;
+    else if (limit && ue->n + ue->pending >= limit)
+    {
+        tb_epoch_t now = now_unix();
+        if (ue->next_lapse && now >= ue->next_lapse)
+        {
+            ue->next_lapse = 0;
+            for (size_t i = 0; i < ue->n;)
+            {
+                user_hold_t *h = &ue->holds[i];
+                if (!hold_live(ev, h, now))
+                {
+                    *h = ue->holds[--ue->n];
+                    continue;
+                }
+                if (ue->next_lapse == 0 || h->expires < ue->next_lapse)
+                    ue->next_lapse = h->expires;
+                i++;
+            }
+        }
+        if (ue->n + ue->pending >= limit)
+            rc = RES_HOLD_LIMIT;
+    }
+    if (rc == RES_OK)
+        ue->pending++;
+    else if (u)
+        user_tidy(sh, u);
+    pthread_mutex_unlock(&sh->mtx);
+    return rc;
+}
+
+// Record the hold index_reserve made room for.
+static void index_commit(const char *user_id, uint32_t ev, uint32_t seat_ix,
+                         const tb_byte_t *token, tb_epoch_t expires)
+{
+    uint64_t hash = user_hash(user_id);
+    hold_shard_t *sh = user_shard(hash);
+    pthread_mutex_lock(&sh->mtx);
+    // The record is gone if cancel_all_holds took it meanwhile: start anew.
+    user_holds_t *u = user_find(sh, user_id, hash, true);
+    user_event_t *ue = u ? user_event(u, ev, true) : NULL;
+    if (ue && ue->pending)
+        ue->pending--;
+    if (ue && user_event_reserve(ue))
+    {
+        user_hold_t *h = &ue->holds[ue->n++];
+        h->seat_ix = seat_ix;
+        h->expires = expires;
+        memcpy(h->token, token, RES_TOKEN_LEN);
+        if (ue->next_lapse == 0 || expires < ue->next_lapse)
+            ue->next_lapse = expires;
+    }
+    else if (u)
+        user_tidy(sh, u); // out of memory: the hold goes unindexed
+    pthread_mutex_unlock(&sh->mtx);
+}
+
+static void index_abort(const char *user_id, uint32_t ev)
+{
+    uint64_t hash = user_hash(user_id);
+    hold_shard_t *sh = user_shard(hash);
+    pthread_mutex_lock(&sh->mtx);
+    user_holds_t *u = user_find(sh, user_id, hash, false);
+    user_event_t *ue = u ? user_event(u, ev, false) : NULL;
+    if (ue && ue->pending)
+        ue->pending--;
+    if (u)
+        user_tidy(sh, u);
+    pthread_mutex_unlock(&sh->mtx);
+}
+
+// Index a hold that arrived whole (event load, replication, one kept by
+// cancel_all_holds): replaces an entry for the same seat rather than adding
+// a second one, and is not held to the limit.
+static void index_restore(const char *user_id, uint32_t ev, uint32_t seat_ix,
+                          const tb_byte_t *token, tb_epoch_t expires)
+{
+    uint64_t hash = user_hash(user_id);
+    hold_shard_t *sh = user_shard(hash);
+    pthread_mutex_lock(&sh->mtx);
+    user_holds_t *u = user_find(sh, user_id, hash, true);
+    user_event_t *ue = u ? user_event(u, ev, true) : NULL;
+    size_t i = 0;
+    while (ue && i < ue->n && ue->holds[i].seat_ix != seat_ix)
+        i++;
+    if (ue && (i < ue->n || user_event_reserve(ue)))
+    {
+        user_hold_t *h = &ue->holds[i];
+        ue->n += i == ue->n;
+        h->seat_ix = seat_ix;
+        h->expires = expires;
+        memcpy(h->token, token, RES_TOKEN_LEN);
+        if (ue->next_lapse == 0 || expires < ue->next_lapse)
+            ue->next_lapse = expires;
+    }
+    else if (u)
+        user_tidy(sh, u);
+    pthread_mutex_unlock(&sh->mtx);
+}
+
+// A hold of user_id on seat r ended (cancel, expiry, sale, takeover).
+static void index_remove(const char *user_id, seat_ref_t r)
+{
+    uint64_t key = seat_map_hot(g_map, r)->key;
+    uint64_t hash = user_hash(user_id);
+    hold_shard_t *sh = user_shard(hash);
+    pthread_mutex_lock(&sh->mtx);
+    user_holds_t *u = user_find(sh, user_id, hash, false);
+    user_event_t *ue = u ? user_event(u, (uint32_t)(key >> 32), false) : NULL;
+    for (size_t i = 0; ue && i < ue->n; ++i)
+        if (ue->holds[i].seat_ix == (uint32_t)key)
+        {
+            ue->holds[i] = ue->holds[--ue->n];
+            break;
+        }
+    if (u)
+        user_tidy(sh, u);
+    pthread_mutex_unlock(&sh->mtx);
+}
+
+static void index_init(void)
+{
+    for (size_t i = 0; i < CONFIG_HOLD_INDEX_SHARDS; ++i)
+        pthread_mutex_init(&g_hold_shards[i].mtx, NULL);
+}
+
+static void index_clear(void)
+{
+    for (size_t i = 0; i < CONFIG_HOLD_INDEX_SHARDS; ++i)
+    {
+        hold_shard_t *sh = &g_hold_shards[i];
+        for (size_t b = 0; sh->buckets && b <= sh->mask; ++b)
+            for (user_holds_t *u = sh->buckets[b], *next; u; u = next)
+            {
+                next = u->next;
+                user_free(u);
+            }
+        free(sh->buckets);
+        pthread_mutex_destroy(&sh->mtx);
+        memset(sh, 0, sizeof *sh);
+    }
+}
+
+// ---- rate limits ----
+//
+// One limiter per operation, created the first time a limit is set and
+// kept until shutdown so checks never race its teardown; a limit of 0 just
+// switches the check off.
+
+static tb_ratelimit_t *g_limiters[RES_OP_COUNT];
+static bool g_limited[RES_OP_COUNT];
+static pthread_mutex_t g_limiter_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+bool reservation_set_rate_limit(res_op_t op, uint32_t per_second, uint32_t burst)
+{
+    if ((unsigned)op >= RES_OP_COUNT)
+        return false;
+    bool ok = true;
+    pthread_mutex_lock(&g_limiter_mtx);
+    if (per_second == 0)
+        __atomic_store_n(&g_limited[op], false, __ATOMIC_RELAXED);
+    else if (g_limiters[op])
+        tb_ratelimit_set(g_limiters[op], per_second, burst ? burst : 1);
+    else
+    {
+        tb_ratelimit_t *rl = tb_ratelimit_create(CONFIG_RATE_LIMIT_USERS, per_second, burst ? burst : 1);
+        if (rl)
+            __atomic_store_n(&g_limiters[op], rl, __ATOMIC_RELEASE);
+        ok = rl != NULL;
+    }
+    if (per_second != 0 && ok)
+        __atomic_store_n(&g_limited[op], true, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&g_limiter_mtx);
+    return ok;
+}
+
+bool reservation_admit(const char *user_id, res_op_t op)
+{
+    if ((unsigned)op >= RES_OP_COUNT || !user_id ||
+        !__atomic_load_n(&g_limited[op], __ATOMIC_ACQUIRE))
+        return true;
+    tb_ratelimit_t *rl = __atomic_load_n(&g_limiters[op], __ATOMIC_ACQUIRE);
+    return tb_ratelimit_allow(rl, user_hash(user_id), now_ns());
+}
+
+static void limiters_clear(void)
+{
+    pthread_mutex_lock(&g_limiter_mtx);
+    for (int op = 0; op < RES_OP_COUNT; ++op)
+    {
+        g_limited[op] = false;
+        tb_ratelimit_destroy(g_limiters[op]);
+        g_limiters[op] = NULL;
+    }
+    pthread_mutex_unlock(&g_limiter_mtx);
+}
+
 // ---- API implementation ----
 
 bool reservation_init(void)
@@ -101,17 +615,124 @@ void reservation_shutdown(void)
     {
         seat_map_destroy(g_map);
         g_map = NULL;
+        index_clear();
     }
+    limiters_clear();
+    chart_cache_clear();
+    tier_clear();
+    tb_feed_destroy(g_feed);
+    g_feed = NULL;
+    tb_feed_destroy(g_change_log);
+    g_change_log = NULL;
     // Allow init to run again for different seats.
     g_reservation_once = (pthread_once_t)PTHREAD_ONCE_INIT;
     g_reservation_init_ok = false;
 }
 
+// Put a full seat record, keeping the hold index in step: the previous
+// holder's entry goes if the hold changed, a live incoming hold is indexed.
+static bool put_indexed(const seat_t *seat, tb_epoch_t now)
+{
+    uint32_t ev = tb_intern(TB_NS_EVENT, seat->event_id);
+    uint32_t st = tb_intern(TB_NS_SEAT, seat->seat_id);
+    seat_t old;
+    tb_ebr_enter();
+    seat_ref_t r = seat_map_find_ix(g_map, ev, st);
+    bool had = r != 0 && seat_map_read(g_map, r, &old) && old.status == SEAT_HELD;
+    bool same = had && seat->status == SEAT_HELD && old.hold_token_len == seat->hold_token_len &&
+                memcmp(old.hold_token, seat->hold_token, old.hold_token_len) == 0;
+    if (had && !same)
+        index_remove(old.holder_user_id, r);
+    tb_ebr_exit();
+    if (!seat_map_put(g_map, seat))
+        return false;
+    if (!same && seat->status == SEAT_HELD && !hold_expired(seat->hold_expires_unix, now))
+        index_restore(seat->holder_user_id, ev, st, seat->hold_token, seat->hold_expires_unix);
+    return true;
+}
+
 bool reservation_put_seat(const seat_t *seat)
 {
     if (!g_reservation_init_ok || !g_map || !seat)
         return false;
-    return seat_map_put(g_map, seat);
+    pthread_rwlock_t *tl = tier_enter(tb_intern_lookup(TB_NS_EVENT, seat->event_id));
+    bool ok = put_indexed(seat, now_unix());
+    tier_exit(tl);
+    if (!ok)
+        return false;
+    log_change(tb_intern_lookup(TB_NS_EVENT, seat->event_id),
+               tb_intern_lookup(TB_NS_SEAT, seat->seat_id), TB_CHANGE_RELOADED);
+    return true;
+}
+
+static bool load_seats(const char *event_id, const seat_t *seats, size_t n)
+{
+    if (!seat_map_event_load(g_map, event_id, n))
+        return false;
+    bool ok = true;
+    tb_epoch_t now = now_unix();
+    for (size_t i = 0; i < n; ++i)
+    {
+        const seat_t *s = &seats[i];
+        if (strncmp(s->event_id, event_id, RES_ID_LEN) != 0 || !seat_map_put(g_map, s))
+            ok = false;
+        else if (s->status == SEAT_HELD && !hold_expired(s->hold_expires_unix, now))
+            index_restore(s->holder_user_id, tb_intern_lookup(TB_NS_EVENT, event_id),
+                          tb_intern_lookup(TB_NS_SEAT, s->seat_id), s->hold_token,
+                          s->hold_expires_unix);
+    }
+    log_change(tb_intern_lookup(TB_NS_EVENT, event_id), 0, TB_CHANGE_RELOADED);
+    return ok;
+}
+
+bool event_load(const char *event_id, const seat_t *seats, size_t n)
+{
+    if (!g_reservation_init_ok || !g_map || !event_id || (!seats && n > 0))
+        return false;
+    pthread_rwlock_t *tl = tier_enter(tb_intern_lookup(TB_NS_EVENT, event_id));
+    bool ok = load_seats(event_id, seats, n);
+    tier_exit(tl);
+    return ok;
+}
+
+size_t reservation_load_manifest(const char *path, unsigned threads)
+{
+    if (!g_reservation_init_ok || !g_map || !path)
+        return 0;
+    tb_manifest_t mf;
+    if (!tb_manifest_open(&mf, path))
+        return 0;
+    // Evicted events come back first: the loader skips loaded events.
+    for (uint32_t e = 0; e < mf.hdr->n_events; ++e)
+        tier_exit(tier_enter(tb_intern_lookup(TB_NS_EVENT, tb_manifest_name(&mf, mf.events[e].name))));
+    size_t loaded = tb_manifest_load(&mf, g_map, threads);
+    for (uint32_t e = 0; loaded && e < mf.hdr->n_events; ++e)
+        log_change(tb_intern_lookup(TB_NS_EVENT, tb_manifest_name(&mf, mf.events[e].name)), 0,
+                   TB_CHANGE_RELOADED);
+    tb_manifest_close(&mf);
+    return loaded;
+}
+
+static bool tier_discard(uint32_t ev);
+static pthread_rwlock_t *tier_lock_write(uint32_t ev);
+
+static bool unload_event(const char *event_id)
+{
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, event_id);
+    if (!tier_discard(ev) && !seat_map_event_unload(g_map, event_id))
+        return false;
+    log_change(ev, 0, TB_CHANGE_RELOADED);
+    return true;
+}
+
+bool event_unload(const char *event_id)
+{
+    if (!g_reservation_init_ok || !g_map || !event_id)
+        return false;
+    pthread_rwlock_t *tl = tier_lock_write(tb_intern_lookup(TB_NS_EVENT, event_id));
+    bool ok = unload_event(event_id);
+    tier_exit(tl);
+    return ok;
 }
 
 void reservation_set_hold_length_seconds(tb_epoch_t seconds)
@@ -120,97 +741,239 @@ void reservation_set_hold_length_seconds(tb_epoch_t seconds)
     g_hold_length_secs = seconds;
 }
 
+void reservation_set_hold_limit(size_t per_user_per_event)
+{
+    __atomic_store_n(&g_hold_limit, per_user_per_event, __ATOMIC_RELAXED);
+}
+
+size_t cancel_all_holds(const char *user_id)
+{
+    if (!g_reservation_init_ok || !g_map || !user_id)
+        return 0;
+    uint64_t hash = user_hash(user_id);
+    hold_shard_t *sh = user_shard(hash);
+    pthread_mutex_lock(&sh->mtx);
+    user_holds_t *u = user_find(sh, user_id, hash, false);
+    if (u)
+        user_unlink(sh, u); // holds placed from now on start a new record
+    pthread_mutex_unlock(&sh->mtx);
+    if (!u)
+        return 0;
+
+    size_t released = 0;
+    tb_ebr_enter();
+    for (size_t i = 0; i < u->n_events; ++i)
+    {
+        const user_event_t *ue = &u->events[i];
+        for (size_t k = 0; k < ue->n; ++k)
+        {
+            const user_hold_t *h = &ue->holds[k];
+            seat_ref_t r = seat_map_find_ix(g_map, ue->event_ix, h->seat_ix);
+            for (uint64_t w; r != 0;)
+            {
+                w = seat_state_load(g_map, r);
+                seat_hold_t cur;
+                if (seat_state_status(w) != SEAT_HELD || seat_state_gone(w))
+                    break;
+                if (!seat_state_hold(g_map, r, w, &cur))
+                    continue;
+                if (cur.token_len != RES_TOKEN_LEN ||
+                    tb_memcmp_token32(cur.token, h->token, RES_TOKEN_LEN) != 0)
+                    break; // a newer hold, not this one
+                if (seat_state_pinned(w))
+                {
+                    // Mid-checkout: the confirm decides; keep it indexed.
+                    // It was counted already, so no limit check: holds
+                    // placed since must not push it out of the index.
+                    index_restore(user_id, ue->event_ix, h->seat_ix, h->token, h->expires);
+                    break;
+                }
+                if (seat_state_cas(g_map, r, w, seat_state_make(SEAT_AVAILABLE, 0, 0)))
+                {
+                    publish(r, TB_CHANGE_RELEASED);
+                    released++;
+                    break;
+                }
+            }
+        }
+    }
+    tb_ebr_exit();
+    user_free(u);
+    return released;
+}
+
 hold_result_t place_hold(const char *user_id,
                          const char *event_id,
                          const char *seat_id)
 {
-    hold_result_t res;
-    memset(&res, 0, sizeof(res));
-
     if (!user_id || !event_id || !seat_id)
     {
+        hold_result_t res;
+        memset(&res, 0, sizeof(res));
         res.code = RES_NOT_FOUND; // treat invalid/NULL ids as not found
         return res;
     }
+    return place_hold_ix(user_id, tb_intern_lookup(TB_NS_EVENT, event_id),
+                         tb_intern_lookup(TB_NS_SEAT, seat_id));
+}
 
-    // Try to acquire the per-seat lock
-    if (!seat_map_lock(g_map, event_id, seat_id))
-    {
-        res.code = RES_HELD_BY_OTHER;
-        return res;
-    }
+// The map entry points below find a seat and then work on its handle; each
+// runs inside one EBR section so a concurrent delete or unload cannot
+// recycle the record under it (the seat then just reads as gone).
+static hold_result_t hold_seat(const char *user_id,
+                               uint32_t event_ix,
+                               uint32_t seat_ix)
+{
+    hold_result_t res;
+    memset(&res, 0, sizeof(res));
 
-    // Fetch the seat from the map
-    seat_t s = {0};
-    bool ok = seat_map_get(g_map, event_id, seat_id, &s);
-    if (!ok)
+    if (!user_id)
     {
-        // seat not found
-        seat_map_unlock(g_map, event_id, seat_id);
         res.code = RES_NOT_FOUND;
         return res;
     }
 
-    // Respect current state before taking the seat
-    tb_epoch_t now = now_unix();
-    if (s.status == SEAT_SOLD)
+    seat_ref_t r = seat_map_find_ix(g_map, event_ix, seat_ix);
+    if (r == 0)
     {
-        seat_map_unlock(g_map, event_id, seat_id);
-        res.code = RES_ALREADY_SOLD;
+        res.code = RES_NOT_FOUND;
         return res;
     }
-    if (s.status == SEAT_HELD)
+
+    // Lock-free: inspect the packed state word and CAS it to HELD. The holder
+    // slot (and token) and the user's place in the hold index are prepared
+    // once and reused across CAS retries.
+    uint32_t slot = 0;
+    tb_byte_t token[RES_TOKEN_LEN];
+    tb_epoch_t expires = 0;
+    bool reserved = false;
+    char lapsed[RES_ID_LEN]; // holder of the lapsed hold being replaced
+    for (;;)
     {
-        const bool same_user = (strncmp(s.holder_user_id, user_id, RES_ID_LEN) == 0);
-        const bool expired = (s.hold_expires_unix > 0 && now >= s.hold_expires_unix);
-        if (!expired)
+        uint64_t w = seat_state_load(g_map, r);
+        tb_epoch_t now = now_unix();
+        lapsed[0] = '\0';
+        if (seat_state_gone(w))
+        {
+            res.code = RES_NOT_FOUND; // deleted since the lookup
+            break;
+        }
+        if (seat_state_status(w) == SEAT_SOLD)
+        {
+            res.code = RES_ALREADY_SOLD;
+            break;
+        }
+        if (seat_state_status(w) == SEAT_REFUNDED)
         {
-            if (same_user)
+            res.code = RES_NOT_FOUND; // off sale: its event was cancelled
+            break;
+        }
+        if (seat_state_status(w) == SEAT_HELD)
+        {
+            seat_hold_t cur;
+            if (!seat_state_hold(g_map, r, w, &cur))
+                continue; // state moved while reading the holder; retry
+
+            // A pinned hold is mid-checkout and cannot be taken even if expired
+            if (seat_state_pinned(w) || !hold_expired(seat_state_expires(w), now))
             {
-                // Existing active hold by same user → return existing details
-                seat_map_unlock(g_map, event_id, seat_id);
-                res.code = RES_HOLD_EXISTS_SAME_USER;
-                res.price_cents = s.price_cents;
-                res.expires_unix = s.hold_expires_unix;
-                res.token_len = s.hold_token_len;
-                memcpy(res.hold_token, s.hold_token, s.hold_token_len);
-                return res;
+                if (!seat_state_pinned(w) &&
+                    strncmp(cur.holder_user_id, user_id, RES_ID_LEN) == 0)
+                {
+                    // Existing active hold by same user → return existing details
+                    res.code = RES_HOLD_EXISTS_SAME_USER;
+                    res.expires_unix = seat_state_expires(w);
+                    res.token_len = cur.token_len;
+                    memcpy(res.hold_token, cur.token, cur.token_len);
+                }
+                else
+                {
+                    res.code = RES_HELD_BY_OTHER;
+                }
+                break;
             }
-            else
+            // if expired, fall through to create a fresh hold
+            memcpy(lapsed, cur.holder_user_id, RES_ID_LEN);
+        }
+
+        if (!reserved)
+        {
+            res.code = index_reserve(user_id, event_ix);
+            if (res.code != RES_OK)
+                break; // at the user's hold limit
+            reserved = true;
+        }
+        if (slot == 0)
+        {
+            random_bytes(token, sizeof token);
+            slot = seat_hold_slot_alloc(g_map, r, user_id, token, sizeof token);
+            if (slot == 0)
             {
-                seat_map_unlock(g_map, event_id, seat_id);
-                res.code = RES_HELD_BY_OTHER;
-                return res;
+                res.code = RES_INTERNAL_ERR; // hold slots exhausted
+                break;
             }
         }
-        // if expired, fall through to create a fresh hold
+        expires = now + g_hold_length_secs;
+        if (seat_state_cas(g_map, r, w, seat_state_make(SEAT_HELD, slot, expires)))
+        {
+            res.code = RES_OK;
+            res.expires_unix = expires;
+            res.token_len = sizeof token;
+            memcpy(res.hold_token, token, sizeof token);
+            slot = 0; // now owned by the seat
+            if (lapsed[0])
+                index_remove(lapsed, r);
+            index_commit(user_id, event_ix, seat_ix, token, expires);
+            reserved = false;
+            publish(r, TB_CHANGE_HELD);
+            break;
+        }
     }
 
-    // Create/refresh hold for this user
-    s.status = SEAT_HELD;
-    memset(s.holder_user_id, 0, sizeof s.holder_user_id);
-    strncpy(s.holder_user_id, user_id, RES_ID_LEN - 1);
-    s.hold_expires_unix = now + g_hold_length_secs;
-    s.hold_token_len = RES_TOKEN_LEN;
-    random_bytes(s.hold_token, s.hold_token_len);
-
-    // Persist back into the map
-    seat_map_put(g_map, &s);
+    if (slot != 0)
+        seat_hold_slot_free(g_map, slot);
+    if (reserved)
+        index_abort(user_id, event_ix);
 
-    // Release the lock before returning
-    seat_map_unlock(g_map, event_id, seat_id);
+    if (res.code == RES_OK || res.code == RES_HOLD_EXISTS_SAME_USER)
+    {
+        // Price hint for the UI; authoritative price is resolved at confirm
+        seat_t s;
+        seat_map_read(g_map, r, &s);
+        res.price_cents = s.price_cents;
+    }
+    return res;
+}
 
-    // Fill minimal result: success code and authoritative price for the UI
-    res.code = RES_OK;
-    res.price_cents = s.price_cents;
-    res.expires_unix = s.hold_expires_unix;
-    res.token_len = s.hold_token_len;
-    memcpy(res.hold_token, s.hold_token, s.hold_token_len);
+static hold_result_t hold_ix(const char *user_id,
+                             uint32_t event_ix,
+                             uint32_t seat_ix)
+{
+    tb_ebr_enter();
+    hold_result_t res = hold_seat(user_id, event_ix, seat_ix);
+    tb_ebr_exit();
+    tb_ebr_reclaim(); // recycles the hold slots released since
+    return res;
+}
 
+hold_result_t place_hold_ix(const char *user_id,
+                            uint32_t event_ix,
+                            uint32_t seat_ix)
+{
+    if (!reservation_admit(user_id, RES_OP_HOLD))
+    {
+        hold_result_t res;
+        memset(&res, 0, sizeof(res));
+        res.code = RES_RATE_LIMITED;
+        return res;
+    }
+    pthread_rwlock_t *tl = tier_enter(event_ix);
+    hold_result_t res = hold_ix(user_id, event_ix, seat_ix);
+    tier_exit(tl);
     return res;
 }
 
-confirm_result_t confirm_reservation(const tb_byte_t *hold_token,
+static confirm_result_t confirm_seat(const tb_byte_t *hold_token,
                                      size_t token_len,
                                      tb_money_cents_t amount_paid_cents)
 {
@@ -250,41 +1013,61 @@ confirm_result_t confirm_reservation(const tb_byte_t *hold_token,
         return out;
     }
 
-    // 4) Lock the concrete seat and re-read to avoid TOCTOU
-    if (!seat_map_lock(g_map, s.event_id, s.seat_id))
+    // 4) Lock the concrete seat (serialises confirm/refund on it), then pin
+    //    the hold with a CAS so lock-free cancel/expiry cannot take it while
+    //    the DB transaction runs.
+    seat_ref_t r = seat_map_find(g_map, s.event_id, s.seat_id);
+    if (r == 0)
     {
-        out.code = RES_HELD_BY_OTHER; // someone else operating on this seat
+        out.code = RES_NOT_FOUND;
         return out;
     }
-
-    bool ok = seat_map_get(g_map, s.event_id, s.seat_id, &s);
-    if (!ok)
+    if (!seat_map_lock_ref(g_map, r))
     {
-        seat_map_unlock(g_map, s.event_id, s.seat_id);
-        out.code = RES_NOT_FOUND;
+        out.code = RES_HELD_BY_OTHER; // someone else operating on this seat
         return out;
     }
 
-    // 5) Validate held state, token, and expiry
-    if (s.status != SEAT_HELD || s.hold_token_len != token_len ||
-        memcmp(s.hold_token, hold_token, token_len) != 0)
+    uint64_t w;
+    for (;;)
     {
-        seat_map_unlock(g_map, s.event_id, s.seat_id);
-        out.code = RES_INVALID_TOKEN;
-        return out;
-    }
+        w = seat_state_load(g_map, r);
 
-    tb_epoch_t now = now_unix();
-    if (s.hold_expires_unix > 0 && now >= s.hold_expires_unix)
-    {
-        // expire and persist
-        s.status = SEAT_AVAILABLE;
-        clear_hold_fields(&s);
-        seat_map_put(g_map, &s);
-        seat_map_unlock(g_map, s.event_id, s.seat_id);
-        out.code = RES_HOLD_EXPIRED;
-        return out;
+        // 5) Validate held state, token, and expiry
+        seat_hold_t cur;
+        if (seat_state_status(w) != SEAT_HELD || seat_state_gone(w))
+        {
+            seat_map_unlock_ref(g_map, r);
+            out.code = RES_INVALID_TOKEN;
+            return out;
+        }
+        if (!seat_state_hold(g_map, r, w, &cur))
+            continue;
+        if (cur.token_len != token_len ||
+            tb_memcmp_token32(cur.token, hold_token, token_len) != 0)
+        {
+            seat_map_unlock_ref(g_map, r);
+            out.code = RES_INVALID_TOKEN;
+            return out;
+        }
+
+        if (hold_expired(seat_state_expires(w), now_unix()))
+        {
+            // expire and persist
+            if (!seat_state_cas(g_map, r, w, seat_state_make(SEAT_AVAILABLE, 0, 0)))
+                continue;
+            index_remove(cur.holder_user_id, r);
+            publish(r, TB_CHANGE_RELEASED);
+            seat_map_unlock_ref(g_map, r);
+            out.code = RES_HOLD_EXPIRED;
+            return out;
+        }
+
+        if (seat_state_cas(g_map, r, w, w | SEAT_STATE_PINNED))
+            break;
     }
+    // Re-read under the pin: holder, price and ids are now stable.
+    seat_map_read(g_map, r, &s);
 
     // 6) Determine authoritative price (DB may override in-memory)
     tb_money_cents_t price = s.price_cents;
@@ -294,7 +1077,7 @@ confirm_result_t confirm_reservation(const tb_byte_t *hold_token,
         price = db_price;
     else if (rc == RES_DB_ERROR)
     {
-        seat_map_unlock(g_map, s.event_id, s.seat_id);
+        unpin_and_unlock(r, w);
         out.code = RES_DB_ERROR;
         return out;
     }
@@ -302,7 +1085,7 @@ confirm_result_t confirm_reservation(const tb_byte_t *hold_token,
     // 6.5) Enforce caller-paid amount equals authoritative price
     if (amount_paid_cents != price)
     {
-        seat_map_unlock(g_map, s.event_id, s.seat_id);
+        unpin_and_unlock(r, w);
         out.code = RES_INTERNAL_ERR; // payment amount mismatch
         return out;
     }
@@ -311,7 +1094,7 @@ confirm_result_t confirm_reservation(const tb_byte_t *hold_token,
     db_txn_t *txn = db_txn_begin();
     if (!txn)
     {
-        seat_map_unlock(g_map, s.event_id, s.seat_id);
+        unpin_and_unlock(r, w);
         out.code = RES_DB_ERROR;
         return out;
     }
@@ -327,16 +1110,21 @@ confirm_result_t confirm_reservation(const tb_byte_t *hold_token,
     if (rc != RES_OK || !db_txn_commit(txn))
     {
         db_txn_rollback(txn);
-        seat_map_unlock(g_map, s.event_id, s.seat_id);
+        unpin_and_unlock(r, w);
         out.code = (rc == RES_DB_ERROR ? RES_DB_ERROR : RES_INTERNAL_ERR);
         return out;
     }
 
-    // 8) Update in-memory seat to SOLD and clear hold
+    // 8) Update in-memory seat to SOLD and clear hold (recycles the slot)
+    char holder[RES_ID_LEN];
+    memcpy(holder, s.holder_user_id, RES_ID_LEN);
     s.status = SEAT_SOLD;
     clear_hold_fields(&s);
+    strncpy(s.last_order_id, order_id, RES_ID_LEN - 1);
     seat_map_put(g_map, &s);
-    seat_map_unlock(g_map, s.event_id, s.seat_id);
+    index_remove(holder, r);
+    publish(r, TB_CHANGE_SOLD);
+    seat_map_unlock_ref(g_map, r);
 
     // 9) Return success
     out.code = RES_OK;
@@ -345,46 +1133,86 @@ confirm_result_t confirm_reservation(const tb_byte_t *hold_token,
     return out;
 }
 
-res_code_t cancel_hold(const char *user_id,
-                       const char *event_id,
-                       const char *seat_id)
-{
-    if (!user_id || !event_id || !seat_id)
-    {
-        return RES_NOT_FOUND; // invalid identifiers treated as not found
-    }
+confirm_result_t confirm_reservation(const tb_byte_t *hold_token,
+                                     size_t token_len,
+                                     tb_money_cents_t amount_paid_cents)
+{
+    tb_ebr_enter();
+    confirm_result_t out = confirm_seat(hold_token, token_len, amount_paid_cents);
+    tb_ebr_exit();
+    return out;
+}
 
-    if (!seat_map_lock(g_map, event_id, seat_id))
+res_code_t cancel_hold(const char *user_id,
+                       const char *event_id,
+                       const char *seat_id)
+{
+    if (!user_id || !event_id || !seat_id)
     {
-        return RES_NOT_FOUND; // seat missing or lock failed
+        return RES_NOT_FOUND; // invalid identifiers treated as not found
     }
+    return cancel_hold_ix(user_id, tb_intern_lookup(TB_NS_EVENT, event_id),
+                          tb_intern_lookup(TB_NS_SEAT, seat_id));
+}
 
-    seat_t s = {0};
-    bool ok = seat_map_get(g_map, event_id, seat_id, &s);
-    if (!ok)
+static res_code_t cancel_seat(const char *user_id,
+                              uint32_t event_ix,
+                              uint32_t seat_ix)
+{
+    seat_ref_t r = seat_map_find_ix(g_map, event_ix, seat_ix);
+    if (!user_id || r == 0)
     {
-        seat_map_unlock(g_map, event_id, seat_id);
         return RES_NOT_FOUND;
     }
 
-    // Only the current holder can cancel; and there must be an active hold
-    if (s.status != SEAT_HELD)
+    for (;;)
     {
-        seat_map_unlock(g_map, event_id, seat_id);
-        return (s.status == SEAT_SOLD) ? RES_ALREADY_SOLD : RES_NOT_FOUND;
-    }
-    if (strncmp(s.holder_user_id, user_id, RES_ID_LEN) != 0)
-    {
-        seat_map_unlock(g_map, event_id, seat_id);
-        return RES_HELD_BY_OTHER;
+        uint64_t w = seat_state_load(g_map, r);
+
+        // Only the current holder can cancel; and there must be an active hold
+        if (seat_state_status(w) != SEAT_HELD || seat_state_gone(w))
+        {
+            return (seat_state_status(w) == SEAT_SOLD) ? RES_ALREADY_SOLD : RES_NOT_FOUND;
+        }
+        seat_hold_t cur;
+        if (!seat_state_hold(g_map, r, w, &cur))
+            continue;
+        if (strncmp(cur.holder_user_id, user_id, RES_ID_LEN) != 0)
+        {
+            return RES_HELD_BY_OTHER;
+        }
+        if (seat_state_pinned(w))
+        {
+            return RES_HELD_BY_OTHER; // checkout in progress
+        }
+
+        // Cancel the hold → AVAILABLE (single CAS; the slot is recycled)
+        if (seat_state_cas(g_map, r, w, seat_state_make(SEAT_AVAILABLE, 0, 0)))
+        {
+            index_remove(user_id, r);
+            publish(r, TB_CHANGE_RELEASED);
+            return RES_OK;
+        }
     }
+}
 
-    // Cancel the hold → AVAILABLE
-    s.status = SEAT_AVAILABLE;
-    clear_hold_fields(&s);
-    seat_map_put(g_map, &s);
-    seat_map_unlock(g_map, event_id, seat_id);
-    return RES_OK;
+static res_code_t cancel_ix(const char *user_id,
+                            uint32_t event_ix,
+                            uint32_t seat_ix)
+{
+    tb_ebr_enter();
+    res_code_t rc = cancel_seat(user_id, event_ix, seat_ix);
+    tb_ebr_exit();
+    return rc;
+}
+
+res_code_t cancel_hold_ix(const char *user_id,
+                          uint32_t event_ix,
+                          uint32_t seat_ix)
+{
+    if (!reservation_admit(user_id, RES_OP_CANCEL))
+        return RES_RATE_LIMITED;
+    return cancel_ix(user_id, event_ix, seat_ix);
 }
 
 bool seat_get(const char *event_id,
@@ -393,38 +1221,1065 @@ bool seat_get(const char *event_id,
 {
     if (!event_id || !seat_id || !out)
         return false;
+    return seat_get_ix(tb_intern_lookup(TB_NS_EVENT, event_id),
+                       tb_intern_lookup(TB_NS_SEAT, seat_id), out);
+}
 
-    if (!seat_map_lock(g_map, event_id, seat_id))
+bool seat_get_ix(uint32_t event_ix,
+                 uint32_t seat_ix,
+                 seat_view_t *out)
+{
+    if (!out)
+        return false;
+
+    // Optimistic seqlock read: no seat lock, so browsing never contends with
+    // writers. An expired hold is reported as AVAILABLE here; the state is
+    // only flipped in the map by the next writer that needs the seat.
+    seat_t internal;
+    pthread_rwlock_t *tl = tier_enter(event_ix);
+    tb_ebr_enter();
+    seat_ref_t r = seat_map_find_ix(g_map, event_ix, seat_ix);
+    bool found = r != 0 && seat_map_read(g_map, r, &internal);
+    tb_ebr_exit();
+    tier_exit(tl);
+    if (!found)
+        return false;
+
+    if (internal.status == SEAT_HELD && hold_expired(internal.hold_expires_unix, now_unix()))
     {
-        return false; // seat not found or failed to lock
+        internal.status = SEAT_AVAILABLE;
+        clear_hold_fields(&internal);
     }
 
-    // Read the current seat (internal model), expire hold if needed, then copy a view.
-    seat_t internal = {0};
-    bool ok = seat_map_get(g_map, event_id, seat_id, &internal);
-    if (ok)
+    to_view(&internal, out);
+    return true;
+}
+
+size_t seat_get_many(const char *event_id,
+                     const char *const *seat_ids,
+                     size_t n,
+                     seat_view_t *out,
+                     bool *found)
+{
+    if (!event_id || !seat_ids || !out)
+        return 0;
+    enum { CHUNK = 64 };
+    seat_t internal[CHUNK];
+    bool hit[CHUNK];
+    long now = now_unix();
+    size_t total = 0;
+    pthread_rwlock_t *tl = tier_enter(tb_intern_lookup(TB_NS_EVENT, event_id));
+    for (size_t b = 0; b < n; b += CHUNK)
     {
-        // Lazy-expire inside the lock to keep state consistent.
-        if (internal.status == SEAT_HELD && internal.hold_expires_unix > 0)
+        size_t k = n - b < CHUNK ? n - b : CHUNK;
+        total += seat_map_get_many(g_map, event_id, seat_ids + b, k, internal, hit);
+        for (size_t i = 0; i < k; ++i)
         {
-            tb_epoch_t now = (tb_epoch_t)now_unix();
-            if (now >= internal.hold_expires_unix)
+            if (found)
+                found[b + i] = hit[i];
+            if (!hit[i])
+                continue;
+            if (internal[i].status == SEAT_HELD && hold_expired(internal[i].hold_expires_unix, now))
             {
-                // Clear hold fields and flip to AVAILABLE.
-                internal.status = SEAT_AVAILABLE;
-                clear_hold_fields(&internal);
-                // Persist the change back to the map.
-                seat_map_put(g_map, &internal);
+                internal[i].status = SEAT_AVAILABLE;
+                clear_hold_fields(&internal[i]);
             }
+            to_view(&internal[i], &out[b + i]);
         }
+    }
+    tier_exit(tl);
+    return total;
+}
+
+seat_snapshot_t *event_snapshot_begin(const char *event_id)
+{
+    if (!g_reservation_init_ok || !g_map || !event_id)
+        return NULL;
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, event_id);
+    tier_exit(tier_enter(ev)); // fault in; see reservation_enable_tiering
+    return seat_map_snapshot_begin(g_map, ev);
+}
 
-        // Convert to public view for callers.
-        to_view(&internal, out);
+bool event_snapshot_next(seat_snapshot_t *snap, seat_view_t *out)
+{
+    seat_t internal;
+    if (!out || !seat_map_snapshot_next(snap, &internal))
+        return false;
+    // Expired holds read as AVAILABLE, as in seat_get.
+    if (internal.status == SEAT_HELD && hold_expired(internal.hold_expires_unix, now_unix()))
+    {
+        internal.status = SEAT_AVAILABLE;
+        clear_hold_fields(&internal);
     }
-    seat_map_unlock(g_map, event_id, seat_id);
+    to_view(&internal, out);
+    return true;
+}
+
+bool event_snapshot_end(seat_snapshot_t *snap)
+{
+    return seat_map_snapshot_end(snap);
+}
+
+bool event_export(const char *event_id, seat_emit_fn emit, void *ctx)
+{
+    seat_counts_t counts;
+    if (!g_reservation_init_ok || !g_map || !event_id || !emit)
+        return false;
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, event_id);
+    pthread_rwlock_t *tl = tier_enter(ev);
+    bool ok = seat_map_event_counts(g_map, ev, &counts);
+    size_t records = ok ? seat_map_event_records(g_map, ev) : 0;
+    seat_t s;
+    tb_ebr_enter();
+    for (size_t pos = 0; ok && pos < records; ++pos)
+    {
+        seat_ref_t r = seat_map_event_ref(g_map, ev, pos);
+        if (r != 0 && seat_map_read(g_map, r, &s))
+            ok = emit(&s, ctx);
+    }
+    tb_ebr_exit();
+    tier_exit(tl);
     return ok;
 }
 
+size_t event_export_orders(const char *event_id, order_record_t *out, size_t max)
+{
+    if (!g_reservation_init_ok || !event_id || (!out && max > 0))
+        return 0;
+    return db_order_export_event(event_id, out, max);
+}
+
+bool event_import_orders(const char *event_id, const order_record_t *orders, size_t n)
+{
+    if (!g_reservation_init_ok || !event_id || (!orders && n > 0))
+        return false;
+    db_txn_t *txn = db_txn_begin();
+    if (!txn)
+        return false;
+    if (db_order_import(txn, event_id, orders, n) != RES_OK || !db_txn_commit(txn))
+    {
+        db_txn_rollback(txn);
+        return false;
+    }
+    return true;
+}
+
+size_t event_drop_orders(const char *event_id)
+{
+    if (!g_reservation_init_ok || !event_id)
+        return 0;
+    return db_order_drop_event(event_id);
+}
+
+bool event_replace(const char *event_id, const seat_t *seats, size_t n)
+{
+    if (!g_reservation_init_ok || !g_map || !event_id || (!seats && n > 0))
+        return false;
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, event_id);
+    pthread_rwlock_t *tl = tier_enter(ev);
+    bool same = ev != 0 && n > 0 && seat_map_event_size(g_map, ev) == n;
+    for (size_t i = 0; same && i < n; ++i)
+        same = strncmp(seats[i].event_id, event_id, RES_ID_LEN) == 0 &&
+               seat_map_find_ix(g_map, ev, tb_intern_lookup(TB_NS_SEAT, seats[i].seat_id)) != 0;
+    bool ok = true;
+    if (!same)
+    {
+        unload_event(event_id);
+        ok = load_seats(event_id, seats, n);
+    }
+    else
+    {
+        tb_epoch_t now = now_unix();
+        for (size_t i = 0; i < n; ++i)
+            ok &= put_indexed(&seats[i], now);
+        log_change(ev, 0, TB_CHANGE_RELOADED);
+    }
+    tier_exit(tl);
+    return ok;
+}
+
+bool seat_export_ix(uint32_t event_ix, uint32_t seat_ix, seat_t *out)
+{
+    if (!g_reservation_init_ok || !g_map || !out)
+        return false;
+    pthread_rwlock_t *tl = tier_enter(event_ix);
+    tb_ebr_enter();
+    seat_ref_t r = seat_map_find_ix(g_map, event_ix, seat_ix);
+    bool ok = r != 0 && seat_map_read(g_map, r, out);
+    tb_ebr_exit();
+    tier_exit(tl);
+    return ok;
+}
+
+// ---- seating chart cache ----
+// Each cached chart keeps its own feed subscription. A request first brings
+// the chart up to the feed's head, patching the status of every seat that
+// changed in place - or in a copy, if readers still hold the buffer - and
+// then hands out a reference. Seats are found by a seat_ix index built with
+// the chart; the status of seat i sits at a fixed offset in each format.
+// A hold that lapses publishes nothing, so the chart keeps the expiry of
+// every seat it shows as held and patches those back to available once
+// the earliest of them has passed.
+
+typedef struct chart_buf
+{
+    event_chart_t pub; // first: readers get &pub
+    uint32_t refs;     // the chart's own reference plus readers'
+    unsigned char bytes[];
+} chart_buf_t;
+
+typedef struct
+{
+    unsigned char *p;
+    size_t len, cap;
+    bool oom;
+} chart_out_t;
+
+typedef struct
+{
+    pthread_mutex_t mtx;
+    uint32_t event_ix;
+    tb_feed_sub_t *sub;
+    size_t n_seats;
+    uint32_t *off[2];   // per seat: offset of its status in each format
+    uint32_t *ix_seat;  // open addressing: seat_ix (0 = empty) ...
+    uint32_t *ix_pos;   // ... and its index in the chart
+    size_t ix_mask;
+    tb_epoch_t *expires;   // per seat: expiry of a hold shown, else 0
+    tb_epoch_t next_lapse; // earliest of those, 0 if none
+    chart_buf_t *buf[2];
+} chart_t;
+
+static pthread_mutex_t g_chart_mtx = PTHREAD_MUTEX_INITIALIZER;
+static chart_t *g_charts[CONFIG_CHART_CACHE_EVENTS]; // by event_ix hash, never removed
+
+static const char k_json_status[4] = {'A', 'H', 'S', 'R'};
+
+static void out_put(chart_out_t *o, const void *src, size_t n)
+{
+    if (o->len + n > o->cap)
+    {
+        size_t cap = o->cap ? o->cap : 4096;
+        while (cap < o->len + n)
+            cap *= 2;
+        unsigned char *p = realloc(o->p, cap);
+        if (!p)
+        {
+            o->oom = true;
+            return;
+        }
+        o->p = p;
+        o->cap = cap;
+    }
+    memcpy(o->p + o->len, src, n);
+    o->len += n;
+}
+
+static void out_str(chart_out_t *o, const char *str)
+{
+    out_put(o, str, strlen(str));
+}
+
+static void out_u32le(chart_out_t *o, uint32_t v)
+{
+    unsigned char b[4] = {(unsigned char)v, (unsigned char)(v >> 8), (unsigned char)(v >> 16),
+                          (unsigned char)(v >> 24)};
+    out_put(o, b, 4);
+}
+
+// ids are plain ASCII in practice; anything JSON needs escaped is.
+static void out_json_str(chart_out_t *o, const char *str)
+{
+    out_put(o, "\"", 1);
+    for (const unsigned char *c = (const unsigned char *)str; *c; ++c)
+    {
+        char esc[8];
+        if (*c == '"' || *c == '\\')
+        {
+            esc[0] = '\\';
+            esc[1] = (char)*c;
+            out_put(o, esc, 2);
+        }
+        else if (*c < 0x20)
+        {
+            snprintf(esc, sizeof esc, "\\u%04x", *c);
+            out_put(o, esc, 6);
+        }
+        else
+            out_put(o, c, 1);
+    }
+    out_put(o, "\"", 1);
+}
+
+static chart_buf_t *chart_buf_from(chart_out_t *o, uint64_t seq)
+{
+    chart_buf_t *b = o->oom ? NULL : malloc(sizeof(chart_buf_t) + o->len + 1);
+    if (b)
+    {
+        memcpy(b->bytes, o->p, o->len);
+        b->bytes[o->len] = 0;
+        b->pub = (event_chart_t){.data = b->bytes, .len = o->len, .seq = seq};
+        b->refs = 1;
+    }
+    free(o->p);
+    return b;
+}
+
+static void chart_buf_unref(chart_buf_t *b)
+{
+    if (b && __atomic_sub_fetch(&b->refs, 1, __ATOMIC_ACQ_REL) == 0)
+        free(b);
+}
+
+static void chart_drop_contents(chart_t *c)
+{
+    for (int f = 0; f < 2; ++f)
+    {
+        chart_buf_unref(c->buf[f]);
+        c->buf[f] = NULL;
+        free(c->off[f]);
+        c->off[f] = NULL;
+    }
+    free(c->ix_seat);
+    free(c->ix_pos);
+    free(c->expires);
+    c->ix_seat = c->ix_pos = NULL;
+    c->expires = NULL;
+    c->next_lapse = 0;
+    c->n_seats = 0;
+}
+
+static size_t chart_find(const chart_t *c, uint32_t seat_ix)
+{
+    size_t h = (size_t)(seat_ix * 0x9E3779B1u) & c->ix_mask;
+    for (; c->ix_seat[h] != 0; h = (h + 1) & c->ix_mask)
+        if (c->ix_seat[h] == seat_ix)
+            return c->ix_pos[h];
+    return SIZE_MAX;
+}
+
+// Seat i is shown held until `expires` (0: no expiry).
+static void chart_note_hold(chart_t *c, size_t i, tb_epoch_t expires)
+{
+    c->expires[i] = expires;
+    if (expires != 0 && (c->next_lapse == 0 || expires < c->next_lapse))
+        c->next_lapse = expires;
+}
+
+// Expiry of the hold now on seat_ix, 0 if it is not held.
+static tb_epoch_t hold_expiry_now(uint32_t ev, uint32_t seat_ix)
+{
+    tb_ebr_enter();
+    seat_ref_t r = seat_map_find_ix(g_map, ev, seat_ix);
+    uint64_t w = r ? seat_state_load(g_map, r) : 0;
+    tb_ebr_exit();
+    return r && !seat_state_gone(w) && seat_state_status(w) == SEAT_HELD ? seat_state_expires(w) : 0;
+}
+
+// (Re)build the chart from the seats as they are now. The subscription is
+// taken first, so any change the walk misses is patched in afterwards.
+static bool chart_build(chart_t *c)
+{
+    chart_drop_contents(c);
+    tb_feed_unsubscribe(c->sub);
+    if (!(c->sub = tb_feed_subscribe(g_feed)))
+        return false;
+    uint64_t seq = tb_feed_cursor(c->sub);
+
+    size_t records = seat_map_event_records(g_map, c->event_ix);
+    size_t cap = records ? records : 1, ix_size = 16;
+    while (ix_size < 2 * cap)
+        ix_size <<= 1;
+    c->off[0] = malloc(cap * sizeof(uint32_t));
+    c->off[1] = malloc(cap * sizeof(uint32_t));
+    c->ix_seat = calloc(ix_size, sizeof(uint32_t));
+    c->ix_pos = malloc(ix_size * sizeof(uint32_t));
+    c->ix_mask = ix_size - 1;
+    c->expires = calloc(cap, sizeof(tb_epoch_t));
+    chart_out_t bin = {0}, json = {0};
+    bin.oom = json.oom = !c->off[0] || !c->off[1] || !c->ix_seat || !c->ix_pos || !c->expires;
+
+    const char *event_id = tb_intern_name(TB_NS_EVENT, c->event_ix);
+    out_put(&bin, "TBC1\0\0\0\0", 8); // count patched below
+    out_str(&json, "{\"event\":");
+    out_json_str(&json, event_id ? event_id : "");
+    out_str(&json, ",\"seats\":[");
+    tb_epoch_t now = now_unix();
+    size_t n = 0;
+    tb_ebr_enter();
+    for (size_t pos = 0; pos < records && !bin.oom && !json.oom; ++pos)
+    {
+        seat_ref_t r = seat_map_event_ref(g_map, c->event_ix, pos);
+        seat_t s;
+        if (r == 0 || !seat_map_read(g_map, r, &s))
+            continue;
+        if (s.status == SEAT_HELD && hold_expired(s.hold_expires_unix, now))
+            s.status = SEAT_AVAILABLE;
+        else if (s.status == SEAT_HELD)
+            chart_note_hold(c, n, s.hold_expires_unix);
+        uint32_t seat_ix = (uint32_t)seat_map_hot(g_map, r)->key;
+        size_t h = (size_t)(seat_ix * 0x9E3779B1u) & c->ix_mask;
+        while (c->ix_seat[h] != 0)
+            h = (h + 1) & c->ix_mask;
+        c->ix_seat[h] = seat_ix;
+        c->ix_pos[h] = (uint32_t)n;
+
+        unsigned char id_len = (unsigned char)strnlen(s.seat_id, TB_ID_LEN - 1);
+        unsigned char head[2] = {(unsigned char)s.status, id_len};
+        c->off[CHART_BINARY][n] = (uint32_t)bin.len;
+        out_put(&bin, head, 2);
+        out_put(&bin, s.seat_id, id_len);
+        out_u32le(&bin, (uint32_t)s.price_cents);
+
+        char num[48];
+        out_str(&json, n ? ",{\"id\":" : "{\"id\":");
+        out_json_str(&json, s.seat_id);
+        snprintf(num, sizeof num, ",\"price\":%d,\"status\":\"", (int)s.price_cents);
+        out_str(&json, num);
+        c->off[CHART_JSON][n] = (uint32_t)json.len;
+        out_put(&json, &k_json_status[s.status & 3], 1);
+        out_str(&json, "\"}");
+        n++;
+    }
+    tb_ebr_exit();
+    out_str(&json, "]}");
+    if (!bin.oom && bin.len >= 8)
+        for (int k = 0; k < 4; ++k)
+            bin.p[4 + k] = (unsigned char)(n >> (8 * k));
+    if (bin.len > UINT32_MAX || json.len > UINT32_MAX)
+        bin.oom = true;
+    c->n_seats = n;
+    c->buf[CHART_BINARY] = chart_buf_from(&bin, seq);
+    c->buf[CHART_JSON] = chart_buf_from(&json, seq);
+    if (!c->buf[0] || !c->buf[1])
+    {
+        chart_drop_contents(c);
+        return false;
+    }
+    return true;
+}
+
+// Buffer of format f that may be written: the chart's own, or a copy of it
+// if readers hold it.
+static chart_buf_t *chart_writable(chart_t *c, int f)
+{
+    chart_buf_t *b = c->buf[f];
+    if (__atomic_load_n(&b->refs, __ATOMIC_ACQUIRE) == 1)
+        return b;
+    chart_buf_t *copy = malloc(sizeof(chart_buf_t) + b->pub.len + 1);
+    if (!copy)
+        return NULL;
+    memcpy(copy->bytes, b->bytes, b->pub.len + 1);
+    copy->pub = (event_chart_t){.data = copy->bytes, .len = b->pub.len, .seq = b->pub.seq};
+    copy->refs = 1;
+    c->buf[f] = copy;
+    chart_buf_unref(b);
+    return copy;
+}
+
+// Set seat i's status in both formats, copying a buffer readers still hold.
+static bool chart_patch(chart_t *c, chart_buf_t *w[2], size_t i, seat_status_t st)
+{
+    for (int f = 0; f < 2; ++f)
+    {
+        if (!w[f] && !(w[f] = chart_writable(c, f)))
+            return false;
+        w[f]->bytes[c->off[f][i]] = f == CHART_BINARY ? (unsigned char)st
+                                                        : (unsigned char)k_json_status[st];
+    }
+    return true;
+}
+
+// Show the holds that lapsed since as available. One pass over the seats,
+// taken only once the earliest hold shown has expired.
+static bool chart_lapse(chart_t *c, chart_buf_t *w[2], tb_epoch_t now)
+{
+    if (!hold_expired(c->next_lapse, now))
+        return true;
+    c->next_lapse = 0;
+    for (size_t i = 0; i < c->n_seats; ++i)
+    {
+        if (!hold_expired(c->expires[i], now))
+            chart_note_hold(c, i, c->expires[i]);
+        else if (chart_patch(c, w, i, SEAT_AVAILABLE))
+            c->expires[i] = 0;
+        else
+        {
+            c->next_lapse = now; // try again next time
+            return false;
+        }
+    }
+    return true;
+}
+
+// Apply the feed up to its current head, then any lapsed holds. Rebuilds
+// instead when the feed lapped the chart, a seat is not in it, or the seat
+// count moved.
+static bool chart_refresh(chart_t *c)
+{
+    if (!c->buf[0] || seat_map_event_size(g_map, c->event_ix) != c->n_seats)
+        return chart_build(c);
+    uint64_t target = tb_feed_head(g_feed);
+    chart_buf_t *w[2] = {NULL, NULL};
+    tb_change_t ch[256];
+    while (tb_feed_cursor(c->sub) < target)
+    {
+        bool lost;
+        size_t n = tb_feed_poll(c->sub, ch, 256, &lost);
+        if (lost)
+            return chart_build(c);
+        if (n == 0)
+            break; // a publisher is mid-write; its change comes next time
+        for (size_t k = 0; k < n; ++k)
+        {
+            if (ch[k].event_ix != c->event_ix)
+                continue;
+            size_t i = chart_find(c, ch[k].seat_ix);
+            if (i == SIZE_MAX)
+                return chart_build(c);
+            seat_status_t st = ch[k].kind == TB_CHANGE_HELD        ? SEAT_HELD
+                               : ch[k].kind == TB_CHANGE_SOLD      ? SEAT_SOLD
+                               : ch[k].kind == TB_CHANGE_WITHDRAWN ? SEAT_REFUNDED
+                                                                   : SEAT_AVAILABLE;
+            if (!chart_patch(c, w, i, st))
+                return false;
+            // A hold gone since is in the feed further on; one that lapsed
+            // is still HELD in the state word, with its expiry.
+            chart_note_hold(c, i, st == SEAT_HELD ? hold_expiry_now(c->event_ix, ch[k].seat_ix) : 0);
+        }
+    }
+    if (!chart_lapse(c, w, now_unix()))
+        return false;
+    // A buffer left untouched keeps its older seq, which still holds.
+    for (int f = 0; f < 2; ++f)
+        if (w[f])
+            w[f]->pub.seq = tb_feed_cursor(c->sub);
+    return true;
+}
+
+// Cached chart of an event, created on first use; NULL when the cache is
+// full.
+static chart_t *chart_slot(uint32_t ev)
+{
+    size_t mask = CONFIG_CHART_CACHE_EVENTS - 1, h = (size_t)(ev * 0x9E3779B1u) & mask;
+    for (size_t probe = 0; probe <= mask; ++probe, h = (h + 1) & mask)
+    {
+        chart_t *c = __atomic_load_n(&g_charts[h], __ATOMIC_ACQUIRE);
+        if (c && c->event_ix == ev)
+            return c;
+        if (c)
+            continue;
+        pthread_mutex_lock(&g_chart_mtx);
+        c = g_charts[h];
+        if (!c && (c = calloc(1, sizeof *c)) != NULL)
+        {
+            pthread_mutex_init(&c->mtx, NULL);
+            c->event_ix = ev;
+            __atomic_store_n(&g_charts[h], c, __ATOMIC_RELEASE);
+        }
+        pthread_mutex_unlock(&g_chart_mtx);
+        if (!c || c->event_ix == ev)
+            return c;
+    }
+    return NULL;
+}
+
+static void chart_free(chart_t *c)
+{
+    chart_drop_contents(c);
+    tb_feed_unsubscribe(c->sub);
+    pthread_mutex_destroy(&c->mtx);
+    free(c);
+}
+
+static void chart_cache_clear(void)
+{
+    pthread_mutex_lock(&g_chart_mtx);
+    for (size_t i = 0; i < CONFIG_CHART_CACHE_EVENTS; ++i)
+        if (g_charts[i])
+        {
+            chart_free(g_charts[i]);
+            g_charts[i] = NULL;
+        }
+    pthread_mutex_unlock(&g_chart_mtx);
+}
+
+static const event_chart_t *chart_acquire(uint32_t ev, chart_format_t format)
+{
+    if (seat_map_event_size(g_map, ev) == 0)
+        return NULL;
+    chart_t *c = chart_slot(ev);
+    if (!c)
+    {
+        // Cache full: a one-off chart the caller owns outright.
+        chart_t tmp = {.event_ix = ev};
+        chart_buf_t *b = NULL;
+        if (chart_build(&tmp))
+        {
+            b = tmp.buf[format];
+            tmp.buf[format] = NULL;
+        }
+        chart_drop_contents(&tmp);
+        tb_feed_unsubscribe(tmp.sub);
+        return b ? &b->pub : NULL;
+    }
+    pthread_mutex_lock(&c->mtx);
+    chart_buf_t *b = NULL;
+    bool fresh = c->buf[0] && tb_feed_cursor(c->sub) == tb_feed_head(g_feed) &&
+                 seat_map_event_size(g_map, ev) == c->n_seats &&
+                 !hold_expired(c->next_lapse, now_unix());
+    if (fresh || chart_refresh(c))
+    {
+        b = c->buf[format];
+        __atomic_add_fetch(&b->refs, 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&c->mtx);
+    return b ? &b->pub : NULL;
+}
+
+const event_chart_t *event_chart_acquire(const char *event_id, chart_format_t format)
+{
+    if (!g_reservation_init_ok || !g_map || !event_id || (format != CHART_BINARY && format != CHART_JSON))
+        return NULL;
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, event_id);
+    pthread_rwlock_t *tl = tier_enter(ev);
+    const event_chart_t *chart = chart_acquire(ev, format);
+    tier_exit(tl);
+    return chart;
+}
+
+void event_chart_release(const event_chart_t *chart)
+{
+    // pub is the first member of its chart_buf_t.
+    chart_buf_unref((chart_buf_t *)(uintptr_t)chart);
+}
+
+// Rows of an event to search, or the whole event as one row if it has no
+// layout. Returns the row count; 0 if there is nothing to search.
+static size_t event_rows(uint32_t ev, const seat_row_t **rows, seat_row_t *whole)
+{
+    size_t n;
+    *rows = seat_map_event_rows(g_map, ev, &n);
+    if (*rows)
+        return n;
+    size_t records = seat_map_event_records(g_map, ev);
+    whole->section_ix = 0;
+    whole->first = 0;
+    whole->n_seats = records > UINT32_MAX ? UINT32_MAX : (uint32_t)records;
+    *rows = whole;
+    return records ? 1 : 0;
+}
+
+size_t event_available_count(const char *event_id, const char *section)
+{
+    if (!g_reservation_init_ok || !g_map || !event_id)
+        return 0;
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, event_id);
+    pthread_rwlock_t *tl = tier_enter(ev);
+    uint32_t sec = section ? tb_intern_lookup(TB_NS_SECTION, section) : 0;
+    size_t n = 0, total = 0;
+    if (!section)
+        total = seat_map_avail_count(g_map, ev, 0, seat_map_event_records(g_map, ev));
+    const seat_row_t *rows = sec ? seat_map_event_rows(g_map, ev, &n) : NULL;
+    for (size_t i = 0; i < n; ++i)
+        if (rows[i].section_ix == sec)
+            total += seat_map_avail_count(g_map, ev, rows[i].first, rows[i].n_seats);
+    tier_exit(tl);
+    return total;
+}
+
+tb_feed_t *reservation_feed(void)
+{
+    return g_reservation_init_ok ? g_feed : NULL;
+}
+
+bool reservation_enable_change_log(size_t capacity)
+{
+    if (!g_reservation_init_ok)
+        return false;
+    if (__atomic_load_n(&g_change_log, __ATOMIC_ACQUIRE))
+        return true;
+    tb_feed_t *log = tb_feed_create(capacity), *none = NULL;
+    if (!log)
+        return false;
+    if (!__atomic_compare_exchange_n(&g_change_log, &none, log, false, __ATOMIC_ACQ_REL,
+                                     __ATOMIC_ACQUIRE))
+        tb_feed_destroy(log); // another caller won
+    return true;
+}
+
+tb_feed_t *reservation_change_log(void)
+{
+    return g_reservation_init_ok ? __atomic_load_n(&g_change_log, __ATOMIC_ACQUIRE) : NULL;
+}
+
+bool event_inventory(const char *event_id, event_inventory_t *out)
+{
+    if (!g_reservation_init_ok || !g_map || !event_id || !out)
+        return false;
+    seat_counts_t c;
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, event_id);
+    pthread_rwlock_t *tl = tier_enter(ev);
+    bool found = seat_map_event_counts(g_map, ev, &c);
+    tier_exit(tl);
+    if (!found)
+        return false;
+    out->seats = c.seats;
+    out->available = c.by_status[SEAT_AVAILABLE];
+    out->held = c.by_status[SEAT_HELD];
+    out->sold = c.by_status[SEAT_SOLD];
+    out->refunded = c.by_status[SEAT_REFUNDED];
+    return true;
+}
+
+static size_t expire_holds(uint32_t ev)
+{
+    size_t records = seat_map_event_records(g_map, ev), released = 0;
+    tb_epoch_t now = now_unix();
+    tb_ebr_enter();
+    for (size_t pos = 0; pos < records; ++pos)
+    {
+        seat_ref_t r = seat_map_event_ref(g_map, ev, pos);
+        if (r == 0)
+            continue;
+        // One try per seat: a word that moved under the CAS was renewed,
+        // confirmed or released by someone else.
+        uint64_t w = seat_state_load(g_map, r);
+        seat_hold_t cur;
+        if (seat_state_status(w) == SEAT_HELD && !seat_state_pinned(w) &&
+            hold_expired(seat_state_expires(w), now) && seat_state_hold(g_map, r, w, &cur) &&
+            seat_state_cas(g_map, r, w, seat_state_make(SEAT_AVAILABLE, 0, 0)))
+        {
+            index_remove(cur.holder_user_id, r);
+            publish(r, TB_CHANGE_RELEASED);
+            released++;
+        }
+    }
+    tb_ebr_exit();
+    return released;
+}
+
+size_t event_expire_holds(const char *event_id)
+{
+    if (!g_reservation_init_ok || !g_map || !event_id)
+        return 0;
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, event_id);
+    pthread_rwlock_t *tl = tier_enter(ev);
+    size_t released = expire_holds(ev);
+    tier_exit(tl);
+    return released;
+}
+
+// Take seat r off sale. A hold is dropped; a checkout in flight is waited
+// out, and if it sold the seat the order is there for the refund pass.
+static void withdraw_seat(seat_ref_t r)
+{
+    for (;;)
+    {
+        uint64_t w = seat_state_load(g_map, r);
+        seat_status_t st = seat_state_status(w);
+        if (seat_state_gone(w) || st == SEAT_SOLD || st == SEAT_REFUNDED)
+            return;
+        if (seat_state_pinned(w))
+        {
+            sched_yield();
+            continue;
+        }
+        seat_hold_t cur;
+        if (st == SEAT_HELD && !seat_state_hold(g_map, r, w, &cur))
+            continue;
+        if (seat_state_cas(g_map, r, w, seat_state_make(SEAT_REFUNDED, 0, 0)))
+        {
+            if (st == SEAT_HELD)
+                index_remove(cur.holder_user_id, r);
+            publish(r, TB_CHANGE_WITHDRAWN);
+            return;
+        }
+    }
+}
+
+// Refunded seat r: SOLD -> REFUNDED.
+static void refund_seat(seat_ref_t r)
+{
+    for (uint64_t w; r != 0;)
+    {
+        w = seat_state_load(g_map, r);
+        if (seat_state_gone(w) || seat_state_status(w) != SEAT_SOLD)
+            return;
+        if (seat_state_cas(g_map, r, w, seat_state_make(SEAT_REFUNDED, 0, 0)))
+        {
+            publish(r, TB_CHANGE_WITHDRAWN);
+            return;
+        }
+    }
+}
+
+typedef struct
+{
+    const char *event_id;
+    uint32_t ev;
+    event_refund_progress_fn progress;
+    void *ctx;
+    pthread_mutex_t mtx; // progress, stop, failed
+    event_refund_progress_t done;
+    bool stop;
+    bool failed;
+} refund_job_t;
+
+static void *refund_worker(void *arg)
+{
+    refund_job_t *job = arg;
+    db_refund_row_t *rows = malloc(CONFIG_REFUND_BATCH * sizeof *rows);
+    bool ok = rows != NULL;
+    while (ok)
+    {
+        pthread_mutex_lock(&job->mtx);
+        bool stop = job->stop || job->failed;
+        pthread_mutex_unlock(&job->mtx);
+        if (stop)
+            break;
+        size_t n = 0;
+        db_txn_t *txn = db_txn_begin();
+        ok = txn && db_refund_event_batch(txn, job->event_id, CONFIG_REFUND_BATCH, rows, &n) == RES_OK;
+        if (!ok || !db_txn_commit(txn))
+        {
+            db_txn_rollback(txn);
+            ok = false;
+            break;
+        }
+        tb_ebr_enter();
+        for (size_t i = 0; i < n; ++i)
+            refund_seat(seat_map_find_ix(g_map, job->ev, rows[i].seat_ix));
+        tb_ebr_exit();
+        if (n == 0)
+            break;
+        pthread_mutex_lock(&job->mtx);
+        job->done.refunded += n;
+        job->done.batches++;
+        if (job->progress && !job->stop && !job->progress(&job->done, job->ctx))
+            job->stop = true;
+        pthread_mutex_unlock(&job->mtx);
+    }
+    free(rows);
+    if (!ok)
+    {
+        pthread_mutex_lock(&job->mtx);
+        job->failed = true;
+        pthread_mutex_unlock(&job->mtx);
+    }
+    return NULL;
+}
+
+bool event_cancel_and_refund(const char *event_id, unsigned threads,
+                             event_refund_progress_fn progress, void *ctx)
+{
+    seat_counts_t counts;
+    if (!g_reservation_init_ok || !g_map || !event_id)
+        return false;
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, event_id);
+    pthread_rwlock_t *tl = tier_enter(ev);
+    if (!seat_map_event_counts(g_map, ev, &counts))
+    {
+        tier_exit(tl);
+        return false;
+    }
+
+    // Off sale first, so the orders cannot grow while they are refunded.
+    size_t records = seat_map_event_records(g_map, ev);
+    tb_ebr_enter();
+    for (size_t pos = 0; pos < records; ++pos)
+    {
+        seat_ref_t r = seat_map_event_ref(g_map, ev, pos);
+        if (r != 0)
+            withdraw_seat(r);
+    }
+    tb_ebr_exit();
+
+    refund_job_t job = {.event_id = event_id, .ev = ev, .progress = progress, .ctx = ctx};
+    pthread_mutex_init(&job.mtx, NULL);
+    job.done.orders = db_order_count_by_event(event_id);
+    if (threads == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (unsigned)cpus : 1;
+    }
+    size_t batches = (job.done.orders + CONFIG_REFUND_BATCH - 1) / CONFIG_REFUND_BATCH;
+    if (threads > batches)
+        threads = batches ? (unsigned)batches : 1;
+    if (threads > CONFIG_REFUND_MAX_THREADS)
+        threads = CONFIG_REFUND_MAX_THREADS;
+    pthread_t th[CONFIG_REFUND_MAX_THREADS];
+    unsigned started = 0;
+    while (started + 1 < threads && pthread_create(&th[started], NULL, refund_worker, &job) == 0)
+        started++;
+    refund_worker(&job); // the caller is a worker too
+    for (unsigned t = 0; t < started; ++t)
+        pthread_join(th[t], NULL);
+    pthread_mutex_destroy(&job.mtx);
+    tier_exit(tl);
+    return !job.failed && db_order_count_by_event(event_id) == 0;
+}
+
+bool event_inventory_verify(const char *event_id)
+{
+    if (!g_reservation_init_ok || !g_map || !event_id)
+        return false;
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, event_id);
+    pthread_rwlock_t *tl = tier_enter(ev);
+    bool ok = seat_map_event_verify(g_map, ev);
+    tier_exit(tl);
+    return ok;
+}
+
+// First block of n free seats in preference order: rows in order, the block
+// nearest the row's centre within a row.
+static bool pick_block(uint32_t ev, uint32_t sec, size_t n, size_t *start)
+{
+    seat_row_t whole;
+    const seat_row_t *rows;
+    size_t n_rows = event_rows(ev, &rows, &whole);
+    for (size_t i = 0; i < n_rows; ++i)
+    {
+        const seat_row_t *r = &rows[i];
+        if ((sec && r->section_ix != sec) || r->n_seats < n)
+            continue;
+        if (seat_map_avail_find(g_map, ev, r->first, r->n_seats, n,
+                                r->first + (r->n_seats - n) / 2, start))
+            return true;
+    }
+    return false;
+}
+
+// Search and hold for find_best_available.
+static res_code_t hold_best(const char *user_id, uint32_t ev, uint32_t sec, size_t n,
+                            group_seat_t *out)
+{
+    memset(out, 0, n * sizeof(*out));
+    for (int attempt = 0; attempt < CONFIG_BEST_AVAILABLE_ATTEMPTS; ++attempt)
+    {
+        size_t start;
+        if (!pick_block(ev, sec, n, &start))
+            return RES_NOT_FOUND;
+
+        // Hold left to right; if another buyer wins a seat first, give back
+        // what this call took and search again with the updated bits.
+        uint32_t seats[RES_MAX_GROUP];
+        size_t held = 0;
+        res_code_t rc = RES_OK;
+        for (; held < n; ++held)
+        {
+            tb_ebr_enter();
+            seat_ref_t r = seat_map_event_ref(g_map, ev, start + held);
+            seats[held] = r ? (uint32_t)seat_map_hot(g_map, r)->key : 0;
+            tb_ebr_exit();
+            out[held].hold = hold_ix(user_id, ev, seats[held]);
+            if (out[held].hold.code != RES_OK)
+            {
+                rc = out[held].hold.code;
+                break;
+            }
+            strncpy(out[held].seat_id, tb_intern_name(TB_NS_SEAT, seats[held]), RES_ID_LEN - 1);
+        }
+        if (held == n)
+            return RES_OK;
+        while (held-- > 0)
+            cancel_ix(user_id, ev, seats[held]);
+        memset(out, 0, n * sizeof(*out));
+        if (rc == RES_INTERNAL_ERR || rc == RES_HOLD_LIMIT)
+            return rc;
+    }
+    return RES_HELD_BY_OTHER;
+}
+
+res_code_t find_best_available(const char *user_id,
+                               const char *event_id,
+                               const char *section,
+                               size_t n,
+                               group_seat_t *out)
+{
+    if (!g_reservation_init_ok || !g_map || !user_id || !event_id || !out)
+        return RES_NOT_FOUND;
+    if (n == 0 || n > RES_MAX_GROUP)
+        return RES_INTERNAL_ERR;
+    if (!reservation_admit(user_id, RES_OP_SEARCH))
+        return RES_RATE_LIMITED; // one token for the search and its holds
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, event_id);
+    uint32_t sec = section ? tb_intern_lookup(TB_NS_SECTION, section) : 0;
+    if (ev == 0 || (section && sec == 0))
+        return RES_NOT_FOUND;
+    pthread_rwlock_t *tl = tier_enter(ev);
+    res_code_t rc = hold_best(user_id, ev, sec, n, out);
+    tier_exit(tl);
+    return rc;
+}
+
+// Merge the available seats of event ev priced in [lo, hi] into out[0..*have),
+// which stays in price order and at most n long. A seat only goes in ahead
+// of dearer ones, so ties keep the order the events were merged in.
+static void cheapest_merge(uint32_t ev, tb_money_cents_t lo, tb_money_cents_t hi, size_t n,
+                           priced_seat_t *out, size_t *have)
+{
+    pthread_rwlock_t *tl = tier_enter(ev);
+    tb_ebr_enter();
+    seat_price_cursor_t c;
+    seat_ref_t r;
+    tb_money_cents_t price;
+    seat_t s;
+    bool ok = seat_map_price_open(g_map, ev, lo, hi, &c);
+    while (ok && seat_map_price_next(g_map, &c, &r, &price))
+    {
+        if (*have == n && price >= out[n - 1].price_cents)
+            break; // the rest of this event is no cheaper
+        if (!seat_map_read(g_map, r, &s) || s.status != SEAT_AVAILABLE)
+            continue; // taken since its bit was read
+        size_t at = *have < n ? (*have)++ : n - 1;
+        for (; at > 0 && out[at - 1].price_cents > price; --at)
+            out[at] = out[at - 1];
+        memcpy(out[at].event_id, s.event_id, RES_ID_LEN);
+        memcpy(out[at].seat_id, s.seat_id, RES_ID_LEN);
+        out[at].price_cents = price;
+    }
+    tb_ebr_exit();
+    tier_exit(tl);
+}
+
+size_t tour_cheapest_seats(const char *const *event_ids, size_t n_events,
+                           tb_money_cents_t min_cents, tb_money_cents_t max_cents, size_t n,
+                           priced_seat_t *out)
+{
+    if (!g_reservation_init_ok || !g_map || !event_ids || !out || n == 0)
+        return 0;
+    size_t have = 0;
+    for (size_t i = 0; i < n_events; ++i)
+    {
+        uint32_t ev = event_ids[i] ? tb_intern_lookup(TB_NS_EVENT, event_ids[i]) : 0;
+        if (ev != 0)
+            cheapest_merge(ev, min_cents, max_cents, n, out, &have);
+    }
+    tb_ebr_reclaim();
+    return have;
+}
+
+size_t event_cheapest_seats(const char *event_id, tb_money_cents_t min_cents,
+                            tb_money_cents_t max_cents, size_t n, priced_seat_t *out)
+{
+    return tour_cheapest_seats(&event_id, 1, min_cents, max_cents, n, out);
+}
+
+size_t event_available_in_price_range(const char *event_id, tb_money_cents_t min_cents,
+                                      tb_money_cents_t max_cents)
+{
+    if (!g_reservation_init_ok || !g_map || !event_id)
+        return 0;
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, event_id);
+    if (ev == 0)
+        return 0;
+    pthread_rwlock_t *tl = tier_enter(ev);
+    size_t n = seat_map_price_count(g_map, ev, min_cents, max_cents);
+    tier_exit(tl);
+    return n;
+}
+
 res_code_t refund(const char *user_id,
                   const char *order_id)
 {
@@ -460,24 +2315,457 @@ res_code_t refund(const char *user_id,
     if (rc != RES_OK || !db_txn_commit(txn))
     {
         db_txn_rollback(txn);
+        if (rc == RES_NOT_FOUND) // lost a race with another refund
+            return RES_NOT_FOUND;
         return (rc == RES_DB_ERROR ? RES_DB_ERROR : RES_INTERNAL_ERR);
     }
 
     // 3) Flip in-memory seat state from SOLD → AVAILABLE (best-effort)
-    if (seat_map_lock(g_map, ev_id, st_id))
+    pthread_rwlock_t *tl = tier_enter(tb_intern_lookup(TB_NS_EVENT, ev_id));
+    tb_ebr_enter();
+    seat_ref_t r = seat_map_find(g_map, ev_id, st_id);
+    if (seat_map_lock_ref(g_map, r))
     {
         seat_t s = {0};
-        if (seat_map_get(g_map, ev_id, st_id, &s))
+        if (seat_map_read(g_map, r, &s))
         {
             if (s.status == SEAT_SOLD)
             {
                 s.status = SEAT_AVAILABLE; // or SEAT_REFUNDED if your enum supports it
                 clear_hold_fields(&s);
                 seat_map_put(g_map, &s);
+                uint32_t ev_ix = tb_intern_lookup(TB_NS_EVENT, ev_id);
+                uint32_t st_ix = tb_intern_lookup(TB_NS_SEAT, st_id);
+                tb_feed_publish(g_feed, ev_ix, st_ix, TB_CHANGE_REFUNDED);
+                log_change(ev_ix, st_ix, TB_CHANGE_REFUNDED);
             }
         }
-        seat_map_unlock(g_map, ev_id, st_id);
+        seat_map_unlock_ref(g_map, r);
     }
+    tb_ebr_exit();
+    tier_exit(tl);
 
     return RES_OK;
 }
+
+// ---- tiered storage ----
+// Per-event access stamps and cold flags live in pages indexed by interned
+// event id, as the seat map's events do. A call on an event holds its
+// stripe's read lock for the duration, so eviction (under the write lock)
+// never pulls an event out from under a caller. Faults run under the read
+// lock too, serialised by the stripe's fault mutex: callers of a cold event
+// wait there until it is back, and calls on other events of the stripe go
+// on meanwhile.
+
+typedef struct
+{
+    uint32_t last_access; // unix seconds
+    uint32_t cold;        // evicted: the seats are in the segment file
+    uint64_t seg_bytes;   // size of that file
+} tier_slot_t;
+
+typedef struct
+{
+    char dir[4096];
+    size_t max_bytes;
+    tb_epoch_t idle_secs;
+    pthread_rwlock_t locks[CONFIG_TIER_LOCK_STRIPES];
+    pthread_mutex_t fault_mtx[CONFIG_TIER_LOCK_STRIPES];
+    pthread_mutex_t sweep_mtx;
+    tier_slot_t *pages[SEAT_EVENT_PAGES];
+    size_t cold_events;
+    uint64_t segment_bytes;
+    uint64_t evictions;
+    uint64_t faults;
+    uint64_t fault_ns;
+} tier_t;
+
+static tier_t *g_tier = NULL; // NULL until enabled
+
+static tier_slot_t *tier_slot(tier_t *t, uint32_t ev)
+{
+    size_t p = ev >> SEAT_EVENT_PAGE_BITS;
+    if (ev == 0 || p >= SEAT_EVENT_PAGES)
+        return NULL;
+    tier_slot_t *page = __atomic_load_n(&t->pages[p], __ATOMIC_ACQUIRE);
+    if (!page)
+    {
+        tier_slot_t *fresh = calloc(SEAT_EVENT_PAGE_SIZE, sizeof *fresh);
+        if (!fresh)
+            return NULL;
+        if (__atomic_compare_exchange_n(&t->pages[p], &page, fresh, false, __ATOMIC_ACQ_REL,
+                                        __ATOMIC_ACQUIRE))
+            page = fresh;
+        else
+            free(fresh); // another thread installed the page
+    }
+    return &page[ev & (SEAT_EVENT_PAGE_SIZE - 1)];
+}
+
+static inline size_t tier_stripe(uint32_t ev)
+{
+    return ev & (CONFIG_TIER_LOCK_STRIPES - 1);
+}
+
+// Segments are a cache of this process's memory, so each process has its
+// own files.
+static bool tier_path(const tier_t *t, uint32_t ev, char *out, size_t cap)
+{
+    return snprintf(out, cap, "%s/tb%ld_ev%u.tbseg", t->dir, (long)getpid(), ev) < (int)cap;
+}
+
+static uint64_t tier_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Does a seat read back need more than a bulk fill of an available seat
+// at the segment's base time?
+static bool tier_seat_special(const seat_t *s, tb_epoch_t base)
+{
+    return s->status != SEAT_AVAILABLE || s->last_order_id[0] != '\0' || s->updated_unix != base;
+}
+
+// Read an evicted event back. Holds the stripe's read lock and fault mutex. The
+// region is rebuilt with every seat at its old position (so the seating
+// layout still applies): one bulk fill of the whole event, then a put for
+// each seat that was sold, refunded or otherwise not as loaded.
+static bool tier_fault(tier_t *t, uint32_t ev, tier_slot_t *slot)
+{
+    uint64_t t0 = tier_now_ns();
+    char path[sizeof t->dir + 64];
+    const char *id = tb_intern_name(TB_NS_EVENT, ev);
+    tb_segment_t seg;
+    if (!id || !tier_path(t, ev, path, sizeof path) || !tb_segment_open(&seg, path))
+        return false;
+    bool ok = strcmp(seg.event_id, id) == 0 && seat_map_bulk_begin(g_map, ev, seg.records);
+    if (!ok)
+    {
+        tb_segment_close(&seg);
+        return false;
+    }
+    enum { CHUNK = 256 };
+    seat_bulk_t chunk[CHUNK];
+    size_t first = 0, n = 0, special = 0;
+    seat_t s;
+    bool present;
+    while (tb_segment_next(&seg, &s, &present))
+    {
+        chunk[n].seat_ix = present ? tb_intern(TB_NS_SEAT, s.seat_id) : 0;
+        chunk[n].price_cents = s.price_cents;
+        special += present && tier_seat_special(&s, seg.base_updated);
+        if (++n == CHUNK)
+        {
+            seat_map_bulk_fill(g_map, ev, first, chunk, n, seg.base_updated);
+            first += n;
+            n = 0;
+        }
+    }
+    seat_map_bulk_fill(g_map, ev, first, chunk, n, seg.base_updated);
+    seat_map_bulk_end(g_map, ev);
+    ok = tb_segment_done(&seg);
+    tb_segment_rewind(&seg);
+    tb_epoch_t now = now_unix();
+    while (ok && special > 0 && tb_segment_next(&seg, &s, &present))
+        if (present && tier_seat_special(&s, seg.base_updated))
+        {
+            ok = put_indexed(&s, now);
+            special--;
+        }
+    ok = ok && (seg.n_rows == 0 || seat_map_event_set_rows(g_map, ev, seg.rows, seg.n_rows));
+    tb_segment_close(&seg);
+    if (!ok)
+    {
+        seat_map_event_unload(g_map, id); // stays cold; the next call tries again
+        return false;
+    }
+    remove(path);
+    __atomic_store_n(&slot->cold, 0, __ATOMIC_RELEASE);
+    __atomic_sub_fetch(&t->cold_events, 1, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&t->segment_bytes, slot->seg_bytes, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&t->faults, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&t->fault_ns, tier_now_ns() - t0, __ATOMIC_RELAXED);
+    return true;
+}
+
+static pthread_rwlock_t *tier_enter(uint32_t ev)
+{
+    tier_t *t = __atomic_load_n(&g_tier, __ATOMIC_ACQUIRE);
+    tier_slot_t *slot = t ? tier_slot(t, ev) : NULL;
+    if (!slot)
+        return NULL;
+    uint32_t now = (uint32_t)now_unix();
+    if (__atomic_load_n(&slot->last_access, __ATOMIC_RELAXED) != now)
+        __atomic_store_n(&slot->last_access, now, __ATOMIC_RELAXED);
+    size_t i = tier_stripe(ev);
+    pthread_rwlock_rdlock(&t->locks[i]);
+    if (__atomic_load_n(&slot->cold, __ATOMIC_ACQUIRE))
+    {
+        // A failed fault leaves the event cold: it reads as not loaded.
+        pthread_mutex_lock(&t->fault_mtx[i]);
+        if (__atomic_load_n(&slot->cold, __ATOMIC_ACQUIRE))
+            tier_fault(t, ev, slot);
+        pthread_mutex_unlock(&t->fault_mtx[i]);
+    }
+    return &t->locks[i];
+}
+
+static void tier_exit(pthread_rwlock_t *l)
+{
+    if (l)
+        pthread_rwlock_unlock(l);
+}
+
+static pthread_rwlock_t *tier_lock_write(uint32_t ev)
+{
+    tier_t *t = __atomic_load_n(&g_tier, __ATOMIC_ACQUIRE);
+    if (!t || ev == 0)
+        return NULL;
+    pthread_rwlock_t *l = &t->locks[tier_stripe(ev)];
+    pthread_rwlock_wrlock(l);
+    return l;
+}
+
+// Forget an evicted event (it is being unloaded). False if the event is
+// not evicted.
+static bool tier_discard(uint32_t ev)
+{
+    tier_t *t = __atomic_load_n(&g_tier, __ATOMIC_ACQUIRE);
+    tier_slot_t *slot = t ? tier_slot(t, ev) : NULL;
+    char path[sizeof t->dir + 64];
+    if (!slot || !__atomic_load_n(&slot->cold, __ATOMIC_ACQUIRE))
+        return false;
+    pthread_mutex_lock(&t->fault_mtx[tier_stripe(ev)]);
+    bool cold = slot->cold;
+    if (cold)
+    {
+        if (tier_path(t, ev, path, sizeof path))
+            remove(path);
+        __atomic_store_n(&slot->cold, 0, __ATOMIC_RELEASE);
+        __atomic_sub_fetch(&t->cold_events, 1, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&t->segment_bytes, slot->seg_bytes, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&t->fault_mtx[tier_stripe(ev)]);
+    return cold;
+}
+
+// Write an event to its segment and drop it from the map. Lapsed holds are
+// released first; an event with live holds stays. With `wait` false an
+// event in use is skipped rather than waited for.
+static bool tier_evict(tier_t *t, uint32_t ev, bool wait)
+{
+    tier_slot_t *slot = tier_slot(t, ev);
+    const char *id = tb_intern_name(TB_NS_EVENT, ev);
+    char path[sizeof t->dir + 64];
+    if (!slot || !id || !tier_path(t, ev, path, sizeof path))
+        return false;
+    if (__atomic_load_n(&slot->cold, __ATOMIC_ACQUIRE))
+        return true;
+    expire_holds(ev);
+    pthread_rwlock_t *l = &t->locks[tier_stripe(ev)];
+    if (wait)
+        pthread_rwlock_wrlock(l);
+    else if (pthread_rwlock_trywrlock(l) != 0)
+        return false;
+    seat_counts_t c;
+    bool ok = slot->cold || (seat_map_event_counts(g_map, ev, &c) && c.by_status[SEAT_HELD] == 0);
+    if (ok && !slot->cold)
+    {
+        size_t records = seat_map_event_records(g_map, ev), n_rows;
+        const seat_row_t *rows = seat_map_event_rows(g_map, ev, &n_rows);
+        seat_t s;
+        tb_epoch_t base = 0;
+        tb_ebr_enter();
+        for (size_t pos = 0; pos < records; ++pos)
+        {
+            seat_ref_t r = seat_map_event_ref(g_map, ev, pos);
+            if (r != 0 && seat_map_read(g_map, r, &s))
+            {
+                base = s.updated_unix;
+                break;
+            }
+        }
+        tb_segment_writer_t w;
+        ok = tb_segment_begin(&w, id, records, base, rows, n_rows);
+        for (size_t pos = 0; ok && pos < records; ++pos)
+        {
+            seat_ref_t r = seat_map_event_ref(g_map, ev, pos);
+            tb_segment_add(&w, r != 0 && seat_map_read(g_map, r, &s) ? &s : NULL);
+        }
+        tb_ebr_exit();
+        size_t bytes = 0;
+        ok = ok && tb_segment_finish(&w, path, &bytes) && seat_map_event_unload(g_map, id);
+        if (ok)
+        {
+            slot->seg_bytes = bytes;
+            __atomic_store_n(&slot->cold, 1, __ATOMIC_RELEASE);
+            __atomic_add_fetch(&t->cold_events, 1, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&t->segment_bytes, bytes, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&t->evictions, 1, __ATOMIC_RELAXED);
+        }
+        else
+        {
+            remove(path);
+        }
+    }
+    pthread_rwlock_unlock(l);
+    return ok;
+}
+
+static void tier_clear(void)
+{
+    tier_t *t = g_tier;
+    if (!t)
+        return;
+    char path[sizeof t->dir + 64];
+    for (size_t p = 0; p < SEAT_EVENT_PAGES; ++p)
+    {
+        if (!t->pages[p])
+            continue;
+        for (size_t i = 0; i < SEAT_EVENT_PAGE_SIZE; ++i)
+            if (t->pages[p][i].cold &&
+                tier_path(t, (uint32_t)(p * SEAT_EVENT_PAGE_SIZE + i), path, sizeof path))
+                remove(path);
+        free(t->pages[p]);
+    }
+    for (size_t i = 0; i < CONFIG_TIER_LOCK_STRIPES; ++i)
+    {
+        pthread_rwlock_destroy(&t->locks[i]);
+        pthread_mutex_destroy(&t->fault_mtx[i]);
+    }
+    pthread_mutex_destroy(&t->sweep_mtx);
+    free(t);
+    g_tier = NULL;
+}
+
+bool reservation_enable_tiering(const char *dir, size_t max_bytes, tb_epoch_t idle_seconds)
+{
+    if (!g_reservation_init_ok || !dir)
+        return false;
+    tier_t *t = __atomic_load_n(&g_tier, __ATOMIC_ACQUIRE);
+    if (!t)
+    {
+        struct stat st;
+        if (stat(dir, &st) != 0 || !S_ISDIR(st.st_mode) || strlen(dir) >= sizeof t->dir)
+            return false;
+        tier_t *fresh = calloc(1, sizeof *fresh), *none = NULL;
+        if (!fresh)
+            return false;
+        strcpy(fresh->dir, dir);
+        for (size_t i = 0; i < CONFIG_TIER_LOCK_STRIPES; ++i)
+        {
+            pthread_rwlock_init(&fresh->locks[i], NULL);
+            pthread_mutex_init(&fresh->fault_mtx[i], NULL);
+        }
+        pthread_mutex_init(&fresh->sweep_mtx, NULL);
+        if (__atomic_compare_exchange_n(&g_tier, &none, fresh, false, __ATOMIC_ACQ_REL,
+                                        __ATOMIC_ACQUIRE))
+        {
+            t = fresh;
+        }
+        else
+        {
+            t = none; // another caller won
+            for (size_t i = 0; i < CONFIG_TIER_LOCK_STRIPES; ++i)
+            {
+                pthread_rwlock_destroy(&fresh->locks[i]);
+                pthread_mutex_destroy(&fresh->fault_mtx[i]);
+            }
+            pthread_mutex_destroy(&fresh->sweep_mtx);
+            free(fresh);
+        }
+    }
+    pthread_mutex_lock(&t->sweep_mtx);
+    t->max_bytes = max_bytes;
+    t->idle_secs = idle_seconds < 0 ? 0 : idle_seconds;
+    pthread_mutex_unlock(&t->sweep_mtx);
+    return true;
+}
+
+typedef struct
+{
+    uint32_t ev;
+    uint32_t last_access;
+} tier_candidate_t;
+
+static int cmp_candidate(const void *a, const void *b)
+{
+    uint32_t x = ((const tier_candidate_t *)a)->last_access;
+    uint32_t y = ((const tier_candidate_t *)b)->last_access;
+    return x < y ? -1 : x > y;
+}
+
+size_t reservation_tier_sweep(void)
+{
+    tier_t *t = g_reservation_init_ok ? __atomic_load_n(&g_tier, __ATOMIC_ACQUIRE) : NULL;
+    if (!t)
+        return 0;
+    pthread_mutex_lock(&t->sweep_mtx);
+    uint32_t events = tb_intern_count(TB_NS_EVENT);
+    tier_candidate_t *cand = malloc(((size_t)events + 1) * sizeof *cand);
+    size_t n = 0, evicted = 0;
+    for (uint32_t ev = 1; cand && ev <= events; ++ev)
+    {
+        tier_slot_t *slot = tier_slot(t, ev);
+        if (slot && !__atomic_load_n(&slot->cold, __ATOMIC_ACQUIRE) &&
+            seat_map_event_memory_bytes(g_map, ev) > 0)
+            cand[n++] = (tier_candidate_t){ev, __atomic_load_n(&slot->last_access, __ATOMIC_RELAXED)};
+    }
+    // Least recently used first: every idle event goes, then more while the
+    // map is over its budget.
+    qsort(cand, n, sizeof *cand, cmp_candidate);
+    tb_epoch_t now = now_unix();
+    size_t bytes = t->max_bytes ? seat_map_memory_bytes(g_map) : 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        bool idle = now - (tb_epoch_t)cand[i].last_access >= t->idle_secs;
+        if (!idle && bytes <= t->max_bytes)
+            break;
+        size_t size = seat_map_event_memory_bytes(g_map, cand[i].ev);
+        if (tier_evict(t, cand[i].ev, false))
+        {
+            bytes = bytes > size ? bytes - size : 0;
+            evicted++;
+        }
+    }
+    free(cand);
+    pthread_mutex_unlock(&t->sweep_mtx);
+    return evicted;
+}
+
+bool event_evict(const char *event_id)
+{
+    tier_t *t = g_reservation_init_ok ? __atomic_load_n(&g_tier, __ATOMIC_ACQUIRE) : NULL;
+    uint32_t ev = event_id ? tb_intern_lookup(TB_NS_EVENT, event_id) : 0;
+    if (!t || ev == 0)
+        return false;
+    tier_slot_t *slot = tier_slot(t, ev);
+    if (!slot || (!__atomic_load_n(&slot->cold, __ATOMIC_ACQUIRE) &&
+                  seat_map_event_memory_bytes(g_map, ev) == 0))
+        return false;
+    return tier_evict(t, ev, true);
+}
+
+bool event_is_cold(const char *event_id)
+{
+    tier_t *t = g_reservation_init_ok ? __atomic_load_n(&g_tier, __ATOMIC_ACQUIRE) : NULL;
+    uint32_t ev = event_id ? tb_intern_lookup(TB_NS_EVENT, event_id) : 0;
+    tier_slot_t *slot = t && ev ? tier_slot(t, ev) : NULL;
+    return slot && __atomic_load_n(&slot->cold, __ATOMIC_ACQUIRE);
+}
+
+bool reservation_tier_stats(tier_stats_t *out)
+{
+    tier_t *t = g_reservation_init_ok ? __atomic_load_n(&g_tier, __ATOMIC_ACQUIRE) : NULL;
+    if (!t || !out)
+        return false;
+    out->map_bytes = seat_map_memory_bytes(g_map);
+    out->cold_events = __atomic_load_n(&t->cold_events, __ATOMIC_RELAXED);
+    out->segment_bytes = __atomic_load_n(&t->segment_bytes, __ATOMIC_RELAXED);
+    out->evictions = __atomic_load_n(&t->evictions, __ATOMIC_RELAXED);
+    out->faults = __atomic_load_n(&t->faults, __ATOMIC_RELAXED);
+    out->fault_ns = __atomic_load_n(&t->fault_ns, __ATOMIC_RELAXED);
+    return true;
+}
@@ -0,0 +1,346 @@
+// Event segments (see segment.h): varint encoding, the writer and the
+// record decoder.
+
+#include "segment.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "utils.h"
+
+#define SEGMENT_CHECKSUM_SEED 0x5345474d454e5431ULL // "SEGMENT1"
+#define SEGMENT_TAIL 8u                             // checksum bytes
+#define SEGMENT_COUNT_BYTES 5u                      // seat count varint, fixed width
+
+// Record flags byte.
+#define REC_STATUS_MASK 3u
+#define REC_PRESENT     (1u << 2)
+#define REC_ORDER       (1u << 3)
+#define REC_UPDATED     (1u << 4)
+#define REC_HOLD        (1u << 5)
+
+/* ---- Writer ---- */
+
+static bool put_bytes(tb_segment_writer_t *w, const void *p, size_t n)
+{
+    if (w->failed)
+        return false;
+    if (w->len + n > w->cap)
+    {
+        size_t cap = w->cap ? w->cap : 4096;
+        while (cap < w->len + n)
+            cap *= 2;
+        unsigned char *buf = realloc(w->buf, cap);
+        if (!buf)
+        {
+            w->failed = true;
+            return false;
+        }
+        w->buf = buf;
+        w->cap = cap;
+    }
+    memcpy(w->buf + w->len, p, n);
+    w->len += n;
+    return true;
+}
+
+static void put_varint(tb_segment_writer_t *w, uint64_t v)
+{
+    unsigned char b[10];
+    size_t n = 0;
+    do
+    {
+        b[n] = (unsigned char)(v & 0x7f);
+        v >>= 7;
+        if (v)
+            b[n] |= 0x80;
+        n++;
+    } while (v);
+    put_bytes(w, b, n);
+}
+
+static inline uint64_t zigzag(int64_t v)
+{
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static void put_str(tb_segment_writer_t *w, const char *s, size_t max)
+{
+    size_t n = strnlen(s, max - 1);
+    put_varint(w, n);
+    put_bytes(w, s, n);
+}
+
+bool tb_segment_begin(tb_segment_writer_t *w, const char *event_id, size_t records,
+                      tb_epoch_t base_updated, const seat_row_t *rows, size_t n_rows)
+{
+    memset(w, 0, sizeof *w);
+    if (!event_id || (!rows && n_rows > 0))
+        return false;
+    w->records = records;
+    w->base_updated = base_updated;
+    put_bytes(w, TB_SEGMENT_MAGIC, 8);
+    put_str(w, event_id, TB_ID_LEN);
+    put_varint(w, records);
+    w->seats_at = w->len;
+    put_bytes(w, "\0\0\0\0\0", SEGMENT_COUNT_BYTES); // seat count, written by finish
+    put_varint(w, zigzag(base_updated));
+    put_varint(w, n_rows);
+    for (size_t i = 0; i < n_rows; ++i)
+    {
+        put_varint(w, rows[i].section_ix);
+        put_varint(w, rows[i].first);
+        put_varint(w, rows[i].n_seats);
+    }
+    if (w->failed)
+    {
+        tb_segment_discard(w);
+        return false;
+    }
+    return true;
+}
+
+void tb_segment_add(tb_segment_writer_t *w, const seat_t *seat)
+{
+    w->added++;
+    if (!seat)
+    {
+        unsigned char none = 0;
+        put_bytes(w, &none, 1);
+        return;
+    }
+    bool order = seat->last_order_id[0] != '\0';
+    bool updated = seat->updated_unix != w->base_updated;
+    bool hold = seat->status == SEAT_HELD;
+    unsigned char flags = (unsigned char)(((unsigned)seat->status & REC_STATUS_MASK) | REC_PRESENT |
+                                          (order ? REC_ORDER : 0) | (updated ? REC_UPDATED : 0) |
+                                          (hold ? REC_HOLD : 0));
+    put_bytes(w, &flags, 1);
+    w->seats++;
+
+    size_t len = strnlen(seat->seat_id, TB_ID_LEN - 1), shared = 0;
+    while (shared < len && seat->seat_id[shared] == w->prev_id[shared])
+        shared++;
+    put_varint(w, shared);
+    put_varint(w, len - shared);
+    put_bytes(w, seat->seat_id + shared, len - shared);
+    memcpy(w->prev_id, seat->seat_id, len);
+    w->prev_id[len] = '\0';
+
+    put_varint(w, zigzag((int64_t)seat->price_cents - w->prev_price));
+    w->prev_price = seat->price_cents;
+    if (order)
+        put_str(w, seat->last_order_id, TB_ID_LEN);
+    if (updated)
+        put_varint(w, zigzag(seat->updated_unix - w->base_updated));
+    if (hold)
+    {
+        size_t tlen = seat->hold_token_len < TB_TOKEN_LEN ? seat->hold_token_len : TB_TOKEN_LEN;
+        put_str(w, seat->holder_user_id, TB_ID_LEN);
+        put_varint(w, zigzag(seat->hold_expires_unix));
+        put_varint(w, tlen);
+        put_bytes(w, seat->hold_token, tlen);
+    }
+}
+
+bool tb_segment_finish(tb_segment_writer_t *w, const char *path, size_t *bytes)
+{
+    bool ok = path && !w->failed && w->added == w->records;
+    if (ok)
+    {
+        // A varint padded to a fixed width, so begin could reserve it.
+        uint64_t v = w->seats;
+        for (unsigned i = 0; i < SEGMENT_COUNT_BYTES; ++i, v >>= 7)
+            w->buf[w->seats_at + i] =
+                (unsigned char)((v & 0x7f) | (i + 1 < SEGMENT_COUNT_BYTES ? 0x80 : 0));
+    }
+    if (ok)
+    {
+        uint64_t sum = tb_hash_bytes(w->buf, w->len, SEGMENT_CHECKSUM_SEED);
+        unsigned char tail[SEGMENT_TAIL];
+        for (unsigned i = 0; i < SEGMENT_TAIL; ++i)
+            tail[i] = (unsigned char)(sum >> (8 * i));
+        ok = put_bytes(w, tail, sizeof tail);
+    }
+    char tmp[4096];
+    if (ok)
+        ok = snprintf(tmp, sizeof tmp, "%s.tmp", path) < (int)sizeof tmp;
+    if (ok)
+    {
+        FILE *f = fopen(tmp, "wb");
+        ok = f && fwrite(w->buf, 1, w->len, f) == w->len;
+        ok = f && fclose(f) == 0 && ok;
+        ok = ok && rename(tmp, path) == 0;
+        if (!ok)
+            remove(tmp);
+    }
+    if (ok && bytes)
+        *bytes = w->len;
+    tb_segment_discard(w);
+    return ok;
+}
+
+void tb_segment_discard(tb_segment_writer_t *w)
+{
+    free(w->buf);
+    memset(w, 0, sizeof *w);
+}
+
+/* ---- Reader ---- */
+
+static bool get_varint(tb_segment_t *s, size_t end, uint64_t *v)
+{
+    uint64_t x = 0;
+    for (unsigned shift = 0; shift < 64 && s->pos < end; shift += 7)
+    {
+        unsigned char b = s->data[s->pos++];
+        x |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80))
+        {
+            *v = x;
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline int64_t unzigzag(uint64_t v)
+{
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+// A string of at most max - 1 bytes into out, NUL-terminated.
+static bool get_str(tb_segment_t *s, size_t end, char *out, size_t max)
+{
+    uint64_t n;
+    if (!get_varint(s, end, &n) || n >= max || n > end - s->pos)
+        return false;
+    memcpy(out, s->data + s->pos, n);
+    out[n] = '\0';
+    s->pos += n;
+    return true;
+}
+
+static bool read_file(const char *path, unsigned char **data, size_t *len)
+{
+    struct stat st;
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return false;
+    bool ok = fstat(fileno(f), &st) == 0 && st.st_size > 0;
+    *len = ok ? (size_t)st.st_size : 0;
+    *data = ok ? malloc(*len) : NULL;
+    ok = *data && fread(*data, 1, *len, f) == *len;
+    fclose(f);
+    return ok;
+}
+
+bool tb_segment_open(tb_segment_t *s, const char *path)
+{
+    memset(s, 0, sizeof *s);
+    if (!path || !read_file(path, &s->data, &s->len) || s->len < 8 + SEGMENT_TAIL ||
+        memcmp(s->data, TB_SEGMENT_MAGIC, 8) != 0)
+    {
+        tb_segment_close(s);
+        return false;
+    }
+    size_t end = s->len - SEGMENT_TAIL;
+    uint64_t sum = 0;
+    for (unsigned i = 0; i < SEGMENT_TAIL; ++i)
+        sum |= (uint64_t)s->data[end + i] << (8 * i);
+    uint64_t records, seats, base, n_rows;
+    s->pos = 8;
+    bool ok = sum == tb_hash_bytes(s->data, end, SEGMENT_CHECKSUM_SEED) &&
+              get_str(s, end, s->event_id, TB_ID_LEN) && get_varint(s, end, &records) &&
+              get_varint(s, end, &seats) && get_varint(s, end, &base) &&
+              get_varint(s, end, &n_rows) && seats <= records && records <= end &&
+              n_rows <= (end - s->pos) / 3;
+    if (ok && n_rows > 0)
+        ok = (s->rows = malloc(n_rows * sizeof *s->rows)) != NULL;
+    for (size_t i = 0; ok && i < n_rows; ++i)
+    {
+        uint64_t sec = 0, first = 0, n = 0;
+        ok = get_varint(s, end, &sec) && get_varint(s, end, &first) && get_varint(s, end, &n) &&
+             sec <= UINT32_MAX && first + n <= records;
+        s->rows[i] = (seat_row_t){(uint32_t)sec, (uint32_t)first, (uint32_t)n};
+    }
+    if (!ok)
+    {
+        tb_segment_close(s);
+        return false;
+    }
+    s->records = records;
+    s->seats = seats;
+    s->base_updated = unzigzag(base);
+    s->n_rows = n_rows;
+    s->body = s->pos;
+    return true;
+}
+
+bool tb_segment_next(tb_segment_t *s, seat_t *out, bool *present)
+{
+    size_t end = s->len - SEGMENT_TAIL;
+    if (s->next == s->records || s->pos >= end)
+        return false;
+    memset(out, 0, sizeof *out);
+    memcpy(out->event_id, s->event_id, TB_ID_LEN);
+    unsigned flags = s->data[s->pos++];
+    *present = flags & REC_PRESENT;
+    if (!*present)
+    {
+        s->next++;
+        return true;
+    }
+    out->status = (seat_status_t)(flags & REC_STATUS_MASK);
+    uint64_t shared, tail, v;
+    if (!get_varint(s, end, &shared) || !get_varint(s, end, &tail) ||
+        shared > strlen(s->prev_id) || shared + tail >= TB_ID_LEN || tail > end - s->pos)
+        return false;
+    memcpy(s->prev_id + shared, s->data + s->pos, tail);
+    s->prev_id[shared + tail] = '\0';
+    s->pos += tail;
+    memcpy(out->seat_id, s->prev_id, shared + tail + 1);
+    if (!get_varint(s, end, &v))
+        return false;
+    s->prev_price = (tb_money_cents_t)(s->prev_price + unzigzag(v));
+    out->price_cents = s->prev_price;
+    if ((flags & REC_ORDER) && !get_str(s, end, out->last_order_id, TB_ID_LEN))
+        return false;
+    out->updated_unix = s->base_updated;
+    if (flags & REC_UPDATED)
+    {
+        if (!get_varint(s, end, &v))
+            return false;
+        out->updated_unix += unzigzag(v);
+    }
+    if (flags & REC_HOLD)
+    {
+        if (!get_str(s, end, out->holder_user_id, TB_ID_LEN) || !get_varint(s, end, &v))
+            return false;
+        out->hold_expires_unix = unzigzag(v);
+        if (!get_varint(s, end, &v) || v > TB_TOKEN_LEN || v > end - s->pos)
+            return false;
+        memcpy(out->hold_token, s->data + s->pos, v);
+        out->hold_token_len = v;
+        s->pos += v;
+    }
+    s->next++;
+    return true;
+}
+
+void tb_segment_rewind(tb_segment_t *s)
+{
+    s->pos = s->body;
+    s->next = 0;
+    s->prev_price = 0;
+    s->prev_id[0] = '\0';
+}
+
+void tb_segment_close(tb_segment_t *s)
+{
+    free(s->data);
+    free(s->rows);
+    memset(s, 0, sizeof *s);
+}
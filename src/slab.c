@@ -0,0 +1,281 @@
+// Fixed-size object allocator (see slab.h).
+//
+// Each thread keeps, per registered slab, a private free list of at most
+// 2 * TB_SLAB_BATCH objects. An empty list refills a batch from the shared
+// list (or carves a fresh batch from a chunk); an overfull one hands a batch
+// back. Thread caches are indexed by registry slot and tagged with the
+// slab's serial, so a cache left behind by a destroyed slab is recognised
+// and dropped rather than flushed into freed memory.
+
+#include "slab.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SLAB_ALIGN 16u
+#define SLAB_DEFAULT_CHUNK_BYTES (256u * 1024u)
+
+struct tb_slab_chunk
+{
+    tb_slab_chunk_t *next;
+    size_t bytes;
+    _Alignas(SLAB_ALIGN) char objs[];
+};
+
+typedef struct
+{
+    uint64_t serial; // owner slab; stale if it no longer matches
+    void *head;
+    uint32_t n;
+} slab_tcache_t;
+
+static pthread_mutex_t g_reg_mtx = PTHREAD_MUTEX_INITIALIZER;
+static tb_slab_t *g_reg[TB_SLAB_MAX_CACHED];
+static uint64_t g_serial;
+
+static pthread_once_t g_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t g_key;
+static bool g_key_ok;
+static __thread slab_tcache_t *t_caches; // [TB_SLAB_MAX_CACHED]
+
+static inline void *next_of(void *obj)
+{
+    void *n;
+    memcpy(&n, obj, sizeof n);
+    return n;
+}
+
+static inline void set_next(void *obj, void *n)
+{
+    memcpy(obj, &n, sizeof n);
+}
+
+// ---- Shared list (caller holds s->mtx) ----
+
+static bool carve_chunk(tb_slab_t *s)
+{
+    size_t bytes = sizeof(tb_slab_chunk_t) + s->chunk_objs * s->obj_size;
+    tb_slab_chunk_t *c = malloc(bytes);
+    if (!c)
+        return false;
+    c->next = s->chunks;
+    c->bytes = bytes;
+    s->chunks = c;
+    s->carve = c->objs;
+    s->carve_end = c->objs + s->chunk_objs * s->obj_size;
+    s->reserved_bytes += bytes;
+    return true;
+}
+
+// Detach up to `want` objects as a list; returns its length.
+static uint32_t take_locked(tb_slab_t *s, uint32_t want, void **out)
+{
+    void *head = NULL;
+    uint32_t n = 0;
+    while (n < want && s->free_head)
+    {
+        void *o = s->free_head;
+        s->free_head = next_of(o);
+        set_next(o, head);
+        head = o;
+        n++;
+    }
+    while (n < want)
+    {
+        if (s->carve == s->carve_end && !carve_chunk(s))
+            break;
+        void *o = s->carve;
+        s->carve += s->obj_size;
+        set_next(o, head);
+        head = o;
+        n++;
+    }
+    *out = head;
+    return n;
+}
+
+static void give_locked(tb_slab_t *s, void *head, void *tail)
+{
+    set_next(tail, s->free_head);
+    s->free_head = head;
+}
+
+// ---- Thread caches ----
+
+static void tcache_exit(void *arg)
+{
+    slab_tcache_t *caches = arg;
+    pthread_mutex_lock(&g_reg_mtx);
+    for (uint32_t i = 0; i < TB_SLAB_MAX_CACHED; ++i)
+    {
+        slab_tcache_t *tc = &caches[i];
+        tb_slab_t *s = g_reg[i];
+        if (!tc->head || !s || s->serial != tc->serial)
+            continue;
+        void *tail = tc->head;
+        while (next_of(tail))
+            tail = next_of(tail);
+        pthread_mutex_lock(&s->mtx);
+        give_locked(s, tc->head, tail);
+        pthread_mutex_unlock(&s->mtx);
+    }
+    pthread_mutex_unlock(&g_reg_mtx);
+    free(caches);
+}
+
+static void key_init(void)
+{
+    g_key_ok = pthread_key_create(&g_key, tcache_exit) == 0;
+}
+
+// This thread's cache for `s`, or NULL if `s` is uncached.
+static slab_tcache_t *tcache_for(tb_slab_t *s)
+{
+    if (s->reg == 0)
+        return NULL;
+    if (!t_caches)
+    {
+        pthread_once(&g_key_once, key_init);
+        if (!g_key_ok)
+            return NULL;
+        t_caches = calloc(TB_SLAB_MAX_CACHED, sizeof(slab_tcache_t));
+        if (!t_caches)
+            return NULL;
+        pthread_setspecific(g_key, t_caches);
+    }
+    slab_tcache_t *tc = &t_caches[s->reg - 1];
+    if (tc->serial != s->serial)
+    {
+        // Left over from a destroyed slab: its memory is gone, just forget it.
+        tc->serial = s->serial;
+        tc->head = NULL;
+        tc->n = 0;
+    }
+    return tc;
+}
+
+// ---- Public API ----
+
+bool tb_slab_init(tb_slab_t *s, size_t obj_size, size_t objs_per_chunk)
+{
+    if (!s || obj_size == 0)
+        return false;
+    memset(s, 0, sizeof(*s));
+    if (obj_size < sizeof(void *))
+        obj_size = sizeof(void *);
+    s->obj_size = (obj_size + SLAB_ALIGN - 1) & ~(size_t)(SLAB_ALIGN - 1);
+    s->chunk_objs = objs_per_chunk ? objs_per_chunk : SLAB_DEFAULT_CHUNK_BYTES / s->obj_size;
+    if (s->chunk_objs < TB_SLAB_BATCH)
+        s->chunk_objs = TB_SLAB_BATCH;
+    if (pthread_mutex_init(&s->mtx, NULL) != 0)
+        return false;
+
+    pthread_mutex_lock(&g_reg_mtx);
+    s->serial = ++g_serial;
+    for (uint32_t i = 0; i < TB_SLAB_MAX_CACHED; ++i)
+    {
+        if (!g_reg[i])
+        {
+            g_reg[i] = s;
+            s->reg = i + 1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_reg_mtx);
+    return true;
+}
+
+void tb_slab_destroy(tb_slab_t *s)
+{
+    if (!s)
+        return;
+    pthread_mutex_lock(&g_reg_mtx);
+    if (s->reg)
+        g_reg[s->reg - 1] = NULL;
+    pthread_mutex_unlock(&g_reg_mtx);
+    if (s->reg && t_caches && t_caches[s->reg - 1].serial == s->serial)
+        memset(&t_caches[s->reg - 1], 0, sizeof(slab_tcache_t));
+
+    tb_slab_chunk_t *c = s->chunks;
+    while (c)
+    {
+        tb_slab_chunk_t *next = c->next;
+        free(c);
+        c = next;
+    }
+    pthread_mutex_destroy(&s->mtx);
+    memset(s, 0, sizeof(*s));
+}
+
+void *tb_slab_alloc(tb_slab_t *s)
+{
+    if (!s || s->obj_size == 0)
+        return NULL;
+    void *o = NULL;
+    slab_tcache_t *tc = tcache_for(s);
+    if (tc && tc->head)
+    {
+        o = tc->head;
+        tc->head = next_of(o);
+        tc->n--;
+    }
+    else
+    {
+        void *batch = NULL;
+        pthread_mutex_lock(&s->mtx);
+        uint32_t n = take_locked(s, tc ? TB_SLAB_BATCH : 1, &batch);
+        pthread_mutex_unlock(&s->mtx);
+        if (n == 0)
+            return NULL;
+        o = batch;
+        if (tc)
+        {
+            tc->head = next_of(o);
+            tc->n = n - 1;
+        }
+    }
+    memset(o, 0, s->obj_size);
+    return o;
+}
+
+void tb_slab_free(tb_slab_t *s, void *obj)
+{
+    if (!s || !obj)
+        return;
+    slab_tcache_t *tc = tcache_for(s);
+    if (!tc)
+    {
+        pthread_mutex_lock(&s->mtx);
+        give_locked(s, obj, obj);
+        pthread_mutex_unlock(&s->mtx);
+        return;
+    }
+    set_next(obj, tc->head);
+    tc->head = obj;
+    if (++tc->n < 2 * TB_SLAB_BATCH)
+        return;
+
+    // Hand the oldest batch back so other threads can reuse it.
+    void *keep_tail = tc->head;
+    for (uint32_t i = 1; i < TB_SLAB_BATCH; ++i)
+        keep_tail = next_of(keep_tail);
+    void *give = next_of(keep_tail);
+    set_next(keep_tail, NULL);
+    tc->n = TB_SLAB_BATCH;
+    void *give_tail = give;
+    while (next_of(give_tail))
+        give_tail = next_of(give_tail);
+    pthread_mutex_lock(&s->mtx);
+    give_locked(s, give, give_tail);
+    pthread_mutex_unlock(&s->mtx);
+}
+
+size_t tb_slab_reserved_bytes(tb_slab_t *s)
+{
+    if (!s)
+        return 0;
+    pthread_mutex_lock(&s->mtx);
+    size_t bytes = s->reserved_bytes;
+    pthread_mutex_unlock(&s->mtx);
+    return bytes;
+}
@@ -1,4 +1,5 @@
-// Portable implementations with RISC-V aware fast paths (no lock changes)
+// Portable implementations plus x86-64 (SSE4.1/AVX2) and RISC-V Vector
+// kernels, bound at runtime to the best variant the CPU supports.
 #include "utils.h"
 
 #include <string.h>
@@ -10,50 +11,401 @@
   #include <stdlib.h>
 #endif
 
-static inline uint64_t splitmix64(uint64_t x)
-{
-    x += 0x9e3779b97f4a7c15ULL;
-    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
-    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
-    return x ^ (x >> 31);
-}
+#ifndef CONFIG_TB_UTILS_SIMD
+#define CONFIG_TB_UTILS_SIMD 1
+#endif
 
-__attribute__((weak)) int tb_memcmp_token32(const void *a, const void *b, size_t n)
+#if CONFIG_TB_UTILS_SIMD && defined(__x86_64__) && defined(__GNUC__)
+#define TB_UTILS_X86 1
+#include <immintrin.h>
+#else
+#define TB_UTILS_X86 0
+#endif
+
+#if CONFIG_TB_UTILS_SIMD && defined(__riscv) && __riscv_xlen == 64 && defined(__linux__)
+#define TB_UTILS_RVV 1
+#include <sys/auxv.h>
+#else
+#define TB_UTILS_RVV 0
+#endif
+
+// ---- Token compare ----
+//
+// Every variant is constant-time in the contents: all n bytes are read and
+// differences are OR-folded, never branched on. Only n (public) picks the path.
+
+static int memcmp32_scalar(const void *a, const void *b, size_t n)
 {
-    if (n == 0) return 0;
     if (n > 32) n = 32; // cap
-
-#if defined(__riscv) && __riscv_xlen == 64
-    // 64-bit word-wise compare via memcpy to avoid alignment UB
     const unsigned char *ca = (const unsigned char *)a;
     const unsigned char *cb = (const unsigned char *)b;
-    while (n >= 8) {
-        uint64_t wa = 0, wb = 0;
+    uint64_t diff = 0;
+    for (; n >= 8; ca += 8, cb += 8, n -= 8)
+    {
+        uint64_t wa, wb; // memcpy avoids alignment UB
         memcpy(&wa, ca, 8);
         memcpy(&wb, cb, 8);
-        if ((wa ^ wb) != 0) return 1;
-        ca += 8; cb += 8; n -= 8;
+        diff |= wa ^ wb;
     }
-    while (n--) {
-        if (*ca++ != *cb++) return 1;
+    while (n--)
+        diff |= (uint64_t)(*ca++ ^ *cb++);
+    return diff != 0;
+}
+
+#if TB_UTILS_X86
+__attribute__((target("sse4.1"))) static int memcmp32_sse4(const void *a, const void *b, size_t n)
+{
+    if (n < 32)
+        return memcmp32_scalar(a, b, n);
+    __m128i x0 = _mm_xor_si128(_mm_loadu_si128((const __m128i *)a),
+                               _mm_loadu_si128((const __m128i *)b));
+    __m128i x1 = _mm_xor_si128(_mm_loadu_si128((const __m128i *)a + 1),
+                               _mm_loadu_si128((const __m128i *)b + 1));
+    return !_mm_testz_si128(_mm_or_si128(x0, x1), _mm_set1_epi8(-1));
+}
+
+__attribute__((target("avx2"))) static int memcmp32_avx2(const void *a, const void *b, size_t n)
+{
+    if (n < 32)
+        return memcmp32_scalar(a, b, n);
+    __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)a),
+                                 _mm256_loadu_si256((const __m256i *)b));
+    return !_mm256_testz_si256(x, x);
+}
+#endif
+
+// ---- Keyed word-at-a-time hash ----
+//
+// Input is consumed in 32-byte stripes of four 64-bit lanes. Each lane is
+// xored with a sliding window of the secret (perturbed by the seed) and
+// accumulated as lo32 * hi32 of the mixed word plus the raw neighbour lane,
+// so no input bits are lost before the final 128-bit multiply folds. Every
+// 8 stripes the accumulators are scrambled. All variants compute identical
+// values; they differ only in how a stripe is accumulated.
+
+#define HASH_STRIPE 32u
+#define HASH_BLOCK_STRIPES 8u
+
+static const uint64_t hash_secret[16] = {
+    0xbe4ba423396cfeb8ULL, 0x1cad21f72c81017cULL, 0xdb979083e96dd4deULL, 0x1f67b3b7a4a44072ULL,
+    0x78e5c0cc4ee679cbULL, 0x2172ffcc7dd05a82ULL, 0x8e2443f7744608b8ULL, 0x4c263a81e69035e0ULL,
+    0xcb00c391bb52283cULL, 0xa32e531b8b65d088ULL, 0x4ef90da297486471ULL, 0xd8acdea946ef1938ULL,
+    0x3f349ce33f76faa8ULL, 0x1d4f0bc7c7bbdcf9ULL, 0x3159b4cd4be0518aULL, 0x647378d9c97e9fc8ULL,
+};
+
+static inline uint64_t hash_fold128(uint64_t a, uint64_t b)
+{
+    __uint128_t p = (__uint128_t)a * b;
+    return (uint64_t)p ^ (uint64_t)(p >> 64);
+}
+
+static inline void hash_scramble(uint64_t acc[4], uint64_t seed)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        uint64_t a = acc[i];
+        a ^= a >> 47;
+        a ^= hash_secret[12 + i] ^ seed;
+        acc[i] = a * 0x9e3779b1u;
     }
-    return 0;
-#else
-    return memcmp(a, b, n);
+}
+
+// Accumulate `n` (<= HASH_BLOCK_STRIPES) stripes; stripe s uses secret[s..s+3].
+static inline void hash_accumulate_scalar(uint64_t acc[4], const unsigned char *p, size_t n, uint64_t seed)
+{
+    for (size_t s = 0; s < n; ++s, p += HASH_STRIPE)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            uint64_t d;
+            memcpy(&d, p + 8 * i, sizeof d);
+            uint64_t dk = d ^ hash_secret[s + i] ^ seed;
+            acc[i ^ 1] += d;
+            acc[i] += (dk & 0xffffffffu) * (dk >> 32);
+        }
+    }
+}
+
+#if TB_UTILS_X86
+__attribute__((target("sse2"))) static inline void
+hash_accumulate_sse2(uint64_t acc[4], const unsigned char *p, size_t n, uint64_t seed)
+{
+    __m128i a0 = _mm_loadu_si128((const __m128i *)&acc[0]);
+    __m128i a1 = _mm_loadu_si128((const __m128i *)&acc[2]);
+    const __m128i sd = _mm_set1_epi64x((long long)seed);
+    for (size_t s = 0; s < n; ++s, p += HASH_STRIPE)
+    {
+        __m128i d0 = _mm_loadu_si128((const __m128i *)p);
+        __m128i d1 = _mm_loadu_si128((const __m128i *)(p + 16));
+        __m128i k0 = _mm_xor_si128(_mm_loadu_si128((const __m128i *)&hash_secret[s]), sd);
+        __m128i k1 = _mm_xor_si128(_mm_loadu_si128((const __m128i *)&hash_secret[s + 2]), sd);
+        __m128i dk0 = _mm_xor_si128(d0, k0);
+        __m128i dk1 = _mm_xor_si128(d1, k1);
+        a0 = _mm_add_epi64(a0, _mm_add_epi64(_mm_mul_epu32(dk0, _mm_srli_epi64(dk0, 32)),
+                                             _mm_shuffle_epi32(d0, _MM_SHUFFLE(1, 0, 3, 2))));
+        a1 = _mm_add_epi64(a1, _mm_add_epi64(_mm_mul_epu32(dk1, _mm_srli_epi64(dk1, 32)),
+                                             _mm_shuffle_epi32(d1, _MM_SHUFFLE(1, 0, 3, 2))));
+    }
+    _mm_storeu_si128((__m128i *)&acc[0], a0);
+    _mm_storeu_si128((__m128i *)&acc[2], a1);
+}
+
+__attribute__((target("avx2"))) static inline void
+hash_accumulate_avx2(uint64_t acc[4], const unsigned char *p, size_t n, uint64_t seed)
+{
+    __m256i a = _mm256_loadu_si256((const __m256i *)acc);
+    const __m256i sd = _mm256_set1_epi64x((long long)seed);
+    for (size_t s = 0; s < n; ++s, p += HASH_STRIPE)
+    {
+        __m256i d = _mm256_loadu_si256((const __m256i *)p);
+        __m256i k = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)&hash_secret[s]), sd);
+        __m256i dk = _mm256_xor_si256(d, k);
+        __m256i prod = _mm256_mul_epu32(dk, _mm256_srli_epi64(dk, 32));
+        __m256i swap = _mm256_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+        a = _mm256_add_epi64(a, _mm256_add_epi64(prod, swap));
+    }
+    _mm256_storeu_si256((__m256i *)acc, a);
+}
+#endif
+
+#if TB_UTILS_RVV
+// src/riscv_inline.S
+int tb_memcmp_token32_rvv(const void *a, const void *b, size_t n);
+void tb_hash_accumulate_rvv(uint64_t acc[4], const unsigned char *p, size_t n,
+                            uint64_t seed, const uint64_t *secret);
+
+static inline void hash_accumulate_rvv(uint64_t acc[4], const unsigned char *p, size_t n, uint64_t seed)
+{
+    tb_hash_accumulate_rvv(acc, p, n, seed, hash_secret);
+}
+#endif
+
+// One copy of the driver per accumulate kernel, so each inlines its own.
+#define HASH_BYTES_IMPL(name, accumulate)                                       \
+    static uint64_t name(const void *data, size_t len, uint64_t seed)           \
+    {                                                                           \
+        const unsigned char *p = (const unsigned char *)data;                   \
+        uint64_t acc[4] = {                                                     \
+            0x00000000c2b2ae3dULL, 0x9e3779b185ebca87ULL,                       \
+            0xc2b2ae3d27d4eb4fULL, 0x165667b19e3779f9ULL,                       \
+        };                                                                      \
+        size_t stripes = len / HASH_STRIPE;                                     \
+        while (stripes >= HASH_BLOCK_STRIPES)                                   \
+        {                                                                       \
+            accumulate(acc, p, HASH_BLOCK_STRIPES, seed);                       \
+            hash_scramble(acc, seed);                                           \
+            p += HASH_BLOCK_STRIPES * HASH_STRIPE;                              \
+            stripes -= HASH_BLOCK_STRIPES;                                      \
+        }                                                                       \
+        if (stripes)                                                            \
+        {                                                                       \
+            accumulate(acc, p, stripes, seed);                                  \
+            p += stripes * HASH_STRIPE;                                         \
+        }                                                                       \
+        /* Tail (and every short key): one zero-padded stripe, scalar as */   \
+        /* vector setup costs more than it saves on one stripe. Length is */   \
+        /* folded in below, so padding cannot collide with real zeros.    */   \
+        size_t tail = len % HASH_STRIPE;                                        \
+        if (tail || len == 0)                                                   \
+        {                                                                       \
+            unsigned char last[HASH_STRIPE] = {0};                              \
+            memcpy(last, p, tail);                                              \
+            hash_accumulate_scalar(acc, last, 1, seed);                         \
+        }                                                                       \
+        uint64_t h = (uint64_t)len * 0x9e3779b97f4a7c15ULL ^ seed;              \
+        h += hash_fold128(acc[0] ^ hash_secret[8], acc[1] ^ hash_secret[9]);    \
+        h += hash_fold128(acc[2] ^ hash_secret[10], acc[3] ^ hash_secret[11]);  \
+        h ^= h >> 37;                                                           \
+        h *= 0x165667919e3779f9ULL;                                             \
+        return h ^ (h >> 32);                                                   \
+    }
+
+HASH_BYTES_IMPL(hash_bytes_scalar, hash_accumulate_scalar)
+#if TB_UTILS_X86
+__attribute__((target("sse2"))) HASH_BYTES_IMPL(hash_bytes_sse2, hash_accumulate_sse2)
+__attribute__((target("avx2"))) HASH_BYTES_IMPL(hash_bytes_avx2, hash_accumulate_avx2)
+#endif
+#if TB_UTILS_RVV
+HASH_BYTES_IMPL(hash_bytes_rvv, hash_accumulate_rvv)
+#endif
+
+// ---- Population count ----
+//
+// The x86 kernels count nibbles with a 16-entry table lookup (pshufb) and
+// sum the byte counts with psadbw, so they need no POPCNT instruction. The
+// scalar loop is what the compiler makes of __builtin_popcountll for the
+// target: a SWAR sequence on baseline x86-64, a single instruction elsewhere.
+
+static size_t popcount_scalar(const uint64_t *w, size_t n)
+{
+    size_t c = 0;
+    for (size_t i = 0; i < n; ++i)
+        c += (size_t)__builtin_popcountll(w[i]);
+    return c;
+}
+
+#if TB_UTILS_X86
+__attribute__((target("sse4.1"))) static size_t popcount_sse4(const uint64_t *w, size_t n)
+{
+    const __m128i lut = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m128i low = _mm_set1_epi8(0x0f);
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(w + i));
+        __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, low));
+        __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), low));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_add_epi8(lo, hi), _mm_setzero_si128()));
+    }
+    size_t c = (size_t)_mm_cvtsi128_si64(acc) + (size_t)_mm_extract_epi64(acc, 1);
+    return c + popcount_scalar(w + i, n - i);
+}
+
+__attribute__((target("avx2"))) static size_t popcount_avx2(const uint64_t *w, size_t n)
+{
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(w + i));
+        __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, low));
+        __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256()));
+    }
+    __m128i s = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    size_t c = (size_t)_mm_cvtsi128_si64(s) + (size_t)_mm_extract_epi64(s, 1);
+    return c + popcount_scalar(w + i, n - i);
+}
+#endif
+
+#if TB_UTILS_RVV
+// src/riscv_inline.S
+size_t tb_popcount_words_rvv(const uint64_t *w, size_t n);
 #endif
+
+// ---- Dispatch ----
+
+typedef struct
+{
+    const char *name;
+    int (*supported)(void);
+    int (*memcmp32)(const void *, const void *, size_t);
+    uint64_t (*hash_bytes)(const void *, size_t, uint64_t);
+    size_t (*popcount)(const uint64_t *, size_t);
+} utils_variant_t;
+
+static int cpu_any(void) { return 1; }
+
+#if TB_UTILS_X86
+static int cpu_sse4(void) { return __builtin_cpu_supports("sse4.1"); }
+static int cpu_avx2(void) { return __builtin_cpu_supports("avx2"); }
+#endif
+
+#if TB_UTILS_RVV
+// 'V' bit of the single-letter ISA extensions in AT_HWCAP.
+static int cpu_rvv(void) { return (getauxval(AT_HWCAP) >> ('V' - 'A')) & 1; }
+#endif
+
+// In order of preference, least first.
+static const utils_variant_t g_variants[] = {
+    {"scalar", cpu_any, memcmp32_scalar, hash_bytes_scalar, popcount_scalar},
+#if TB_UTILS_X86
+    {"sse4", cpu_sse4, memcmp32_sse4, hash_bytes_sse2, popcount_sse4},
+    {"avx2", cpu_avx2, memcmp32_avx2, hash_bytes_avx2, popcount_avx2},
+#endif
+#if TB_UTILS_RVV
+    {"rvv", cpu_rvv, tb_memcmp_token32_rvv, hash_bytes_rvv, tb_popcount_words_rvv},
+#endif
+};
+
+#define N_VARIANTS (sizeof g_variants / sizeof g_variants[0])
+
+static const utils_variant_t *g_active; // NULL until first use
+
+static const utils_variant_t *active_variant(void)
+{
+    const utils_variant_t *v = __atomic_load_n(&g_active, __ATOMIC_ACQUIRE);
+    if (v)
+        return v;
+    v = &g_variants[0];
+    for (size_t i = N_VARIANTS; i-- > 1;)
+    {
+        if (g_variants[i].supported())
+        {
+            v = &g_variants[i];
+            break;
+        }
+    }
+    // Racing first callers all compute the same answer.
+    const utils_variant_t *expected = NULL;
+    if (!__atomic_compare_exchange_n(&g_active, &expected, v, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        v = expected;
+    return v;
+}
+
+const char *tb_utils_variant(void)
+{
+    return active_variant()->name;
+}
+
+const char *tb_utils_variant_name(size_t i)
+{
+    return i < N_VARIANTS ? g_variants[i].name : NULL;
+}
+
+bool tb_utils_select(const char *name)
+{
+    for (size_t i = 0; name && i < N_VARIANTS; ++i)
+    {
+        if (strcmp(g_variants[i].name, name) == 0)
+        {
+            if (!g_variants[i].supported())
+                return false;
+            __atomic_store_n(&g_active, &g_variants[i], __ATOMIC_RELEASE);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ---- Public entry points ----
+//
+// Weak so a platform file can still replace an entry point outright.
+
+__attribute__((weak)) int tb_memcmp_token32(const void *a, const void *b, size_t n)
+{
+    if (n == 0) return 0;
+    return active_variant()->memcmp32(a, b, n);
+}
+
+uint64_t tb_hash_bytes(const void *data, size_t len, uint64_t seed)
+{
+    return active_variant()->hash_bytes(data, len, seed);
 }
 
 __attribute__((weak)) uint64_t tb_hash_key_fast(const char *event_id, const char *seat_id)
 {
-    // Cheap but solid: hash the two strings with splitmix64 over bytes
-    uint64_t h1 = 0x1234567890abcdefULL;
-    for (const unsigned char *p = (const unsigned char *)event_id; p && *p; ++p)
-        h1 = splitmix64(h1 ^ *p);
-    uint64_t h2 = 0x0fedcba987654321ULL;
-    for (const unsigned char *p = (const unsigned char *)seat_id; p && *p; ++p)
-        h2 = splitmix64(h2 ^ *p);
-    uint64_t h = h1 ^ (h2 + 0x9e3779b97f4a7c15ULL + (h1<<6) + (h1>>2));
-    return h;
+    event_id = event_id ? event_id : "";
+    seat_id = seat_id ? seat_id : "";
+    const utils_variant_t *v = active_variant();
+    uint64_t h = v->hash_bytes(event_id, strlen(event_id), 0x1234567890abcdefULL);
+    return v->hash_bytes(seat_id, strlen(seat_id), h);
+}
+
+__attribute__((weak)) uint64_t tb_hash_name_fast(const char *name)
+{
+    name = name ? name : "";
+    return active_variant()->hash_bytes(name, strlen(name), 0);
+}
+
+size_t tb_popcount_words(const uint64_t *words, size_t n)
+{
+    return n ? active_variant()->popcount(words, n) : 0;
 }
 
 void tb_random_bytes_fast(unsigned char *out, size_t n)
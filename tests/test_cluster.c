@@ -0,0 +1,211 @@
+// Unit tests for the cluster: ring balance and movement, routing to forked
+// nodes, and moving events live while calls run
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "cluster.h"
+#include "orderid.h"
+
+static void test_ring(void)
+{
+    enum { KEYS = 20000 };
+    static uint32_t before[KEYS];
+    char id[TB_ID_LEN];
+    tb_ring_t *ring = tb_ring_create();
+    assert(tb_ring_owner(ring, "E1") == TB_NODE_NONE);
+    for (uint32_t n = 0; n < 4; ++n)
+        assert(tb_ring_add(ring, n));
+    assert(!tb_ring_add(ring, 2) && tb_ring_nodes(ring) == 4);
+
+    // Each node gets a fair share.
+    size_t share[5] = {0};
+    for (uint32_t k = 0; k < KEYS; ++k)
+    {
+        snprintf(id, sizeof id, "EV%u", k);
+        before[k] = tb_ring_owner(ring, id);
+        assert(before[k] < 4);
+        share[before[k]]++;
+    }
+    for (int n = 0; n < 4; ++n)
+        assert(share[n] > KEYS / 4 * 7 / 10 && share[n] < KEYS / 4 * 13 / 10);
+
+    // A fifth node takes about a fifth, and only for itself.
+    assert(tb_ring_add(ring, 4));
+    size_t moved = 0;
+    for (uint32_t k = 0; k < KEYS; ++k)
+    {
+        snprintf(id, sizeof id, "EV%u", k);
+        uint32_t o = tb_ring_owner(ring, id);
+        assert(o == before[k] || o == 4);
+        moved += o != before[k];
+    }
+    assert(moved > KEYS / 5 * 7 / 10 && moved < KEYS / 5 * 13 / 10);
+
+    // Taking it off again puts everything back.
+    assert(tb_ring_remove(ring, 4) && !tb_ring_remove(ring, 4));
+    for (uint32_t k = 0; k < KEYS; ++k)
+    {
+        snprintf(id, sizeof id, "EV%u", k);
+        assert(tb_ring_owner(ring, id) == before[k]);
+    }
+    tb_ring_destroy(ring);
+    printf("[OK] cluster ring balance and movement\n");
+}
+
+#define NODES  3
+#define EVENTS 24
+#define SEATS  8
+
+static char g_paths[NODES][64];
+static tb_router_t *g_router;
+static volatile int g_stop;
+
+static void make_event(int e, seat_t *seats)
+{
+    memset(seats, 0, SEATS * sizeof *seats);
+    for (int s = 0; s < SEATS; ++s)
+    {
+        snprintf(seats[s].event_id, TB_ID_LEN, "CE%d", e);
+        snprintf(seats[s].seat_id, TB_ID_LEN, "S%d", s);
+        seats[s].price_cents = 1000 + e;
+    }
+}
+
+// Reads every event in turn while nodes join and leave; none may fail.
+static void *reader(void *arg)
+{
+    size_t fails = 0;
+    char ev[TB_ID_LEN];
+    seat_view_t v;
+    for (int i = 0; !__atomic_load_n(&g_stop, __ATOMIC_ACQUIRE); ++i)
+    {
+        snprintf(ev, sizeof ev, "CE%d", i % EVENTS);
+        if (!tb_router_seat_get(g_router, ev, "S7", &v) || v.price_cents != 1000 + i % EVENTS)
+            fails++;
+    }
+    *(size_t *)arg = fails;
+    return NULL;
+}
+
+static void test_routing_and_moves(void)
+{
+    pid_t pids[NODES];
+    for (int n = 0; n < NODES; ++n)
+    {
+        snprintf(g_paths[n], sizeof g_paths[n], "/tmp/tb_test_cluster_%d_%d.sock", (int)getpid(), n);
+        pids[n] = tb_node_spawn(g_paths[n], (uint32_t)n);
+        assert(pids[n] > 0);
+    }
+    g_router = tb_router_create();
+    assert(tb_router_add_node(g_router, 0, g_paths[0]));
+    assert(tb_router_add_node(g_router, 1, g_paths[1]));
+    assert(!tb_router_add_node(g_router, 1, g_paths[1]));
+
+    seat_t seats[SEATS];
+    for (int e = 0; e < EVENTS; ++e)
+    {
+        make_event(e, seats);
+        assert(tb_router_load_event(g_router, seats[0].event_id, seats, SEATS));
+    }
+
+    // Per event: S0 held by U<e>, S1 sold to B<e>.
+    hold_result_t holds[EVENTS], sold[EVENTS];
+    char orders[EVENTS][TB_ID_LEN], late[EVENTS][TB_ID_LEN];
+    char ev[TB_ID_LEN], user[TB_ID_LEN];
+    for (int e = 0; e < EVENTS; ++e)
+    {
+        snprintf(ev, sizeof ev, "CE%d", e);
+        snprintf(user, sizeof user, "U%d", e);
+        holds[e] = tb_router_place_hold(g_router, user, ev, "S0");
+        assert(holds[e].code == RES_OK);
+        snprintf(user, sizeof user, "B%d", e);
+        hold_result_t h = sold[e] = tb_router_place_hold(g_router, user, ev, "S1");
+        assert(h.code == RES_OK);
+        confirm_result_t c = tb_router_confirm(g_router, ev, h.hold_token, h.token_len, h.price_cents);
+        assert(c.code == RES_OK);
+        strcpy(orders[e], c.order_id);
+    }
+
+    // A third node joins, then the first leaves, while a reader runs.
+    size_t fails = 0;
+    pthread_t th;
+    __atomic_store_n(&g_stop, 0, __ATOMIC_RELEASE);
+    pthread_create(&th, NULL, reader, &fails);
+    assert(tb_router_add_node(g_router, 2, g_paths[2]));
+    size_t moved = tb_router_moves(g_router);
+    assert(moved > 0 && moved < EVENTS);
+    assert(tb_router_remove_node(g_router, 0));
+    assert(!tb_router_remove_node(g_router, 0));
+    __atomic_store_n(&g_stop, 1, __ATOMIC_RELEASE);
+    pthread_join(th, NULL);
+    assert(fails == 0);
+    assert(tb_router_moves(g_router) > moved);
+
+    // Holds and sales moved with their events.
+    seat_view_t v;
+    for (int e = 0; e < EVENTS; ++e)
+    {
+        snprintf(ev, sizeof ev, "CE%d", e);
+        uint32_t owner = tb_router_owner(g_router, ev);
+        assert(owner == 1 || owner == 2);
+        snprintf(user, sizeof user, "U%d", e);
+        assert(tb_router_seat_get(g_router, ev, "S0", &v) && v.status == SEAT_HELD);
+        assert(strcmp(v.holder_user_id, user) == 0);
+        assert(tb_router_seat_get(g_router, ev, "S1", &v) && v.status == SEAT_SOLD);
+        assert(tb_router_place_hold(g_router, "X", ev, "S0").code == RES_HELD_BY_OTHER);
+        confirm_result_t c = tb_router_confirm(g_router, ev, holds[e].hold_token,
+                                               holds[e].token_len, holds[e].price_cents);
+        assert(c.code == RES_OK && strcmp(c.order_id, orders[e]) != 0);
+        strcpy(late[e], c.order_id);
+        assert(tb_router_seat_get(g_router, ev, "S0", &v) && v.status == SEAT_SOLD);
+    }
+
+    // Orders moved with their events: a confirm retry finds the order made
+    // before the move, and it refunds on the new owner.
+    for (int e = 0; e < EVENTS; ++e)
+    {
+        snprintf(ev, sizeof ev, "CE%d", e);
+        snprintf(user, sizeof user, "B%d", e);
+        confirm_result_t c = tb_router_confirm(g_router, ev, sold[e].hold_token, sold[e].token_len,
+                                               sold[e].price_cents);
+        assert(c.code == RES_OK && strcmp(c.order_id, orders[e]) == 0);
+        assert(tb_router_refund(g_router, user, ev, orders[e]) == RES_OK);
+        assert(tb_router_seat_get(g_router, ev, "S1", &v) && v.status == SEAT_AVAILABLE);
+        assert(tb_router_refund(g_router, user, ev, orders[e]) == RES_NOT_FOUND);
+    }
+
+    // The last node with events stays; an unknown node is refused.
+    assert(tb_router_remove_node(g_router, 1));
+    assert(!tb_router_remove_node(g_router, 2));
+    assert(!tb_router_add_node(g_router, TB_ORDERID_MAX_NODE + 1, g_paths[0]));
+    assert(tb_router_owner(g_router, "CE0") == 2);
+    assert(tb_router_seat_get(g_router, "CE0", "S7", &v) && v.price_cents == 1000);
+    for (int e = 0; e < EVENTS; ++e)
+    {
+        snprintf(ev, sizeof ev, "CE%d", e);
+        snprintf(user, sizeof user, "U%d", e);
+        assert(tb_router_refund(g_router, user, ev, late[e]) == RES_OK);
+        assert(tb_router_seat_get(g_router, ev, "S0", &v) && v.status == SEAT_AVAILABLE);
+    }
+
+    tb_router_destroy(g_router);
+    for (int n = 0; n < NODES; ++n)
+    {
+        int status;
+        assert(tb_node_stop(g_paths[n]));
+        assert(waitpid(pids[n], &status, 0) == pids[n] && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+    printf("[OK] cluster routing and live moves\n");
+}
+
+int main(void)
+{
+    test_ring();
+    test_routing_and_moves();
+    printf("All cluster tests passed.\n");
+    return 0;
+}
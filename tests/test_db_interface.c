@@ -4,6 +4,7 @@
 #include <string.h>
 
 #include "db_interface.h"
+#include "orderid.h"
 
 int main(void)
 {
@@ -17,7 +18,8 @@ int main(void)
     char order_id[RES_ID_LEN] = {0};
     db_txn_t *t2 = db_txn_begin();
     assert(db_order_create(t2, "U1", "E1", "A1", 1234, tok, 4, order_id) == RES_OK);
-    assert(strlen(order_id) > 0);
+    uint64_t oid;
+    assert(tb_orderid_parse(order_id, &oid));
     assert(db_seat_mark_sold(t2, "E1", "A1", order_id) == RES_OK);
     assert(db_txn_commit(t2));
 
@@ -38,9 +40,91 @@ int main(void)
 
     // Refund
     db_txn_t *t3 = db_txn_begin();
+    assert(db_refund_create(t3, "U2", order_id, 1234) == RES_NOT_FOUND); // not the buyer
     assert(db_refund_create(t3, "U1", order_id, 1234) == RES_OK);
     assert(db_txn_commit(t3));
 
+    // A refunded order is gone; refunding it again finds nothing
+    assert(db_order_find_by_id(order_id, user, ev, seat, &price) == RES_NOT_FOUND);
+    assert(db_order_find_by_token(tok, 4, found_id, &price) == RES_NOT_FOUND);
+    db_txn_t *t4 = db_txn_begin();
+    assert(db_refund_create(t4, "U1", order_id, 1234) == RES_NOT_FOUND);
+    db_txn_rollback(t4);
+
+    // Many orders: both indexes grow and every row stays reachable
+    enum { MANY = 5000 };
+    static char ids[MANY][RES_ID_LEN];
+    for (uint32_t i = 0; i < MANY; ++i)
+    {
+        tb_byte_t t[8];
+        memcpy(t, &i, sizeof i);
+        memcpy(t + 4, "tok", 4);
+        char sid[RES_ID_LEN];
+        snprintf(sid, sizeof sid, "S%u", i);
+        assert(db_order_create(NULL, "U9", "E9", sid, (tb_money_cents_t)i, t, sizeof t, ids[i]) == RES_OK);
+        assert(i == 0 || strcmp(ids[i], ids[i - 1]) > 0); // ids sort in issue order
+    }
+    for (uint32_t i = 0; i < MANY; i += 7)
+    {
+        tb_byte_t t[8];
+        memcpy(t, &i, sizeof i);
+        memcpy(t + 4, "tok", 4);
+        assert(db_order_find_by_token(t, sizeof t, found_id, &price) == RES_OK);
+        assert(strcmp(found_id, ids[i]) == 0 && price == (tb_money_cents_t)i);
+        assert(db_order_find_by_id(ids[i], user, ev, seat, &price) == RES_OK);
+        assert(db_refund_create(NULL, "U9", ids[i], price) == RES_OK);
+    }
+    assert(db_order_find_by_id(ids[7], user, ev, seat, &price) == RES_NOT_FOUND);
+    assert(db_order_find_by_id(ids[8], user, ev, seat, &price) == RES_OK);
+
+    // Per-event batches: the orders of E9 left after the refunds above, in
+    // disjoint batches, each once; other events keep theirs
+    size_t left = MANY - (MANY + 6) / 7;
+    assert(db_order_count_by_event("E9") == left);
+    assert(db_order_count_by_event("E1") == 0 && db_order_count_by_event("NOPE") == 0);
+    assert(db_order_create(NULL, "U8", "E8", "A1", 5, tok, 4, order_id) == RES_OK);
+    static db_refund_row_t rows[1000];
+    static bool seen[MANY];
+    size_t n, total = 0;
+    do
+    {
+        db_txn_t *t5 = db_txn_begin();
+        assert(db_refund_event_batch(t5, "E9", 1000, rows, &n) == RES_OK && n <= 1000);
+        assert(db_txn_commit(t5));
+        for (size_t i = 0; i < n; ++i)
+        {
+            unsigned k = (unsigned)rows[i].price_cents;
+            assert(k < MANY && k % 7 != 0 && !seen[k] && strcmp(rows[i].order_id, ids[k]) == 0);
+            assert(strcmp(rows[i].user_id, "U9") == 0);
+            seen[k] = true;
+        }
+        total += n;
+        assert(db_order_count_by_event("E9") == left - total);
+    } while (n > 0);
+    assert(total == left);
+    assert(db_order_find_by_id(ids[8], user, ev, seat, &price) == RES_NOT_FOUND);
+    assert(db_refund_create(NULL, "U9", ids[8], 8) == RES_NOT_FOUND);
+    assert(db_order_count_by_event("E8") == 1);
+    assert(db_refund_event_batch(NULL, "NOPE", 10, rows, &n) == RES_OK && n == 0);
+
+    // Moving an event's orders: export, drop, import back under the same
+    // ids; a second import skips what is already there
+    order_record_t moved[4];
+    assert(db_order_export_event("E8", NULL, 0) == 1);
+    assert(db_order_export_event("E8", moved, 4) == 1);
+    assert(strcmp(moved[0].order_id, order_id) == 0 && strcmp(moved[0].seat_id, "A1") == 0);
+    assert(moved[0].price_cents == 5 && moved[0].token_len == 4);
+    assert(db_order_drop_event("E8") == 1 && db_order_count_by_event("E8") == 0);
+    assert(db_order_find_by_token(tok, 4, found_id, &price) == RES_NOT_FOUND);
+    assert(db_order_import(NULL, "E8", moved, 1) == RES_OK);
+    assert(db_order_import(NULL, "E8", moved, 1) == RES_OK);
+    assert(db_order_count_by_event("E8") == 1);
+    assert(db_order_find_by_token(tok, 4, found_id, &price) == RES_OK && strcmp(found_id, order_id) == 0);
+    assert(db_order_find_by_id(order_id, user, ev, seat, &price) == RES_OK);
+    assert(strcmp(user, "U8") == 0 && strcmp(ev, "E8") == 0 && strcmp(seat, "A1") == 0);
+    assert(db_refund_create(NULL, "U8", order_id, 5) == RES_OK);
+    assert(db_order_export_event("E8", moved, 4) == 0 && db_order_drop_event("NOPE") == 0);
+
     printf("All DB interface tests passed.\n");
     return 0;
 }
@@ -0,0 +1,179 @@
+// Unit tests for the seat change feed: ordering, coalescing, lapping
+#include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "feed.h"
+
+static void test_publish_poll(void)
+{
+    tb_feed_t *f = tb_feed_create(100);
+    tb_feed_sub_t *early = tb_feed_subscribe(f);
+    assert(tb_feed_publish(f, 1, 10, TB_CHANGE_HELD) == 0);
+    tb_feed_sub_t *late = tb_feed_subscribe(f); // sees only what follows
+    assert(tb_feed_publish(f, 1, 11, TB_CHANGE_HELD) == 1);
+    assert(tb_feed_publish(f, 2, 10, TB_CHANGE_SOLD) == 2);
+    assert(tb_feed_head(f) == 3);
+
+    tb_change_t out[8];
+    bool lost = true;
+    assert(tb_feed_poll(early, out, 8, &lost) == 3 && !lost);
+    assert(out[0].seq == 0 && out[0].event_ix == 1 && out[0].seat_ix == 10);
+    assert(out[2].event_ix == 2 && out[2].kind == TB_CHANGE_SOLD);
+    assert(tb_feed_poll(early, out, 8, &lost) == 0 && !lost);
+    assert(tb_feed_poll(late, out, 8, NULL) == 2 && out[0].seq == 1);
+    assert(tb_feed_poll(late, out, 0, NULL) == 0);
+    tb_feed_unsubscribe(early);
+    tb_feed_unsubscribe(late);
+    tb_feed_destroy(f);
+    printf("[OK] feed publish/poll\n");
+}
+
+static void test_coalescing(void)
+{
+    tb_feed_t *f = tb_feed_create(64);
+    tb_feed_sub_t *s = tb_feed_subscribe(f);
+    // Seat 1 is held, released and held again; seat 2 sold; seat 3 held.
+    tb_feed_publish(f, 7, 1, TB_CHANGE_HELD);
+    tb_feed_publish(f, 7, 2, TB_CHANGE_HELD);
+    tb_feed_publish(f, 7, 1, TB_CHANGE_RELEASED);
+    tb_feed_publish(f, 7, 2, TB_CHANGE_SOLD);
+    tb_feed_publish(f, 7, 1, TB_CHANGE_HELD);
+    tb_feed_publish(f, 7, 3, TB_CHANGE_HELD);
+    tb_feed_publish(f, 8, 1, TB_CHANGE_HELD); // another event's seat 1
+
+    // Two seats per poll: the third seat's change waits for the next one.
+    tb_change_t out[4];
+    assert(tb_feed_poll(s, out, 2, NULL) == 2);
+    assert(out[0].seat_ix == 1 && out[0].kind == TB_CHANGE_HELD && out[0].seq == 4);
+    assert(out[1].seat_ix == 2 && out[1].kind == TB_CHANGE_SOLD && out[1].seq == 3);
+    assert(tb_feed_poll(s, out, 4, NULL) == 2);
+    assert(out[0].seat_ix == 3 && out[1].event_ix == 8 && out[1].seat_ix == 1);
+    tb_feed_unsubscribe(s);
+    tb_feed_destroy(f);
+    printf("[OK] feed coalesces per seat\n");
+}
+
+static void test_lapped_subscriber(void)
+{
+    tb_feed_t *f = tb_feed_create(64);
+    tb_feed_sub_t *slow = tb_feed_subscribe(f);
+    tb_feed_sub_t *fast = tb_feed_subscribe(f);
+    tb_change_t out[64];
+    size_t seen = 0;
+    for (uint32_t i = 0; i < 200; ++i)
+    {
+        tb_feed_publish(f, 1, i, TB_CHANGE_HELD);
+        if (i % 16 == 15)
+            seen += tb_feed_poll(fast, out, 64, NULL);
+    }
+    assert(seen == 192 && tb_feed_poll(fast, out, 64, NULL) == 8);
+
+    bool lost = false;
+    tb_feed_poll(slow, out, 64, &lost);
+    assert(lost);
+    assert(tb_feed_poll(slow, out, 64, &lost) == 0 && !lost); // resynced to the head
+    tb_feed_publish(f, 1, 500, TB_CHANGE_SOLD);
+    assert(tb_feed_poll(slow, out, 64, &lost) == 1 && !lost && out[0].seq == 200);
+    tb_feed_unsubscribe(slow);
+    tb_feed_unsubscribe(fast);
+    tb_feed_destroy(f);
+    printf("[OK] feed reports lapped subscribers\n");
+}
+
+// Publishers each walk their own seats through held/released/sold while
+// subscribers poll; a subscriber that was never lapped must end with every
+// seat's last change.
+#define FEED_PUBLISHERS 4
+#define FEED_SEATS      64
+#define FEED_ROUNDS     2000
+
+static tb_feed_t *g_feed;
+static int g_publishing;
+
+static void *publisher_fn(void *arg)
+{
+    uint32_t p = (uint32_t)(uintptr_t)arg;
+    for (int r = 0; r < FEED_ROUNDS; ++r)
+        for (uint32_t i = 0; i < FEED_SEATS; ++i)
+            tb_feed_publish(g_feed, p + 1, i, (tb_change_kind_t)((r + i) % 3));
+    __atomic_sub_fetch(&g_publishing, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+typedef struct
+{
+    tb_feed_sub_t *sub;
+    uint64_t last_seq[FEED_PUBLISHERS][FEED_SEATS];
+    tb_change_kind_t kind[FEED_PUBLISHERS][FEED_SEATS];
+    bool lost;
+} subscriber_t;
+
+static size_t drain(subscriber_t *s)
+{
+    tb_change_t out[32];
+    bool lost;
+    size_t n = tb_feed_poll(s->sub, out, 32, &lost);
+    s->lost |= lost;
+    for (size_t k = 0; k < n; ++k)
+    {
+        uint32_t p = out[k].event_ix - 1, i = out[k].seat_ix;
+        assert(p < FEED_PUBLISHERS && i < FEED_SEATS);
+        assert(out[k].seq + 1 > s->last_seq[p][i]); // never goes back
+        s->last_seq[p][i] = out[k].seq + 1;
+        s->kind[p][i] = out[k].kind;
+    }
+    return n;
+}
+
+static void *subscriber_fn(void *arg)
+{
+    subscriber_t *s = (subscriber_t *)arg;
+    while (__atomic_load_n(&g_publishing, __ATOMIC_ACQUIRE) > 0)
+        drain(s);
+    while (drain(s) > 0)
+        ;
+    return NULL;
+}
+
+static void test_concurrent(void)
+{
+    g_feed = tb_feed_create(FEED_PUBLISHERS * FEED_SEATS * FEED_ROUNDS);
+    g_publishing = FEED_PUBLISHERS;
+    static subscriber_t subs[2];
+    pthread_t pt[FEED_PUBLISHERS], st[2];
+    for (int k = 0; k < 2; ++k)
+    {
+        memset(&subs[k], 0, sizeof subs[k]);
+        subs[k].sub = tb_feed_subscribe(g_feed);
+        pthread_create(&st[k], NULL, subscriber_fn, &subs[k]);
+    }
+    for (uintptr_t p = 0; p < FEED_PUBLISHERS; ++p)
+        pthread_create(&pt[p], NULL, publisher_fn, (void *)p);
+    for (int p = 0; p < FEED_PUBLISHERS; ++p)
+        pthread_join(pt[p], NULL);
+    for (int k = 0; k < 2; ++k)
+    {
+        pthread_join(st[k], NULL);
+        assert(!subs[k].lost); // the ring holds every change
+        for (uint32_t p = 0; p < FEED_PUBLISHERS; ++p)
+            for (uint32_t i = 0; i < FEED_SEATS; ++i)
+                assert(subs[k].kind[p][i] == (tb_change_kind_t)((FEED_ROUNDS - 1 + i) % 3));
+        tb_feed_unsubscribe(subs[k].sub);
+    }
+    assert(tb_feed_head(g_feed) == (uint64_t)FEED_PUBLISHERS * FEED_SEATS * FEED_ROUNDS);
+    tb_feed_destroy(g_feed);
+    printf("[OK] feed under concurrent publishers and subscribers\n");
+}
+
+int main(void)
+{
+    test_publish_poll();
+    test_coalescing();
+    test_lapped_subscriber();
+    test_concurrent();
+    printf("All feed tests passed.\n");
+    return 0;
+}
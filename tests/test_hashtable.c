@@ -4,6 +4,7 @@
 #include <string.h>
 #include <pthread.h>
 
+#include "ebr.h"
 #include "hashtable.h"
 #include "types.h"
 
@@ -150,6 +151,42 @@ static void test_delete(void)
     printf("[OK] delete\n");
 }
 
+static void test_delete_recycles_records(void)
+{
+    seat_map_t *m = seat_map_create(4); // long chains on purpose
+    for (int i = 0; i < 32; ++i)
+    {
+        char sid[TB_ID_LEN];
+        snprintf(sid, sizeof sid, "S%d", i);
+        seat_t s = mkseat("E1", sid, 100 + i);
+        assert(seat_map_put(m, &s));
+    }
+    assert(seat_map_size(m) == 32);
+    size_t mem = seat_map_memory_bytes(m);
+
+    assert(seat_map_delete(m, "E1", "S7"));
+    assert(!seat_map_delete(m, "E1", "S7"));
+    assert(seat_map_find(m, "E1", "S7") == 0);
+    seat_t n = mkseat("E1", "N1", 4242);
+    assert(seat_map_put(m, &n));
+    assert(seat_map_size(m) == 32);
+    assert(seat_map_memory_bytes(m) == mem); // slot reused, nothing grew
+
+    seat_t out = {0};
+    assert(seat_map_get(m, "E1", "N1", &out) && out.price_cents == 4242);
+    assert(strcmp(out.event_id, "E1") == 0 && strcmp(out.seat_id, "N1") == 0);
+    for (int i = 0; i < 32; ++i)
+    {
+        char sid[TB_ID_LEN];
+        snprintf(sid, sizeof sid, "S%d", i);
+        assert(seat_map_get(m, "E1", sid, &out) == (i != 7));
+        assert(i == 7 || out.price_cents == 100 + i);
+    }
+
+    seat_map_destroy(m);
+    printf("[OK] delete recycles records\n");
+}
+
 static void test_find_by_token(void)
 {
     seat_map_t *m = seat_map_create(64);
@@ -170,10 +207,831 @@ static void test_find_by_token(void)
     tok[0] = 0xFF;
     assert(!seat_map_find_by_token(m, tok, 8, &out));
 
+    // many holds: each found through its chain, released ones no longer
+    char sid[TB_ID_LEN];
+    for (uint32_t i = 0; i < 3000; ++i)
+    {
+        snprintf(sid, sizeof sid, "T%u", (unsigned)i);
+        seat_t h = mkseat("E1", sid, (int)i);
+        h.status = SEAT_HELD;
+        h.hold_token_len = sizeof i;
+        memcpy(h.hold_token, &i, sizeof i);
+        assert(seat_map_put(m, &h));
+    }
+    for (uint32_t i = 0; i < 3000; i += 2)
+    {
+        snprintf(sid, sizeof sid, "T%u", (unsigned)i);
+        seat_t a = mkseat("E1", sid, (int)i);
+        assert(seat_map_put(m, &a));
+    }
+    for (uint32_t i = 0; i < 3000; ++i)
+    {
+        bool held = seat_map_find_by_token(m, (const tb_byte_t *)&i, sizeof i, &out);
+        assert(held == (i % 2 == 1));
+        assert(!held || out.price_cents == (int)i);
+    }
+
     seat_map_destroy(m);
     printf("[OK] find_by_token\n");
 }
 
+typedef struct
+{
+    seat_map_t *m;
+    int loops;
+    volatile int done;
+} seqlock_arg;
+
+static void *seqlock_writer(void *p)
+{
+    seqlock_arg *a = (seqlock_arg *)p;
+    seat_t s = mkseat("E1", "A1", 0);
+    for (int i = 1; i <= a->loops; ++i)
+    {
+        // price, expiry and order id always move together
+        s.price_cents = i;
+        s.hold_expires_unix = i;
+        snprintf(s.last_order_id, sizeof s.last_order_id, "ORD-%d", i);
+        assert(seat_map_lock(a->m, "E1", "A1"));
+        assert(seat_map_put(a->m, &s));
+        seat_map_unlock(a->m, "E1", "A1");
+    }
+    __atomic_store_n(&a->done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void *seqlock_reader(void *p)
+{
+    seqlock_arg *a = (seqlock_arg *)p;
+    uint32_t last_version = 0;
+    while (!__atomic_load_n(&a->done, __ATOMIC_ACQUIRE))
+    {
+        seat_t out = {0};
+        char expect[TB_ID_LEN];
+        assert(seat_map_get(a->m, "E1", "A1", &out));
+        assert((out.version & 1u) == 0);
+        assert(out.version >= last_version);
+        last_version = out.version;
+        assert(out.hold_expires_unix == out.price_cents);
+        snprintf(expect, sizeof expect, "ORD-%d", out.price_cents);
+        assert(out.price_cents == 0 || strcmp(out.last_order_id, expect) == 0);
+    }
+    return NULL;
+}
+
+// A caller that loaded a HELD word and stalled before its CAS must not be
+// able to take a later hold that happens to rebuild the same word: far more
+// hold/cancel cycles than the generation bits count, all in one second.
+static void test_hold_slot_reuse_waits_for_readers(void)
+{
+    seat_map_t *m = seat_map_create(16);
+    seat_t a = mkseat("EREUSE", "A1", 100);
+    assert(seat_map_put(m, &a));
+    seat_ref_t r = seat_map_find(m, "EREUSE", "A1");
+    const tb_epoch_t expires = 4000000000;
+
+    tb_ebr_enter(); // the stalled caller's section
+    uint64_t w = seat_state_load(m, r);
+    uint32_t slot = seat_hold_slot_alloc(m, r, "U1", (const tb_byte_t *)"t1", 2);
+    assert(seat_state_cas(m, r, w, seat_state_make(SEAT_HELD, slot, expires)));
+    uint64_t stale = seat_state_load(m, r);
+    for (int i = 0; i < 100; ++i)
+    {
+        w = seat_state_load(m, r);
+        assert(seat_state_cas(m, r, w, seat_state_make(SEAT_AVAILABLE, 0, 0)));
+        w = seat_state_load(m, r);
+        slot = seat_hold_slot_alloc(m, r, "U2", (const tb_byte_t *)"t2", 2);
+        assert(slot != 0 && seat_state_slot(stale) != slot);
+        assert(seat_state_cas(m, r, w, seat_state_make(SEAT_HELD, slot, expires)));
+        tb_ebr_reclaim();
+    }
+    assert(!seat_state_cas(m, r, stale, seat_state_make(SEAT_AVAILABLE, 0, 0)));
+    seat_t out;
+    assert(seat_map_read(m, r, &out) && strcmp(out.holder_user_id, "U2") == 0);
+    tb_ebr_exit();
+
+    // Once the section is gone the retired slots are freed.
+    w = seat_state_load(m, r);
+    assert(seat_state_cas(m, r, w, seat_state_make(SEAT_AVAILABLE, 0, 0)));
+    tb_ebr_barrier();
+    assert(tb_ebr_pending() == 0);
+    seat_map_destroy(m);
+    assert(tb_ebr_pending() == 0);
+    printf("[OK] hold slots are not reused under a reader\n");
+}
+
+static void test_seqlock_reads(void)
+{
+    seat_map_t *m = seat_map_create(64);
+    seat_t s = mkseat("E1", "A1", 0);
+    assert(seat_map_put(m, &s));
+
+    seqlock_arg arg = {.m = m, .loops = 200000, .done = 0};
+    pthread_t w, r1, r2;
+    pthread_create(&r1, NULL, seqlock_reader, &arg);
+    pthread_create(&r2, NULL, seqlock_reader, &arg);
+    pthread_create(&w, NULL, seqlock_writer, &arg);
+    pthread_join(w, NULL);
+    pthread_join(r1, NULL);
+    pthread_join(r2, NULL);
+
+    seat_t out = {0};
+    assert(seat_map_get(m, "E1", "A1", &out));
+    assert(out.price_cents == arg.loops);
+    assert(out.version == 2u * (uint32_t)arg.loops);
+
+    seat_map_destroy(m);
+    printf("[OK] seqlock reads are never torn\n");
+}
+
+static void test_event_regions(void)
+{
+    seat_map_t *m = seat_map_create(16); // small tables: forces several grows
+    assert(seat_map_event_load(m, "EA", 0));
+    assert(seat_map_event_load(m, "EA", 0)); // already loaded
+    char sid[TB_ID_LEN];
+    for (int i = 0; i < 5000; ++i)
+    {
+        snprintf(sid, sizeof sid, "R%d", i);
+        seat_t a = mkseat("EA", sid, i);
+        if (i % 100 == 0)
+        {
+            a.status = SEAT_HELD;
+            a.hold_token_len = 4;
+            memcpy(a.hold_token, &i, 4);
+        }
+        assert(seat_map_put(m, &a));
+        if (i < 10)
+        {
+            seat_t b = mkseat("EB", sid, 7);
+            assert(seat_map_put(m, &b));
+        }
+    }
+    uint32_t ea = tb_intern_lookup(TB_NS_EVENT, "EA");
+    uint32_t eb = tb_intern_lookup(TB_NS_EVENT, "EB");
+    assert(seat_map_event_size(m, ea) == 5000 && seat_map_event_size(m, eb) == 10);
+    assert(seat_map_size(m) == 5010);
+    seat_t out;
+    for (int i = 0; i < 5000; ++i)
+    {
+        snprintf(sid, sizeof sid, "R%d", i);
+        assert(seat_map_get(m, "EA", sid, &out) && out.price_cents == i);
+    }
+    int probe = 300;
+    assert(seat_map_find_by_token(m, (const tb_byte_t *)&probe, 4, &out));
+
+    size_t mem = seat_map_memory_bytes(m);
+    assert(seat_map_event_unload(m, "EA"));
+    assert(!seat_map_event_unload(m, "EA"));
+    assert(seat_map_size(m) == 10 && seat_map_event_size(m, ea) == 0);
+    assert(seat_map_memory_bytes(m) < mem);
+    assert(!seat_map_get(m, "EA", "R1", &out));
+    assert(!seat_map_find_by_token(m, (const tb_byte_t *)&probe, 4, &out)); // holds released
+    assert(seat_map_get(m, "EB", "R3", &out) && out.price_cents == 7);
+
+    // the event can come back; its segments are reused
+    seat_t a = mkseat("EA", "R1", 11);
+    assert(seat_map_put(m, &a));
+    assert(seat_map_get(m, "EA", "R1", &out) && out.price_cents == 11);
+    assert(seat_map_event_size(m, ea) == 1);
+    seat_map_destroy(m);
+    printf("[OK] event regions load/unload\n");
+}
+
+// Readers looking up existing seats must never miss while a writer keeps
+// adding seats to the same event (and its chain table keeps growing).
+static seat_map_t *g_grow_map;
+static volatile int g_grow_stop;
+
+static void *grow_reader(void *arg)
+{
+    (void)arg;
+    char sid[TB_ID_LEN];
+    unsigned i = 0;
+    while (!__atomic_load_n(&g_grow_stop, __ATOMIC_ACQUIRE))
+    {
+        snprintf(sid, sizeof sid, "G%u", i++ % 64);
+        assert(seat_map_find(g_grow_map, "EG", sid) != 0);
+    }
+    return NULL;
+}
+
+static void test_lookup_during_growth(void)
+{
+    g_grow_map = seat_map_create(1);
+    char sid[TB_ID_LEN];
+    for (int i = 0; i < 64; ++i)
+    {
+        snprintf(sid, sizeof sid, "G%d", i);
+        seat_t s = mkseat("EG", sid, i);
+        assert(seat_map_put(g_grow_map, &s));
+    }
+    pthread_t th[2];
+    for (int t = 0; t < 2; ++t)
+        pthread_create(&th[t], NULL, grow_reader, NULL);
+    for (int i = 64; i < 200000; ++i)
+    {
+        snprintf(sid, sizeof sid, "G%d", i);
+        seat_t s = mkseat("EG", sid, i);
+        assert(seat_map_put(g_grow_map, &s));
+    }
+    __atomic_store_n(&g_grow_stop, 1, __ATOMIC_RELEASE);
+    for (int t = 0; t < 2; ++t)
+        pthread_join(th[t], NULL);
+    seat_map_destroy(g_grow_map);
+    printf("[OK] lookups during chain table growth\n");
+}
+
+static void test_snapshot_preimages(void)
+{
+    seat_map_t *m = seat_map_create(16);
+    char sid[TB_ID_LEN];
+    for (int i = 0; i < 3; ++i)
+    {
+        snprintf(sid, sizeof sid, "P%d", i);
+        seat_t a = mkseat("ESNAP", sid, 100 + i);
+        assert(seat_map_put(m, &a));
+    }
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, "ESNAP");
+    assert(seat_map_snapshot_begin(m, 0) == NULL);
+
+    seat_snapshot_t *s = seat_map_snapshot_begin(m, ev);
+    assert(s);
+    seat_t a = mkseat("ESNAP", "P0", 999); // in-place rewrite
+    assert(seat_map_put(m, &a));
+    seat_ref_t r1 = seat_map_find(m, "ESNAP", "P1");
+    uint64_t w = seat_state_load(m, r1); // lock-free hold
+    uint32_t slot = seat_hold_slot_alloc(m, r1, "U1", (const tb_byte_t *)"tok", 3);
+    assert(seat_state_cas(m, r1, w, seat_state_make(SEAT_HELD, slot, 4000000000)));
+
+    seat_t out;
+    int n = 0;
+    while (seat_map_snapshot_next(s, &out))
+    {
+        assert(strcmp(out.event_id, "ESNAP") == 0);
+        assert(out.status == SEAT_AVAILABLE && out.price_cents == 100 + n);
+        assert(out.hold_token_len == 0);
+        n++;
+    }
+    assert(n == 3);
+    assert(seat_map_snapshot_end(s));
+
+    s = seat_map_snapshot_begin(m, ev);
+    assert(seat_map_snapshot_next(s, &out) && out.price_cents == 999);
+    assert(seat_map_snapshot_next(s, &out) && out.status == SEAT_HELD);
+    assert(strcmp(out.holder_user_id, "U1") == 0 && out.hold_token_len == 0);
+    // held seat released mid-scan: pre-image keeps the holder
+    seat_ref_t r2 = seat_map_find(m, "ESNAP", "P2");
+    w = seat_state_load(m, r2);
+    slot = seat_hold_slot_alloc(m, r2, "U2", (const tb_byte_t *)"tok", 3);
+    assert(seat_state_cas(m, r2, w, seat_state_make(SEAT_HELD, slot, 4000000000)));
+    assert(seat_map_snapshot_next(s, &out) && out.status == SEAT_AVAILABLE);
+    assert(!seat_map_snapshot_next(s, &out));
+
+    // every slot taken: further snapshots are refused until one closes
+    seat_snapshot_t *more[SEAT_SNAP_SLOTS];
+    for (int i = 0; i < SEAT_SNAP_SLOTS - 1; ++i)
+        assert((more[i] = seat_map_snapshot_begin(m, ev)) != NULL);
+    assert(seat_map_snapshot_begin(m, ev) == NULL);
+    assert(seat_map_snapshot_end(s));
+    assert((s = seat_map_snapshot_begin(m, ev)) != NULL);
+    assert(seat_map_snapshot_end(s));
+    for (int i = 0; i < SEAT_SNAP_SLOTS - 1; ++i)
+        assert(seat_map_snapshot_end(more[i]));
+    seat_map_destroy(m);
+    printf("[OK] snapshot pre-images\n");
+}
+
+// A writer sweeps the event in scan order setting every price to the round
+// number, so at any instant prices never increase along the scan and differ
+// by at most one. A torn scan would see a later seat ahead of an earlier one.
+#define SNAP_SEATS 2048
+static seat_map_t *g_snap_map;
+static volatile int g_snap_stop;
+
+static void *snap_writer(void *arg)
+{
+    (void)arg;
+    char sid[TB_ID_LEN];
+    for (int round = 1; !__atomic_load_n(&g_snap_stop, __ATOMIC_ACQUIRE); ++round)
+    {
+        for (int i = 0; i < SNAP_SEATS; ++i)
+        {
+            snprintf(sid, sizeof sid, "W%d", i);
+            seat_t s = mkseat("ESWEEP", sid, round);
+            assert(seat_map_lock(g_snap_map, "ESWEEP", sid));
+            assert(seat_map_put(g_snap_map, &s));
+            seat_map_unlock(g_snap_map, "ESWEEP", sid);
+        }
+    }
+    return NULL;
+}
+
+static void test_snapshot_consistent_under_writers(void)
+{
+    g_snap_map = seat_map_create(SNAP_SEATS);
+    char sid[TB_ID_LEN];
+    for (int i = 0; i < SNAP_SEATS; ++i)
+    {
+        snprintf(sid, sizeof sid, "W%d", i);
+        seat_t s = mkseat("ESWEEP", sid, 0);
+        assert(seat_map_put(g_snap_map, &s));
+    }
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, "ESWEEP");
+    pthread_t th;
+    pthread_create(&th, NULL, snap_writer, NULL);
+    int rounds_seen = 0, last_max = -1;
+    for (int k = 0; k < 300; ++k)
+    {
+        seat_snapshot_t *s = seat_map_snapshot_begin(g_snap_map, ev);
+        assert(s);
+        seat_t out;
+        int n = 0, first = -1, prev = -1;
+        while (seat_map_snapshot_next(s, &out))
+        {
+            if (first < 0)
+                first = prev = out.price_cents;
+            assert(out.price_cents <= prev && out.price_cents >= first - 1);
+            prev = out.price_cents;
+            n++;
+        }
+        assert(n == SNAP_SEATS && seat_map_snapshot_end(s));
+        if (first != last_max)
+            rounds_seen++;
+        last_max = first;
+    }
+    __atomic_store_n(&g_snap_stop, 1, __ATOMIC_RELEASE);
+    pthread_join(th, NULL);
+    seat_map_destroy(g_snap_map);
+    printf("[OK] snapshots consistent under writers (%d distinct rounds)\n", rounds_seen);
+}
+
+// Brute-force count over the records, for checking the bitmaps.
+static size_t count_by_reading(seat_map_t *m, uint32_t ev, size_t first, size_t count)
+{
+    size_t n = 0;
+    seat_t out;
+    for (size_t p = first; p < first + count; ++p)
+    {
+        seat_ref_t r = seat_map_event_ref(m, ev, p);
+        if (r)
+        {
+            seat_map_read(m, r, &out);
+            n += out.status == SEAT_AVAILABLE;
+        }
+    }
+    return n;
+}
+
+static void hold_ref(seat_map_t *m, seat_ref_t r)
+{
+    uint64_t w = seat_state_load(m, r);
+    uint32_t slot = seat_hold_slot_alloc(m, r, "U", (const tb_byte_t *)"t", 1);
+    assert(seat_state_cas(m, r, w, seat_state_make(SEAT_HELD, slot, 4000000000)));
+}
+
+static void test_availability_bits(void)
+{
+    seat_map_t *m = seat_map_create(16);
+    char sid[TB_ID_LEN];
+    for (int i = 0; i < 200; ++i)
+    {
+        snprintf(sid, sizeof sid, "V%d", i);
+        seat_t a = mkseat("EAVAIL", sid, 100);
+        assert(seat_map_put(m, &a));
+    }
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, "EAVAIL");
+    assert(seat_map_event_records(m, ev) == 200);
+    assert(seat_map_avail_count(m, ev, 0, 1000) == 200);
+    assert(seat_map_avail_count(m, ev, 60, 10) == 10 && seat_map_avail_count(m, ev, 200, 5) == 0);
+
+    // Hold every third seat of positions 0..98, sell 150, delete 160.
+    for (int p = 0; p < 99; p += 3)
+        hold_ref(m, seat_map_event_ref(m, ev, (size_t)p));
+    seat_t sold = mkseat("EAVAIL", "V150", 100);
+    sold.status = SEAT_SOLD;
+    assert(seat_map_put(m, &sold));
+    assert(seat_map_delete(m, "EAVAIL", "V160"));
+    assert(seat_map_event_ref(m, ev, 160) == 0);
+    for (size_t a = 0; a < 200; a += 7)
+        for (size_t n = 0; a + n <= 200; n += 13)
+            assert(seat_map_avail_count(m, ev, a, n) == count_by_reading(m, ev, a, n));
+
+    // Runs: nothing of 3 among 0..98 (every third held), pairs there are.
+    size_t start;
+    assert(!seat_map_avail_find(m, ev, 0, 99, 3, 0, &start));
+    assert(seat_map_avail_find(m, ev, 0, 99, 2, 50, &start) && start == 49);
+    // 97..149 free: a run of 53, none of 54; runs of 40 cross a word.
+    assert(seat_map_avail_find(m, ev, 90, 70, 53, 0, &start) && start == 97);
+    assert(!seat_map_avail_find(m, ev, 90, 70, 54, 0, &start));
+    assert(seat_map_avail_find(m, ev, 99, 51, 40, 105, &start) && start == 105);
+    assert(seat_map_avail_find(m, ev, 99, 51, 40, 200, &start) && start == 110);
+    assert(!seat_map_avail_find(m, ev, 0, 200, SEAT_AVAIL_MAX_RUN + 1, 0, &start));
+
+    // A cancel frees the bit again; the recycled record of V160 too.
+    seat_ref_t r0 = seat_map_event_ref(m, ev, 0);
+    assert(seat_state_cas(m, r0, seat_state_load(m, r0), seat_state_make(SEAT_AVAILABLE, 0, 0)));
+    seat_t back = mkseat("EAVAIL", "V999", 100);
+    assert(seat_map_put(m, &back) && seat_map_event_ref(m, ev, 160) != 0);
+    assert(seat_map_avail_count(m, ev, 0, 200) == count_by_reading(m, ev, 0, 200));
+
+    // Layouts must lie within the records.
+    seat_row_t rows[2] = {{tb_intern(TB_NS_SECTION, "S1"), 0, 100}, {0, 100, 100}};
+    assert(seat_map_event_set_rows(m, ev, rows, 2));
+    size_t nrows;
+    assert(seat_map_event_rows(m, ev, &nrows)[1].first == 100 && nrows == 2);
+    rows[1].n_seats = 101;
+    assert(!seat_map_event_set_rows(m, ev, rows, 2));
+    assert(seat_map_event_set_rows(m, ev, NULL, 0) && !seat_map_event_rows(m, ev, &nrows));
+    seat_map_destroy(m);
+    printf("[OK] availability bits\n");
+}
+
+// Bulk-loaded event spanning two segments: counts and runs cross the seam.
+static void test_availability_across_segments(void)
+{
+    enum { N = SEAT_SEG_SIZE + 1000 };
+    seat_map_t *m = seat_map_create(16);
+    uint32_t ev = tb_intern(TB_NS_EVENT, "EAVSEG");
+    assert(seat_map_bulk_begin(m, ev, N));
+    static seat_bulk_t rows[N];
+    char sid[TB_ID_LEN];
+    for (size_t i = 0; i < N; ++i)
+    {
+        snprintf(sid, sizeof sid, "G%zu", i);
+        rows[i].seat_ix = tb_intern(TB_NS_SEAT, sid);
+        rows[i].price_cents = 1;
+    }
+    assert(seat_map_bulk_fill(m, ev, 0, rows, N, 0) == N);
+    assert(seat_map_bulk_end(m, ev) == N);
+    assert(seat_map_avail_count(m, ev, 0, N) == N);
+
+    // Hold every other seat except 8 straddling the seam: with the odd
+    // seats around them that leaves one run of 17 across it.
+    size_t seam = SEAT_SEG_SIZE;
+    for (size_t p = 0; p < N; p += 2)
+        if (p < seam - 8 || p >= seam + 8)
+            hold_ref(m, seat_map_event_ref(m, ev, p));
+    assert(seat_map_avail_count(m, ev, 0, N) == N / 2 + 8);
+    assert(seat_map_avail_count(m, ev, 3, N - 10) == count_by_reading(m, ev, 3, N - 10));
+    size_t start;
+    assert(seat_map_avail_find(m, ev, 0, N, 17, 0, &start) && start == seam - 9);
+    assert(!seat_map_avail_find(m, ev, 0, N, 18, 0, &start));
+    seat_map_destroy(m);
+    printf("[OK] availability across segments\n");
+}
+
+// Threads hold and cancel the same few seats; once they stop, every bit
+// must again agree with its seat.
+#define AV_SEATS 8
+static seat_map_t *g_av_map;
+static uint32_t g_av_event;
+
+static void *av_worker(void *arg)
+{
+    uint64_t x = (uint64_t)(uintptr_t)arg * 0x9e3779b97f4a7c15ULL + 1;
+    for (int i = 0; i < 100000; ++i)
+    {
+        x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+        seat_ref_t r = seat_map_event_ref(g_av_map, g_av_event, x % AV_SEATS);
+        uint64_t w = seat_state_load(g_av_map, r);
+        if (seat_state_status(w) == SEAT_AVAILABLE)
+            seat_state_cas(g_av_map, r, w, seat_state_make(SEAT_HELD, 0, 4000000000));
+        else
+            seat_state_cas(g_av_map, r, w, seat_state_make(SEAT_AVAILABLE, 0, 0));
+    }
+    return NULL;
+}
+
+static void test_availability_racing_writers(void)
+{
+    g_av_map = seat_map_create(16);
+    char sid[TB_ID_LEN];
+    for (int i = 0; i < AV_SEATS; ++i)
+    {
+        snprintf(sid, sizeof sid, "R%d", i);
+        seat_t a = mkseat("EAVRACE", sid, 1);
+        assert(seat_map_put(g_av_map, &a));
+    }
+    g_av_event = tb_intern_lookup(TB_NS_EVENT, "EAVRACE");
+    assert(seat_map_price_count(g_av_map, g_av_event, 1, 1) == AV_SEATS); // index kept in step too
+    pthread_t th[4];
+    for (uintptr_t t = 0; t < 4; ++t)
+        pthread_create(&th[t], NULL, av_worker, (void *)t);
+    for (int t = 0; t < 4; ++t)
+        pthread_join(th[t], NULL);
+    for (size_t p = 0; p < AV_SEATS; ++p)
+        assert(seat_map_avail_count(g_av_map, g_av_event, p, 1) ==
+               count_by_reading(g_av_map, g_av_event, p, 1));
+    assert(seat_map_event_verify(g_av_map, g_av_event)); // counters and price bits too
+    assert(seat_map_price_count(g_av_map, g_av_event, 1, 1) ==
+           seat_map_avail_count(g_av_map, g_av_event, 0, AV_SEATS));
+    seat_map_destroy(g_av_map);
+    printf("[OK] availability bits under racing writers\n");
+}
+
+// Walk the price index over [lo, hi] and check it against the records: the
+// available seats in ascending (price, position), each price as indexed.
+static size_t check_price_walk(seat_map_t *m, uint32_t ev, tb_money_cents_t lo, tb_money_cents_t hi)
+{
+    size_t records = seat_map_event_records(m, ev), n = 0;
+    tb_money_cents_t last_price = 0;
+    size_t last_pos = 0;
+    seat_price_cursor_t c;
+    seat_ref_t r;
+    tb_money_cents_t price;
+    seat_t s;
+    tb_ebr_enter();
+    assert(seat_map_price_open(m, ev, lo, hi, &c));
+    while (seat_map_price_next(m, &c, &r, &price))
+    {
+        assert(seat_map_read(m, r, &s) && s.status == SEAT_AVAILABLE && s.price_cents == price);
+        assert(price >= lo && price <= hi);
+        size_t pos = 0;
+        while (seat_map_event_ref(m, ev, pos) != r)
+            pos++;
+        assert(n == 0 || price > last_price || (price == last_price && pos > last_pos));
+        last_price = price;
+        last_pos = pos;
+        n++;
+    }
+    tb_ebr_exit();
+    size_t want = 0;
+    for (size_t p = 0; p < records; ++p)
+    {
+        seat_ref_t q = seat_map_event_ref(m, ev, p);
+        if (q && seat_map_read(m, q, &s))
+            want += s.status == SEAT_AVAILABLE && s.price_cents >= lo && s.price_cents <= hi;
+    }
+    assert(n == want && seat_map_price_count(m, ev, lo, hi) == want);
+    return n;
+}
+
+static void test_price_index(void)
+{
+    enum { N = 9000 };
+    seat_map_t *m = seat_map_create(16);
+    char sid[TB_ID_LEN];
+    for (int i = 0; i < N; ++i)
+    {
+        snprintf(sid, sizeof sid, "P%d", i);
+        seat_t a = mkseat("EPRICE", sid, 1000 + ((i * 37) % 10) * 250 - (i % 500 == 0) * 5000);
+        assert(seat_map_put(m, &a));
+    }
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, "EPRICE");
+    assert(seat_map_price_count(m, ev, 1000, 1000) == N / 10 - N / 500);
+    assert(seat_map_price_count(m, ev, INT32_MIN, INT32_MAX) == N);
+    assert(seat_map_price_count(m, ev, 2000, 1000) == 0 && seat_map_price_count(m, ev, 9999, 99999) == 0);
+    assert(check_price_walk(m, ev, INT32_MIN, INT32_MAX) == N);
+
+    // Sell every seat of the two cheapest tiers but the last few, so the
+    // walk skips thousands of sold ranks; hold a scatter of the rest.
+    size_t left = 0;
+    for (size_t p = 0; p < N; ++p)
+    {
+        seat_ref_t r = seat_map_event_ref(m, ev, p);
+        seat_t s;
+        assert(seat_map_read(m, r, &s));
+        if ((s.price_cents < 1500 && p < N - 40) || p % 7 == 3)
+            hold_ref(m, r);
+        else if (s.price_cents < 1500)
+            left++;
+    }
+    assert(seat_map_price_count(m, ev, INT32_MIN, 1250) == left);
+    check_price_walk(m, ev, INT32_MIN, INT32_MAX);
+    check_price_walk(m, ev, 1250, 2000);
+    check_price_walk(m, ev, 1300, 1400);
+    assert(seat_map_event_verify(m, ev));
+
+    // A cancel, a reprice (rebuilds on the next query), a delete, a new seat.
+    seat_ref_t r3 = seat_map_event_ref(m, ev, 3);
+    assert(seat_state_cas(m, r3, seat_state_load(m, r3), seat_state_make(SEAT_AVAILABLE, 0, 0)));
+    seat_t cheap = mkseat("EPRICE", "P1", 1);
+    assert(seat_map_put(m, &cheap));
+    assert(seat_map_delete(m, "EPRICE", "P2"));
+    seat_t extra = mkseat("EPRICE", "PX", 2);
+    assert(seat_map_put(m, &extra));
+    assert(seat_map_price_count(m, ev, 1, 2) == 2);
+    seat_price_cursor_t c;
+    seat_ref_t r;
+    tb_money_cents_t price;
+    tb_ebr_enter();
+    assert(seat_map_price_open(m, ev, INT32_MIN, INT32_MAX, &c));
+    assert(seat_map_price_next(m, &c, &r, &price) && price == 1 && r == seat_map_find(m, "EPRICE", "P1"));
+    assert(seat_map_price_next(m, &c, &r, &price) && price == 2);
+    assert(seat_map_price_next(m, &c, &r, &price) && price == 1000); // the negative prices are held
+    tb_ebr_exit();
+    check_price_walk(m, ev, INT32_MIN, INT32_MAX);
+    assert(seat_map_event_verify(m, ev));
+    assert(!seat_map_price_open(m, tb_intern(TB_NS_EVENT, "ENOPRICE"), 0, 1, &c));
+    seat_map_destroy(m);
+    printf("[OK] price index\n");
+}
+
+static void test_event_counters(void)
+{
+    seat_map_t *m = seat_map_create(16);
+    char sid[TB_ID_LEN];
+    for (int i = 0; i < 20; ++i)
+    {
+        snprintf(sid, sizeof sid, "C%d", i);
+        seat_t a = mkseat("ECOUNT", sid, 100);
+        a.status = i < 2 ? SEAT_SOLD : SEAT_AVAILABLE;
+        assert(seat_map_put(m, &a));
+    }
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, "ECOUNT");
+    seat_counts_t c;
+    assert(seat_map_event_counts(m, ev, &c));
+    assert(c.seats == 20 && c.by_status[SEAT_AVAILABLE] == 18 && c.by_status[SEAT_SOLD] == 2);
+
+    // Holds, a cancel, a refund through put and a delete each move a count.
+    for (size_t p = 2; p < 6; ++p)
+        hold_ref(m, seat_map_event_ref(m, ev, p));
+    seat_ref_t r = seat_map_event_ref(m, ev, 2);
+    assert(seat_state_cas(m, r, seat_state_load(m, r), seat_state_make(SEAT_AVAILABLE, 0, 0)));
+    seat_t refunded = mkseat("ECOUNT", "C0", 100);
+    refunded.status = SEAT_REFUNDED;
+    assert(seat_map_put(m, &refunded));
+    assert(seat_map_delete(m, "ECOUNT", "C3"));
+    assert(seat_map_event_counts(m, ev, &c));
+    assert(c.seats == 19 && c.by_status[SEAT_AVAILABLE] == 15 && c.by_status[SEAT_HELD] == 2);
+    assert(c.by_status[SEAT_SOLD] == 1 && c.by_status[SEAT_REFUNDED] == 1);
+    assert(seat_map_event_verify(m, ev));
+
+    // A bulk load counts its seats available; an unknown event has none.
+    uint32_t bev = tb_intern(TB_NS_EVENT, "ECOUNTB");
+    seat_bulk_t rows[100];
+    for (size_t i = 0; i < 100; ++i)
+    {
+        snprintf(sid, sizeof sid, "B%zu", i);
+        rows[i] = (seat_bulk_t){.seat_ix = tb_intern(TB_NS_SEAT, sid), .price_cents = 1};
+    }
+    assert(seat_map_bulk_begin(m, bev, 100));
+    assert(seat_map_bulk_fill(m, bev, 0, rows, 100, 0) == 100);
+    assert(seat_map_bulk_end(m, bev) == 100);
+    assert(seat_map_event_counts(m, bev, &c) && c.by_status[SEAT_AVAILABLE] == 100);
+    assert(seat_map_event_verify(m, bev));
+    assert(!seat_map_event_counts(m, tb_intern(TB_NS_EVENT, "ECOUNTX"), &c));
+    assert(!seat_map_event_verify(m, tb_intern(TB_NS_EVENT, "ECOUNTX")));
+    seat_map_destroy(m);
+    printf("[OK] event counters\n");
+}
+
+// Batches that are not a multiple of the prefetch group, mixing hits with
+// unknown names, names of another event, and an unknown event.
+static void test_get_many(void)
+{
+    seat_map_t *m = seat_map_create(4);
+    char names[40][TB_ID_LEN];
+    const char *ids[40];
+    for (int i = 0; i < 40; ++i)
+    {
+        snprintf(names[i], TB_ID_LEN, "M%d", i);
+        ids[i] = names[i];
+        if (i % 3 == 2)
+            continue;
+        seat_t s = mkseat(i % 5 == 4 ? "EMANYX" : "EMANY", names[i], 100 + i);
+        assert(seat_map_put(m, &s));
+    }
+    ids[39] = "NOSUCHSEAT";
+    seat_t out[40];
+    bool found[40];
+    size_t want = 0;
+    for (int i = 0; i < 39; ++i)
+        want += i % 3 != 2 && i % 5 != 4;
+    assert(seat_map_get_many(m, "EMANY", ids, 40, out, found) == want);
+    for (int i = 0; i < 40; ++i)
+    {
+        seat_t one;
+        bool hit = seat_map_get(m, "EMANY", ids[i], &one);
+        assert(found[i] == hit);
+        if (hit)
+            assert(out[i].price_cents == 100 + i && strcmp(out[i].seat_id, ids[i]) == 0);
+        else
+            assert(out[i].price_cents == 0 && out[i].seat_id[0] == 0);
+    }
+    assert(seat_map_get_many(m, "NOEVENT", ids, 40, out, found) == 0 && !found[0]);
+    assert(seat_map_get_many(m, "EMANY", ids, 0, out, NULL) == 0);
+    seat_map_destroy(m);
+    printf("[OK] batched get_many\n");
+}
+
+// Readers look seats up while writers insert and delete seats of one event
+// and load and unload another, under EBR. A seat found must read back
+// whole; a stable event's seats must always be found.
+#define EBR_STABLE 256
+#define EBR_CHURN 512
+#define EBR_ROUNDS 20000
+
+static seat_map_t *g_ebr_map;
+static int g_ebr_stop;
+
+static void *ebr_reader(void *arg)
+{
+    uint64_t seed = (uintptr_t)arg + 1;
+    char sid[TB_ID_LEN];
+    size_t reads = 0;
+    while (!__atomic_load_n(&g_ebr_stop, __ATOMIC_ACQUIRE) || reads < 1000)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        unsigned i = (unsigned)(seed >> 33);
+        seat_t out;
+        snprintf(sid, sizeof sid, "K%u", i % EBR_STABLE);
+        assert(seat_map_get(g_ebr_map, "EEBRSTABLE", sid, &out));
+        assert(out.price_cents == (int)(i % EBR_STABLE) && strcmp(out.seat_id, sid) == 0);
+        snprintf(sid, sizeof sid, "C%u", i % EBR_CHURN);
+        if (seat_map_get(g_ebr_map, "EEBRCHURN", sid, &out))
+            assert(out.price_cents == 1000 + (int)(i % EBR_CHURN) && strcmp(out.seat_id, sid) == 0);
+        snprintf(sid, sizeof sid, "U%u", i % 64);
+        if (seat_map_get(g_ebr_map, "EEBRUNLOAD", sid, &out))
+            assert(out.price_cents == 2000 + (int)(i % 64) && strcmp(out.event_id, "EEBRUNLOAD") == 0);
+
+        // Hold and release a churning seat through its handle.
+        snprintf(sid, sizeof sid, "C%u", (i >> 9) % EBR_CHURN);
+        tb_ebr_enter();
+        seat_ref_t r = seat_map_find(g_ebr_map, "EEBRCHURN", sid);
+        uint64_t w = r ? seat_state_load(g_ebr_map, r) : 0;
+        if (r && !seat_state_gone(w) && seat_state_status(w) == SEAT_AVAILABLE &&
+            seat_state_cas(g_ebr_map, r, w, seat_state_make(SEAT_HELD, 0, 4000000000)))
+        {
+            w = seat_state_load(g_ebr_map, r);
+            if (!seat_state_gone(w))
+                seat_state_cas(g_ebr_map, r, w, seat_state_make(SEAT_AVAILABLE, 0, 0));
+        }
+        tb_ebr_exit();
+        reads++;
+    }
+    return NULL;
+}
+
+static void *ebr_unloader(void *arg)
+{
+    (void)arg;
+    char sid[TB_ID_LEN];
+    while (!__atomic_load_n(&g_ebr_stop, __ATOMIC_ACQUIRE))
+    {
+        for (int i = 0; i < 64; ++i)
+        {
+            snprintf(sid, sizeof sid, "U%d", i);
+            seat_t s = mkseat("EEBRUNLOAD", sid, 2000 + i);
+            assert(seat_map_put(g_ebr_map, &s));
+        }
+        assert(seat_map_event_unload(g_ebr_map, "EEBRUNLOAD"));
+    }
+    return NULL;
+}
+
+static void test_structural_changes_under_readers(void)
+{
+    g_ebr_map = seat_map_create(16);
+    char sid[TB_ID_LEN];
+    for (int i = 0; i < EBR_STABLE; ++i)
+    {
+        snprintf(sid, sizeof sid, "K%d", i);
+        seat_t s = mkseat("EEBRSTABLE", sid, i);
+        assert(seat_map_put(g_ebr_map, &s));
+    }
+    pthread_t th[4];
+    for (uintptr_t t = 0; t < 3; ++t)
+        pthread_create(&th[t], NULL, ebr_reader, (void *)t);
+    pthread_create(&th[3], NULL, ebr_unloader, NULL);
+
+    bool live[EBR_CHURN] = {false};
+    size_t n_live = 0;
+    uint64_t seed = 99;
+    for (int k = 0; k < EBR_ROUNDS; ++k)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        unsigned i = (unsigned)(seed >> 33) % EBR_CHURN;
+        snprintf(sid, sizeof sid, "C%u", i);
+        if (live[i])
+        {
+            assert(seat_map_delete(g_ebr_map, "EEBRCHURN", sid));
+            n_live--;
+        }
+        else
+        {
+            seat_t s = mkseat("EEBRCHURN", sid, 1000 + (int)i);
+            assert(seat_map_put(g_ebr_map, &s));
+            n_live++;
+        }
+        live[i] = !live[i];
+    }
+    __atomic_store_n(&g_ebr_stop, 1, __ATOMIC_RELEASE);
+    for (int t = 0; t < 4; ++t)
+        pthread_join(th[t], NULL);
+
+    uint32_t ev = tb_intern_lookup(TB_NS_EVENT, "EEBRCHURN");
+    assert(seat_map_event_size(g_ebr_map, ev) == n_live);
+    assert(seat_map_event_verify(g_ebr_map, ev));
+    assert(seat_map_event_verify(g_ebr_map, tb_intern_lookup(TB_NS_EVENT, "EEBRSTABLE")));
+    seat_map_event_unload(g_ebr_map, "EEBRUNLOAD");
+    assert(seat_map_size(g_ebr_map) == EBR_STABLE + n_live);
+    seat_map_destroy(g_ebr_map);
+    assert(tb_ebr_pending() == 0);
+    printf("[OK] inserts, deletes and unloads under lock-free readers\n");
+}
+
 int main(void)
 {
     test_create_put_get();
@@ -181,7 +1039,21 @@ int main(void)
     test_lock_unlock();
     test_concurrent_rw();
     test_delete();
+    test_delete_recycles_records();
     test_find_by_token();
+    test_hold_slot_reuse_waits_for_readers();
+    test_seqlock_reads();
+    test_event_regions();
+    test_lookup_during_growth();
+    test_snapshot_preimages();
+    test_snapshot_consistent_under_writers();
+    test_availability_bits();
+    test_availability_across_segments();
+    test_availability_racing_writers();
+    test_price_index();
+    test_event_counters();
+    test_get_many();
+    test_structural_changes_under_readers();
     printf("All hashtable tests passed.\n");
     return 0;
 }
@@ -0,0 +1,105 @@
+// Unit tests for identifier interning
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "intern.h"
+
+static void test_roundtrip(void)
+{
+    uint32_t base = tb_intern_count(TB_NS_EVENT);
+    uint32_t a = tb_intern(TB_NS_EVENT, "EV-A");
+    uint32_t b = tb_intern(TB_NS_EVENT, "EV-B");
+    assert(a == base + 1 && b == base + 2); // dense, in order
+    assert(tb_intern(TB_NS_EVENT, "EV-A") == a);
+    assert(tb_intern_lookup(TB_NS_EVENT, "EV-B") == b);
+    assert(strcmp(tb_intern_name(TB_NS_EVENT, a), "EV-A") == 0);
+
+    // namespaces are independent; unknown names are not assigned by lookup
+    assert(tb_intern_lookup(TB_NS_SEAT, "EV-A") == 0);
+    assert(tb_intern_lookup(TB_NS_EVENT, "EV-C") == 0);
+    assert(tb_intern_count(TB_NS_EVENT) == base + 2);
+    assert(tb_intern(TB_NS_EVENT, "") == 0 && tb_intern(TB_NS_EVENT, NULL) == 0);
+    assert(tb_intern_name(TB_NS_EVENT, 0) == NULL);
+    printf("[OK] intern roundtrip\n");
+}
+
+static void test_truncation(void)
+{
+    char longname[64];
+    memset(longname, 'x', sizeof longname - 1);
+    longname[sizeof longname - 1] = '\0';
+    uint32_t id = tb_intern(TB_NS_SEAT, longname);
+    assert(id != 0);
+    assert(strlen(tb_intern_name(TB_NS_SEAT, id)) == TB_ID_LEN - 1);
+    longname[TB_ID_LEN + 3] = 'y'; // differs only past the stored prefix
+    assert(tb_intern_lookup(TB_NS_SEAT, longname) == id);
+    printf("[OK] intern truncation\n");
+}
+
+#define THREADS 4
+#define NAMES   20000
+
+static void *intern_worker(void *p)
+{
+    uint32_t *ids = (uint32_t *)p;
+    char name[TB_ID_LEN];
+    for (int i = 0; i < NAMES; ++i)
+    {
+        snprintf(name, sizeof name, "T-%d", i);
+        ids[i] = tb_intern(TB_NS_SEAT, name);
+    }
+    return NULL;
+}
+
+static void test_concurrent_intern(void)
+{
+    static uint32_t ids[THREADS][NAMES];
+    pthread_t th[THREADS];
+    for (int t = 0; t < THREADS; ++t)
+        pthread_create(&th[t], NULL, intern_worker, ids[t]);
+    for (int t = 0; t < THREADS; ++t)
+        pthread_join(th[t], NULL);
+
+    for (int i = 0; i < NAMES; ++i)
+    {
+        char name[TB_ID_LEN];
+        snprintf(name, sizeof name, "T-%d", i);
+        assert(ids[0][i] != 0);
+        for (int t = 1; t < THREADS; ++t)
+            assert(ids[t][i] == ids[0][i]); // every thread agrees
+        assert(strcmp(tb_intern_name(TB_NS_SEAT, ids[0][i]), name) == 0);
+    }
+    printf("[OK] concurrent intern\n");
+}
+
+static void test_lookup_many(void)
+{
+    uint32_t a = tb_intern(TB_NS_SEAT, "MANY-A");
+    uint32_t b = tb_intern(TB_NS_SEAT, "MANY-B");
+    const char *names[20];
+    for (int i = 0; i < 20; ++i)
+        names[i] = i % 4 == 0 ? "MANY-A" : i % 4 == 1 ? "MANY-B" : i % 4 == 2 ? "MANY-C" : NULL;
+    uint32_t ids[20];
+    assert(tb_intern_lookup_many(TB_NS_SEAT, names, 20, ids) == 10);
+    for (int i = 0; i < 20; ++i)
+        assert(ids[i] == (i % 4 == 0 ? a : i % 4 == 1 ? b : 0));
+    assert(tb_intern_lookup(TB_NS_SEAT, "MANY-C") == 0); // lookups never assign
+
+    // tb_intern_many assigns the misses and keeps the hits' ids.
+    assert(tb_intern_many(TB_NS_SEAT, names, 20, ids) == 15);
+    uint32_t c = tb_intern_lookup(TB_NS_SEAT, "MANY-C");
+    assert(c != 0 && ids[2] == c && ids[0] == a && ids[3] == 0);
+    printf("[OK] intern lookup_many\n");
+}
+
+int main(void)
+{
+    test_roundtrip();
+    test_truncation();
+    test_concurrent_intern();
+    test_lookup_many();
+    printf("All intern tests passed.\n");
+    return 0;
+}
@@ -0,0 +1,183 @@
+// Unit tests for venue manifests: CSV conversion, validation, bulk load
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hashtable.h"
+#include "intern.h"
+#include "manifest.h"
+
+static char g_csv[64], g_bin[64];
+
+static void write_file(const char *path, const char *text)
+{
+    FILE *f = fopen(path, "w");
+    assert(f);
+    fputs(text, f);
+    fclose(f);
+}
+
+static void test_convert_and_open(void)
+{
+    // Interleaved events and rows; grouped by first appearance on output.
+    write_file(g_csv,
+               "event_id,section,row,seat_id,tier,price_cents\n"
+               "MF-E1,Floor,A,A1,GA,5000\n"
+               "MF-E2,Balcony,K,K1,Cheap,2500\r\n"
+               "MF-E1,Floor,B,B1,GA,5000\n"
+               "MF-E1,Floor,A,A2,VIP,12000\n"
+               "\n"
+               "MF-E1,Upper,Z,Z9,GA,5000\n");
+    size_t bad = 99;
+    assert(tb_manifest_from_csv(g_csv, g_bin, &bad) && bad == 0);
+
+    tb_manifest_t mf;
+    assert(tb_manifest_open(&mf, g_bin));
+    assert(mf.hdr->n_events == 2 && mf.hdr->n_sections == 3 && mf.hdr->n_rows == 4);
+    assert(mf.hdr->n_tiers == 3 && mf.hdr->n_seats == 5 && mf.hdr->n_seat_names == 5);
+
+    const tb_manifest_event_t *e1 = &mf.events[0];
+    assert(strcmp(tb_manifest_name(&mf, e1->name), "MF-E1") == 0);
+    assert(e1->first_seat == 0 && e1->n_seats == 4 && e1->n_sections == 2 && e1->n_tiers == 2);
+    const tb_manifest_row_t *ra = &mf.rows[mf.sections[0].first_row];
+    assert(strcmp(tb_manifest_name(&mf, ra->name), "A") == 0 && ra->n_seats == 2);
+    assert(strcmp(tb_manifest_seat_name(&mf, ra->first_seat + 1), "A2") == 0);
+    assert(mf.tiers[mf.seats[ra->first_seat + 1].tier].price_cents == 12000);
+    assert(mf.events[1].first_seat == 4 && mf.events[1].n_seats == 1);
+    // "GA" appears once in the string blob even though three seats use it
+    assert(mf.tiers[mf.seats[0].tier].name == mf.tiers[mf.seats[3].tier].name);
+    tb_manifest_close(&mf);
+    printf("[OK] manifest convert/open\n");
+}
+
+static void test_bad_csv(void)
+{
+    size_t bad = 0;
+    write_file(g_csv, "E,S,R,A1,GA,100\nE,S,R,A2,GA\n");
+    assert(!tb_manifest_from_csv(g_csv, g_bin, &bad) && bad == 2);
+    write_file(g_csv, "E,S,R,A1,GA,100\nE,S,R2,A1,GA,100\n"); // duplicate seat
+    assert(!tb_manifest_from_csv(g_csv, g_bin, &bad) && bad == 2);
+    write_file(g_csv, "E,S,R,A1,GA,100\nE,S,R,A2,GA,200\n"); // tier repriced
+    assert(!tb_manifest_from_csv(g_csv, g_bin, &bad) && bad == 2);
+    write_file(g_csv, "E,S,R,A1,GA,-1\n");
+    assert(!tb_manifest_from_csv(g_csv, g_bin, &bad) && bad == 1);
+    write_file(g_csv, "E,S,R,0123456789012345678901234567890123,GA,1\n");
+    assert(!tb_manifest_from_csv(g_csv, g_bin, &bad) && bad == 1);
+    assert(!tb_manifest_from_csv("/nonexistent/x.csv", g_bin, &bad) && bad == 0);
+    printf("[OK] manifest rejects bad CSV\n");
+}
+
+static void test_corrupt_file(void)
+{
+    write_file(g_csv, "E,S,R,A1,GA,100\nE,S,R,A2,GA,100\n");
+    assert(tb_manifest_from_csv(g_csv, g_bin, NULL));
+    FILE *f = fopen(g_bin, "r+b");
+    assert(f);
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    unsigned char *buf = malloc((size_t)size);
+    fseek(f, 0, SEEK_SET);
+    assert(fread(buf, 1, (size_t)size, f) == (size_t)size);
+
+    tb_manifest_t mf;
+    tb_manifest_header_t *h = (tb_manifest_header_t *)buf;
+    h->n_seats++; // row runs no longer tile the seat table
+    fseek(f, 0, SEEK_SET);
+    fwrite(buf, 1, (size_t)size, f);
+    fflush(f);
+    assert(!tb_manifest_open(&mf, g_bin) && mf.base == NULL);
+
+    h->n_seats--;
+    h->magic[0] = 'X';
+    fseek(f, 0, SEEK_SET);
+    fwrite(buf, 1, (size_t)size, f);
+    fflush(f);
+    assert(!tb_manifest_open(&mf, g_bin));
+
+    h->magic[0] = 'T';
+    fseek(f, 0, SEEK_SET);
+    fwrite(buf, 1, (size_t)size, f);
+    fclose(f);
+    assert(tb_manifest_open(&mf, g_bin));
+    tb_manifest_close(&mf);
+    assert(truncate(g_bin, size - 1) == 0);
+    assert(!tb_manifest_open(&mf, g_bin));
+    free(buf);
+    printf("[OK] manifest rejects corrupt files\n");
+}
+
+#define LOAD_EVENTS 3
+#define LOAD_SEATS  20000 // per event, several load blocks
+
+static void test_parallel_load(void)
+{
+    FILE *f = fopen(g_csv, "w");
+    assert(f);
+    for (int e = 0; e < LOAD_EVENTS; ++e)
+        for (int i = 0; i < LOAD_SEATS; ++i)
+            fprintf(f, "MFL-%d,S%d,R%d,L%d,T%d,%d\n", e, i / 1000, i / 50, i, i % 4, 100 * (i % 4 + 1));
+    fclose(f);
+    assert(tb_manifest_from_csv(g_csv, g_bin, NULL));
+
+    tb_manifest_t mf;
+    assert(tb_manifest_open(&mf, g_bin));
+    seat_map_t *m = seat_map_create(64);
+    seat_t s = {0};
+    strcpy(s.event_id, "MFL-1");
+    strcpy(s.seat_id, "L0");
+    assert(seat_map_put(m, &s)); // MFL-1 already loaded: skipped by the manifest
+
+    assert(tb_manifest_load(&mf, m, 4) == (LOAD_EVENTS - 1) * LOAD_SEATS);
+    assert(seat_map_size(m) == (LOAD_EVENTS - 1) * LOAD_SEATS + 1);
+    seat_t out;
+    for (int i = 0; i < LOAD_SEATS; i += 997)
+    {
+        char id[TB_ID_LEN];
+        snprintf(id, sizeof id, "L%d", i);
+        assert(seat_map_get(m, "MFL-2", id, &out));
+        assert(out.status == SEAT_AVAILABLE && out.price_cents == 100 * (i % 4 + 1));
+    }
+    assert(seat_map_event_size(m, tb_intern_lookup(TB_NS_EVENT, "MFL-0")) == LOAD_SEATS);
+    assert(seat_map_event_size(m, tb_intern_lookup(TB_NS_EVENT, "MFL-1")) == 1);
+
+    // Sections and rows become the layout: rows of 50, twenty per section.
+    size_t nrows;
+    uint32_t ev0 = tb_intern_lookup(TB_NS_EVENT, "MFL-0");
+    const seat_row_t *rows = seat_map_event_rows(m, ev0, &nrows);
+    assert(rows && nrows == LOAD_SEATS / 50);
+    assert(rows[21].first == 21 * 50 && rows[21].n_seats == 50);
+    assert(rows[21].section_ix == tb_intern_lookup(TB_NS_SECTION, "S1"));
+    assert(seat_map_avail_count(m, ev0, rows[21].first, rows[21].n_seats) == 50);
+    seat_ref_t r = seat_map_event_ref(m, ev0, rows[21].first + 7);
+    assert((uint32_t)seat_map_hot(m, r)->key == tb_intern_lookup(TB_NS_SEAT, "L1057"));
+    assert(!seat_map_event_rows(m, tb_intern_lookup(TB_NS_EVENT, "MFL-1"), &nrows) && nrows == 0);
+
+    // A loaded event behaves like any other: new seats, deletes, unload.
+    strcpy(s.event_id, "MFL-0");
+    strcpy(s.seat_id, "EXTRA");
+    assert(seat_map_put(m, &s));
+    assert(seat_map_delete(m, "MFL-0", "L5"));
+    assert(!seat_map_get(m, "MFL-0", "L5", &out));
+    assert(seat_map_event_size(m, tb_intern_lookup(TB_NS_EVENT, "MFL-0")) == LOAD_SEATS);
+    assert(seat_map_event_unload(m, "MFL-2"));
+    assert(tb_manifest_load(&mf, m, 1) == LOAD_SEATS); // only MFL-2 is missing again
+    seat_map_destroy(m);
+    tb_manifest_close(&mf);
+    printf("[OK] manifest parallel load\n");
+}
+
+int main(void)
+{
+    snprintf(g_csv, sizeof g_csv, "/tmp/tb_manifest_%d.csv", (int)getpid());
+    snprintf(g_bin, sizeof g_bin, "/tmp/tb_manifest_%d.tbv", (int)getpid());
+    test_convert_and_open();
+    test_bad_csv();
+    test_corrupt_file();
+    test_parallel_load();
+    remove(g_csv);
+    remove(g_bin);
+    printf("All manifest tests passed.\n");
+    return 0;
+}
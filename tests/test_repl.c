@@ -0,0 +1,185 @@
+// Unit tests for replication: a forked standby follows a primary through a
+// full copy and streamed changes, including a log too small to keep up, and
+// takes over on promotion
+#include <assert.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "repl.h"
+#include "reservation.h"
+
+#define SEATS 8
+
+// What the primary tells the standby when it is time to take over.
+typedef struct
+{
+    uint64_t head;
+    hold_result_t u1, u2;
+} handover_t;
+
+static void make_event(const char *event_id, seat_t *seats)
+{
+    memset(seats, 0, SEATS * sizeof *seats);
+    for (int s = 0; s < SEATS; ++s)
+    {
+        snprintf(seats[s].event_id, TB_ID_LEN, "%s", event_id);
+        snprintf(seats[s].seat_id, TB_ID_LEN, "S%d", s);
+        seats[s].price_cents = 2500;
+    }
+}
+
+static void nap(void)
+{
+    struct timespec ts = {0, 1000000};
+    nanosleep(&ts, NULL);
+}
+
+static seat_status_t status_of(const char *ev, const char *seat, char *holder)
+{
+    seat_view_t v;
+    assert(seat_get(ev, seat, &v));
+    if (holder)
+        strcpy(holder, v.holder_user_id);
+    return v.status;
+}
+
+// Standby: follow the primary, then promote and check what it took over.
+static int standby_main(const char *path, int cmd_fd)
+{
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    assert(reservation_init());
+    while (!tb_repl_standby_start(path))
+        nap();
+    handover_t h;
+    assert(read(cmd_fd, &h, sizeof h) == (ssize_t)sizeof h);
+    assert(tb_repl_promote() == h.head);
+    assert(!tb_repl_standby_connected());
+
+    char who[TB_ID_LEN];
+    assert(status_of("RE1", "S0", who) == SEAT_HELD && strcmp(who, "U1") == 0);
+    assert(status_of("RE1", "S1", NULL) == SEAT_AVAILABLE); // sold, then refunded
+    assert(status_of("RE1", "S2", who) == SEAT_HELD && strcmp(who, "U2") == 0);
+    assert(status_of("RE1", "S3", NULL) == SEAT_AVAILABLE); // held, then cancelled
+    assert(status_of("RE1", "S4", NULL) == SEAT_SOLD);
+    for (int s = 5; s < SEATS; ++s)
+    {
+        char sid[TB_ID_LEN];
+        snprintf(sid, sizeof sid, "S%d", s);
+        assert(status_of("RE1", sid, NULL) == SEAT_AVAILABLE); // churned
+    }
+    assert(status_of("RE2", "S0", who) == SEAT_HELD && strcmp(who, "U4") == 0);
+    assert(status_of("RE2", "S1", NULL) == SEAT_SOLD);
+    event_inventory_t inv;
+    assert(!event_inventory("RE3", &inv)); // unloaded on the primary
+    assert(event_inventory("RE2", &inv) && inv.seats == SEATS && inv.held == 1 && inv.sold == 1);
+
+    // Holds came with their tokens and hold index.
+    assert(place_hold("X", "RE1", "S0").code == RES_HELD_BY_OTHER);
+    confirm_result_t c = confirm_reservation(h.u2.hold_token, h.u2.token_len, h.u2.price_cents);
+    assert(c.code == RES_OK);
+    assert(status_of("RE1", "S2", NULL) == SEAT_SOLD);
+    assert(cancel_all_holds("U1") == 1);
+    assert(status_of("RE1", "S0", NULL) == SEAT_AVAILABLE);
+    reservation_shutdown();
+    return 0;
+}
+
+static void wait_caught_up(tb_repl_status_t *st)
+{
+    for (int i = 0; i < 10000; ++i)
+    {
+        assert(tb_repl_primary_status(st));
+        if (st->connected && st->resyncs > 0 && st->acked == st->head)
+            return;
+        nap();
+    }
+    assert(!"standby did not catch up");
+}
+
+static void test_follow_and_promote(void)
+{
+    char path[64];
+    snprintf(path, sizeof path, "/tmp/tb_test_repl_%d.sock", (int)getpid());
+    int cmd[2];
+    assert(pipe(cmd) == 0);
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0)
+    {
+        close(cmd[1]);
+        _exit(standby_main(path, cmd[0]));
+    }
+    close(cmd[0]);
+
+    // Before the standby connects: RE1 with a hold and a sale, RE3.
+    assert(reservation_init());
+    seat_t seats[SEATS];
+    make_event("RE1", seats);
+    assert(event_load("RE1", seats, SEATS));
+    make_event("RE3", seats);
+    assert(event_load("RE3", seats, SEATS));
+    handover_t h = {0};
+    h.u1 = place_hold("U1", "RE1", "S0");
+    assert(h.u1.code == RES_OK);
+    hold_result_t b = place_hold("B1", "RE1", "S1");
+    confirm_result_t sold = confirm_reservation(b.hold_token, b.token_len, b.price_cents);
+    assert(sold.code == RES_OK);
+
+    // A tiny log, so the churn below may lap the shipper and force a resync.
+    assert(tb_repl_primary_start(path, 64));
+    assert(!tb_repl_primary_start(path, 64));
+    tb_repl_status_t st;
+    wait_caught_up(&st);
+    assert(st.resyncs == 1);
+
+    // Streamed: holds, a cancel, a sale, a refund, a new event, an unload.
+    h.u2 = place_hold("U2", "RE1", "S2");
+    assert(h.u2.code == RES_OK);
+    assert(place_hold("U3", "RE1", "S3").code == RES_OK);
+    assert(cancel_hold("U3", "RE1", "S3") == RES_OK);
+    b = place_hold("B2", "RE1", "S4");
+    assert(confirm_reservation(b.hold_token, b.token_len, b.price_cents).code == RES_OK);
+    assert(refund("B1", sold.order_id) == RES_OK);
+    make_event("RE2", seats);
+    assert(event_load("RE2", seats, SEATS));
+    assert(place_hold("U4", "RE2", "S0").code == RES_OK);
+    b = place_hold("B3", "RE2", "S1");
+    assert(confirm_reservation(b.hold_token, b.token_len, b.price_cents).code == RES_OK);
+    assert(event_unload("RE3"));
+    for (int i = 0; i < 5000; ++i)
+    {
+        char sid[TB_ID_LEN];
+        snprintf(sid, sizeof sid, "S%d", 5 + i % (SEATS - 5));
+        assert(place_hold("C", "RE1", sid).code == RES_OK);
+        assert(cancel_hold("C", "RE1", sid) == RES_OK);
+    }
+    wait_caught_up(&st);
+    assert(st.shipped == st.head && st.batches > 0);
+    printf("  (log head %llu, %llu batches, %llu full copies)\n", (unsigned long long)st.head,
+           (unsigned long long)st.batches, (unsigned long long)st.resyncs);
+
+    h.head = st.head;
+    assert(write(cmd[1], &h, sizeof h) == (ssize_t)sizeof h);
+    int status;
+    assert(waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    for (int i = 0; i < 10000 && st.connected; ++i, nap())
+        assert(tb_repl_primary_status(&st));
+    assert(!st.connected);
+    tb_repl_primary_stop();
+    assert(!tb_repl_primary_status(&st));
+    close(cmd[1]);
+    reservation_shutdown();
+    printf("[OK] repl standby follows and takes over\n");
+}
+
+int main(void)
+{
+    test_follow_and_promote();
+    printf("All repl tests passed.\n");
+    return 0;
+}
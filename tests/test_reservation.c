@@ -1,9 +1,14 @@
 // Unit tests for reservation API
 #include <assert.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
 
+#include "intern.h"
+#include "manifest.h"
 #include "reservation.h"
 #include "types.h"
 
@@ -110,10 +115,948 @@ static void test_cancel_hold_and_expiry(void)
     printf("[OK] cancel hold and expiry\n");
 }
 
+static seat_t g_exported[4];
+static size_t g_n_exported;
+
+static bool export_seat(const seat_t *seat, void *ctx)
+{
+    (void)ctx;
+    if (g_n_exported == 4)
+        return false;
+    g_exported[g_n_exported++] = *seat;
+    return true;
+}
+
+static void test_event_load_unload(void)
+{
+    assert(reservation_init());
+    reservation_set_hold_length_seconds(300);
+
+    seat_t seats[3] = {mkseat("EV3", "A1", 500), mkseat("EV3", "A2", 600),
+                       mkseat("OTHER", "A3", 700)};
+    assert(!event_load("EV3", seats, 3)); // foreign seat rejected, rest loaded
+    assert(event_load("EV3", seats, 2));
+    seat_view_t v = {0};
+    assert(seat_get("EV3", "A2", &v) && v.price_cents == 600);
+    assert(!seat_get("OTHER", "A3", &v));
+
+    hold_result_t h = place_hold("U7", "EV3", "A1");
+    assert(h.code == RES_OK);
+    assert(event_unload("EV3"));
+    assert(!event_unload("EV3"));
+    assert(!seat_get("EV3", "A1", &v));
+    assert(place_hold("U7", "EV3", "A2").code == RES_NOT_FOUND);
+    assert(confirm_reservation(h.hold_token, h.token_len, 500).code != RES_OK);
+
+    assert(event_load("EV3", seats, 2)); // reload after teardown
+    assert(seat_get("EV3", "A1", &v) && v.status == SEAT_AVAILABLE);
+
+    // Bulk load from a manifest; EV3 is already loaded and left alone.
+    char csv[64], bin[64];
+    snprintf(csv, sizeof csv, "/tmp/tb_res_%d.csv", (int)getpid());
+    snprintf(bin, sizeof bin, "/tmp/tb_res_%d.tbv", (int)getpid());
+    FILE *f = fopen(csv, "w");
+    assert(f);
+    fputs("EV4,Floor,A,A1,GA,800\nEV4,Floor,A,A2,GA,800\nEV3,Floor,A,A9,GA,800\n", f);
+    fclose(f);
+    assert(tb_manifest_from_csv(csv, bin, NULL));
+    assert(reservation_load_manifest(bin, 2) == 2);
+    assert(reservation_load_manifest("/nonexistent.tbv", 2) == 0);
+    assert(seat_get("EV4", "A2", &v) && v.price_cents == 800);
+    assert(!seat_get("EV3", "A9", &v));
+    assert(place_hold("U7", "EV4", "A1").code == RES_OK);
+    remove(csv);
+    remove(bin);
+
+    // Chart snapshot: the hold placed after opening is not in it.
+    seat_snapshot_t *snap = event_snapshot_begin("EV4");
+    assert(snap && !event_snapshot_begin("NOPE"));
+    assert(place_hold("U8", "EV4", "A2").code == RES_OK);
+    int n = 0, held = 0;
+    while (event_snapshot_next(snap, &v))
+    {
+        n++;
+        held += v.status == SEAT_HELD;
+        assert(v.status != SEAT_HELD || strcmp(v.holder_user_id, "U7") == 0);
+    }
+    assert(n == 2 && held == 1 && event_snapshot_end(snap));
+
+    // Export and reload, as when an event moves: holds keep their tokens
+    // and their place in the hold index.
+    hold_result_t h7 = place_hold("U7", "EV3", "A2");
+    assert(h7.code == RES_OK);
+    assert(!event_export("NOPE", export_seat, NULL));
+    assert(event_export("EV3", export_seat, NULL) && g_n_exported == 2);
+    assert(event_unload("EV3") && event_load("EV3", g_exported, g_n_exported));
+    assert(seat_get("EV3", "A2", &v) && v.status == SEAT_HELD && strcmp(v.holder_user_id, "U7") == 0);
+    assert(cancel_all_holds("U7") == 2); // EV4/A1 and the moved EV3/A2
+    assert(seat_get("EV3", "A2", &v) && v.status == SEAT_AVAILABLE);
+    h7 = place_hold("U7", "EV3", "A2");
+    g_n_exported = 0;
+    assert(event_export("EV3", export_seat, NULL) && event_unload("EV3"));
+    assert(event_load("EV3", g_exported, g_n_exported));
+    assert(confirm_reservation(h7.hold_token, h7.token_len, 600).code == RES_OK);
+
+    reservation_shutdown();
+    printf("[OK] event load/unload\n");
+}
+
+static void test_best_available(void)
+{
+    assert(reservation_init());
+    reservation_set_hold_length_seconds(300);
+    char csv[64], bin[64];
+    snprintf(csv, sizeof csv, "/tmp/tb_best_%d.csv", (int)getpid());
+    snprintf(bin, sizeof bin, "/tmp/tb_best_%d.tbv", (int)getpid());
+    FILE *f = fopen(csv, "w");
+    assert(f);
+    for (int i = 0; i < 10; ++i)
+        fprintf(f, "EVB,112,A,A%d,P1,800\n", i);
+    for (int i = 0; i < 10; ++i)
+        fprintf(f, "EVB,112,B,B%d,P1,800\n", i);
+    for (int i = 0; i < 6; ++i)
+        fprintf(f, "EVB,200,C,C%d,P1,800\n", i);
+    fclose(f);
+    assert(tb_manifest_from_csv(csv, bin, NULL));
+    assert(reservation_load_manifest(bin, 1) == 26);
+    remove(csv);
+    remove(bin);
+
+    assert(event_available_count("EVB", NULL) == 26);
+    assert(event_available_count("EVB", "112") == 20 && event_available_count("EVB", "200") == 6);
+    assert(event_available_count("EVB", "nope") == 0 && event_available_count("NOPE", NULL) == 0);
+
+    // The middle of row A is taken: the best 4 are the left block, then
+    // the right one, then the centre of row B.
+    assert(place_hold("U1", "EVB", "A4").code == RES_OK);
+    assert(place_hold("U1", "EVB", "A5").code == RES_OK);
+    group_seat_t g[RES_MAX_GROUP];
+    assert(find_best_available("U2", "EVB", "112", 4, g) == RES_OK);
+    assert(strcmp(g[0].seat_id, "A0") == 0 && strcmp(g[3].seat_id, "A3") == 0);
+    assert(event_available_count("EVB", "112") == 14);
+    assert(find_best_available("U2", "EVB", "112", 4, g) == RES_OK);
+    assert(strcmp(g[0].seat_id, "A6") == 0);
+    assert(find_best_available("U3", "EVB", "112", 4, g) == RES_OK);
+    assert(strcmp(g[0].seat_id, "B3") == 0 && strcmp(g[3].seat_id, "B6") == 0);
+    seat_view_t v;
+    assert(seat_get("EVB", "B5", &v) && v.status == SEAT_HELD && strcmp(v.holder_user_id, "U3") == 0);
+
+    // The holds are ordinary holds: confirm one, cancel another.
+    confirm_result_t c = confirm_reservation(g[0].hold.hold_token, g[0].hold.token_len,
+                                             g[0].hold.price_cents);
+    assert(c.code == RES_OK);
+    assert(cancel_hold("U3", "EVB", "B6") == RES_OK);
+    assert(event_available_count("EVB", "112") == 7);
+
+    // No row of section 200 seats 7; nothing is left held by the attempt.
+    assert(find_best_available("U4", "EVB", "200", 7, g) == RES_NOT_FOUND);
+    assert(event_available_count("EVB", "200") == 6);
+    assert(find_best_available("U4", "EVB", NULL, 6, g) == RES_OK && strcmp(g[0].seat_id, "C0") == 0);
+    assert(find_best_available("U4", "EVB", "nope", 1, g) == RES_NOT_FOUND);
+    assert(find_best_available("U4", "EVB", NULL, 0, g) == RES_INTERNAL_ERR);
+    assert(find_best_available("U4", "EVB", NULL, RES_MAX_GROUP + 1, g) == RES_INTERNAL_ERR);
+
+    // Without a manifest the event is one row in load order.
+    seat_t seats[6];
+    char sid[RES_ID_LEN];
+    for (int i = 0; i < 6; ++i)
+    {
+        snprintf(sid, sizeof sid, "P%d", i);
+        seats[i] = mkseat("EVP", sid, 100);
+    }
+    assert(event_load("EVP", seats, 6));
+    assert(place_hold("U1", "EVP", "P2").code == RES_OK);
+    assert(event_available_count("EVP", NULL) == 5 && event_available_count("EVP", "112") == 0);
+    assert(find_best_available("U2", "EVP", NULL, 3, g) == RES_OK && strcmp(g[0].seat_id, "P3") == 0);
+    assert(find_best_available("U2", "EVP", NULL, 2, g) == RES_OK && strcmp(g[1].seat_id, "P1") == 0);
+    assert(find_best_available("U2", "EVP", "112", 1, g) == RES_NOT_FOUND);
+
+    reservation_shutdown();
+    printf("[OK] availability counts and best-available groups\n");
+}
+
+static void test_inventory(void)
+{
+    assert(reservation_init());
+    reservation_set_hold_length_seconds(300);
+    seat_t seats[10];
+    char sid[RES_ID_LEN];
+    for (int i = 0; i < 10; ++i)
+    {
+        snprintf(sid, sizeof sid, "I%d", i);
+        seats[i] = mkseat("EVI", sid, 700);
+    }
+    assert(event_load("EVI", seats, 10));
+    tb_feed_sub_t *sub = tb_feed_subscribe(reservation_feed());
+    assert(sub);
+    event_inventory_t inv;
+    assert(event_inventory("EVI", &inv) && inv.seats == 10 && inv.available == 10);
+
+    hold_result_t h0 = place_hold("U1", "EVI", "I0");
+    assert(h0.code == RES_OK);
+    assert(place_hold("U1", "EVI", "I1").code == RES_OK);
+    assert(place_hold("U2", "EVI", "I2").code == RES_OK);
+    assert(cancel_hold("U1", "EVI", "I1") == RES_OK);
+    confirm_result_t c = confirm_reservation(h0.hold_token, h0.token_len, 700);
+    assert(c.code == RES_OK);
+    assert(event_inventory("EVI", &inv));
+    assert(inv.available == 8 && inv.held == 1 && inv.sold == 1 && inv.refunded == 0);
+    assert(event_inventory_verify("EVI"));
+    assert(refund("U1", c.order_id) == RES_OK);
+    assert(event_inventory("EVI", &inv) && inv.available == 9 && inv.sold == 0);
+
+    // A lapsed hold stays counted as held until swept; a live one is kept.
+    reservation_set_hold_length_seconds(0);
+    assert(place_hold("U3", "EVI", "I5").code == RES_OK);
+    assert(event_inventory("EVI", &inv) && inv.held == 2);
+    assert(event_expire_holds("EVI") == 1 && event_expire_holds("EVI") == 0);
+    assert(event_inventory("EVI", &inv) && inv.held == 1 && inv.available == 9);
+    assert(event_inventory_verify("EVI"));
+    assert(!event_inventory("NOPE", &inv) && !event_inventory_verify("NOPE"));
+    assert(event_expire_holds("NOPE") == 0);
+
+    // The feed saw every transition; a poll gives each seat's latest.
+    tb_change_t ch[16];
+    bool lost;
+    assert(tb_feed_poll(sub, ch, 16, &lost) == 4 && !lost);
+    assert(ch[0].seat_ix == tb_seat_ix("I0") && ch[0].kind == TB_CHANGE_REFUNDED);
+    assert(ch[1].seat_ix == tb_seat_ix("I1") && ch[1].kind == TB_CHANGE_RELEASED);
+    assert(ch[2].seat_ix == tb_seat_ix("I2") && ch[2].kind == TB_CHANGE_HELD);
+    assert(ch[3].seat_ix == tb_seat_ix("I5") && ch[3].kind == TB_CHANGE_RELEASED);
+    assert(ch[0].event_ix == tb_event_ix("EVI"));
+    tb_feed_unsubscribe(sub);
+
+    reservation_shutdown();
+    printf("[OK] inventory counters\n");
+}
+
+static void test_price_queries(void)
+{
+    assert(reservation_init());
+    reservation_set_hold_length_seconds(300);
+    seat_t seats[12];
+    char sid[RES_ID_LEN];
+    for (int i = 0; i < 12; ++i)
+    {
+        snprintf(sid, sizeof sid, "P%d", i);
+        seats[i] = mkseat("EVP1", sid, 1000 + (i % 4) * 500);
+    }
+    assert(event_load("EVP1", seats, 12));
+    for (int i = 0; i < 6; ++i)
+    {
+        snprintf(sid, sizeof sid, "P%d", i);
+        seats[i] = mkseat("EVP2", sid, i < 3 ? 900 : i < 5 ? 1200 : 1000);
+    }
+    assert(event_load("EVP2", seats, 6));
+
+    priced_seat_t out[8];
+    assert(event_cheapest_seats("EVP1", INT32_MIN, INT32_MAX, 4, out) == 4);
+    assert(strcmp(out[0].seat_id, "P0") == 0 && strcmp(out[2].seat_id, "P8") == 0);
+    assert(strcmp(out[3].seat_id, "P1") == 0 && out[3].price_cents == 1500);
+    assert(strcmp(out[0].event_id, "EVP1") == 0);
+
+    // Holds and sales leave the index; a cancel and a refund come back.
+    hold_result_t h0 = place_hold("U1", "EVP1", "P0");
+    assert(place_hold("U1", "EVP1", "P4").code == RES_OK);
+    confirm_result_t c = confirm_reservation(h0.hold_token, h0.token_len, 1000);
+    assert(c.code == RES_OK);
+    assert(event_cheapest_seats("EVP1", INT32_MIN, INT32_MAX, 2, out) == 2);
+    assert(strcmp(out[0].seat_id, "P8") == 0 && strcmp(out[1].seat_id, "P1") == 0);
+    assert(event_available_in_price_range("EVP1", 1000, 1500) == 4);
+    assert(event_available_in_price_range("EVP1", 1001, 1999) == 3);
+    assert(cancel_hold("U1", "EVP1", "P4") == RES_OK && refund("U1", c.order_id) == RES_OK);
+    assert(event_available_in_price_range("EVP1", 1000, 1500) == 6);
+    assert(event_cheapest_seats("EVP1", 2000, 2000, 8, out) == 3 && out[2].price_cents == 2000);
+
+    // A tour: cheapest over both events, ties in the order given.
+    const char *tour[3] = {"EVP1", "NOPE", "EVP2"};
+    assert(tour_cheapest_seats(tour, 3, INT32_MIN, INT32_MAX, 7, out) == 7);
+    assert(strcmp(out[0].event_id, "EVP2") == 0 && out[2].price_cents == 900);
+    assert(strcmp(out[3].event_id, "EVP1") == 0 && strcmp(out[3].seat_id, "P0") == 0);
+    assert(strcmp(out[5].event_id, "EVP1") == 0 && strcmp(out[5].seat_id, "P8") == 0);
+    assert(strcmp(out[6].event_id, "EVP2") == 0 && strcmp(out[6].seat_id, "P5") == 0);
+    assert(tour_cheapest_seats(tour, 3, 1100, 1300, 8, out) == 2 && out[1].price_cents == 1200);
+
+    // A repriced seat moves; nothing for empty ranges or unknown events.
+    seat_t cheap = mkseat("EVP1", "P11", 10);
+    assert(reservation_put_seat(&cheap));
+    assert(event_cheapest_seats("EVP1", INT32_MIN, INT32_MAX, 1, out) == 1);
+    assert(strcmp(out[0].seat_id, "P11") == 0 && out[0].price_cents == 10);
+    assert(event_available_in_price_range("EVP1", 2000, 1000) == 0);
+    assert(event_cheapest_seats("EVP1", 0, 5, 4, out) == 0);
+    assert(event_cheapest_seats("NOPE", 0, 5000, 4, out) == 0);
+    assert(event_cheapest_seats("EVP1", 0, 5000, 0, out) == 0);
+    assert(event_inventory_verify("EVP1") && event_inventory_verify("EVP2"));
+    reservation_shutdown();
+    printf("[OK] cheapest seats and price ranges\n");
+}
+
+static void test_seating_chart(void)
+{
+    assert(reservation_init());
+    reservation_set_hold_length_seconds(300);
+    seat_t seats[3] = {mkseat("EVC", "A1", 2500), mkseat("EVC", "A2", 2500), mkseat("EVC", "Q\"3", 900)};
+    assert(event_load("EVC", seats, 3));
+    const char *want = "{\"event\":\"EVC\",\"seats\":["
+                       "{\"id\":\"A1\",\"price\":2500,\"status\":\"A\"},"
+                       "{\"id\":\"A2\",\"price\":2500,\"status\":\"A\"},"
+                       "{\"id\":\"Q\\\"3\",\"price\":900,\"status\":\"A\"}]}";
+    const event_chart_t *j0 = event_chart_acquire("EVC", CHART_JSON);
+    assert(j0 && j0->len == strlen(want) && memcmp(j0->data, want, j0->len) == 0);
+    const event_chart_t *b0 = event_chart_acquire("EVC", CHART_BINARY);
+    assert(b0 && b0->len == 8 + 3 * 6 + 2 + 2 + 3);
+    assert(memcmp(b0->data, "TBC1\x03\0\0\0", 8) == 0);
+    assert(b0->data[8] == SEAT_AVAILABLE && b0->data[9] == 2 && memcmp(b0->data + 10, "A1", 2) == 0);
+    assert(b0->data[12] == 0xc4 && b0->data[13] == 0x09); // 2500 little-endian
+    const event_chart_t *again = event_chart_acquire("EVC", CHART_JSON);
+    assert(again == j0); // nothing moved: the same buffer
+    event_chart_release(again);
+
+    // A hold is patched into a new buffer while the old one is still held.
+    hold_result_t h = place_hold("U1", "EVC", "A2");
+    assert(h.code == RES_OK);
+    const event_chart_t *j1 = event_chart_acquire("EVC", CHART_JSON);
+    assert(j1 != j0 && j1->seq > j0->seq && j1->len == j0->len);
+    assert(strstr((const char *)j1->data, "\"A2\",\"price\":2500,\"status\":\"H\""));
+    assert(memcmp(j0->data, want, j0->len) == 0);
+    event_chart_release(j0);
+    event_chart_release(j1);
+
+    // Nobody holds it now: the sale is patched in place.
+    const event_chart_t *b1 = event_chart_acquire("EVC", CHART_BINARY);
+    assert(b1 != b0 && b1->data[16] == SEAT_HELD);
+    event_chart_release(b0);
+    event_chart_release(b1);
+    assert(confirm_reservation(h.hold_token, h.token_len, 2500).code == RES_OK);
+    b1 = event_chart_acquire("EVC", CHART_BINARY);
+    assert(b1->data[16] == SEAT_SOLD);
+    event_chart_release(b1);
+
+    // A hold that lapses publishes nothing; the cached chart drops it anyway,
+    // whether it lapsed before the chart caught up or after.
+    reservation_set_hold_length_seconds(0);
+    assert(place_hold("U2", "EVC", "A1").code == RES_OK);
+    b1 = event_chart_acquire("EVC", CHART_BINARY);
+    assert(b1->data[8] == SEAT_AVAILABLE && b1->data[16] == SEAT_SOLD);
+    event_chart_release(b1);
+    reservation_set_hold_length_seconds(1);
+    assert(place_hold("U2", "EVC", "A1").code == RES_OK);
+    j1 = event_chart_acquire("EVC", CHART_JSON);
+    assert(strstr((const char *)j1->data, "\"A1\",\"price\":2500,\"status\":\"H\""));
+    event_chart_release(j1);
+    sleep(2);
+    j1 = event_chart_acquire("EVC", CHART_JSON);
+    assert(strstr((const char *)j1->data, "\"A1\",\"price\":2500,\"status\":\"A\""));
+    event_chart_release(j1);
+    reservation_set_hold_length_seconds(300);
+
+    // A new seat rebuilds the chart; unknown events have none.
+    seat_t extra = mkseat("EVC", "A4", 100);
+    assert(reservation_put_seat(&extra));
+    j1 = event_chart_acquire("EVC", CHART_JSON);
+    assert(j1 && strstr((const char *)j1->data, "{\"id\":\"A4\",\"price\":100,\"status\":\"A\"}]}"));
+    assert(strstr((const char *)j1->data, "\"A2\",\"price\":2500,\"status\":\"S\""));
+    assert(!event_chart_acquire("NOPE", CHART_JSON));
+    reservation_shutdown();
+    assert(j1->data[0] == '{'); // still valid after shutdown
+    event_chart_release(j1);
+    printf("[OK] seating chart cache\n");
+}
+
+// ---- Linearizability stress: lock-free hold/cancel vs locked confirm ----
+
+#define STRESS_THREADS 8
+#define STRESS_SEATS   4
+#define STRESS_LOOPS   20000
+
+static int g_owner[STRESS_SEATS]; // thread that the test believes holds each seat
+
+typedef struct
+{
+    int id;
+    int holds;
+    int sales;
+} stress_arg;
+
+static void *stress_worker(void *p)
+{
+    stress_arg *a = (stress_arg *)p;
+    char user[RES_ID_LEN];
+    snprintf(user, sizeof user, "SU%d", a->id);
+    unsigned rng = (unsigned)a->id * 2654435761u + 1u;
+
+    for (int i = 0; i < STRESS_LOOPS; ++i)
+    {
+        rng = rng * 1103515245u + 12345u;
+        int k = (int)((rng >> 8) % STRESS_SEATS);
+        char sid[RES_ID_LEN];
+        snprintf(sid, sizeof sid, "S%d", k);
+
+        hold_result_t h = place_hold(user, "EVS", sid);
+        assert(h.code != RES_HOLD_EXISTS_SAME_USER); // we always release first
+        if (h.code != RES_OK)
+        {
+            assert(h.code == RES_HELD_BY_OTHER || h.code == RES_ALREADY_SOLD);
+            continue;
+        }
+
+        // Exactly one thread may believe it holds the seat.
+        int expect = 0;
+        assert(__atomic_compare_exchange_n(&g_owner[k], &expect, a->id, false,
+                                           __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+        a->holds++;
+
+        hold_result_t again = place_hold(user, "EVS", sid);
+        assert(again.code == RES_HOLD_EXISTS_SAME_USER);
+        assert(again.token_len == h.token_len);
+        assert(memcmp(again.hold_token, h.hold_token, h.token_len) == 0);
+
+        if ((rng >> 20) % 16 == 0)
+        {
+            confirm_result_t c = confirm_reservation(h.hold_token, h.token_len, 100);
+            assert(c.code == RES_OK);
+            assert(place_hold(user, "EVS", sid).code == RES_ALREADY_SOLD);
+            expect = a->id;
+            assert(__atomic_compare_exchange_n(&g_owner[k], &expect, 0, false,
+                                               __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+            assert(refund(user, c.order_id) == RES_OK);
+            a->sales++;
+        }
+        else
+        {
+            expect = a->id;
+            assert(__atomic_compare_exchange_n(&g_owner[k], &expect, 0, false,
+                                               __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+            assert(cancel_hold(user, "EVS", sid) == RES_OK);
+        }
+    }
+    return NULL;
+}
+
+static void test_seat_get_many(void)
+{
+    assert(reservation_init());
+    seat_t seats[70];
+    char names[72][RES_ID_LEN];
+    const char *ids[72];
+    for (int i = 0; i < 72; ++i)
+    {
+        snprintf(names[i], RES_ID_LEN, "G%d", i);
+        ids[i] = names[i];
+        if (i < 70)
+            seats[i] = mkseat("EVG", names[i], 100 + i);
+    }
+    assert(event_load("EVG", seats, 70));
+    reservation_set_hold_length_seconds(300);
+    assert(place_hold("U1", "EVG", "G3").code == RES_OK);
+    reservation_set_hold_length_seconds(0);
+    assert(place_hold("U1", "EVG", "G65").code == RES_OK); // lapses at once
+
+    // 72 names span two chunks; the last two are unknown.
+    seat_view_t out[72];
+    bool found[72];
+    assert(seat_get_many("EVG", ids, 72, out, found) == 70);
+    for (int i = 0; i < 72; ++i)
+    {
+        seat_view_t one;
+        assert(found[i] == seat_get("EVG", ids[i], &one));
+        if (found[i])
+            assert(out[i].status == one.status && out[i].price_cents == one.price_cents &&
+                   strcmp(out[i].seat_id, ids[i]) == 0);
+    }
+    assert(out[3].status == SEAT_HELD && strcmp(out[3].holder_user_id, "U1") == 0);
+    assert(out[65].status == SEAT_AVAILABLE && out[65].holder_user_id[0] == 0);
+    assert(seat_get_many("NOPE", ids, 72, out, NULL) == 0);
+    reservation_shutdown();
+    printf("[OK] seat_get_many\n");
+}
+
+static void test_concurrent_hold_linearizable(void)
+{
+    assert(reservation_init());
+    reservation_set_hold_length_seconds(300);
+    for (int k = 0; k < STRESS_SEATS; ++k)
+    {
+        char sid[RES_ID_LEN];
+        snprintf(sid, sizeof sid, "S%d", k);
+        seat_t s = mkseat("EVS", sid, 100);
+        assert(reservation_put_seat(&s));
+    }
+
+    pthread_t th[STRESS_THREADS];
+    stress_arg args[STRESS_THREADS];
+    for (int i = 0; i < STRESS_THREADS; ++i)
+    {
+        args[i] = (stress_arg){.id = i + 1};
+        pthread_create(&th[i], NULL, stress_worker, &args[i]);
+    }
+    int holds = 0;
+    for (int i = 0; i < STRESS_THREADS; ++i)
+    {
+        pthread_join(th[i], NULL);
+        holds += args[i].holds;
+    }
+    assert(holds > 0);
+
+    for (int k = 0; k < STRESS_SEATS; ++k)
+    {
+        char sid[RES_ID_LEN];
+        seat_view_t v = {0};
+        snprintf(sid, sizeof sid, "S%d", k);
+        assert(seat_get("EVS", sid, &v));
+        assert(v.status == SEAT_AVAILABLE);
+        assert(g_owner[k] == 0);
+    }
+    event_inventory_t inv;
+    assert(event_inventory("EVS", &inv) && inv.available == STRESS_SEATS && inv.held == 0);
+    assert(event_inventory_verify("EVS"));
+
+    reservation_shutdown();
+    printf("[OK] concurrent hold/cancel/confirm is linearizable (%d holds)\n", holds);
+}
+
+#define LIMIT_THREADS 4
+
+static void *limit_worker(void *arg)
+{
+    int t = (int)(intptr_t)arg, ok = 0;
+    for (int k = 0; k < 8; ++k)
+    {
+        char sid[RES_ID_LEN];
+        snprintf(sid, sizeof sid, "P%d", t * 8 + k);
+        hold_result_t h = place_hold("UBOT", "EVQR", sid);
+        assert(h.code == RES_OK || h.code == RES_HOLD_LIMIT);
+        ok += h.code == RES_OK;
+    }
+    return (void *)(intptr_t)ok;
+}
+
+#define PIN_EVENTS 100
+#define PIN_SEATS  200
+#define PIN_ROUNDS 8
+
+static volatile int g_pin_stop, g_pin_ready;
+
+// Confirms with the wrong amount until told to stop: the hold is pinned for
+// the length of each try and stays held.
+static void *pin_worker(void *arg)
+{
+    const hold_result_t *h = arg;
+    while (!__atomic_load_n(&g_pin_stop, __ATOMIC_ACQUIRE))
+    {
+        confirm_reservation(h->hold_token, h->token_len, 1);
+        __atomic_store_n(&g_pin_ready, 1, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+// Takes a second seat as soon as the limit lets it.
+static void *rehold_worker(void *arg)
+{
+    (void)arg;
+    while (!__atomic_load_n(&g_pin_stop, __ATOMIC_ACQUIRE) &&
+           place_hold("UPIN", "EVPIN", "B").code != RES_OK)
+        __atomic_store_n(&g_pin_ready, 2, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void test_hold_limit_and_cancel_all(void)
+{
+    assert(reservation_init());
+    reservation_set_hold_length_seconds(300);
+    char sid[RES_ID_LEN];
+    for (int i = 0; i < 10; ++i)
+    {
+        snprintf(sid, sizeof sid, "Q%d", i);
+        seat_t a = mkseat("EVQ", sid, 100), b = mkseat("EVQ2", sid, 100);
+        assert(reservation_put_seat(&a) && reservation_put_seat(&b));
+    }
+
+    // Three per user per event; other users and events are separate.
+    reservation_set_hold_limit(3);
+    assert(place_hold("U1", "EVQ", "Q0").code == RES_OK);
+    assert(place_hold("U1", "EVQ", "Q1").code == RES_OK);
+    assert(place_hold("U1", "EVQ", "Q2").code == RES_OK);
+    assert(place_hold("U1", "EVQ", "Q3").code == RES_HOLD_LIMIT);
+    assert(place_hold("U1", "EVQ", "Q0").code == RES_HOLD_EXISTS_SAME_USER);
+    assert(place_hold("U1", "EVQ2", "Q3").code == RES_OK);
+    assert(place_hold("U2", "EVQ", "Q3").code == RES_OK);
+    assert(cancel_hold("U1", "EVQ", "Q1") == RES_OK);
+    assert(place_hold("U1", "EVQ", "Q4").code == RES_OK);
+    group_seat_t g[4];
+    assert(find_best_available("U3", "EVQ", NULL, 4, g) == RES_HOLD_LIMIT);
+    seat_view_t v;
+    assert(seat_get("EVQ", "Q5", &v) && v.status == SEAT_AVAILABLE);
+
+    // A sale leaves the index; lapsed holds do not count.
+    hold_result_t h = place_hold("U4", "EVQ", "Q5");
+    assert(h.code == RES_OK);
+    assert(confirm_reservation(h.hold_token, h.token_len, 100).code == RES_OK);
+    assert(cancel_all_holds("U4") == 0);
+    reservation_set_hold_length_seconds(0);
+    for (int i = 6; i < 10; ++i)
+    {
+        snprintf(sid, sizeof sid, "Q%d", i);
+        assert(place_hold("U5", "EVQ2", sid).code == RES_OK);
+    }
+    reservation_set_hold_length_seconds(300);
+
+    // Release everything of U1 across events; a seat no longer there is
+    // skipped.
+    assert(event_unload("EVQ2"));
+    assert(cancel_all_holds("U1") == 3);
+    assert(cancel_all_holds("U1") == 0 && cancel_all_holds("NOBODY") == 0);
+    for (int i = 0; i < 5; ++i)
+    {
+        snprintf(sid, sizeof sid, "Q%d", i);
+        assert(seat_get("EVQ", sid, &v));
+        assert(v.status == (i == 3 ? SEAT_HELD : SEAT_AVAILABLE));
+    }
+    assert(place_hold("U1", "EVQ", "Q0").code == RES_OK);
+    event_inventory_t inv;
+    assert(event_inventory("EVQ", &inv) && inv.held == 2 && inv.sold == 1);
+
+    // Racing holds of one user never pass the limit.
+    for (int i = 0; i < LIMIT_THREADS * 8; ++i)
+    {
+        snprintf(sid, sizeof sid, "P%d", i);
+        seat_t a = mkseat("EVQR", sid, 100);
+        assert(reservation_put_seat(&a));
+    }
+    reservation_set_hold_limit(5);
+    pthread_t th[LIMIT_THREADS];
+    for (intptr_t t = 0; t < LIMIT_THREADS; ++t)
+        pthread_create(&th[t], NULL, limit_worker, (void *)t);
+    intptr_t held = 0;
+    for (int t = 0; t < LIMIT_THREADS; ++t)
+    {
+        void *ok;
+        pthread_join(th[t], &ok);
+        held += (intptr_t)ok;
+    }
+    assert(held == 5);
+    assert(cancel_all_holds("UBOT") == 5);
+    assert(event_inventory("EVQR", &inv) && inv.held == 0);
+
+    // A hold mid-checkout stays indexed through cancel_all_holds even when
+    // a new hold fills the limit first (the holds walked before it give the
+    // new hold time), so once the confirm fails the next call releases it.
+    char eid[RES_ID_LEN];
+    for (int e = 0; e < PIN_EVENTS; ++e)
+        for (int i = 0; i < PIN_SEATS; ++i)
+        {
+            snprintf(eid, sizeof eid, "EVPX%d", e);
+            snprintf(sid, sizeof sid, "X%d", i);
+            seat_t x = mkseat(eid, sid, 100);
+            assert(reservation_put_seat(&x));
+        }
+    seat_t pa = mkseat("EVPIN", "A", 100), pb = mkseat("EVPIN", "B", 100);
+    assert(reservation_put_seat(&pa) && reservation_put_seat(&pb));
+    for (int round = 0; round < PIN_ROUNDS; ++round)
+    {
+        reservation_set_hold_limit(0);
+        for (int e = 0; e < PIN_EVENTS; ++e)
+            for (int i = 0; i < PIN_SEATS; ++i)
+            {
+                snprintf(eid, sizeof eid, "EVPX%d", e);
+                snprintf(sid, sizeof sid, "X%d", i);
+                assert(place_hold("UPIN", eid, sid).code == RES_OK);
+            }
+        hold_result_t h = place_hold("UPIN", "EVPIN", "A");
+        assert(h.code == RES_OK);
+        reservation_set_hold_limit(1);
+        __atomic_store_n(&g_pin_stop, 0, __ATOMIC_RELEASE);
+        __atomic_store_n(&g_pin_ready, 0, __ATOMIC_RELEASE);
+        pthread_t pin, rehold;
+        pthread_create(&pin, NULL, pin_worker, &h);
+        while (__atomic_load_n(&g_pin_ready, __ATOMIC_ACQUIRE) != 1)
+            sched_yield();
+        pthread_create(&rehold, NULL, rehold_worker, NULL);
+        while (__atomic_load_n(&g_pin_ready, __ATOMIC_ACQUIRE) != 2)
+            sched_yield(); // both are at it
+        cancel_all_holds("UPIN");
+        __atomic_store_n(&g_pin_stop, 1, __ATOMIC_RELEASE);
+        pthread_join(pin, NULL);
+        pthread_join(rehold, NULL);
+        cancel_all_holds("UPIN");
+        assert(event_inventory("EVPIN", &inv) && inv.held == 0);
+    }
+
+    reservation_set_hold_limit(0);
+    reservation_shutdown();
+    printf("[OK] per-user hold limit and cancel_all_holds\n");
+}
+
+#define CANCEL_SOLD 600 // three refund batches
+
+static bool stop_after_one(const event_refund_progress_t *p, void *ctx)
+{
+    *(size_t *)ctx += p->refunded;
+    return false;
+}
+
+static bool count_refunds(const event_refund_progress_t *p, void *ctx)
+{
+    *(size_t *)ctx = p->refunded;
+    return true;
+}
+
+static void test_event_cancel_and_refund(void)
+{
+    assert(reservation_init());
+    reservation_set_hold_length_seconds(300);
+    enum { SEATS = CANCEL_SOLD + 40 };
+    static seat_t seats[SEATS];
+    static char orders[CANCEL_SOLD][RES_ID_LEN];
+    char sid[RES_ID_LEN], user[RES_ID_LEN];
+    for (int i = 0; i < SEATS; ++i)
+    {
+        snprintf(sid, sizeof sid, "X%d", i);
+        seats[i] = mkseat("EVX", sid, 900);
+    }
+    assert(event_load("EVX", seats, SEATS));
+    seat_t other = mkseat("EVX2", "X0", 900);
+    assert(reservation_put_seat(&other));
+    for (int i = 0; i < CANCEL_SOLD; ++i)
+    {
+        snprintf(sid, sizeof sid, "X%d", i);
+        snprintf(user, sizeof user, "B%d", i % 50);
+        hold_result_t h = place_hold(user, "EVX", sid);
+        confirm_result_t c = confirm_reservation(h.hold_token, h.token_len, 900);
+        assert(h.code == RES_OK && c.code == RES_OK);
+        strcpy(orders[i], c.order_id);
+    }
+    hold_result_t held = place_hold("H1", "EVX", "X620");
+    assert(held.code == RES_OK);
+    hold_result_t h2 = place_hold("B0", "EVX2", "X0");
+    confirm_result_t sold2 = confirm_reservation(h2.hold_token, h2.token_len, 900);
+    assert(sold2.code == RES_OK);
+    assert(refund("B0", orders[0]) == RES_OK); // refunded on its own before the cancel
+
+    // A run stopped after its first batch leaves the rest for the next.
+    size_t refunded = 0;
+    assert(!event_cancel_and_refund("EVX", 1, stop_after_one, &refunded));
+    assert(refunded > 0 && refunded < CANCEL_SOLD - 1);
+    size_t resumed = 0;
+    assert(event_cancel_and_refund("EVX", 4, count_refunds, &resumed));
+    assert(refunded + resumed == CANCEL_SOLD - 1);
+    assert(event_cancel_and_refund("EVX", 0, NULL, NULL)); // nothing left
+
+    // Every seat is off sale; holds are gone, other events untouched.
+    event_inventory_t inv;
+    assert(event_inventory("EVX", &inv) && inv.refunded == SEATS && inv.sold == 0 && inv.held == 0);
+    assert(event_inventory_verify("EVX"));
+    seat_view_t v;
+    assert(seat_get("EVX", "X0", &v) && v.status == SEAT_REFUNDED);
+    assert(place_hold("NEW", "EVX", "X0").code == RES_NOT_FOUND);
+    assert(place_hold("NEW", "EVX", "X630").code == RES_NOT_FOUND);
+    group_seat_t g[1];
+    assert(find_best_available("NEW", "EVX", NULL, 1, g) != RES_OK);
+    assert(confirm_reservation(held.hold_token, held.token_len, 900).code != RES_OK);
+    assert(cancel_all_holds("H1") == 0);
+    assert(refund("B1", orders[1]) == RES_NOT_FOUND);
+    assert(seat_get("EVX2", "X0", &v) && v.status == SEAT_SOLD);
+    assert(refund("B0", sold2.order_id) == RES_OK);
+    assert(!event_cancel_and_refund("NOPE", 1, NULL, NULL));
+
+    reservation_shutdown();
+    printf("[OK] event cancel and mass refund\n");
+}
+
+static void test_rate_limits(void)
+{
+    assert(reservation_init());
+    seat_t a = mkseat("EVRL", "R1", 100);
+    assert(reservation_put_seat(&a));
+
+    // A burst of 3 holds a second, counted per user and per operation.
+    assert(reservation_set_rate_limit(RES_OP_HOLD, 1, 3));
+    assert(!reservation_set_rate_limit(RES_OP_COUNT, 1, 1));
+    assert(place_hold("SPAM", "EVRL", "R1").code == RES_OK);
+    assert(place_hold("SPAM", "EVRL", "R1").code == RES_HOLD_EXISTS_SAME_USER);
+    assert(place_hold("SPAM", "EVRL", "NOPE").code == RES_NOT_FOUND);
+    assert(place_hold("SPAM", "EVRL", "R1").code == RES_RATE_LIMITED);
+    assert(place_hold_ix("SPAM", 1, 1).code == RES_RATE_LIMITED);
+    assert(place_hold("OTHER", "EVRL", "R1").code == RES_HELD_BY_OTHER);
+    assert(cancel_hold("SPAM", "EVRL", "R1") == RES_OK); // cancels are not limited
+
+    assert(reservation_set_rate_limit(RES_OP_CANCEL, 1, 1));
+    assert(cancel_hold("SPAM", "EVRL", "R1") == RES_NOT_FOUND);
+    assert(cancel_hold("SPAM", "EVRL", "R1") == RES_RATE_LIMITED);
+    group_seat_t g[1];
+    assert(reservation_set_rate_limit(RES_OP_SEARCH, 1, 1));
+    assert(find_best_available("SPAM", "EVRL", NULL, 1, g) == RES_OK); // holds not charged
+    assert(find_best_available("SPAM", "EVRL", NULL, 1, g) == RES_RATE_LIMITED);
+
+    // Reads are gated by the caller; 0 lifts a limit.
+    assert(reservation_admit("SPAM", RES_OP_GET));
+    assert(reservation_set_rate_limit(RES_OP_GET, 1, 2));
+    assert(reservation_admit("SPAM", RES_OP_GET) && reservation_admit("SPAM", RES_OP_GET));
+    assert(!reservation_admit("SPAM", RES_OP_GET) && reservation_admit("OTHER", RES_OP_GET));
+    assert(reservation_set_rate_limit(RES_OP_GET, 0, 0));
+    assert(reservation_admit("SPAM", RES_OP_GET));
+    assert(reservation_set_rate_limit(RES_OP_HOLD, 0, 0));
+    assert(place_hold("SPAM", "EVRL", "R1").code == RES_HOLD_EXISTS_SAME_USER);
+
+    reservation_shutdown(); // clears every limit
+    assert(reservation_init());
+    assert(reservation_admit("SPAM", RES_OP_GET) && reservation_admit("SPAM", RES_OP_SEARCH));
+    reservation_shutdown();
+    printf("[OK] per-user rate limits\n");
+}
+
+// Buyers keep holding and cancelling seats of EVC while the main thread
+// sweeps with no idle time, so the event is evicted whenever it is free of
+// holds and faulted back by the next call.
+static int g_tier_stop;
+
+static void *tier_churn(void *arg)
+{
+    char user[RES_ID_LEN], sid[RES_ID_LEN];
+    snprintf(user, sizeof user, "TC%d", (int)(intptr_t)arg);
+    for (int i = 0; !__atomic_load_n(&g_tier_stop, __ATOMIC_RELAXED); ++i)
+    {
+        snprintf(sid, sizeof sid, "C%d", ((int)(intptr_t)arg * 7 + i) % 16);
+        seat_view_t v;
+        assert(seat_get("EVC", sid, &v));
+        if (i % 4 == 0 && place_hold(user, "EVC", sid).code == RES_OK)
+            assert(cancel_hold(user, "EVC", sid) == RES_OK);
+        usleep(20);
+    }
+    return NULL;
+}
+
+static void test_tiering(void)
+{
+    assert(reservation_init());
+    reservation_set_hold_length_seconds(300);
+    char csv[64], bin[64];
+    snprintf(csv, sizeof csv, "/tmp/tb_tier_%d.csv", (int)getpid());
+    snprintf(bin, sizeof bin, "/tmp/tb_tier_%d.tbv", (int)getpid());
+    FILE *f = fopen(csv, "w");
+    assert(f);
+    for (int i = 0; i < 8; ++i)
+        fprintf(f, "EVT,Floor,A,A%d,P1,800\n", i);
+    for (int i = 0; i < 8; ++i)
+        fprintf(f, "EVT,Upper,B,B%d,P2,400\n", i);
+    fclose(f);
+    assert(tb_manifest_from_csv(csv, bin, NULL));
+    assert(reservation_load_manifest(bin, 1) == 16);
+    seat_t seats[16];
+    char sid[RES_ID_LEN];
+    for (int i = 0; i < 16; ++i)
+    {
+        snprintf(sid, sizeof sid, "Q%d", i);
+        seats[i] = mkseat("EVQ", sid, 100 + i);
+    }
+    assert(event_load("EVQ", seats, 16));
+    hold_result_t h = place_hold("TB", "EVT", "A3");
+    confirm_result_t sold = confirm_reservation(h.hold_token, h.token_len, h.price_cents);
+    assert(sold.code == RES_OK);
+    assert(place_hold("TH", "EVT", "A5").code == RES_OK);
+
+    // Off until enabled; a sweep leaves events with live holds alone.
+    assert(!event_evict("EVQ") && reservation_tier_sweep() == 0);
+    assert(!reservation_enable_tiering("/nonexistent/dir", 0, 0));
+    assert(reservation_enable_tiering("/tmp", 0, 0));
+    tier_stats_t st;
+    assert(reservation_tier_sweep() == 1);
+    assert(event_is_cold("EVQ") && !event_is_cold("EVT"));
+    assert(reservation_tier_stats(&st) && st.cold_events == 1 && st.segment_bytes > 0);
+
+    // The first read faults EVQ back with its seats as they were.
+    seat_view_t v;
+    assert(seat_get("EVQ", "Q7", &v) && v.price_cents == 107 && v.status == SEAT_AVAILABLE);
+    assert(!event_is_cold("EVQ"));
+    assert(reservation_tier_stats(&st) && st.cold_events == 0 && st.faults == 1);
+    assert(st.segment_bytes == 0 && st.fault_ns > 0);
+
+    // Once its hold is gone EVT goes too, sale, layout and all.
+    assert(cancel_hold("TH", "EVT", "A5") == RES_OK);
+    assert(reservation_tier_sweep() == 2);
+    assert(event_is_cold("EVT") && event_is_cold("EVQ"));
+    assert(event_available_count("EVT", "Floor") == 7 && !event_is_cold("EVT"));
+    seat_t full;
+    assert(seat_export_ix(tb_intern_lookup(TB_NS_EVENT, "EVT"), tb_intern_lookup(TB_NS_SEAT, "A3"), &full));
+    assert(full.status == SEAT_SOLD && strcmp(full.last_order_id, sold.order_id) == 0);
+    assert(event_inventory_verify("EVT"));
+    group_seat_t g[4];
+    assert(find_best_available("TG", "EVT", "Upper", 4, g) == RES_OK);
+    assert(strcmp(g[0].seat_id, "B2") == 0 && strcmp(g[3].seat_id, "B5") == 0);
+    assert(!event_evict("EVT")); // held again
+    assert(cancel_all_holds("TG") == 4);
+    assert(event_evict("EVT") && event_evict("EVT"));
+    assert(refund("TB", sold.order_id) == RES_OK); // faults it back
+    assert(seat_get("EVT", "A3", &v) && v.status == SEAT_AVAILABLE);
+    event_inventory_t inv;
+    assert(event_evict("EVT") && event_inventory("EVT", &inv) && inv.seats == 16 && inv.available == 16);
+    priced_seat_t cheap[2];
+    assert(event_evict("EVT") && event_cheapest_seats("EVT", 0, 1000, 2, cheap) == 2);
+    assert(strcmp(cheap[0].seat_id, "B0") == 0 && cheap[1].price_cents == 400);
+
+    // Loading more seats into a cold event adds to it; unloading drops the
+    // segment.
+    seat_t more = mkseat("EVQ", "Q99", 5);
+    assert(event_is_cold("EVQ") && reservation_put_seat(&more));
+    assert(event_inventory("EVQ", &inv) && inv.seats == 17);
+    assert(event_evict("EVQ") && event_unload("EVQ"));
+    assert(!event_is_cold("EVQ") && !event_inventory("EVQ", &inv));
+    assert(reservation_tier_stats(&st) && st.cold_events == 0 && st.segment_bytes == 0);
+    assert(!event_evict("EVQ") && !event_evict("NOPE"));
+
+    // A memory limit evicts busy events too, least recently used first.
+    assert(reservation_enable_tiering("/tmp", 1, 3600));
+    assert(reservation_tier_sweep() == 1 && event_is_cold("EVT"));
+    assert(reservation_enable_tiering("/tmp", 0, 0));
+
+    // Evictions and faults racing callers.
+    for (int i = 0; i < 16; ++i)
+    {
+        snprintf(sid, sizeof sid, "C%d", i);
+        seats[i] = mkseat("EVC", sid, 300);
+    }
+    assert(event_load("EVC", seats, 16));
+    enum { CHURNERS = 4 };
+    pthread_t th[CHURNERS];
+    __atomic_store_n(&g_tier_stop, 0, __ATOMIC_RELAXED);
+    for (int t = 0; t < CHURNERS; ++t)
+        assert(pthread_create(&th[t], NULL, tier_churn, (void *)(intptr_t)t) == 0);
+    size_t evicted = 0;
+    for (int i = 0; i < 2000; ++i)
+    {
+        evicted += reservation_tier_sweep();
+        usleep(20);
+    }
+    __atomic_store_n(&g_tier_stop, 1, __ATOMIC_RELAXED);
+    for (int t = 0; t < CHURNERS; ++t)
+        pthread_join(th[t], NULL);
+    assert(event_inventory("EVC", &inv) && inv.seats == 16 && inv.available == 16);
+    assert(event_inventory_verify("EVC"));
+    assert(reservation_tier_stats(&st));
+    printf("  (%zu evictions under load, %llu faults in all)\n", evicted,
+           (unsigned long long)st.faults);
+
+    remove(csv);
+    remove(bin);
+    reservation_shutdown();
+    printf("[OK] tiered storage evicts and faults events back\n");
+}
+
 int main(void)
 {
     test_hold_confirm_cancel_flow();
     test_cancel_hold_and_expiry();
+    test_event_load_unload();
+    test_best_available();
+    test_inventory();
+    test_price_queries();
+    test_seating_chart();
+    test_seat_get_many();
+    test_concurrent_hold_linearizable();
+    test_hold_limit_and_cancel_all();
+    test_rate_limits();
+    test_event_cancel_and_refund();
+    test_tiering();
     printf("All reservation tests passed.\n");
     return 0;
 }
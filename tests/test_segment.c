@@ -0,0 +1,130 @@
+// Unit tests for event segments: round trip, compactness, damaged files
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "segment.h"
+
+#define RECORDS 1000
+
+static char g_path[64];
+
+static void make_seat(seat_t *s, size_t i)
+{
+    memset(s, 0, sizeof *s);
+    strcpy(s->event_id, "SG1");
+    snprintf(s->seat_id, TB_ID_LEN, "ROW%02zu-%03zu", i / 40, i % 40);
+    s->price_cents = (tb_money_cents_t)(2500 + (i / 100) * 500);
+    s->updated_unix = 1700000000;
+}
+
+// Record i: unused every 97th, sold every 10th, one held, one refunded.
+static bool record(size_t i, seat_t *s)
+{
+    if (i % 97 == 5)
+        return false;
+    make_seat(s, i);
+    if (i % 10 == 0)
+    {
+        s->status = SEAT_SOLD;
+        snprintf(s->last_order_id, TB_ID_LEN, "ORD%zu", i);
+        s->updated_unix = 1700000000 + (tb_epoch_t)i;
+    }
+    if (i == 7)
+    {
+        s->status = SEAT_HELD;
+        strcpy(s->holder_user_id, "U7");
+        s->hold_expires_unix = 1700000300;
+        memset(s->hold_token, 0xAB, 16);
+        s->hold_token_len = 16;
+    }
+    if (i == 11)
+        s->status = SEAT_REFUNDED;
+    return true;
+}
+
+static void write_segment(size_t *bytes)
+{
+    seat_row_t rows[2] = {{1, 0, 500}, {2, 500, 500}};
+    tb_segment_writer_t w;
+    assert(tb_segment_begin(&w, "SG1", RECORDS, 1700000000, rows, 2));
+    seat_t s;
+    for (size_t i = 0; i < RECORDS; ++i)
+        tb_segment_add(&w, record(i, &s) ? &s : NULL);
+    assert(tb_segment_finish(&w, g_path, bytes));
+}
+
+static void test_round_trip(void)
+{
+    size_t bytes = 0;
+    write_segment(&bytes);
+    assert(bytes > 0 && bytes < RECORDS * 12); // vs ~200-byte seat_t records
+
+    tb_segment_t seg;
+    assert(tb_segment_open(&seg, g_path));
+    assert(strcmp(seg.event_id, "SG1") == 0 && seg.records == RECORDS);
+    assert(seg.n_rows == 2 && seg.rows[1].section_ix == 2 && seg.rows[1].first == 500);
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        seat_t got, want;
+        bool present;
+        size_t seats = 0;
+        for (size_t i = 0; i < RECORDS; ++i)
+        {
+            assert(tb_segment_next(&seg, &got, &present));
+            assert(present == record(i, &want));
+            if (!present)
+                continue;
+            seats++;
+            assert(memcmp(&got, &want, sizeof got) == 0);
+        }
+        assert(!tb_segment_next(&seg, &got, &present) && tb_segment_done(&seg));
+        assert(seats == seg.seats);
+        tb_segment_rewind(&seg);
+    }
+    tb_segment_close(&seg);
+    printf("[OK] segment round trip (%zu records in %zu bytes)\n", (size_t)RECORDS, bytes);
+}
+
+static void test_damaged(void)
+{
+    tb_segment_t seg;
+    size_t bytes;
+    write_segment(&bytes);
+
+    // A flipped byte fails the checksum.
+    FILE *f = fopen(g_path, "r+b");
+    assert(f && fseek(f, (long)bytes / 2, SEEK_SET) == 0);
+    int c = fgetc(f);
+    assert(fseek(f, (long)bytes / 2, SEEK_SET) == 0 && fputc(c ^ 0x5A, f) != EOF);
+    fclose(f);
+    assert(!tb_segment_open(&seg, g_path));
+
+    // Truncated; missing.
+    write_segment(&bytes);
+    assert(truncate(g_path, (off_t)bytes - 1) == 0);
+    assert(!tb_segment_open(&seg, g_path));
+    remove(g_path);
+    assert(!tb_segment_open(&seg, g_path));
+
+    // Fewer records than announced writes nothing.
+    tb_segment_writer_t w;
+    seat_t s;
+    make_seat(&s, 0);
+    assert(tb_segment_begin(&w, "SG1", 2, 0, NULL, 0));
+    tb_segment_add(&w, &s);
+    assert(!tb_segment_finish(&w, g_path, NULL));
+    assert(access(g_path, F_OK) != 0);
+    printf("[OK] segment damaged files rejected\n");
+}
+
+int main(void)
+{
+    snprintf(g_path, sizeof g_path, "/tmp/tb_segment_%d.tbseg", (int)getpid());
+    test_round_trip();
+    test_damaged();
+    printf("All segment tests passed.\n");
+    return 0;
+}
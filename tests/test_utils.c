@@ -0,0 +1,184 @@
+// Unit tests for the hash and compare helpers, including a distribution
+// harness (chain lengths over seat-shaped keys, bit avalanche).
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils.h"
+
+// Known answers from the scalar variant; every SIMD variant must match them
+// bit for bit.
+static void check_known_answers(void)
+{
+    static const struct
+    {
+        size_t len;
+        uint64_t h;
+    } kat[] = {
+        {0, 0xe1ece85427cee75eULL},   {1, 0x13bf9b86951790c9ULL},
+        {7, 0xec2fe3c091c2ba17ULL},   {8, 0x09fcb735ab41a04eULL},
+        {31, 0x030cc1bd2ce80c6aULL},  {32, 0x88867a757e1bd35eULL},
+        {33, 0x8dd1345755761a41ULL},  {64, 0x60b064f61b0b6d22ULL},
+        {255, 0xc8dc3b89ed84e30cULL}, {256, 0x19083a60ad8a5798ULL},
+        {300, 0x3fc063d90a14ed2fULL},
+    };
+    unsigned char buf[300];
+    for (int i = 0; i < 300; ++i)
+        buf[i] = (unsigned char)(i * 7 + 1);
+    for (size_t i = 0; i < sizeof kat / sizeof kat[0]; ++i)
+        assert(tb_hash_bytes(buf, kat[i].len, 42) == kat[i].h);
+    assert(tb_hash_key_fast("E1", "S1") == 0x3920bc68c757028bULL);
+
+    // seed and field boundaries matter
+    assert(tb_hash_bytes(buf, 16, 1) != tb_hash_bytes(buf, 16, 2));
+    assert(tb_hash_key_fast("E1", "S12") != tb_hash_key_fast("E1S", "12"));
+    assert(tb_hash_name_fast("E1") == tb_hash_bytes("E1", 2, 0));
+}
+
+// Seat-shaped keys into a power-of-two table at load factor 1: the longest
+// chain and the chi-square of the bucket histogram should look random.
+static void test_chain_lengths(void)
+{
+    enum { EVENTS = 64, SEATS = 4096, N = EVENTS * SEATS, BUCKETS = N };
+    unsigned *chain = calloc(BUCKETS, sizeof *chain);
+    assert(chain);
+    char ev[32], st[32];
+    for (int e = 0; e < EVENTS; ++e)
+    {
+        snprintf(ev, sizeof ev, "EV-%d", e);
+        for (int s = 0; s < SEATS; ++s)
+        {
+            snprintf(st, sizeof st, "R%02d-S%03d", s / 100, s % 100);
+            chain[tb_hash_key_fast(ev, st) & (BUCKETS - 1)]++;
+        }
+    }
+    unsigned longest = 0;
+    double chi2 = 0;
+    for (size_t b = 0; b < BUCKETS; ++b)
+    {
+        if (chain[b] > longest)
+            longest = chain[b];
+        chi2 += ((double)chain[b] - 1.0) * ((double)chain[b] - 1.0);
+    }
+    // Poisson(1): max of 262144 draws is ~9; chi2 ~ N +- sqrt(2N)
+    assert(longest <= 12);
+    assert(fabs(chi2 - N) < 6 * sqrt(2.0 * N));
+    free(chain);
+    printf("[OK] hash chain lengths (max %u, chi2/N %.3f)\n", longest, chi2 / N);
+}
+
+// Flipping any input bit must flip every output bit with probability ~1/2.
+static void test_avalanche(void)
+{
+    enum { LEN = 24, BITS = LEN * 8, SAMPLES = 2000 };
+    unsigned (*flips)[64] = calloc(BITS, sizeof *flips);
+    assert(flips);
+    uint64_t rng = 0x9e3779b97f4a7c15ULL;
+    unsigned char in[LEN];
+    for (int n = 0; n < SAMPLES; ++n)
+    {
+        for (int i = 0; i < LEN; ++i)
+        {
+            rng ^= rng << 13, rng ^= rng >> 7, rng ^= rng << 17;
+            in[i] = (unsigned char)rng;
+        }
+        uint64_t h0 = tb_hash_bytes(in, LEN, 7);
+        for (int b = 0; b < BITS; ++b)
+        {
+            in[b / 8] ^= (unsigned char)(1u << (b % 8));
+            uint64_t d = h0 ^ tb_hash_bytes(in, LEN, 7);
+            in[b / 8] ^= (unsigned char)(1u << (b % 8));
+            for (int o = 0; o < 64; ++o)
+                flips[b][o] += (unsigned)(d >> o) & 1u;
+        }
+    }
+    double worst = 0;
+    for (int b = 0; b < BITS; ++b)
+        for (int o = 0; o < 64; ++o)
+        {
+            double bias = fabs((double)flips[b][o] / SAMPLES - 0.5);
+            if (bias > worst)
+                worst = bias;
+        }
+    // sampling noise alone is ~0.011 per cell, ~0.05 worst over 12k cells
+    assert(worst < 0.08);
+    free(flips);
+    printf("[OK] hash avalanche (worst bias %.3f)\n", worst);
+}
+
+static void check_memcmp_token32(void)
+{
+    unsigned char a[40], b[40];
+    memset(a, 0x5a, sizeof a);
+    memcpy(b, a, sizeof b);
+    assert(tb_memcmp_token32(a, b, 32) == 0);
+    b[31] ^= 1;
+    assert(tb_memcmp_token32(a, b, 32) != 0);
+    b[31] ^= 1;
+    b[35] ^= 1; // past the 32-byte cap
+    assert(tb_memcmp_token32(a, b, 40) == 0);
+    assert(tb_memcmp_token32(a, b, 0) == 0);
+    for (size_t n = 1; n <= 32; ++n) // every short length, first and last byte
+    {
+        b[0] ^= 1;
+        assert(tb_memcmp_token32(a, b, n) != 0);
+        b[0] ^= 1;
+        b[n - 1] ^= 0x80;
+        assert(tb_memcmp_token32(a, b, n) != 0);
+        b[n - 1] ^= 0x80;
+        assert(tb_memcmp_token32(a + 1, b + 1, n) == 0); // unaligned
+    }
+}
+
+static void check_popcount(void)
+{
+    uint64_t w[67];
+    uint64_t x = 0x9e3779b97f4a7c15ULL;
+    for (size_t i = 0; i < 67; ++i)
+    {
+        x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+        w[i] = i % 5 == 0 ? ~0ULL : x;
+    }
+    for (size_t off = 0; off < 3; ++off) // unaligned starts, every tail length
+        for (size_t n = 0; off + n <= 67; ++n)
+        {
+            size_t want = 0;
+            for (size_t i = off; i < off + n; ++i)
+                for (uint64_t v = w[i]; v; v &= v - 1)
+                    want++;
+            assert(tb_popcount_words(w + off, n) == want);
+        }
+}
+
+// Run the kernel checks under every variant this CPU can execute.
+static void test_variants(void)
+{
+    const char *def = tb_utils_variant();
+    const char *name;
+    for (size_t i = 0; (name = tb_utils_variant_name(i)) != NULL; ++i)
+    {
+        if (!tb_utils_select(name))
+        {
+            printf("[--] variant %s not supported here\n", name);
+            continue;
+        }
+        assert(strcmp(tb_utils_variant(), name) == 0);
+        check_known_answers();
+        check_memcmp_token32();
+        check_popcount();
+        printf("[OK] variant %s: hash known answers, memcmp_token32, popcount\n", name);
+    }
+    assert(!tb_utils_select("no-such-variant"));
+    assert(tb_utils_select(def));
+}
+
+int main(void)
+{
+    test_variants();
+    test_chain_lengths();
+    test_avalanche();
+    printf("All utils tests passed.\n");
+    return 0;
+}
@@ -0,0 +1,39 @@
+// Convert a venue CSV into a binary manifest (see manifest.h).
+//
+//   make tools/venue_convert && ./tools/venue_convert venue.csv venue.tbv
+#include <stdio.h>
+
+#include "manifest.h"
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "usage: %s <in.csv> <out.tbv>\n"
+                        "  CSV columns: event_id,section,row,seat_id,tier,price_cents\n",
+                argv[0]);
+        return 2;
+    }
+    size_t bad_line = 0;
+    if (!tb_manifest_from_csv(argv[1], argv[2], &bad_line))
+    {
+        if (bad_line)
+            fprintf(stderr, "%s:%zu: malformed, duplicate seat or conflicting tier price\n",
+                    argv[1], bad_line);
+        else
+            perror(argv[1]);
+        return 1;
+    }
+
+    tb_manifest_t mf;
+    if (!tb_manifest_open(&mf, argv[2]))
+    {
+        fprintf(stderr, "%s: written file failed validation\n", argv[2]);
+        return 1;
+    }
+    printf("%s: %u events, %u sections, %u rows, %u tiers, %llu seats, %zu bytes\n",
+           argv[2], mf.hdr->n_events, mf.hdr->n_sections, mf.hdr->n_rows, mf.hdr->n_tiers,
+           (unsigned long long)mf.hdr->n_seats, mf.bytes);
+    tb_manifest_close(&mf);
+    return 0;
+}